@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_BENCHMARK_H
+#define LAMBDACOMMON_BENCHMARK_H
+
+#include <lambdacommon/lambdacommon.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace lambdabench
+{
+    typedef std::chrono::steady_clock clock;
+
+    /*!
+     * Prevents the compiler from optimizing away a value.
+     * @param value The value.
+     */
+    template<typename T>
+    inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T* sink;
+        sink = &value;
+#endif
+    }
+
+    /*!
+     * Measures the execution time of a function.
+     * @param func The function.
+     * @return The time in seconds.
+     */
+    template<typename F>
+    inline double measure(F&& func) {
+        auto start = clock::now();
+        func();
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+
+    /*!
+     * Prints the throughput of a benchmark.
+     * @param name The name of the benchmark.
+     * @param count The count of operations.
+     * @param seconds The time taken by the operations.
+     * @param unit The name of an operation.
+     */
+    inline void report(const std::string& name, double count, double seconds, const char* unit) {
+        std::printf("%-40s %14.0f %s/s (%.3fs)\n", name.c_str(), count / seconds, unit, seconds);
+    }
+}
+
+#endif //LAMBDACOMMON_BENCHMARK_H
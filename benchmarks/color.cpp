@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/graphics/color.h>
+#include <lambdacommon/maths/soa.h>
+#include <vector>
+
+using namespace lambdacommon;
+
+// A 256 by 256 image.
+#define COUNT 65536
+#define ITERATIONS 500
+
+template<typename F>
+static void run(const std::string& name, F function) {
+    auto seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++)
+            function();
+    });
+    lambdabench::report(name, static_cast<double>(COUNT) * ITERATIONS, seconds, "pixels");
+}
+
+int main() {
+    std::vector<Color> colors;
+    std::vector<color_f32x4> floats;
+    for (int i = 0; i < COUNT; i++) {
+        Color color{static_cast<f32>(i % 256) / 255.f, static_cast<f32>(i / 256) / 255.f, 0.5f, static_cast<f32>(i % 7) / 6.f};
+        colors.push_back(color);
+        floats.push_back(color::to_f32x4(color));
+    }
+    std::vector<color_rgba8> bytes(COUNT);
+
+    // The existing class, a call per component.
+    run("Color to bytes", [&]() {
+        for (size_t j = 0; j < COUNT; j++)
+            bytes[j] = {colors[j].red_as_int(), colors[j].green_as_int(), colors[j].blue_as_int(), colors[j].alpha_as_int()};
+        lambdabench::do_not_optimize(bytes.data());
+    });
+    run("bytes to Color", [&]() {
+        for (size_t j = 0; j < COUNT; j++)
+            colors[j] = color::from_int_rgba(bytes[j].red, bytes[j].green, bytes[j].blue, bytes[j].alpha);
+        lambdabench::do_not_optimize(colors.data());
+    });
+
+    auto supported = maths::get_supported_simd_level();
+    for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+        if (level > supported || maths::set_simd_level(level) != level)
+            continue;
+        std::string name = maths::get_simd_level_name(level);
+        run("to_rgba8 (" + name + ")", [&]() {
+            color::to_rgba8(floats.data(), bytes.data(), COUNT);
+            lambdabench::do_not_optimize(bytes.data());
+        });
+        run("to_rgba8 premultiplied (" + name + ")", [&]() {
+            color::to_rgba8(floats.data(), bytes.data(), COUNT, ALPHA_PREMULTIPLY);
+            lambdabench::do_not_optimize(bytes.data());
+        });
+        run("to_f32x4 (" + name + ")", [&]() {
+            color::to_f32x4(bytes.data(), floats.data(), COUNT);
+            lambdabench::do_not_optimize(floats.data());
+        });
+        run("premultiply rgba8 (" + name + ")", [&]() {
+            color::premultiply(bytes.data(), COUNT);
+            lambdabench::do_not_optimize(bytes.data());
+        });
+    }
+    maths::set_simd_level(supported);
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/fast.h>
+#include <lambdacommon/maths/soa.h>
+#include <cmath>
+#include <vector>
+
+using namespace lambdacommon;
+
+#define COUNT 4096
+#define ITERATIONS 2000
+
+typedef void (* batch_function)(const f32* in, f32* out, size_t count);
+
+template<typename F>
+static void run_scalar(const std::string& name, const std::vector<f32>& in, std::vector<f32>& out, F function) {
+    auto seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < COUNT; j++)
+                out[j] = function(in[j]);
+            lambdabench::do_not_optimize(out.data());
+        }
+    });
+    lambdabench::report(name, static_cast<double>(COUNT) * ITERATIONS, seconds, "values");
+}
+
+static void run_batch(const std::string& name, const std::vector<f32>& in, std::vector<f32>& out, batch_function function) {
+    auto seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            function(in.data(), out.data(), COUNT);
+            lambdabench::do_not_optimize(out.data());
+        }
+    });
+    lambdabench::report(name, static_cast<double>(COUNT) * ITERATIONS, seconds, "values");
+}
+
+int main() {
+    std::vector<f32> angles, positives, out(COUNT);
+    for (int i = 0; i < COUNT; i++) {
+        angles.push_back(static_cast<f32>(i - COUNT / 2) * 0.01f);
+        positives.push_back(static_cast<f32>(i) * 0.37f + 0.01f);
+    }
+
+    run_scalar("std::sin", angles, out, [](f32 x) { return std::sin(x); });
+    run_scalar("fast::sin", angles, out, [](f32 x) { return maths::fast::sin(x); });
+    run_scalar("std::exp", angles, out, [](f32 x) { return std::exp(x); });
+    run_scalar("fast::exp", angles, out, [](f32 x) { return maths::fast::exp(x); });
+    run_scalar("std::log", positives, out, [](f32 x) { return std::log(x); });
+    run_scalar("fast::log", positives, out, [](f32 x) { return maths::fast::log(x); });
+    run_scalar("1 / std::sqrt", positives, out, [](f32 x) { return 1.f / std::sqrt(x); });
+    run_scalar("fast::rsqrt", positives, out, [](f32 x) { return maths::fast::rsqrt(x); });
+
+    auto supported = maths::get_supported_simd_level();
+    for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+        if (level > supported || maths::set_simd_level(level) != level)
+            continue;
+        std::string name = maths::get_simd_level_name(level);
+        run_batch("batch sin (" + name + ")", angles, out, maths::fast::sin);
+        run_batch("batch exp (" + name + ")", angles, out, maths::fast::exp);
+        run_batch("batch log (" + name + ")", positives, out, maths::fast::log);
+        run_batch("batch rsqrt (" + name + ")", positives, out, maths::fast::rsqrt);
+    }
+    maths::set_simd_level(supported);
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/fixed.h>
+#include <lambdacommon/maths/soa.h>
+#include <vector>
+
+using namespace lambdacommon;
+
+#define COUNT 4096
+#define ITERATIONS 5000
+
+template<typename F>
+static void run(const std::string& name, F function) {
+    auto seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++)
+            function();
+    });
+    lambdabench::report(name, static_cast<double>(COUNT) * ITERATIONS, seconds, "products");
+}
+
+template<typename Fixed>
+static void run_fixed(const std::string& name) {
+    std::vector<Fixed> a, b, out(COUNT);
+    for (int i = 0; i < COUNT; i++) {
+        a.push_back(Fixed{static_cast<f64>(i % 100) * 0.37});
+        b.push_back(Fixed{static_cast<f64>(i % 7) - 3.1});
+    }
+    run(name + " scalar", [&]() {
+        for (size_t j = 0; j < COUNT; j++)
+            out[j] = a[j] * b[j];
+        lambdabench::do_not_optimize(out.data());
+    });
+
+    auto supported = maths::get_supported_simd_level();
+    for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+        if (level > supported || maths::set_simd_level(level) != level)
+            continue;
+        run(name + " batch (" + maths::get_simd_level_name(level) + ")", [&]() {
+            maths::multiply(a.data(), b.data(), out.data(), COUNT);
+            lambdabench::do_not_optimize(out.data());
+        });
+    }
+    maths::set_simd_level(supported);
+}
+
+int main() {
+    std::vector<f32> a, b, out(COUNT);
+    for (int i = 0; i < COUNT; i++) {
+        a.push_back(static_cast<f32>(i % 100) * 0.37f);
+        b.push_back(static_cast<f32>(i % 7) - 3.1f);
+    }
+    run("f32", [&]() {
+        for (size_t j = 0; j < COUNT; j++)
+            out[j] = a[j] * b[j];
+        lambdabench::do_not_optimize(out.data());
+    });
+
+    run_fixed<maths::fixed32>("fixed32");
+    run_fixed<maths::fixed32_saturate>("fixed32_saturate");
+    return 0;
+}
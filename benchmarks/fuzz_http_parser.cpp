@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include <lambdacommon/connection/http.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace lambdacommon::connection;
+
+/*
+ * libFuzzer target: the first byte selects a split point, the parse of the rest in two calls must match a single parse.
+ * The seed corpus is the one of the HTTP parser benchmark, see http_corpus.h.
+ */
+
+static void check(bool condition) {
+    if (!condition)
+        std::abort();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size == 0)
+        return 0;
+    size_t split = data[0];
+    // A copy of the exact size lets the address sanitizer catch any read past the end.
+    std::vector<char> copy(data + 1, data + size);
+    std::string_view input(copy.data(), copy.size());
+    split = split < input.size() ? split : input.size();
+
+    http::request_parser whole;
+    auto status = whole.parse(input);
+
+    http::request_parser resumed;
+    auto first = resumed.parse(input.substr(0, split));
+    if (first == http::INCOMPLETE)
+        first = resumed.parse(input);
+    check(first == status);
+    if (status == http::COMPLETE) {
+        check(whole.get_head_size() == resumed.get_head_size());
+        check(whole.get_header_count() == resumed.get_header_count());
+        check(whole.get_method() == resumed.get_method());
+        check(whole.get_target().get_raw() == resumed.get_target().get_raw());
+    }
+
+    std::vector<char> body(data + 1, data + size);
+    size_t body_size = body.size();
+    http::chunked_decoder decoder;
+    if (decoder.decode(body.data(), body_size) != http::INVALID)
+        check(body_size <= decoder.get_consumed());
+    return 0;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/geometry2d.h>
+#include <lambdacommon/maths/soa.h>
+#include <random>
+
+using namespace lambdacommon;
+
+#define POINTS 100000
+#define VERTICES 64
+#define ITERATIONS 10
+
+int main() {
+    std::vector<point2f> polygon, points;
+    for (int i = 0; i < VERTICES; i++) {
+        f32 angle = static_cast<f32>(i) * 2.f * static_cast<f32>(M_PI) / VERTICES, radius = i % 2 ? 4.f : 10.f;
+        polygon.push_back({radius * std::cos(angle), radius * std::sin(angle)});
+    }
+    std::mt19937 engine{42};
+    std::uniform_real_distribution<f32> distribution{-12.f, 12.f};
+    for (int i = 0; i < POINTS; i++)
+        points.push_back({distribution(engine), distribution(engine)});
+
+    maths::geometry2d::scratch_buffer scratch;
+    std::vector<u8> inside;
+    auto supported = maths::get_supported_simd_level();
+    for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+        if (level > supported || maths::set_simd_level(level) != level)
+            continue;
+        auto seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::geometry2d::contains(polygon, points, inside, scratch);
+                lambdabench::do_not_optimize(inside.data());
+            }
+        });
+        lambdabench::report(std::string("point in polygon (") + maths::get_simd_level_name(level) + ")",
+                            static_cast<double>(POINTS) * ITERATIONS, seconds, "points");
+    }
+    maths::set_simd_level(supported);
+
+    std::vector<u32> hull;
+    auto seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++)
+            maths::geometry2d::convex_hull(points, hull, scratch);
+    });
+    lambdabench::report("convex hull", static_cast<double>(POINTS) * ITERATIONS, seconds, "points");
+
+    std::vector<maths::geometry2d::segment2f> segments;
+    for (int i = 0; i + 1 < POINTS / 10; i++)
+        segments.push_back({points[i], {points[i].x + 0.1f, points[i].y - 0.05f}});
+    std::vector<std::pair<u32, u32>> pairs;
+    seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++)
+            maths::geometry2d::find_intersections(segments, pairs, scratch);
+    });
+    lambdabench::report("segment intersection sweep", static_cast<double>(segments.size()) * ITERATIONS, seconds, "segments");
+    return 0;
+}
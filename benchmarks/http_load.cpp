@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+/*
+ * A closed-loop HTTP/1.1 load generator, the companion of the static server sample.
+ *
+ * Usage: lambdacommon_benchmark_http_load <port> <path> [connections] [seconds] [threads]
+ *
+ * Each connection keeps a single request in flight and sends the next one as soon as the response is complete.
+ * The requests per second and the latency percentiles are printed at the end, to be compared across releases.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/connection/event_loop.h>
+#include <lambdacommon/connection/http.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace lambdacommon;
+using namespace lambdacommon::connection;
+
+struct load_connection
+{
+    tcp_stream stream;
+    std::string input;
+    http::response_parser parser;
+    lambdabench::clock::time_point sent;
+    size_t written = 0;
+};
+
+struct load_result
+{
+    std::vector<double> latencies;
+    u64 errors = 0;
+    /*!
+     * The message of the first exception, the other errors are only counted.
+     */
+    std::string first_exception;
+};
+
+static void run_connections(const Address& address, const std::string& request, size_t count, lambdabench::clock::time_point end,
+                            load_result& result) {
+    event_loop loop;
+    std::vector<std::unique_ptr<load_connection>> connections;
+    size_t active = count;
+    auto finish = [&](load_connection& connection) {
+        loop.remove(connection.stream.get_fd());
+        connection.stream.close();
+        if (--active == 0)
+            loop.stop();
+    };
+
+    auto send = [&](load_connection& connection) {
+        while (connection.written < request.size()) {
+            auto written = connection.stream.write(request.data() + connection.written, request.size() - connection.written);
+            if (!written)
+                return;
+            connection.written += *written;
+        }
+    };
+
+    for (size_t i = 0; i < count; i++) {
+        auto connection = std::make_unique<load_connection>();
+        connection->stream = tcp_stream::connect(address);
+        connection->stream.set_no_delay(true);
+        auto raw = connection.get();
+        loop.add(raw->stream.get_fd(), READABLE | WRITABLE, [&, raw](u32 events) {
+            try {
+                if (events & WRITABLE)
+                    send(*raw);
+                char buffer[16384];
+                while (auto read = raw->stream.read(buffer, sizeof(buffer))) {
+                    if (*read == 0) {
+                        result.errors++;
+                        finish(*raw);
+                        return;
+                    }
+                    raw->input.append(buffer, *read);
+                }
+                for (;;) {
+                    auto status = raw->parser.parse(raw->input);
+                    if (status == http::INCOMPLETE)
+                        return;
+                    auto length = raw->parser.get_content_length();
+                    if (status == http::INVALID || !length) {
+                        result.errors++;
+                        finish(*raw);
+                        return;
+                    }
+                    auto size = raw->parser.get_head_size() + *length;
+                    if (raw->input.size() < size)
+                        return;
+
+                    auto now = lambdabench::clock::now();
+                    if (raw->parser.get_status() != 200)
+                        result.errors++;
+                    result.latencies.push_back(std::chrono::duration<double, std::micro>(now - raw->sent).count());
+                    raw->input.erase(0, size);
+                    raw->parser.reset();
+                    if (end < now) {
+                        finish(*raw);
+                        return;
+                    }
+                    raw->sent = now;
+                    raw->written = 0;
+                    send(*raw);
+                }
+            } catch (const std::exception& e) {
+                if (result.first_exception.empty())
+                    result.first_exception = e.what();
+                result.errors++;
+                finish(*raw);
+            }
+        });
+        raw->sent = lambdabench::clock::now();
+        send(*raw);
+        connections.push_back(std::move(connection));
+    }
+    // A stalled server cannot block the run forever.
+    loop.set_timeout(end - lambdabench::clock::now() + std::chrono::seconds(5), [&]() { loop.stop(); });
+    loop.run();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <port> <path> [connections] [seconds] [threads]" << std::endl;
+        return 1;
+    }
+    Address address{"127.0.0.1", static_cast<port_t>(std::stoi(argv[1]))};
+    std::string request = "GET " + std::string(argv[2]) + " HTTP/1.1\r\nHost: " + address.to_string() + "\r\nUser-Agent: lambdacommon\r\n\r\n";
+    size_t connections = argc > 3 ? std::stoul(argv[3]) : 64;
+    double seconds = argc > 4 ? std::stod(argv[4]) : 10.0;
+    size_t threads = argc > 5 ? std::stoul(argv[5]) : 2;
+
+    auto end = lambdabench::clock::now() + std::chrono::duration_cast<lambdabench::clock::duration>(std::chrono::duration<double>(seconds));
+    std::vector<load_result> results(threads);
+    std::vector<std::thread> workers;
+    auto elapsed = lambdabench::measure([&]() {
+        for (size_t i = 0; i < threads; i++) {
+            size_t count = connections / threads + (i < connections % threads ? 1 : 0);
+            workers.emplace_back([&, i, count]() { run_connections(address, request, count, end, results[i]); });
+        }
+        for (auto& worker : workers)
+            worker.join();
+    });
+
+    std::vector<double> latencies;
+    u64 errors = 0;
+    for (auto& result : results) {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+        if (!result.first_exception.empty())
+            std::cerr << "Connection error: " << result.first_exception << std::endl;
+    }
+    if (latencies.empty()) {
+        std::cerr << "No response received." << std::endl;
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))]; };
+
+    lambdabench::report("GET " + std::string(argv[2]), static_cast<double>(latencies.size()), elapsed, "requests");
+    std::printf("latency: p50 %.1fus, p99 %.1fus, p99.9 %.1fus, max %.1fus\n", percentile(0.5), percentile(0.99), percentile(0.999),
+                latencies.back());
+    std::printf("errors: %llu\n", static_cast<unsigned long long>(errors));
+    return errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include "http_corpus.h"
+#include <lambdacommon/connection/http.h>
+#include <lambdacommon/lstring.h>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace lambdacommon;
+using namespace lambdacommon::connection;
+
+#define ITERATIONS 200000
+
+/*!
+ * The usual copying parser: the head is split into lines and every header is lowered and stored in a map.
+ */
+static bool parse_naive(const std::string& data, std::map<std::string, std::string>& headers) {
+    auto end = data.find("\r\n\r\n");
+    if (end == std::string::npos)
+        return false;
+    std::istringstream stream(data.substr(0, end));
+    std::string line;
+    if (!std::getline(stream, line))
+        return false;
+    auto parts = lstring::split(line, ' ');
+    if (parts.size() != 3)
+        return false;
+    headers.clear();
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        auto colon = line.find(':');
+        if (colon == std::string::npos)
+            return false;
+        auto value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(' '));
+        headers[lstring::to_lower_case(line.substr(0, colon))] = value;
+    }
+    return true;
+}
+
+int main() {
+    std::vector<std::string> corpus;
+    size_t total_bytes = 0;
+    for (auto request : lambdabench::HTTP_REQUEST_CORPUS) {
+        corpus.emplace_back(request);
+        total_bytes += corpus.back().size();
+    }
+    double requests = static_cast<double>(ITERATIONS * corpus.size());
+    double bytes = static_cast<double>(ITERATIONS) * total_bytes;
+
+    std::map<std::string, std::string> headers;
+    auto naive = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++)
+            for (auto& request : corpus)
+                lambdabench::do_not_optimize(parse_naive(request, headers));
+    });
+    lambdabench::report("naive (copying)", requests, naive, "requests");
+
+    http::request_parser parser;
+    auto whole = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++)
+            for (auto& request : corpus) {
+                parser.reset();
+                lambdabench::do_not_optimize(parser.parse(request));
+            }
+    });
+    lambdabench::report("request_parser", requests, whole, "requests");
+    lambdabench::report("request_parser", bytes, whole, "bytes");
+
+    // The head arrives in 3 reads, the bytes already scanned are not scanned again.
+    auto split = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++)
+            for (auto& request : corpus) {
+                std::string_view data = request;
+                parser.reset();
+                parser.parse(data.substr(0, data.size() / 3));
+                parser.parse(data.substr(0, data.size() * 2 / 3));
+                lambdabench::do_not_optimize(parser.parse(data));
+            }
+    });
+    lambdabench::report("request_parser (3 reads)", requests, split, "requests");
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/intersection.h>
+#include <random>
+#include <vector>
+
+using namespace lambdacommon;
+
+#define COUNT 4096
+#define ITERATIONS 2000
+
+int main() {
+    std::mt19937 random{42};
+    std::uniform_real_distribution<f32> coordinate{-100.f, 100.f};
+    auto random_point = [&]() { return point3f{coordinate(random), coordinate(random), coordinate(random)}; };
+
+    std::vector<maths::spatial::aabb3f> box_list;
+    maths::aabb_soa boxes;
+    maths::triangle_soa triangles;
+    maths::sphere_soa spheres;
+    maths::ray_soa rays;
+    for (int i = 0; i < COUNT; i++) {
+        auto corner = random_point();
+        box_list.push_back({corner, corner + vec3f{5.f, 5.f, 5.f}});
+        boxes.push_back(box_list.back());
+        triangles.push_back(random_point(), random_point(), random_point());
+        spheres.push_back(random_point(), 5.f);
+        rays.push_back({random_point(), random_point() - point3f{0.f, 0.f, 0.f}});
+    }
+    maths::ray3f ray{{0.f, 0.f, -150.f}, {0.1f, 0.2f, 1.f}};
+    maths::spatial::aabb3f box{{-20.f, -20.f, -20.f}, {20.f, 20.f, 20.f}};
+    double count = static_cast<double>(COUNT) * ITERATIONS;
+    std::vector<f32> out(COUNT);
+
+    auto seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < COUNT; j++)
+                out[j] = maths::intersect(ray, box_list[j]);
+            lambdabench::do_not_optimize(out.data());
+        }
+    });
+    lambdabench::report("ray-box single", count, seconds, "tests");
+
+    auto supported = maths::get_supported_simd_level();
+    for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+        if (level > supported || maths::set_simd_level(level) != level)
+            continue;
+        std::string name = maths::get_simd_level_name(level);
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::intersect(ray, boxes, out);
+                lambdabench::do_not_optimize(out.data());
+            }
+        });
+        lambdabench::report("ray-boxes (" + name + ")", count, seconds, "tests");
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::intersect(rays, box, out);
+                lambdabench::do_not_optimize(out.data());
+            }
+        });
+        lambdabench::report("rays-box (" + name + ")", count, seconds, "tests");
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::intersect(ray, triangles, out);
+                lambdabench::do_not_optimize(out.data());
+            }
+        });
+        lambdabench::report("ray-triangles (" + name + ")", count, seconds, "tests");
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::intersect(ray, spheres, out);
+                lambdabench::do_not_optimize(out.data());
+            }
+        });
+        lambdabench::report("ray-spheres (" + name + ")", count, seconds, "tests");
+    }
+    maths::set_simd_level(supported);
+    return 0;
+}
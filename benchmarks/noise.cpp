@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/noise.h>
+#include <lambdacommon/maths/soa.h>
+#include <vector>
+
+using namespace lambdacommon;
+using namespace lambdacommon::maths::noise;
+
+#define SIZE 512
+#define DEPTH 8
+
+static const char* get_type_name(noise_type type) {
+    switch (type) {
+        case NOISE_VALUE:
+            return "value";
+        case NOISE_PERLIN:
+            return "perlin";
+        default:
+            return "simplex";
+    }
+}
+
+int main() {
+    std::vector<f32> grid(SIZE * SIZE * DEPTH);
+    noise_settings settings;
+    auto supported = maths::get_supported_simd_level();
+    for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+        if (level > supported || maths::set_simd_level(level) != level)
+            continue;
+        std::string suffix = std::string(" (") + maths::get_simd_level_name(level) + ")";
+        for (auto type : {NOISE_VALUE, NOISE_PERLIN, NOISE_SIMPLEX}) {
+            settings.type = type;
+            settings.fractal = FRACTAL_NONE;
+            std::string name = get_type_name(type);
+            auto seconds = lambdabench::measure([&]() {
+                fill(settings, grid.data(), SIZE, SIZE * DEPTH, 0.f, 0.f);
+                lambdabench::do_not_optimize(grid.data());
+            });
+            lambdabench::report(name + " 2D" + suffix, static_cast<double>(grid.size()), seconds, "samples");
+            seconds = lambdabench::measure([&]() {
+                fill(settings, grid.data(), SIZE, SIZE, DEPTH, 0.f, 0.f, 0.f);
+                lambdabench::do_not_optimize(grid.data());
+            });
+            lambdabench::report(name + " 3D" + suffix, static_cast<double>(grid.size()), seconds, "samples");
+            seconds = lambdabench::measure([&]() {
+                fill(settings, grid.data(), SIZE, SIZE, DEPTH, 0.f, 0.f, 0.f, 0.f);
+                lambdabench::do_not_optimize(grid.data());
+            });
+            lambdabench::report(name + " 4D" + suffix, static_cast<double>(grid.size()), seconds, "samples");
+        }
+
+        // The octaves multiply the cost, the throughput is still counted in samples.
+        settings.type = NOISE_SIMPLEX;
+        settings.fractal = FRACTAL_FBM;
+        settings.octaves = 5;
+        auto seconds = lambdabench::measure([&]() {
+            fill(settings, grid.data(), SIZE, SIZE * DEPTH, 0.f, 0.f);
+            lambdabench::do_not_optimize(grid.data());
+        });
+        lambdabench::report("simplex 2D fBm 5 octaves" + suffix, static_cast<double>(grid.size()), seconds, "samples");
+    }
+    maths::set_simd_level(supported);
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/random.h>
+#include <lambdacommon/maths/soa.h>
+#include <random>
+#include <vector>
+
+using namespace lambdacommon;
+
+#define COUNT 4096
+#define ITERATIONS 2000
+
+template<typename T, typename F>
+static void run(const std::string& name, std::vector<T>& out, F function) {
+    auto seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            function(out.data(), out.size());
+            lambdabench::do_not_optimize(out.data());
+        }
+    });
+    lambdabench::report(name, static_cast<double>(COUNT) * ITERATIONS, seconds, "values");
+}
+
+int main() {
+    std::vector<u64> bits(COUNT);
+    std::vector<f32> floats(COUNT);
+
+    std::mt19937_64 mt{42};
+    std::uniform_real_distribution<f32> std_uniform;
+    std::normal_distribution<f32> std_normal;
+    run("std::mt19937_64", bits, [&](u64* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = mt();
+    });
+    run("std::mt19937_64 uniform", floats, [&](f32* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = std_uniform(mt);
+    });
+    run("std::mt19937_64 normal", floats, [&](f32* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = std_normal(mt);
+    });
+
+    maths::random::xoshiro256pp xoshiro{42};
+    maths::random::pcg64 pcg{42};
+    run("xoshiro256pp", bits, [&](u64* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = xoshiro();
+    });
+    run("pcg64", bits, [&](u64* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = pcg();
+    });
+    run("xoshiro256pp uniform", floats, [&](f32* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = maths::random::uniform_f32(xoshiro);
+    });
+    run("xoshiro256pp normal", floats, [&](f32* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = static_cast<f32>(maths::random::normal(xoshiro));
+    });
+
+    auto supported = maths::get_supported_simd_level();
+    for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+        if (level > supported || maths::set_simd_level(level) != level)
+            continue;
+        std::string name = maths::get_simd_level_name(level);
+        maths::random::xoshiro256pp_x8 x8{42};
+        run("xoshiro256pp_x8 fill (" + name + ")", bits, [&](u64* out, size_t count) { x8.fill(out, count); });
+        run("xoshiro256pp_x8 uniform (" + name + ")", floats, [&](f32* out, size_t count) { x8.fill_uniform(out, count); });
+        run("xoshiro256pp_x8 normal (" + name + ")", floats, [&](f32* out, size_t count) { x8.fill_normal(out, count); });
+    }
+    maths::set_simd_level(supported);
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/rect_packer.h>
+#include <random>
+
+using namespace lambdacommon;
+
+#define COUNT 2000
+#define PAGE_SIZE 1024
+
+/*!
+ * Generates sizes looking like an atlas of glyphs and sprites: many small rectangles and a few large ones.
+ */
+static std::vector<Size2D<u32>> generate_sizes() {
+    std::mt19937 engine{42};
+    std::uniform_int_distribution<u32> small{6, 32}, large{32, 160};
+    std::vector<Size2D<u32>> sizes;
+    for (int i = 0; i < COUNT; i++) {
+        if (i % 10 == 0)
+            sizes.emplace_back(large(engine), large(engine));
+        else
+            sizes.emplace_back(small(engine), small(engine));
+    }
+    return sizes;
+}
+
+/*!
+ * Prints the packing time and density, the first page tells the heuristics apart when they need as many pages.
+ */
+static void report(const std::string& name, double seconds, u32 pages, f64 occupancy, f64 first_page) {
+    lambdabench::report(name, COUNT, seconds, "rects");
+    std::printf("%-40s %u pages, %.2f%% occupancy, %.2f%% on the first page\n", "", pages, occupancy * 100.0,
+                first_page * 100.0);
+}
+
+int main() {
+    auto sizes = generate_sizes();
+    maths::pack_options options;
+    options.padding = 1;
+
+    const std::pair<maths::pack_algorithm, maths::pack_heuristic> methods[] = {
+            {maths::PACK_MAX_RECTS, maths::PACK_BEST_SHORT_SIDE_FIT},
+            {maths::PACK_MAX_RECTS, maths::PACK_BEST_LONG_SIDE_FIT},
+            {maths::PACK_MAX_RECTS, maths::PACK_BEST_AREA_FIT},
+            {maths::PACK_MAX_RECTS, maths::PACK_BOTTOM_LEFT},
+            {maths::PACK_MAX_RECTS, maths::PACK_CONTACT_POINT},
+            {maths::PACK_SKYLINE,   maths::PACK_BOTTOM_LEFT},
+            {maths::PACK_SKYLINE,   maths::PACK_BEST_AREA_FIT}
+    };
+    const char* names[] = {"max_rects short side", "max_rects long side", "max_rects area", "max_rects bottom left",
+                           "max_rects contact point", "skyline bottom left", "skyline min waste"};
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(const char*); i++) {
+        options.algorithm = methods[i].first;
+        options.heuristic = methods[i].second;
+        maths::rect_packer packer{{PAGE_SIZE, PAGE_SIZE}, options};
+        auto seconds = lambdabench::measure([&]() {
+            for (const auto& size : sizes)
+                lambdabench::do_not_optimize(packer.insert(size));
+        });
+        report(names[i], seconds, packer.get_page_count(), packer.get_occupancy(), packer.get_occupancy(0));
+    }
+
+    maths::pack_result result;
+    auto seconds = lambdabench::measure([&]() {
+        result = maths::rect_packer::pack(sizes, {PAGE_SIZE, PAGE_SIZE}, options);
+    });
+    u64 first_page = 0;
+    for (size_t i = 0; i < sizes.size(); i++)
+        if (result.rects[i] && result.rects[i]->page == 0)
+            first_page += static_cast<u64>(sizes[i].get_width()) * sizes[i].get_height();
+    report("offline (all heuristics)", seconds, result.pages, result.occupancy,
+           static_cast<f64>(first_page) / (PAGE_SIZE * PAGE_SIZE));
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/spatial.h>
+#include <random>
+#include <vector>
+
+using namespace lambdacommon;
+
+#define COUNT 100000
+#define QUERIES 20000
+#define BRUTE_QUERIES 200
+
+int main() {
+    std::mt19937 random{42};
+    std::uniform_real_distribution<f32> coordinate{0.f, 1000.f};
+    std::vector<point3f> points(COUNT), queries(QUERIES);
+    for (auto& p : points)
+        p = {coordinate(random), coordinate(random), coordinate(random)};
+    for (auto& p : queries)
+        p = {coordinate(random), coordinate(random), coordinate(random)};
+
+    std::vector<size_t> nearest(QUERIES);
+    auto seconds = lambdabench::measure([&]() {
+        for (size_t i = 0; i < BRUTE_QUERIES; i++) {
+            f32 best = std::numeric_limits<f32>::infinity();
+            for (size_t j = 0; j < COUNT; j++) {
+                f32 distance = length_squared(points[j] - queries[i]);
+                if (distance < best) {
+                    best = distance;
+                    nearest[i] = j;
+                }
+            }
+        }
+        lambdabench::do_not_optimize(nearest.data());
+    });
+    lambdabench::report("nearest brute force", BRUTE_QUERIES, seconds, "queries");
+
+    maths::spatial::kd_tree3f tree;
+    seconds = lambdabench::measure([&]() { tree = maths::spatial::kd_tree3f{points}; });
+    lambdabench::report("kd_tree build", COUNT, seconds, "points");
+    seconds = lambdabench::measure([&]() {
+        for (size_t i = 0; i < QUERIES; i++)
+            nearest[i] = tree.nearest(queries[i]);
+        lambdabench::do_not_optimize(nearest.data());
+    });
+    lambdabench::report("kd_tree nearest", QUERIES, seconds, "queries");
+    std::vector<size_t> found;
+    seconds = lambdabench::measure([&]() {
+        for (size_t i = 0; i < QUERIES; i++)
+            tree.k_nearest(queries[i], 8, found);
+        lambdabench::do_not_optimize(found.data());
+    });
+    lambdabench::report("kd_tree k_nearest (k = 8)", QUERIES, seconds, "queries");
+    system::thread_pool pool;
+    std::vector<size_t> k_nearest(QUERIES * 8);
+    seconds = lambdabench::measure([&]() { tree.k_nearest(pool, queries.data(), QUERIES, 8, k_nearest.data()); });
+    lambdabench::report("kd_tree k_nearest batch (" + std::to_string(pool.size()) + " threads)", QUERIES, seconds, "queries");
+
+    maths::spatial::spatial_hash3f grid{20.f};
+    seconds = lambdabench::measure([&]() {
+        for (size_t i = 0; i < COUNT; i++)
+            grid.insert(i, points[i]);
+    });
+    lambdabench::report("spatial_hash insert", COUNT, seconds, "points");
+    seconds = lambdabench::measure([&]() {
+        for (size_t i = 0; i < COUNT; i++)
+            grid.update(i, points[i] + vec3f{1.f, 0.5f, -1.f});
+    });
+    lambdabench::report("spatial_hash update", COUNT, seconds, "points");
+    seconds = lambdabench::measure([&]() {
+        for (size_t i = 0; i < QUERIES; i++)
+            grid.radius(queries[i], 20.f, found);
+        lambdabench::do_not_optimize(found.data());
+    });
+    lambdabench::report("spatial_hash radius", QUERIES, seconds, "queries");
+
+    std::vector<maths::spatial::aabb3f> boxes;
+    for (size_t i = 0; i < COUNT; i++)
+        boxes.push_back(maths::spatial::aabb3f::around(points[i], 1.f + static_cast<f32>(i % 4)));
+    maths::spatial::bvh3f hierarchy;
+    seconds = lambdabench::measure([&]() { hierarchy = maths::spatial::bvh3f{boxes}; });
+    lambdabench::report("bvh build", COUNT, seconds, "boxes");
+    seconds = lambdabench::measure([&]() {
+        for (size_t i = 0; i < QUERIES; i++)
+            hierarchy.query(maths::spatial::aabb3f::around(queries[i], 10.f), found);
+        lambdabench::do_not_optimize(found.data());
+    });
+    lambdabench::report("bvh box query", QUERIES, seconds, "queries");
+    seconds = lambdabench::measure([&]() { hierarchy.refit(boxes.data()); });
+    lambdabench::report("bvh refit", COUNT, seconds, "boxes");
+    return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/soa.h>
+#include <vector>
+
+using namespace lambdacommon;
+
+#define COUNT 4096
+#define ITERATIONS 2000
+
+int main() {
+    auto parent = mat4f::compose({1.f, 2.f, 3.f}, normalize(quatf{0.3f, -0.5f, 0.2f, 0.8f}), {2.f, 2.f, 2.f});
+    std::vector<mat4f> locals, globals(COUNT);
+    std::vector<Point3D<f32>> objects;
+    maths::vec3_soa<f32> points, transformed;
+    for (int i = 0; i < COUNT; i++) {
+        locals.push_back(mat4f::translation({static_cast<f32>(i), 0.f, 1.f}) * mat4f::scale({1.f, static_cast<f32>(i % 3) + 1.f, 1.f}));
+        objects.emplace_back(static_cast<f32>(i), static_cast<f32>(i % 7), 1.f);
+        points.push_back({static_cast<f32>(i), static_cast<f32>(i % 7), 1.f});
+    }
+    double count = static_cast<double>(COUNT) * ITERATIONS;
+
+    auto seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < COUNT; j++)
+                globals[j] = parent * locals[j];
+            lambdabench::do_not_optimize(globals.data());
+        }
+    });
+    lambdabench::report("mat4f operator*", count, seconds, "matrices");
+    auto result = objects;
+    seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < COUNT; j++)
+                result[j] = transform_point(parent, objects[j]);
+            lambdabench::do_not_optimize(result.data());
+        }
+    });
+    lambdabench::report("transform_point Point3D", count, seconds, "points");
+
+    auto supported = maths::get_supported_simd_level();
+    for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+        if (level > supported || maths::set_simd_level(level) != level)
+            continue;
+        std::string name = maths::get_simd_level_name(level);
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::multiply(parent, locals.data(), globals.data(), COUNT);
+                lambdabench::do_not_optimize(globals.data());
+            }
+        });
+        lambdabench::report("multiply (" + name + ")", count, seconds, "matrices");
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::transform_points(parent, points, transformed);
+                lambdabench::do_not_optimize(transformed.x());
+            }
+        });
+        lambdabench::report("transform_points vec3_soa (" + name + ")", count, seconds, "points");
+    }
+    maths::set_simd_level(supported);
+    return 0;
+}
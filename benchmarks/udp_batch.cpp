@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/connection/udp_batch.h>
+#include <cstdlib>
+#include <iostream>
+
+using namespace lambdacommon;
+using namespace lambdacommon::connection;
+
+#define BATCH_SIZE 64
+#define DATAGRAM_SIZE 64
+
+/*
+ * Every benchmark runs on a single thread: it sends a burst of datagrams over the loopback and reads them back,
+ * so the socket buffers never overflow and no datagram is lost.
+ */
+
+static size_t run_naive(udp_socket& sender, udp_socket& receiver, const Address& to, size_t count) {
+    char datagram[DATAGRAM_SIZE] = {};
+    char buffer[2048];
+    size_t received = 0;
+    while (received < count) {
+        for (int i = 0; i < BATCH_SIZE; i++)
+            sender.send_to(datagram, sizeof(datagram), to);
+        while (receiver.receive_from(buffer, sizeof(buffer)))
+            received++;
+    }
+    return received;
+}
+
+static size_t run_batched(udp_socket& sender, udp_socket& receiver, const Address& to, size_t count, bool offload) {
+    char datagram[DATAGRAM_SIZE] = {};
+    udp_send_batch send_batch{BATCH_SIZE};
+    send_batch.set_segmentation(offload);
+    udp_receive_batch receive_batch{BATCH_SIZE, offload ? 65535u : 2048u};
+    size_t received = 0;
+    while (received < count) {
+        for (int i = 0; i < BATCH_SIZE; i++)
+            send_batch.add(datagram, sizeof(datagram), to);
+        while (send_batch.size() != 0 && send_batch.send(sender));
+        send_batch.clear();
+        while (auto result = receive_batch.receive(receiver))
+            received += *result;
+    }
+    return received;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    udp_socket receiver{Address{"127.0.0.1", 0}};
+    udp_socket sender{Address{"127.0.0.1", 0}};
+    auto to = receiver.get_local_address();
+
+    std::cout << "Sending " << count << " datagrams of " << DATAGRAM_SIZE << " bytes over the loopback." << std::endl;
+
+    size_t received = 0;
+    auto seconds = lambdabench::measure([&]() { received = run_naive(sender, receiver, to, count); });
+    lambdabench::report("sendto/recvfrom", received, seconds, "packets");
+
+    seconds = lambdabench::measure([&]() { received = run_batched(sender, receiver, to, count, false); });
+    lambdabench::report("sendmmsg/recvmmsg", received, seconds, "packets");
+
+    if (receiver.set_gro(true)) {
+        seconds = lambdabench::measure([&]() { received = run_batched(sender, receiver, to, count, true); });
+        lambdabench::report("sendmmsg/recvmmsg with UDP_SEGMENT/GRO", received, seconds, "packets");
+    } else
+        std::cout << "UDP_GRO is not supported, skipping the offload benchmark." << std::endl;
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "benchmark.h"
+#include <lambdacommon/maths/geometry/vector.h>
+#include <lambdacommon/maths/soa.h>
+#include <lambdacommon/maths/soa_expression.h>
+#include <vector>
+
+using namespace lambdacommon;
+
+#define COUNT 4096
+#define ITERATIONS 5000
+
+int main() {
+    std::vector<Vector3D<f32>> aos_a, aos_b;
+    std::vector<vec3f> vec_a, vec_b, vec_out(COUNT);
+    maths::vec3_soa<f32> a, b, out;
+    for (int i = 0; i < COUNT; i++) {
+        vec3f u{static_cast<f32>(i % 13) + 1.f, static_cast<f32>(i % 7) - 3.f, 0.5f};
+        vec3f v{2.f, static_cast<f32>(i % 5), static_cast<f32>(i % 3) + 1.f};
+        aos_a.emplace_back(u.x, u.y, u.z);
+        aos_b.emplace_back(v.x, v.y, v.z);
+        vec_a.push_back(u);
+        vec_b.push_back(v);
+        a.push_back(u);
+        b.push_back(v);
+    }
+    auto aos_out = aos_a;
+    std::vector<f32> lengths(COUNT);
+    double vectors = static_cast<double>(COUNT) * ITERATIONS;
+
+    // The existing virtual vector classes, one vector at a time.
+    auto seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < COUNT; j++)
+                aos_out[j] = aos_a[j].cross_product(aos_b[j]);
+            lambdabench::do_not_optimize(aos_out.data());
+        }
+    });
+    lambdabench::report("cross Vector3D (AoS)", vectors, seconds, "vectors");
+    seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < COUNT; j++)
+                lengths[j] = aos_a[j].get_standard();
+            lambdabench::do_not_optimize(lengths.data());
+        }
+    });
+    lambdabench::report("length Vector3D (AoS)", vectors, seconds, "vectors");
+
+    // The value types, left to the auto-vectorizer.
+    seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < COUNT; j++)
+                vec_out[j] = cross(vec_a[j], vec_b[j]);
+            lambdabench::do_not_optimize(vec_out.data());
+        }
+    });
+    lambdabench::report("cross vec3f (AoS)", vectors, seconds, "vectors");
+    seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < COUNT; j++)
+                lengths[j] = length(vec_a[j]);
+            lambdabench::do_not_optimize(lengths.data());
+        }
+    });
+    lambdabench::report("length vec3f (AoS)", vectors, seconds, "vectors");
+
+    // A compound expression, a + b - (a - b) * 0.5, with a temporary vector per operator.
+    seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < COUNT; j++)
+                vec_out[j] = vec_a[j] + vec_b[j] - (vec_a[j] - vec_b[j]) * 0.5f;
+            lambdabench::do_not_optimize(vec_out.data());
+        }
+    });
+    lambdabench::report("compound vec3f (AoS)", vectors, seconds, "vectors");
+
+    auto supported = maths::get_supported_simd_level();
+    for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+        if (level > supported || maths::set_simd_level(level) != level)
+            continue;
+        std::string name = maths::get_simd_level_name(level);
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::cross(a, b, out);
+                lambdabench::do_not_optimize(out.x());
+            }
+        });
+        lambdabench::report("cross vec3_soa (" + name + ")", vectors, seconds, "vectors");
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::length(a, lengths);
+                lambdabench::do_not_optimize(lengths.data());
+            }
+        });
+        lambdabench::report("length vec3_soa (" + name + ")", vectors, seconds, "vectors");
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::normalize(a, out);
+                lambdabench::do_not_optimize(out.x());
+            }
+        });
+        lambdabench::report("normalize vec3_soa (" + name + ")", vectors, seconds, "vectors");
+        maths::vec3_soa<f32> temporary;
+        seconds = lambdabench::measure([&]() {
+            for (int i = 0; i < ITERATIONS; i++) {
+                maths::sub(a, b, temporary);
+                maths::scale(temporary, 0.5f, temporary);
+                maths::add(a, b, out);
+                maths::sub(out, temporary, out);
+                lambdabench::do_not_optimize(out.x());
+            }
+        });
+        lambdabench::report("compound kernels (" + name + ")", vectors, seconds, "vectors");
+    }
+    maths::set_simd_level(supported);
+
+    // The same expression fused in a single pass, vectorized at compile time.
+    seconds = lambdabench::measure([&]() {
+        for (int i = 0; i < ITERATIONS; i++) {
+            maths::evaluate(a + b - (a - b) * 0.5f, out);
+            lambdabench::do_not_optimize(out.x());
+        }
+    });
+    lambdabench::report("compound expression", vectors, seconds, "vectors");
+    return 0;
+}
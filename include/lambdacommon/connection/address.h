@@ -10,6 +10,7 @@
 #ifndef LAMBDACOMMON_ADDRESS_H
 #define LAMBDACOMMON_ADDRESS_H
 
+#include "ip.h"
 #include "../serializable.h"
 #include "../types.h"
 #include <array>
@@ -40,6 +41,11 @@ namespace lambdacommon
     protected:
         host _host;
         port_t _port;
+        // The host is parsed once at construction, the host and port being immutable.
+        AddressType _type;
+        ip_address _ip;
+
+        void parse_host();
 
     public:
         Address(host host, port_t port = 0);
@@ -74,8 +80,18 @@ namespace lambdacommon
          */
         bool is_ipv6() const;
 
+        /*!
+         * Checks whether the address is a valid domain name with a known top-level domain.
+         * @return True if the address is a valid domain name, else false.
+         */
         bool is_domain_valid() const;
 
+        /*!
+         * Gets the binary form of the host if the address is an IPv4 or IPv6 address.
+         * @return The IP address if the host is an IP address, else an empty optional.
+         */
+        std::optional<ip_address> get_ip_address() const;
+
         /*!
          * Checks whether the address is empty.
          * @return True if the address is empty, else false.
@@ -124,6 +140,14 @@ namespace std
     {
         using type = decltype(std::declval<lambdacommon::Address>().get<N>());
     };
+
+    template<>
+    struct hash<lambdacommon::Address>
+    {
+        size_t operator()(const lambdacommon::Address& address) const noexcept {
+            return hash<lambdacommon::host>()(address.get_host()) ^ static_cast<size_t>(address.get_port() * 0x9E3779B97F4A7C15ull);
+        }
+    };
 }
 
 #ifdef LAMBDA_WINDOWS
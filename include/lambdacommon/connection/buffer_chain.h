@@ -0,0 +1,248 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_BUFFER_CHAIN_H
+#define LAMBDACOMMON_BUFFER_CHAIN_H
+
+#include "../types.h"
+#include <atomic>
+#include <deque>
+#include <string_view>
+
+#if !defined(LAMBDA_WINDOWS) && !defined(LAMBDA_WASM)
+#  include <sys/uio.h>
+#endif
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+namespace lambdacommon::connection
+{
+    /*!
+     * Represents a reference-counted block of memory, allocated from a per-thread cache of free slabs.
+     */
+    struct slab
+    {
+        std::atomic<u32> references;
+        u32 capacity;
+
+        inline char* data() {
+            return reinterpret_cast<char*>(this + 1);
+        }
+
+        /*!
+         * The default capacity of a slab.
+         */
+        static constexpr u32 DEFAULT_CAPACITY = 16384 - 64;
+
+        /*!
+         * Allocates a slab with at least the specified capacity. Slabs of the default capacity come from the cache of the thread,
+         * refilled by batches from a shared free list.
+         * @param capacity The minimum capacity.
+         * @return The slab with a reference count of 1.
+         */
+        static LAMBDACOMMON_API slab* acquire(size_t capacity = DEFAULT_CAPACITY);
+
+        /*!
+         * Releases a reference to a slab, the slab is given back to the cache of the thread once it is not referenced
+         * anymore, a full cache spills a batch to the shared free list.
+         * @param s The slab.
+         */
+        static LAMBDACOMMON_API void release(slab* s);
+    };
+
+    /*!
+     * Represents a read-only slice of a slab, holding a reference to the slab.
+     */
+    class LAMBDACOMMON_API buffer_slice
+    {
+    private:
+        slab* _slab = nullptr;
+        u32 _offset = 0;
+        u32 _length = 0;
+
+        friend class buffer_chain;
+
+    public:
+        buffer_slice() = default;
+
+        buffer_slice(slab* s, u32 offset, u32 length);
+
+        buffer_slice(const buffer_slice& other);
+
+        buffer_slice(buffer_slice&& other) noexcept;
+
+        ~buffer_slice();
+
+        inline const char* data() const {
+            return _slab->data() + _offset;
+        }
+
+        inline size_t size() const {
+            return _length;
+        }
+
+        inline std::string_view view() const {
+            return {data(), _length};
+        }
+
+        /*!
+         * Checks whether bytes can be appended right after the slice, in place.
+         * @return The count of bytes writable after the slice.
+         */
+        size_t get_writable() const;
+
+        buffer_slice& operator=(const buffer_slice& other);
+
+        buffer_slice& operator=(buffer_slice&& other) noexcept;
+    };
+
+    /*!
+     * Represents a sequence of bytes stored in a chain of slab slices.
+     *
+     * Slicing and appending other chains never copy the bytes, slabs are shared and reference-counted.
+     * A chain itself is not thread-safe, but slabs may be shared between chains on different threads.
+     */
+    class LAMBDACOMMON_API buffer_chain
+    {
+    private:
+        std::deque<buffer_slice> _slices;
+        size_t _size = 0;
+
+    public:
+        buffer_chain() = default;
+
+        buffer_chain(const buffer_chain& other) = default;
+
+        buffer_chain(buffer_chain&& other) noexcept;
+
+        /*!
+         * Gets the count of bytes in the chain.
+         * @return The size of the chain.
+         */
+        size_t size() const;
+
+        bool empty() const;
+
+        /*!
+         * Gets the count of slices in the chain.
+         * @return The count of slices.
+         */
+        size_t get_slice_count() const;
+
+        /*!
+         * Appends a copy of the given bytes, filling the free space of the last slab first.
+         * @param data The bytes to append.
+         * @param size The count of bytes.
+         */
+        void append(const void* data, size_t size);
+
+        inline void append(std::string_view data) {
+            append(data.data(), data.size());
+        }
+
+        /*!
+         * Appends the content of another chain without copying the bytes.
+         * @param other The other chain.
+         */
+        void append(const buffer_chain& other);
+
+        /*!
+         * Appends a slice without copying the bytes.
+         * @param slice The slice.
+         */
+        void append(buffer_slice slice);
+
+        /*!
+         * Gets a writable area at the end of the chain, to read directly into it. Call commit() with the count of bytes written.
+         * @param min_size The minimum size of the area.
+         * @return The pointer to the writable area and its size.
+         */
+        std::pair<char*, size_t> prepare(size_t min_size = 1);
+
+        /*!
+         * Commits bytes written in the area returned by prepare().
+         * @param size The count of bytes written.
+         */
+        void commit(size_t size);
+
+        /*!
+         * Removes bytes from the front of the chain.
+         * @param size The count of bytes to remove.
+         */
+        void consume(size_t size);
+
+        /*!
+         * Makes a new chain sharing a range of this chain, without copying the bytes.
+         * @param offset The offset of the range.
+         * @param length The length of the range.
+         * @return The new chain.
+         */
+        buffer_chain slice(size_t offset, size_t length) const;
+
+        /*!
+         * Gets the first contiguous segment of the chain.
+         * @return The first segment, empty if the chain is empty.
+         */
+        std::string_view front() const;
+
+        /*!
+         * Gets a contiguous view of the first bytes of the chain, coalescing slices only if they span several slabs.
+         * The view stays valid until the chain is modified.
+         * @param size The count of bytes wanted, clamped to the size of the chain.
+         * @return The contiguous view.
+         */
+        std::string_view contiguous(size_t size);
+
+        /*!
+         * Copies bytes from the front of the chain without consuming them.
+         * @param out The output buffer.
+         * @param size The count of bytes to copy.
+         * @return The count of bytes copied.
+         */
+        size_t copy_to(void* out, size_t size) const;
+
+        /*!
+         * Fills an array with views of the segments of the chain.
+         * @param out The output array.
+         * @param max The size of the array.
+         * @return The count of segments written.
+         */
+        size_t get_segments(std::string_view* out, size_t max) const;
+
+#if !defined(LAMBDA_WINDOWS) && !defined(LAMBDA_WASM)
+        /*!
+         * Fills an iovec array with the segments of the chain, for writev() or sendmsg().
+         * @param out The output array.
+         * @param max The size of the array.
+         * @return The count of iovec written.
+         */
+        size_t get_iovecs(iovec* out, size_t max) const;
+#endif
+
+        /*!
+         * Removes every byte of the chain.
+         */
+        void clear();
+
+        std::string to_string() const;
+
+        buffer_chain& operator=(const buffer_chain& other) = default;
+
+        buffer_chain& operator=(buffer_chain&& other) noexcept;
+    };
+}
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_BUFFER_CHAIN_H
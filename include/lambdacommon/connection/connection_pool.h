@@ -0,0 +1,262 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_CONNECTION_POOL_H
+#define LAMBDACOMMON_CONNECTION_POOL_H
+
+#include "socket.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+#ifdef LAMBDA_HAS_SOCKETS
+
+namespace lambdacommon::connection
+{
+    class connection_pool;
+
+    struct connection_pool_options
+    {
+        /*!
+         * The maximum count of connections to a same address, idle or in use.
+         */
+        u32 max_per_host = 8;
+        /*!
+         * The maximum count of distinct addresses.
+         */
+        u32 max_hosts = 1024;
+        /*!
+         * The time after which an idle connection is closed.
+         */
+        std::chrono::milliseconds idle_timeout{30000};
+        /*!
+         * The maximum time to wait for a connection when the limit of the address is reached.
+         */
+        std::chrono::milliseconds wait_timeout{5000};
+        /*!
+         * The maximum time to wait for a new connection to be established, given to the connector.
+         */
+        std::chrono::milliseconds connect_timeout{5000};
+        /*!
+         * Opens a new connection, the default connector waits until the connection is established.
+         */
+        std::function<tcp_stream(const Address&, std::chrono::milliseconds timeout)> connector;
+    };
+
+    /*!
+     * Statistics of a connection pool, every counter is cumulative.
+     */
+    struct connection_pool_stats
+    {
+        u64 checkouts = 0;
+        u64 reused = 0;
+        u64 created = 0;
+        /*!
+         * The count of idle connections closed by the idle timeout.
+         */
+        u64 evicted = 0;
+        /*!
+         * The count of idle connections found closed by the peer when checked out, or discarded by the user.
+         */
+        u64 discarded = 0;
+        u64 connect_failures = 0;
+        /*!
+         * The count of checkouts which had to wait for the limit of the address.
+         */
+        u64 waits = 0;
+        /*!
+         * The total time spent waiting in microseconds.
+         */
+        u64 wait_time_us = 0;
+
+        inline double get_reuse_ratio() const {
+            return checkouts == 0 ? 0.0 : static_cast<double>(reused) / static_cast<double>(checkouts);
+        }
+
+        inline double get_average_wait_ms() const {
+            return waits == 0 ? 0.0 : static_cast<double>(wait_time_us) / static_cast<double>(waits) / 1000.0;
+        }
+    };
+
+    namespace internal
+    {
+        struct pool_host;
+    }
+
+    /*!
+     * Represents a connection checked out of a pool. The connection goes back to the pool when the object is destroyed,
+     * unless it is discarded or closed.
+     */
+    class LAMBDACOMMON_API pooled_connection
+    {
+    private:
+        connection_pool* _pool = nullptr;
+        internal::pool_host* _host = nullptr;
+        tcp_stream _stream;
+        bool _reused = false;
+
+        friend class connection_pool;
+
+        pooled_connection(connection_pool* pool, internal::pool_host* host, tcp_stream stream, bool reused);
+
+    public:
+        pooled_connection() = default;
+
+        pooled_connection(const pooled_connection& other) = delete;
+
+        pooled_connection(pooled_connection&& other) noexcept;
+
+        ~pooled_connection();
+
+        inline tcp_stream& get() {
+            return _stream;
+        }
+
+        inline tcp_stream* operator->() {
+            return &_stream;
+        }
+
+        /*!
+         * Checks whether the connection was reused from the idle connections of the pool.
+         * @return True if the connection was reused, else false.
+         */
+        inline bool is_reused() const {
+            return _reused;
+        }
+
+        /*!
+         * Closes the connection instead of giving it back to the pool, for example after an I/O error or a protocol error.
+         */
+        void discard();
+
+        /*!
+         * Gives the connection back to the pool now.
+         */
+        void release();
+
+        pooled_connection& operator=(const pooled_connection& other) = delete;
+
+        pooled_connection& operator=(pooled_connection&& other) noexcept;
+    };
+
+    /*!
+     * Represents a pool of TCP connections keyed by address.
+     *
+     * Checking out an idle connection is lock-free: the addresses are stored in a lock-free open-addressing table
+     * and the idle connections of an address in an array of atomic slots packing the socket and its idle timestamp.
+     * Locks are only taken to register a new address, to schedule the idle timeout and to wait when the limit of an address is reached.
+     *
+     * Idle connections are evicted by a hashed timer wheel advanced by tick(), typically called from an event loop interval.
+     */
+    class LAMBDACOMMON_API connection_pool
+    {
+    private:
+        struct timer_wheel;
+
+        connection_pool_options _options;
+        std::chrono::steady_clock::time_point _epoch;
+        size_t _mask;
+        std::unique_ptr<std::atomic<internal::pool_host*>[]> _table;
+        std::vector<std::unique_ptr<internal::pool_host>> _hosts;
+        std::mutex _hosts_mutex;
+        std::unique_ptr<timer_wheel> _wheel;
+        std::mutex _wheel_mutex;
+
+        std::atomic<u64> _checkouts{0};
+        std::atomic<u64> _reused{0};
+        std::atomic<u64> _created{0};
+        std::atomic<u64> _evicted{0};
+        std::atomic<u64> _discarded{0};
+        std::atomic<u64> _connect_failures{0};
+        std::atomic<u64> _waits{0};
+        std::atomic<u64> _wait_time_us{0};
+
+        friend class pooled_connection;
+
+        u64 now_ms() const;
+
+        internal::pool_host* find_host(const Address& address) const;
+
+        internal::pool_host& get_host(const Address& address);
+
+        std::optional<tcp_stream> take_idle(internal::pool_host& host);
+
+        void give_back(internal::pool_host& host, tcp_stream stream);
+
+        void close(internal::pool_host& host, tcp_stream& stream);
+
+    public:
+        explicit connection_pool(connection_pool_options options = {});
+
+        connection_pool(const connection_pool& other) = delete;
+
+        ~connection_pool();
+
+        /*!
+         * Checks out a connection to the given address, reusing an idle connection if possible.
+         * If the limit of the address is reached, waits until a connection is given back.
+         * @param address The address, it must be an IP address.
+         * @return The connection.
+         * @throws std::system_error If the connection fails or the wait times out.
+         */
+        pooled_connection acquire(const Address& address);
+
+        /*!
+         * Closes the idle connections which exceeded the idle timeout.
+         * @return The count of connections closed.
+         */
+        size_t tick();
+
+        /*!
+         * Closes every idle connection.
+         */
+        void clear();
+
+        /*!
+         * Gets the count of idle connections to an address.
+         * @param address The address.
+         * @return The count of idle connections.
+         */
+        size_t get_idle_count(const Address& address) const;
+
+        /*!
+         * Gets the count of open connections to an address, idle or in use.
+         * @param address The address.
+         * @return The count of open connections.
+         */
+        size_t get_open_count(const Address& address) const;
+
+        /*!
+         * Gets the recommended interval between two calls of tick().
+         * @return The tick interval.
+         */
+        std::chrono::milliseconds get_tick_interval() const;
+
+        connection_pool_stats get_stats() const;
+
+        connection_pool& operator=(const connection_pool& other) = delete;
+    };
+}
+
+#endif
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_CONNECTION_POOL_H
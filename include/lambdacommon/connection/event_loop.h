@@ -0,0 +1,265 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_EVENT_LOOP_H
+#define LAMBDACOMMON_EVENT_LOOP_H
+
+#include "socket.h"
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(LAMBDA_LINUX) || defined(LAMBDA_ANDROID)
+#  define LAMBDA_HAS_EVENT_LOOP
+#endif
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+#ifdef LAMBDA_HAS_EVENT_LOOP
+
+namespace lambdacommon::connection
+{
+    /*!
+     * Readiness events of a file descriptor.
+     */
+    enum io_event : u32
+    {
+        READABLE = 1,
+        WRITABLE = 2,
+        /*!
+         * The peer hung up or an error is pending on the file descriptor.
+         */
+        CLOSED = 4
+    };
+
+    /*!
+     * Represents a single-threaded edge-triggered event loop built on epoll, with timers.
+     *
+     * As the loop is edge-triggered, a callback must read or write until it would block before waiting for the next event.
+     * Only post() and stop() may be called from other threads.
+     */
+    class LAMBDACOMMON_API event_loop
+    {
+    public:
+        typedef std::function<void(u32 events)> io_callback;
+        typedef std::function<void()> task;
+        typedef u64 timer_id;
+        typedef std::chrono::steady_clock clock;
+
+    private:
+        struct timer
+        {
+            clock::time_point deadline;
+            timer_id id;
+
+            bool operator>(const timer& other) const {
+                return other.deadline < deadline;
+            }
+        };
+
+        struct timer_entry
+        {
+            task callback;
+            clock::duration interval;
+        };
+
+        /*!
+         * The generation tells the events of a watched file descriptor from the ones of a previous file descriptor
+         * with the same number, still queued in the same batch.
+         */
+        struct handler_entry
+        {
+            std::shared_ptr<io_callback> callback;
+            u32 generation;
+        };
+
+        int _epoll_fd;
+        int _wake_fd;
+        std::atomic_bool _running{false};
+        std::atomic_bool _stop_requested{false};
+        std::unordered_map<int, handler_entry> _handlers;
+        u32 _next_generation = 1;
+        std::priority_queue<timer, std::vector<timer>, std::greater<timer>> _timers;
+        std::unordered_map<timer_id, timer_entry> _timer_entries;
+        timer_id _next_timer_id = 1;
+        std::mutex _posted_mutex;
+        std::vector<task> _posted;
+
+        void wake();
+
+        int next_timeout(int timeout_ms) const;
+
+        size_t run_timers();
+
+        size_t run_posted();
+
+    public:
+        event_loop();
+
+        event_loop(const event_loop& other) = delete;
+
+        ~event_loop();
+
+        /*!
+         * Watches a file descriptor.
+         * @param fd The file descriptor, it should be non-blocking.
+         * @param events The events to watch (READABLE and/or WRITABLE).
+         * @param callback The callback called with the ready events.
+         */
+        void add(int fd, u32 events, io_callback callback);
+
+        /*!
+         * Changes the watched events of a file descriptor.
+         * @param fd The file descriptor.
+         * @param events The events to watch (READABLE and/or WRITABLE).
+         */
+        void modify(int fd, u32 events);
+
+        /*!
+         * Stops watching a file descriptor, it must be called before closing it.
+         * @param fd The file descriptor.
+         */
+        void remove(int fd);
+
+        /*!
+         * Checks whether a file descriptor is watched.
+         * @param fd The file descriptor.
+         * @return True if the file descriptor is watched, else false.
+         */
+        bool is_watched(int fd) const;
+
+        /*!
+         * Calls a callback once after a delay.
+         * @param delay The delay.
+         * @param callback The callback.
+         * @return The identifier of the timer.
+         */
+        timer_id set_timeout(clock::duration delay, task callback);
+
+        /*!
+         * Calls a callback repeatedly.
+         * @param interval The interval between the calls.
+         * @param callback The callback.
+         * @return The identifier of the timer.
+         */
+        timer_id set_interval(clock::duration interval, task callback);
+
+        /*!
+         * Cancels a timer.
+         * @param id The identifier of the timer.
+         * @return True if the timer was pending, else false.
+         */
+        bool cancel_timer(timer_id id);
+
+        /*!
+         * Runs a task on the loop thread, can be called from any thread.
+         * @param callback The task.
+         */
+        void post(task callback);
+
+        /*!
+         * Waits for events and runs the ready callbacks, timers and posted tasks once.
+         * @param timeout_ms The maximum time to wait in milliseconds, -1 to wait until something happens.
+         * @return The count of callbacks called.
+         */
+        size_t run_once(int timeout_ms = -1);
+
+        /*!
+         * Runs the loop until stop() is called or a callback throws, the exception is then propagated.
+         */
+        void run();
+
+        /*!
+         * Stops the loop, can be called from any thread. If the loop is not running yet, the next run() returns immediately.
+         */
+        void stop();
+
+        /*!
+         * Checks whether the loop is running.
+         * @return True if the loop is running, else false.
+         */
+        bool is_running() const;
+
+        event_loop& operator=(const event_loop& other) = delete;
+    };
+
+    /*!
+     * Represents a group of event loops, one per thread, pinned to the CPU cores.
+     *
+     * Combined with SO_REUSEPORT listeners the kernel balances the connections across the loops.
+     */
+    class LAMBDACOMMON_API event_loop_group
+    {
+    private:
+        std::vector<std::unique_ptr<event_loop>> _loops;
+        std::vector<std::thread> _threads;
+        std::mutex _error_mutex;
+        std::exception_ptr _error;
+
+        void join();
+
+    public:
+        /*!
+         * Creates a new group.
+         * @param count The count of loops, 0 to use one loop per CPU core.
+         */
+        explicit event_loop_group(u32 count = 0);
+
+        event_loop_group(const event_loop_group& other) = delete;
+
+        ~event_loop_group();
+
+        /*!
+         * Gets the count of loops.
+         * @return The count of loops.
+         */
+        size_t size() const;
+
+        /*!
+         * Gets a loop of the group.
+         * @param index The index of the loop.
+         * @return The loop.
+         */
+        event_loop& get(size_t index);
+
+        /*!
+         * Starts a thread per loop. The setup callback is called on the loop thread before running it,
+         * typically to bind a SO_REUSEPORT listener per loop.
+         * If the setup or a callback throws, the loop of that thread stops and stop() rethrows the first exception.
+         * @param setup The setup callback, called with the loop and its index.
+         */
+        void start(const std::function<void(event_loop&, size_t)>& setup = {});
+
+        /*!
+         * Stops every loop and joins the threads.
+         * @throws The first exception thrown on a loop thread since the start, if any.
+         */
+        void stop();
+
+        event_loop_group& operator=(const event_loop_group& other) = delete;
+    };
+}
+
+#endif
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_EVENT_LOOP_H
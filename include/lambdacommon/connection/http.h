@@ -0,0 +1,247 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_HTTP_H
+#define LAMBDACOMMON_HTTP_H
+
+#include "../system/uri.h"
+#include <optional>
+#include <string_view>
+
+namespace lambdacommon::connection::http
+{
+    enum parse_status : u8
+    {
+        COMPLETE,
+        /*!
+         * More bytes are needed, call the parser again with the same bytes followed by the new ones.
+         */
+        INCOMPLETE,
+        INVALID
+    };
+
+    /*!
+     * Represents a header field, the name and the value are views of the parsed bytes.
+     */
+    struct header
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    /*!
+     * Represents the common part of the HTTP/1.x request and response parsers.
+     *
+     * The parsers are zero-copy and never allocate: the headers are stored in a fixed array of views of the parsed bytes.
+     * They are resumable: the bytes already scanned for the end of the head are not scanned again when more bytes arrive.
+     */
+    class LAMBDACOMMON_API message_parser
+    {
+    public:
+        static constexpr size_t MAX_HEADERS = 64;
+
+    protected:
+        header _headers[MAX_HEADERS];
+        size_t _header_count = 0;
+        size_t _head_size = 0;
+        size_t _scanned = 0;
+        size_t _max_head_size;
+        u8 _minor_version = 1;
+
+        /*!
+         * Finds the end of the head, resuming from the previous call.
+         * @param data The bytes received so far.
+         * @return The status of the head.
+         */
+        parse_status find_head_end(std::string_view data);
+
+        /*!
+         * Parses the header lines following the start line.
+         * @param lines The header lines, ending with the empty line.
+         * @return True if the headers are valid, else false.
+         */
+        bool parse_headers(std::string_view lines);
+
+        /*!
+         * Parses the "HTTP/1.x" version.
+         */
+        bool parse_version(std::string_view version);
+
+    public:
+        explicit message_parser(size_t max_head_size = 65536);
+
+        /*!
+         * Gets the size of the head, which is the offset of the body once the head is complete.
+         * @return The size of the head.
+         */
+        inline size_t get_head_size() const {
+            return _head_size;
+        }
+
+        inline u8 get_minor_version() const {
+            return _minor_version;
+        }
+
+        inline size_t get_header_count() const {
+            return _header_count;
+        }
+
+        inline const header* begin() const {
+            return _headers;
+        }
+
+        inline const header* end() const {
+            return _headers + _header_count;
+        }
+
+        /*!
+         * Finds the value of the first header with the given name, ignoring case.
+         * @param name The name of the header.
+         * @return The value of the header, or an empty optional if there is no such header.
+         */
+        std::optional<std::string_view> find_header(std::string_view name) const;
+
+        /*!
+         * Checks whether a header contains a token in its comma-separated list, ignoring case. For example "Connection: keep-alive, Upgrade".
+         * @param name The name of the header.
+         * @param token The token.
+         * @return True if a header with the given name contains the token, else false.
+         */
+        bool has_header_token(std::string_view name, std::string_view token) const;
+
+        /*!
+         * Gets the value of the Content-Length header, already validated by the parser.
+         * @return The content length, or an empty optional if the message has no Content-Length header.
+         */
+        std::optional<u64> get_content_length() const;
+
+        /*!
+         * Checks whether the body uses the chunked transfer coding.
+         * @return True if the body is chunked, else false.
+         */
+        bool is_chunked() const;
+
+        /*!
+         * Checks whether the connection stays open after the message, following the HTTP version and the Connection header.
+         * @return True if the connection is persistent, else false.
+         */
+        bool is_keep_alive() const;
+
+        /*!
+         * Resets the parser for the next message.
+         */
+        void reset();
+    };
+
+    /*!
+     * Represents an incremental HTTP/1.x request parser.
+     */
+    class LAMBDACOMMON_API request_parser : public message_parser
+    {
+    private:
+        std::string_view _method;
+        uri::uri_view _target;
+
+    public:
+        explicit request_parser(size_t max_head_size = 65536);
+
+        /*!
+         * Parses the head of a request.
+         * @param data Every byte received for the request so far, they must outlive the parsed views.
+         * @return The status of the parsing.
+         */
+        parse_status parse(std::string_view data);
+
+        inline std::string_view get_method() const {
+            return _method;
+        }
+
+        inline const uri::uri_view& get_target() const {
+            return _target;
+        }
+
+        void reset();
+    };
+
+    /*!
+     * Represents an incremental HTTP/1.x response parser.
+     */
+    class LAMBDACOMMON_API response_parser : public message_parser
+    {
+    private:
+        u16 _status = 0;
+        std::string_view _reason;
+
+    public:
+        explicit response_parser(size_t max_head_size = 65536);
+
+        /*!
+         * Parses the head of a response.
+         * @param data Every byte received for the response so far, they must outlive the parsed views.
+         * @return The status of the parsing.
+         */
+        parse_status parse(std::string_view data);
+
+        inline u16 get_status() const {
+            return _status;
+        }
+
+        inline std::string_view get_reason() const {
+            return _reason;
+        }
+
+        void reset();
+    };
+
+    /*!
+     * Represents an incremental decoder of the chunked transfer coding, decoding in place.
+     */
+    class LAMBDACOMMON_API chunked_decoder
+    {
+    private:
+        enum state : u8
+        {
+            SIZE,
+            SIZE_EXTENSION,
+            DATA,
+            DATA_CR,
+            DATA_LF,
+            TRAILER_START,
+            TRAILER_LF,
+            TRAILER_LINE,
+            DONE
+        };
+
+        state _state = SIZE;
+        u8 _digits = 0;
+        u64 _chunk_size = 0;
+        size_t _consumed = 0;
+
+    public:
+        /*!
+         * Decodes bytes in place: the chunk data is moved to the front of the buffer.
+         * @param data The bytes of the body.
+         * @param size The count of bytes, replaced by the count of decoded bytes.
+         * @return COMPLETE once the last chunk and the trailers are decoded, INCOMPLETE if more bytes are needed, INVALID on malformed chunks.
+         */
+        parse_status decode(char* data, size_t& size);
+
+        /*!
+         * Gets the count of bytes consumed by the last call of decode(). Once complete, the bytes after the body start at this offset.
+         * @return The count of bytes consumed.
+         */
+        inline size_t get_consumed() const {
+            return _consumed;
+        }
+
+        void reset();
+    };
+}
+
+#endif //LAMBDACOMMON_HTTP_H
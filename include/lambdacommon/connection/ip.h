@@ -0,0 +1,401 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_IP_H
+#define LAMBDACOMMON_IP_H
+
+#include "../types.h"
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+namespace lambdacommon
+{
+    /*!
+     * Represents a binary IP address.
+     *
+     * IPv4 addresses are stored as IPv4-mapped IPv6 addresses (::ffff:a.b.c.d), so every address is 16 bytes in network byte order.
+     */
+    class LAMBDACOMMON_API ip_address
+    {
+    private:
+        std::array<u8, 16> _bytes;
+
+    public:
+        /*!
+         * The maximum length of a formatted IP address, without the null terminator.
+         */
+        static constexpr size_t MAX_STRING_LENGTH = 45;
+
+        /*!
+         * Creates the unspecified address (::).
+         */
+        constexpr ip_address() : _bytes{} {}
+
+        constexpr explicit ip_address(const std::array<u8, 16>& bytes) : _bytes(bytes) {}
+
+        /*!
+         * Gets the bytes of the address in network byte order.
+         * @return The bytes of the address.
+         */
+        constexpr const std::array<u8, 16>& get_bytes() const {
+            return _bytes;
+        }
+
+        /*!
+         * Gets the 64 most significant bits of the address.
+         * @return The 64 most significant bits.
+         */
+        u64 get_high() const;
+
+        /*!
+         * Gets the 64 least significant bits of the address.
+         * @return The 64 least significant bits.
+         */
+        u64 get_low() const;
+
+        /*!
+         * Checks whether the address is an IPv4-mapped address.
+         * @return True if the address is an IPv4 address, else false.
+         */
+        bool is_v4() const;
+
+        /*!
+         * Gets the IPv4 address in host byte order, only meaningful if is_v4() is true.
+         * @return The IPv4 address.
+         */
+        u32 to_v4() const;
+
+        /*!
+         * Checks whether the address is the unspecified address (0.0.0.0 or ::).
+         * @return True if the address is unspecified, else false.
+         */
+        bool is_unspecified() const;
+
+        /*!
+         * Checks whether the address is a loopback address (127.0.0.0/8 or ::1).
+         * @return True if the address is a loopback address, else false.
+         */
+        bool is_loopback() const;
+
+        /*!
+         * Gets the bit at the specified index, 0 being the most significant bit.
+         * @param index The index of the bit, between 0 and 127.
+         * @return The value of the bit.
+         */
+        inline bool get_bit(u32 index) const {
+            return (_bytes[index >> 3] >> (7 - (index & 7))) & 1;
+        }
+
+        /*!
+         * Keeps only the specified count of most significant bits.
+         * @param prefix_length The count of bits to keep, between 0 and 128.
+         * @return The masked address.
+         */
+        ip_address masked(u32 prefix_length) const;
+
+        /*!
+         * Gets the length of the common prefix between this address and another.
+         * @param other The other address.
+         * @return The length of the common prefix in bits.
+         */
+        u32 common_prefix_length(const ip_address& other) const;
+
+        /*!
+         * Formats the address into the given buffer without allocating, IPv6 addresses are formatted following RFC 5952.
+         * The output is null-terminated if there is enough room.
+         * @param buffer The output buffer, should be at least MAX_STRING_LENGTH + 1 characters long.
+         * @param size The size of the buffer.
+         * @return The length of the formatted address, or 0 if the buffer is too small.
+         */
+        size_t format(char* buffer, size_t size) const;
+
+        std::string to_string() const;
+
+        bool operator==(const ip_address& other) const;
+
+        bool operator!=(const ip_address& other) const;
+
+        bool operator<(const ip_address& other) const;
+
+        /*!
+         * Makes an IPv4-mapped address.
+         * @param address The IPv4 address in host byte order.
+         * @return The IP address.
+         */
+        static ip_address from_v4(u32 address);
+
+        /*!
+         * Parses an IPv4 address in dotted-decimal notation without allocating.
+         * @param str The string to parse.
+         * @return The IPv4-mapped address if the string is valid, else an empty optional.
+         */
+        static std::optional<ip_address> parse_v4(std::string_view str);
+
+        /*!
+         * Parses an IPv6 address without allocating.
+         * @param str The string to parse.
+         * @return The address if the string is valid, else an empty optional.
+         */
+        static std::optional<ip_address> parse_v6(std::string_view str);
+
+        /*!
+         * Parses an IPv4 or IPv6 address without allocating.
+         * @param str The string to parse.
+         * @return The address if the string is valid, else an empty optional.
+         */
+        static std::optional<ip_address> parse(std::string_view str);
+    };
+
+    static_assert(sizeof(ip_address) == 16, "ip_address must stay a 16 bytes value type.");
+
+    /*!
+     * Represents a range of IP addresses sharing the same prefix.
+     */
+    class LAMBDACOMMON_API cidr
+    {
+    private:
+        ip_address _address;
+        // The prefix length in the 128-bit address space (IPv4 ranges are offset by 96).
+        u8 _length;
+
+    public:
+        constexpr cidr() : _address(), _length(0) {}
+
+        /*!
+         * Creates a new range.
+         * @param address The address, it will be masked with the prefix length.
+         * @param prefix_length The prefix length in the family of the address (0-32 for IPv4, 0-128 for IPv6).
+         */
+        cidr(const ip_address& address, u32 prefix_length);
+
+        /*!
+         * Gets the first address of the range.
+         * @return The network address.
+         */
+        const ip_address& get_address() const;
+
+        /*!
+         * Gets the prefix length in the family of the address.
+         * @return The prefix length.
+         */
+        u32 get_prefix_length() const;
+
+        /*!
+         * Gets the prefix length in the 128-bit address space.
+         * @return The prefix length in bits.
+         */
+        inline u32 get_bit_length() const {
+            return _length;
+        }
+
+        /*!
+         * Checks whether the given address is in the range.
+         * @param address The address to check.
+         * @return True if the address is in the range, else false.
+         */
+        bool contains(const ip_address& address) const;
+
+        std::string to_string() const;
+
+        bool operator==(const cidr& other) const;
+
+        bool operator!=(const cidr& other) const;
+
+        /*!
+         * Parses a range like "10.0.0.0/8" or "fe80::/10". An address without prefix length is a single address range.
+         * @param str The string to parse.
+         * @return The range if the string is valid, else an empty optional.
+         */
+        static std::optional<cidr> parse(std::string_view str);
+    };
+
+    /*!
+     * Maps IP ranges to values with longest-prefix matching, implemented as a compressed radix trie (PATRICIA).
+     * Lookups are bounded by the address length (128 bits) whatever the count of ranges.
+     * @tparam T The type of the values.
+     */
+    template<typename T>
+    class ip_prefix_table
+    {
+    private:
+        static constexpr u32 NO_NODE = ~u32(0);
+
+        struct node
+        {
+            ip_address key;
+            u32 length;
+            u32 children[2];
+            std::optional<T> value;
+        };
+
+        // Nodes are stored contiguously and linked with indices, the root (length 0) is always the first node.
+        std::vector<node> _nodes;
+        size_t _size = 0;
+
+        u32 new_node(const ip_address& key, u32 length) {
+            _nodes.push_back({key.masked(length), length, {NO_NODE, NO_NODE}, std::nullopt});
+            return static_cast<u32>(_nodes.size() - 1);
+        }
+
+        static bool matches(const node& n, const ip_address& address) {
+            return n.length == 0 || address.common_prefix_length(n.key) >= n.length;
+        }
+
+    public:
+        ip_prefix_table() {
+            clear();
+        }
+
+        /*!
+         * Inserts or replaces the value associated with the given range.
+         * @param range The range.
+         * @param value The value.
+         */
+        void insert(const cidr& range, T value) {
+            const ip_address& key = range.get_address();
+            const u32 length = range.get_bit_length();
+            u32 current = 0;
+            for (;;) {
+                if (_nodes[current].length == length) {
+                    if (!_nodes[current].value)
+                        _size++;
+                    _nodes[current].value = std::move(value);
+                    return;
+                }
+
+                bool bit = key.get_bit(_nodes[current].length);
+                u32 child = _nodes[current].children[bit];
+                if (child == NO_NODE) {
+                    u32 leaf = new_node(key, length);
+                    _nodes[leaf].value = std::move(value);
+                    _nodes[current].children[bit] = leaf;
+                    _size++;
+                    return;
+                }
+
+                u32 common = std::min({key.common_prefix_length(_nodes[child].key), _nodes[child].length, length});
+                if (common == _nodes[child].length) {
+                    // The child is a prefix of the range, go deeper.
+                    current = child;
+                    continue;
+                }
+
+                // Split the edge to the child.
+                u32 split = new_node(key, common);
+                _nodes[split].children[_nodes[child].key.get_bit(common)] = child;
+                if (common == length)
+                    _nodes[split].value = std::move(value);
+                else {
+                    u32 leaf = new_node(key, length);
+                    _nodes[leaf].value = std::move(value);
+                    _nodes[split].children[key.get_bit(common)] = leaf;
+                }
+                _nodes[current].children[bit] = split;
+                _size++;
+                return;
+            }
+        }
+
+        /*!
+         * Finds the value associated with exactly the given range.
+         * @param range The range.
+         * @return The value if found, else nullptr.
+         */
+        const T* find(const cidr& range) const {
+            const ip_address& key = range.get_address();
+            u32 current = 0;
+            while (current != NO_NODE) {
+                const node& n = _nodes[current];
+                if (!matches(n, key) || n.length > range.get_bit_length())
+                    return nullptr;
+                if (n.length == range.get_bit_length())
+                    return n.value ? &*n.value : nullptr;
+                current = n.children[key.get_bit(n.length)];
+            }
+            return nullptr;
+        }
+
+        /*!
+         * Finds the value of the most specific range containing the given address.
+         * @param address The address to match.
+         * @return The value of the longest matching prefix if any, else nullptr.
+         */
+        const T* match(const ip_address& address) const {
+            const T* best = nullptr;
+            u32 current = 0;
+            while (current != NO_NODE) {
+                const node& n = _nodes[current];
+                if (!matches(n, address))
+                    break;
+                if (n.value)
+                    best = &*n.value;
+                if (n.length == 128)
+                    break;
+                current = n.children[address.get_bit(n.length)];
+            }
+            return best;
+        }
+
+        /*!
+         * Checks whether any range contains the given address.
+         * @param address The address to check.
+         * @return True if the address is in a range of the table, else false.
+         */
+        inline bool contains(const ip_address& address) const {
+            return match(address) != nullptr;
+        }
+
+        /*!
+         * Gets the count of ranges in the table.
+         * @return The count of ranges.
+         */
+        size_t size() const {
+            return _size;
+        }
+
+        bool empty() const {
+            return _size == 0;
+        }
+
+        /*!
+         * Removes every range of the table.
+         */
+        void clear() {
+            _nodes.clear();
+            _size = 0;
+            new_node(ip_address(), 0);
+        }
+    };
+}
+
+namespace std
+{
+    template<>
+    struct hash<lambdacommon::ip_address>
+    {
+        size_t operator()(const lambdacommon::ip_address& address) const noexcept {
+            lambdacommon::u64 h = address.get_high() * 0x9E3779B97F4A7C15ull ^ address.get_low();
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+}
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_IP_H
@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_RESOLVER_H
+#define LAMBDACOMMON_RESOLVER_H
+
+#include "address.h"
+#include "../system/thread_pool.h"
+#include <chrono>
+#include <system_error>
+#include <unordered_map>
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+namespace lambdacommon::connection
+{
+    /*!
+     * Gets the error category of the getaddrinfo() error codes (EAI_*), thrown by the default lookup.
+     * A system error of the lookup is thrown with its errno in the generic category instead.
+     * @return The category.
+     */
+    extern const std::error_category& LAMBDACOMMON_API resolver_category();
+
+    struct resolver_options
+    {
+        /*!
+         * The count of threads running the lookups.
+         */
+        u32 threads = 2;
+        /*!
+         * The time a successful lookup stays cached.
+         */
+        std::chrono::milliseconds ttl{60000};
+        /*!
+         * The time a failed lookup stays cached.
+         */
+        std::chrono::milliseconds negative_ttl{5000};
+        /*!
+         * The maximum count of cached hosts.
+         */
+        size_t max_entries = 4096;
+        /*!
+         * Resolves a host name, the default lookup calls getaddrinfo().
+         * It returns an empty vector if the host does not exist and throws on other errors.
+         */
+        std::function<std::vector<ip_address>(const std::string&)> lookup;
+    };
+
+    /*!
+     * Statistics of a resolver, every counter is cumulative.
+     */
+    struct resolver_stats
+    {
+        /*!
+         * The count of lookups run on the thread pool.
+         */
+        u64 lookups = 0;
+        /*!
+         * The count of requests answered by a completed cache entry.
+         */
+        u64 cache_hits = 0;
+        /*!
+         * The count of requests joined to a lookup in progress.
+         */
+        u64 joined = 0;
+    };
+
+    /*!
+     * Represents an asynchronous host name resolver with a TTL cache.
+     *
+     * Lookups run on a small dedicated thread pool, concurrent requests for the same host share a single lookup.
+     * Host names are case-insensitive and IP address literals are answered without any lookup.
+     */
+    class LAMBDACOMMON_API resolver
+    {
+    public:
+        typedef std::shared_future<std::vector<ip_address>> result;
+
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        struct entry
+        {
+            result addresses;
+            clock::time_point expiration;
+            /*!
+             * True while the lookup is in progress, the expiration time is set once it completes.
+             */
+            bool pending;
+        };
+
+        resolver_options _options;
+        std::unordered_map<std::string, entry> _cache;
+        mutable std::mutex _mutex;
+        resolver_stats _stats;
+        // Declared last so the workers are joined before the cache is destroyed.
+        system::thread_pool _pool;
+
+        void complete(const std::string& host, bool success);
+
+        void evict(clock::time_point now);
+
+    public:
+        explicit resolver(resolver_options options = {});
+
+        resolver(const resolver& other) = delete;
+
+        /*!
+         * Resolves a host name to its IP addresses.
+         * @param host The host name or IP address literal.
+         * @return The future of the IP addresses, empty if the host does not exist.
+         */
+        result resolve(const std::string& host);
+
+        /*!
+         * Resolves the host of an address to socket-ready addresses with the same port.
+         * Unlike the other overload, it blocks until the lookup completes.
+         * @param address The address.
+         * @return The resolved addresses, empty if the host does not exist.
+         */
+        std::vector<Address> resolve(const Address& address);
+
+        /*!
+         * Gets the cached IP addresses of a host without starting a lookup.
+         * @param host The host name.
+         * @return The IP addresses if the host is cached and its lookup completed, else an empty optional.
+         */
+        std::optional<std::vector<ip_address>> get_cached(const std::string& host) const;
+
+        /*!
+         * Removes every completed entry from the cache.
+         */
+        void clear_cache();
+
+        resolver_stats get_stats() const;
+
+        resolver& operator=(const resolver& other) = delete;
+    };
+}
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_RESOLVER_H
@@ -0,0 +1,244 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_SOCKET_H
+#define LAMBDACOMMON_SOCKET_H
+
+#include "address.h"
+#include "buffer_chain.h"
+#include <optional>
+
+#if !defined(LAMBDA_WINDOWS) && !defined(LAMBDA_WASM)
+#  define LAMBDA_HAS_SOCKETS
+#endif
+
+#ifdef LAMBDA_HAS_SOCKETS
+
+struct sockaddr_storage;
+
+namespace lambdacommon::connection
+{
+    /*!
+     * Converts an address to a socket address. The host must be an IPv4 or IPv6 address, domain names must be resolved first.
+     * @param address The address to convert.
+     * @param storage The socket address storage to fill.
+     * @return The length of the socket address.
+     */
+    extern u32 LAMBDACOMMON_API to_sockaddr(const Address& address, sockaddr_storage& storage);
+
+    /*!
+     * Converts a socket address to an address.
+     * @param storage The socket address.
+     * @return The address.
+     */
+    extern Address LAMBDACOMMON_API from_sockaddr(const sockaddr_storage& storage);
+
+    /*!
+     * Represents an owned non-blocking socket file descriptor, closed on destruction.
+     */
+    class LAMBDACOMMON_API socket_handle
+    {
+    protected:
+        int _fd = -1;
+
+    public:
+        socket_handle() = default;
+
+        explicit socket_handle(int fd);
+
+        socket_handle(const socket_handle& other) = delete;
+
+        socket_handle(socket_handle&& other) noexcept;
+
+        virtual ~socket_handle();
+
+        /*!
+         * Gets the file descriptor of the socket.
+         * @return The file descriptor, -1 if the socket is closed.
+         */
+        int get_fd() const;
+
+        /*!
+         * Checks whether the socket is open.
+         * @return True if the socket is open, else false.
+         */
+        bool is_open() const;
+
+        /*!
+         * Closes the socket.
+         */
+        void close();
+
+        /*!
+         * Releases the ownership of the file descriptor.
+         * @return The file descriptor.
+         */
+        int release();
+
+        /*!
+         * Gets the local address of the socket.
+         * @return The local address.
+         */
+        Address get_local_address() const;
+
+        /*!
+         * Gets and clears the pending error of the socket (SO_ERROR), useful to know whether a connection succeeded.
+         * @return The error code, 0 if there is no error.
+         */
+        int get_error() const;
+
+        socket_handle& operator=(const socket_handle& other) = delete;
+
+        socket_handle& operator=(socket_handle&& other) noexcept;
+    };
+
+    /*!
+     * Represents a non-blocking TCP connection.
+     */
+    class LAMBDACOMMON_API tcp_stream : public socket_handle
+    {
+    public:
+        tcp_stream() = default;
+
+        explicit tcp_stream(int fd);
+
+        /*!
+         * Starts a non-blocking connection to the given address, wait for the writable event to know when it completes.
+         * @param address The address to connect to.
+         * @return The stream.
+         */
+        static tcp_stream connect(const Address& address);
+
+        /*!
+         * Reads data from the stream.
+         * @param buffer The buffer to fill.
+         * @param size The size of the buffer.
+         * @return The count of bytes read, 0 if the peer closed the connection, or an empty optional if no data is available yet.
+         */
+        std::optional<size_t> read(void* buffer, size_t size);
+
+        /*!
+         * Writes data to the stream.
+         * @param data The data to write.
+         * @param size The size of the data.
+         * @return The count of bytes written, or an empty optional if the send buffer is full.
+         */
+        std::optional<size_t> write(const void* data, size_t size);
+
+        /*!
+         * Reads data from the stream directly into the free space at the end of a buffer chain.
+         * @param buffer The buffer chain to append to.
+         * @param max The maximum count of bytes to read.
+         * @return The count of bytes read, 0 if the peer closed the connection, or an empty optional if no data is available yet.
+         */
+        std::optional<size_t> read(buffer_chain& buffer, size_t max = slab::DEFAULT_CAPACITY);
+
+        /*!
+         * Writes the segments of a buffer chain with a single gathering write, the written bytes are consumed from the chain.
+         * @param buffer The buffer chain to write.
+         * @return The count of bytes written, or an empty optional if the send buffer is full.
+         */
+        std::optional<size_t> write(buffer_chain& buffer);
+
+        /*!
+         * Sends a part of a file to the stream. On Linux the kernel copies the bytes without going through user space (sendfile).
+         * @param file_fd The file descriptor of the file.
+         * @param offset The offset of the first byte to send, advanced by the count of bytes sent.
+         * @param count The count of bytes to send.
+         * @return The count of bytes sent, 0 at the end of the file, or an empty optional if the send buffer is full.
+         */
+        std::optional<size_t> send_file(int file_fd, u64& offset, size_t count);
+
+        /*!
+         * Shuts down the writing side of the connection.
+         */
+        void shutdown_write();
+
+        /*!
+         * Enables or disables Nagle's algorithm.
+         * @param no_delay True to disable Nagle's algorithm, else false.
+         */
+        void set_no_delay(bool no_delay);
+
+        /*!
+         * Gets the address of the peer.
+         * @return The peer address.
+         */
+        Address get_peer_address() const;
+    };
+
+    /*!
+     * Represents a non-blocking TCP listening socket.
+     */
+    class LAMBDACOMMON_API tcp_listener : public socket_handle
+    {
+    public:
+        tcp_listener() = default;
+
+        /*!
+         * Binds a new listener.
+         * @param address The address to listen on, a port of 0 picks an ephemeral port.
+         * @param reuse_port True to set SO_REUSEPORT so several listeners (one per loop) can share the port.
+         * @param backlog The length of the pending connections queue.
+         */
+        explicit tcp_listener(const Address& address, bool reuse_port = false, int backlog = 1024);
+
+        /*!
+         * Accepts a pending connection.
+         * @return The new non-blocking stream, or an empty optional if there is no pending connection.
+         */
+        std::optional<tcp_stream> accept();
+    };
+
+    /*!
+     * Represents a non-blocking UDP socket.
+     */
+    class LAMBDACOMMON_API udp_socket : public socket_handle
+    {
+    public:
+        udp_socket() = default;
+
+        /*!
+         * Binds a new UDP socket.
+         * @param address The address to bind, a port of 0 picks an ephemeral port.
+         * @param reuse_port True to set SO_REUSEPORT so several sockets can share the port.
+         */
+        explicit udp_socket(const Address& address, bool reuse_port = false);
+
+        /*!
+         * Sends a datagram.
+         * @param data The datagram content.
+         * @param size The size of the datagram.
+         * @param to The destination address.
+         * @return The count of bytes sent, or an empty optional if the send buffer is full.
+         */
+        std::optional<size_t> send_to(const void* data, size_t size, const Address& to);
+
+        /*!
+         * Receives a datagram.
+         * @param buffer The buffer to fill.
+         * @param size The size of the buffer.
+         * @param from The address of the sender, if not null.
+         * @return The size of the datagram, or an empty optional if no datagram is available.
+         */
+        std::optional<size_t> receive_from(void* buffer, size_t size, Address* from = nullptr);
+
+        /*!
+         * Enables or disables UDP generic receive offload, the kernel may then coalesce datagrams of a same flow into a single read.
+         * Use a udp_receive_batch to split them back.
+         * @param enabled True to enable the offload, else false.
+         * @return True if the kernel supports it, else false.
+         */
+        bool set_gro(bool enabled);
+    };
+}
+
+#endif
+
+#endif //LAMBDACOMMON_SOCKET_H
@@ -0,0 +1,191 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_UDP_BATCH_H
+#define LAMBDACOMMON_UDP_BATCH_H
+
+#include "socket.h"
+#include <string_view>
+#include <vector>
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+#ifdef LAMBDA_HAS_SOCKETS
+
+#include <sys/socket.h>
+
+namespace lambdacommon::connection
+{
+    /*!
+     * Represents a ring of preallocated datagram buffers filled with a single recvmmsg() call.
+     *
+     * If generic receive offload is enabled on the socket, coalesced datagrams are split back so each datagram has its own entry.
+     */
+    class LAMBDACOMMON_API udp_receive_batch
+    {
+    private:
+        struct datagram
+        {
+            u32 offset;
+            u32 length;
+            u32 source;
+        };
+
+        size_t _capacity;
+        size_t _buffer_size;
+        std::vector<char> _buffers;
+        std::vector<sockaddr_storage> _sources;
+        std::vector<datagram> _datagrams;
+#ifdef LAMBDA_LINUX
+        std::vector<mmsghdr> _messages;
+        std::vector<iovec> _iovecs;
+        std::vector<char> _control;
+#endif
+
+    public:
+        /*!
+         * Creates a new receive batch.
+         * @param capacity The count of buffers, which is the maximum count of reads per call.
+         * @param buffer_size The size of a buffer, use 65535 when generic receive offload is enabled.
+         */
+        explicit udp_receive_batch(size_t capacity = 64, size_t buffer_size = 2048);
+
+        udp_receive_batch(const udp_receive_batch& other) = delete;
+
+        /*!
+         * Receives as many datagrams as possible, replacing the previously received ones.
+         * @param socket The socket.
+         * @return The count of datagrams received, or an empty optional if no datagram is available.
+         */
+        std::optional<size_t> receive(udp_socket& socket);
+
+        /*!
+         * Gets the count of datagrams received by the last call of receive().
+         * @return The count of datagrams.
+         */
+        size_t size() const;
+
+        /*!
+         * Gets the content of a received datagram, valid until the next call of receive().
+         * @param index The index of the datagram.
+         * @return The content of the datagram.
+         */
+        std::string_view get_data(size_t index) const;
+
+        /*!
+         * Gets the socket address of the sender of a datagram, to reply without converting it.
+         * @param index The index of the datagram.
+         * @return The socket address of the sender.
+         */
+        const sockaddr_storage& get_source_storage(size_t index) const;
+
+        /*!
+         * Gets the address of the sender of a datagram.
+         * @param index The index of the datagram.
+         * @return The address of the sender.
+         */
+        Address get_source(size_t index) const;
+
+        udp_receive_batch& operator=(const udp_receive_batch& other) = delete;
+    };
+
+    /*!
+     * Represents a batch of outgoing datagrams sent with a single sendmmsg() call.
+     *
+     * When the kernel supports UDP segmentation offload, consecutive datagrams of the same size to the same destination
+     * are sent as a single message which the kernel (or the network card) splits.
+     */
+    class LAMBDACOMMON_API udp_send_batch
+    {
+    private:
+        size_t _capacity;
+        size_t _buffer_size;
+        size_t _count = 0;
+        size_t _sent = 0;
+        bool _segmentation = true;
+        std::vector<char> _buffers;
+        std::vector<sockaddr_storage> _destinations;
+        std::vector<u32> _destination_lengths;
+        std::vector<iovec> _iovecs;
+#ifdef LAMBDA_LINUX
+        std::vector<mmsghdr> _messages;
+        std::vector<u32> _runs;
+        std::vector<char> _control;
+#endif
+
+    public:
+        /*!
+         * Creates a new send batch.
+         * @param capacity The maximum count of datagrams in the batch.
+         * @param buffer_size The maximum size of a datagram.
+         */
+        explicit udp_send_batch(size_t capacity = 64, size_t buffer_size = 2048);
+
+        udp_send_batch(const udp_send_batch& other) = delete;
+
+        /*!
+         * Adds a copy of a datagram to the batch.
+         * @param data The datagram content.
+         * @param size The size of the datagram.
+         * @param to The destination address.
+         * @return True if the datagram was added, false if the batch is full or the datagram is too big.
+         */
+        bool add(const void* data, size_t size, const Address& to);
+
+        /*!
+         * Adds a copy of a datagram to the batch.
+         * @param data The datagram content.
+         * @param size The size of the datagram.
+         * @param to The destination socket address, for example the source of a received datagram.
+         * @return True if the datagram was added, false if the batch is full or the datagram is too big.
+         */
+        bool add(const void* data, size_t size, const sockaddr_storage& to);
+
+        /*!
+         * Sends the pending datagrams. The sent datagrams are removed from the batch.
+         * @param socket The socket.
+         * @return The count of datagrams sent, or an empty optional if the send buffer is full.
+         */
+        std::optional<size_t> send(udp_socket& socket);
+
+        /*!
+         * Gets the count of pending datagrams.
+         * @return The count of pending datagrams.
+         */
+        size_t size() const;
+
+        bool is_full() const;
+
+        /*!
+         * Enables or disables UDP segmentation offload. It is enabled by default and disabled automatically if the kernel rejects it.
+         * @param enabled True to enable segmentation offload, else false.
+         */
+        void set_segmentation(bool enabled);
+
+        bool is_segmentation_enabled() const;
+
+        /*!
+         * Removes every pending datagram.
+         */
+        void clear();
+
+        udp_send_batch& operator=(const udp_send_batch& other) = delete;
+    };
+}
+
+#endif
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_UDP_BATCH_H
@@ -196,6 +196,61 @@ namespace lambdacommon
         static Color COLOR_BLUE;
     };
 
+    /*!
+     * Represents a color packed in 32 bits, a byte per component in the order red, green, blue then alpha.
+     * It is the compact form of the pixel buffers, converted in bulk with color::to_rgba8 and color::to_f32x4.
+     */
+    struct color_rgba8
+    {
+        u8 red;
+        u8 green;
+        u8 blue;
+        u8 alpha;
+
+        constexpr bool operator==(const color_rgba8& other) const {
+            return red == other.red && green == other.green && blue == other.blue && alpha == other.alpha;
+        }
+
+        constexpr bool operator!=(const color_rgba8& other) const {
+            return !(*this == other);
+        }
+    };
+
+    /*!
+     * Represents a color as four floats in the order red, green, blue then alpha, usually between 0 and 1.
+     * Unlike Color it is a plain aggregate without clamping, for the buffers of computations.
+     */
+    struct alignas(16) color_f32x4
+    {
+        f32 red;
+        f32 green;
+        f32 blue;
+        f32 alpha;
+
+        constexpr bool operator==(const color_f32x4& other) const {
+            return red == other.red && green == other.green && blue == other.blue && alpha == other.alpha;
+        }
+
+        constexpr bool operator!=(const color_f32x4& other) const {
+            return !(*this == other);
+        }
+    };
+
+    static_assert(sizeof(color_rgba8) == 4 && sizeof(color_f32x4) == 16, "The colors must be packed.");
+
+    /*!
+     * Represents how a conversion handles the alpha channel.
+     */
+    enum alpha_conversion : u8
+    {
+        /*! The components are converted as they are. */
+        ALPHA_KEEP,
+        /*! The components are multiplied by the alpha. */
+        ALPHA_PREMULTIPLY,
+        /*! The components are divided by the alpha, the transparent colors become black. */
+        ALPHA_UNPREMULTIPLY
+    };
+
     namespace color
     {
         /*!
@@ -239,6 +294,46 @@ namespace lambdacommon
          * @return A new Color instance.
          */
         extern Color LAMBDACOMMON_API from_int_rgba(u8 red, u8 green, u8 blue, u8 alpha = 255);
+
+        /*
+         * Conversions between the packed colors: the floats are clamped between 0 and 1, NaN giving 0, and multiplied
+         * by 255 rounded to nearest. The bytes are divided by 255.
+         * The alpha conversion applies on the floats, after the clamping.
+         */
+
+        extern color_rgba8 LAMBDACOMMON_API to_rgba8(const color_f32x4& color, alpha_conversion conversion = ALPHA_KEEP);
+
+        extern color_f32x4 LAMBDACOMMON_API to_f32x4(const color_rgba8& color, alpha_conversion conversion = ALPHA_KEEP);
+
+        /*
+         * Bulk conversions, they dispatch at runtime to the instruction set returned by maths::get_simd_level() and give
+         * the same results as the single ones.
+         */
+
+        extern void LAMBDACOMMON_API to_rgba8(const color_f32x4* in, color_rgba8* out, size_t count, alpha_conversion conversion = ALPHA_KEEP);
+
+        extern void LAMBDACOMMON_API to_f32x4(const color_rgba8* in, color_f32x4* out, size_t count, alpha_conversion conversion = ALPHA_KEEP);
+
+        /*!
+         * Multiplies the components of colors by their alpha in place, rounded to nearest.
+         */
+        extern void LAMBDACOMMON_API premultiply(color_rgba8* colors, size_t count);
+
+        /*!
+         * Divides the components of premultiplied colors by their alpha in place, rounded to nearest and clamped.
+         */
+        extern void LAMBDACOMMON_API unpremultiply(color_rgba8* colors, size_t count);
+
+        inline color_f32x4 to_f32x4(const Color& color) {
+            return {color.red(), color.green(), color.blue(), color.alpha()};
+        }
+
+        /*!
+         * Packs a color, rounded to nearest unlike the truncation of Color::red_as_int() and the others.
+         */
+        inline color_rgba8 to_rgba8(const Color& color) {
+            return to_rgba8(to_f32x4(color));
+        }
     }
 }
 
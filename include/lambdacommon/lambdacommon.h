@@ -41,6 +41,8 @@
 #  endif
 #elif defined(sun) || defined(__sun)
 #  define LAMBDA_SOLARIS
+#elif defined(__linux__)
+#  define LAMBDA_LINUX
 #endif
 #ifdef __CYGWIN__
 #  define LAMBDA_CYGWIN
@@ -13,6 +13,7 @@
 #include "object.h"
 #include <vector>
 #include <optional>
+#include <string_view>
 
 namespace lambdacommon::lstring
 {
@@ -44,12 +45,13 @@ namespace lambdacommon::lstring
     extern bool LAMBDACOMMON_API equals(const std::string& a, const std::string& b);
 
     /*!
-     * Checks if two strings are equal with case insensitive.
+     * Checks if two strings are equal with case insensitive, only ASCII letters are folded.
+     * The strings are compared 16 bytes at a time when SSE2 is available.
      * @param a One of two strings.
      * @param b One of two strings.
      * @return True if they are equal with case insensitive else false.
      */
-    extern bool LAMBDACOMMON_API equals_ignore_case(const std::string& a, const std::string& b);
+    extern bool LAMBDACOMMON_API equals_ignore_case(std::string_view a, std::string_view b);
 
     /*!
      * Transforms a string to a full lower case string.
@@ -17,6 +17,9 @@
  */
 
 #include "types.h"
+#include <initializer_list>
+#include <limits>
+#include <type_traits>
 
 #define LCOMMON_PI 3.14159265359
 #define LCOMMON_TAU 6.28318530718
@@ -30,7 +33,7 @@ namespace lambdacommon::maths
      * @return The absolute value.
      */
     template<typename N>
-    inline N abs(N number) {
+    constexpr N abs(N number) {
         return number < 0 ? -number : number;
     }
 
@@ -42,29 +45,39 @@ namespace lambdacommon::maths
      * @return The smallest number.
      */
     template<typename N>
-    inline N min(N a, N b) {
+    constexpr N min(N a, N b) {
         return a < b ? a : b;
     }
 
     /*!
      * Returns the smallest value of all arguments.
      * @tparam N The number type.
-     * @param numbers Numbers to get the smallest from.
+     * @param a One of the numbers to get the smallest from.
+     * @param b One of the numbers to get the smallest from.
+     * @param c One of the numbers to get the smallest from.
+     * @param others Other numbers to get the smallest from.
      * @return The smallest number.
      */
+    template<typename N, typename... Others>
+    constexpr N min(N a, N b, N c, Others... others) {
+        return maths::min(maths::min(a, b), c, others...);
+    }
+
+    /*!
+     * Returns the smallest value of all arguments.
+     * @tparam N The number type.
+     * @param numbers Numbers to get the smallest from.
+     * @return The smallest number, or 0 if there is none.
+     */
     template<typename N>
-    N min(const std::initializer_list<N>& numbers) {
+    constexpr N min(std::initializer_list<N> numbers) {
         if (numbers.size() == 0)
             return 0;
 
-        bool first = true;
-        N min_n;
-        for (auto i : numbers)
-            if (first) {
-                min_n = i;
-                first = false;
-            } else
-                min_n = min(min_n, i);
+        auto it = numbers.begin();
+        N min_n = *it;
+        for (++it; it != numbers.end(); ++it)
+            min_n = maths::min(min_n, *it);
         return min_n;
     }
 
@@ -76,29 +89,39 @@ namespace lambdacommon::maths
      * @return The largest number.
      */
     template<typename N>
-    inline N max(N a, N b) {
+    constexpr N max(N a, N b) {
         return a > b ? a : b;
     }
 
     /*!
      * Returns the largest value of all arguments.
      * @tparam N The number type.
-     * @param numbers Numbers to get the largest from.
+     * @param a One of the numbers to get the largest from.
+     * @param b One of the numbers to get the largest from.
+     * @param c One of the numbers to get the largest from.
+     * @param others Other numbers to get the largest from.
      * @return The largest number.
      */
+    template<typename N, typename... Others>
+    constexpr N max(N a, N b, N c, Others... others) {
+        return maths::max(maths::max(a, b), c, others...);
+    }
+
+    /*!
+     * Returns the largest value of all arguments.
+     * @tparam N The number type.
+     * @param numbers Numbers to get the largest from.
+     * @return The largest number, or 0 if there is none.
+     */
     template<typename N>
-    N max(const std::initializer_list<N>& numbers) {
+    constexpr N max(std::initializer_list<N> numbers) {
         if (numbers.size() == 0)
             return 0;
 
-        bool first = true;
-        N max_n;
-        for (auto i : numbers)
-            if (first) {
-                max_n = i;
-                first = false;
-            } else
-                max_n = max(max_n, i);
+        auto it = numbers.begin();
+        N max_n = *it;
+        for (++it; it != numbers.end(); ++it)
+            max_n = maths::max(max_n, *it);
         return max_n;
     }
 
@@ -111,7 +134,7 @@ namespace lambdacommon::maths
      * @return The clamped value.
      */
     template<typename N>
-    inline N clamp(N number, N min, N max) {
+    constexpr N clamp(N number, N min, N max) {
         return maths::min(maths::max(number, min), max);
     }
 
@@ -125,7 +148,7 @@ namespace lambdacommon::maths
      * @return The clamped value.
      */
     template<typename N>
-    N clamp_reset(N number, N min, N max) {
+    constexpr N clamp_reset(N number, N min, N max) {
         if (number > max)
             return min;
         else if (number < min)
@@ -134,6 +157,96 @@ namespace lambdacommon::maths
             return number;
     }
 
+    /*
+     * Integer functions.
+     */
+
+    /*!
+     * Raises a number to an integer power by repeated squaring.
+     * @tparam N The number type.
+     * @param base The base.
+     * @param exponent The exponent.
+     * @return The base raised to the exponent, 1 if the exponent is 0.
+     */
+    template<typename N>
+    constexpr N ipow(N base, u32 exponent) {
+        N result = 1;
+        while (exponent) {
+            if (exponent & 1u)
+                result *= base;
+            exponent >>= 1u;
+            if (exponent)
+                base *= base;
+        }
+        return result;
+    }
+
+    /*!
+     * Calculates the integer square root of a number, rounded down.
+     * @tparam N The integer type.
+     * @param number The number, must not be negative.
+     * @return The largest integer whose square is not greater than the number.
+     */
+    template<typename N>
+    constexpr N isqrt(N number) {
+        static_assert(std::is_integral_v<N>, "isqrt requires an integer type.");
+        using U = std::make_unsigned_t<N>;
+        auto value = static_cast<U>(number);
+        U result = 0;
+        U bit = U(1) << ((std::numeric_limits<U>::digits - 2) & ~1);
+        while (bit > value)
+            bit >>= 2u;
+        while (bit) {
+            if (value >= result + bit) {
+                value -= result + bit;
+                result = (result >> 1u) + bit;
+            } else
+                result >>= 1u;
+            bit >>= 2u;
+        }
+        return static_cast<N>(result);
+    }
+
+    /*!
+     * Calculates the base 2 logarithm of a number, rounded down.
+     * @tparam N The integer type.
+     * @param number The number, must be positive.
+     * @return The index of the highest set bit of the number.
+     */
+    template<typename N>
+    constexpr u32 ilog2(N number) {
+        static_assert(std::is_integral_v<N>, "ilog2 requires an integer type.");
+        auto value = static_cast<std::make_unsigned_t<N>>(number);
+        u32 result = 0;
+        while (value >>= 1u)
+            result++;
+        return result;
+    }
+
+    /*!
+     * Checks whether a number is a power of two.
+     * @tparam N The integer type.
+     * @param number The number.
+     * @return True if the number is a power of two, else false.
+     */
+    template<typename N>
+    constexpr bool is_power_of_two(N number) {
+        static_assert(std::is_integral_v<N>, "is_power_of_two requires an integer type.");
+        return number > 0 && (number & (number - 1)) == 0;
+    }
+
+    /*!
+     * Rounds a number up to a power of two.
+     * @tparam N The integer type.
+     * @param number The number.
+     * @return The smallest power of two not less than the number, 1 if the number is not positive.
+     */
+    template<typename N>
+    constexpr N next_power_of_two(N number) {
+        static_assert(std::is_integral_v<N>, "next_power_of_two requires an integer type.");
+        return number <= 1 ? N(1) : static_cast<N>(N(1) << (ilog2(number - 1) + 1));
+    }
+
     /*
      * Trigonometric functions.
      */
@@ -143,14 +256,18 @@ namespace lambdacommon::maths
      * @param degrees Value representing an angle, expressed in degrees.
      * @return The radian value.
      */
-    extern f64 LAMBDACOMMON_API radians(f64 degrees);
+    constexpr f64 radians(f64 degrees) {
+        return degrees * (LCOMMON_PI / 180.0);
+    }
 
     /*!
      * Converts a degree value to a radian value.
      * @param degrees Value representing an angle, expressed in degrees.
      * @return The radian value.
      */
-    extern f32 LAMBDACOMMON_API radians(f32 degrees);
+    constexpr f32 radians(f32 degrees) {
+        return degrees * static_cast<f32>(LCOMMON_PI / 180.0);
+    }
 
     /*!
      * Converts a degree value to a radian value.
@@ -159,7 +276,7 @@ namespace lambdacommon::maths
      * @return The radian value.
      */
     template<typename N>
-    f64 radians(N degrees) {
+    constexpr f64 radians(N degrees) {
         return radians(static_cast<f64>(degrees));
     }
 
@@ -168,14 +285,18 @@ namespace lambdacommon::maths
      * @param degrees Value representing an angle, expressed in radians.
      * @return The degree value.
      */
-    extern f64 LAMBDACOMMON_API degrees(f64 radians);
+    constexpr f64 degrees(f64 radians) {
+        return radians * (180.0 / LCOMMON_PI);
+    }
 
     /*!
      * Converts a radian value to a radian value.
      * @param degrees Value representing an angle, expressed in radians.
      * @return The degree value.
      */
-    extern f32 LAMBDACOMMON_API degrees(f32 radians);
+    constexpr f32 degrees(f32 radians) {
+        return radians * static_cast<f32>(180.0 / LCOMMON_PI);
+    }
 
     /*!
      * Converts a radian value to a radian value.
@@ -184,7 +305,7 @@ namespace lambdacommon::maths
      * @return The degree value.
      */
     template<typename N>
-    f64 degrees(N radians) {
+    constexpr f64 degrees(N radians) {
         return degrees(static_cast<f64>(radians));
     }
 }
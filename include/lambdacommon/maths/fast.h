@@ -0,0 +1,373 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_FAST_H
+#define LAMBDACOMMON_FAST_H
+
+#include "../types.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+/*
+ * fast.h
+ *
+ * Single precision approximations of the transcendental functions, written once over the operations of an instruction set
+ * so the scalar functions and the batch kernels compute the same polynomials.
+ * The error bounds are measured against the double precision functions of the standard library, in units in the last
+ * place (ULP) of the float result.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LAMBDACOMMON_FAST_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace lambdacommon::maths::fast
+{
+    namespace internal
+    {
+        /*!
+         * The operations of the scalar instruction set: a float, its bits, and a bool as the comparison mask.
+         */
+        struct scalar_ops
+        {
+            typedef f32 reg;
+            typedef u32 ireg;
+            typedef bool mask;
+
+            static inline reg splat(f32 v) { return v; }
+
+            static inline ireg isplat(u32 v) { return v; }
+
+            static inline reg add(reg a, reg b) { return a + b; }
+
+            static inline reg sub(reg a, reg b) { return a - b; }
+
+            static inline reg mul(reg a, reg b) { return a * b; }
+
+            static inline reg div(reg a, reg b) { return a / b; }
+
+            static inline reg fmadd(reg a, reg b, reg c) { return a * b + c; }
+
+            static inline reg min(reg a, reg b) { return b < a ? b : a; }
+
+            static inline reg max(reg a, reg b) { return a < b ? b : a; }
+
+            static inline reg sqrt(reg a) { return std::sqrt(a); }
+
+            /*!
+             * Estimates 1 / sqrt(a) to about 12 bits.
+             */
+            static inline reg rsqrt_estimate(reg a) {
+#ifdef LAMBDACOMMON_FAST_SSE2
+                return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(a)));
+#else
+                reg y = as_float(0x5F375A86u - (as_int(a) >> 1));
+                return y * (1.5f - 0.5f * a * y * y);
+#endif
+            }
+
+            static inline ireg as_int(reg a) {
+                ireg result;
+                std::memcpy(&result, &a, sizeof(result));
+                return result;
+            }
+
+            static inline reg as_float(ireg a) {
+                reg result;
+                std::memcpy(&result, &a, sizeof(result));
+                return result;
+            }
+
+            static inline ireg round_to_int(reg a) { return static_cast<ireg>(static_cast<i32>(std::nearbyint(a))); }
+
+            static inline ireg truncate_to_int(reg a) { return static_cast<ireg>(static_cast<i32>(a)); }
+
+            static inline reg to_float(ireg a) { return static_cast<reg>(static_cast<i32>(a)); }
+
+            static inline ireg iadd(ireg a, ireg b) { return a + b; }
+
+            static inline ireg isub(ireg a, ireg b) { return a - b; }
+
+            static inline ireg iand(ireg a, ireg b) { return a & b; }
+
+            static inline ireg ior(ireg a, ireg b) { return a | b; }
+
+            static inline ireg ixor(ireg a, ireg b) { return a ^ b; }
+
+            template<int N>
+            static inline ireg shl(ireg a) { return a << N; }
+
+            template<int N>
+            static inline ireg shr(ireg a) { return a >> N; }
+
+            static inline ireg imul(ireg a, ireg b) { return a * b; }
+
+            static inline mask less(reg a, reg b) { return a < b; }
+
+            static inline mask equal(reg a, reg b) { return a == b; }
+
+            static inline mask is_zero(ireg a) { return a == 0; }
+
+            static inline reg select(mask m, reg a, reg b) { return m ? a : b; }
+        };
+
+        /*!
+         * Implements the approximations over the operations of an instruction set.
+         * @tparam Ops The operations, see scalar_ops for the expected members.
+         */
+        template<typename Ops>
+        struct algorithms
+        {
+            typedef typename Ops::reg reg;
+            typedef typename Ops::ireg ireg;
+
+            static constexpr f32 PI = 3.14159265358979f;
+            static constexpr f32 HALF_PI = 1.57079632679490f;
+            static constexpr f32 QUARTER_PI = 0.785398163397448f;
+
+            static inline reg abs(reg x) {
+                return Ops::as_float(Ops::iand(Ops::as_int(x), Ops::isplat(0x7FFFFFFFu)));
+            }
+
+            static inline ireg sign_of(reg x) {
+                return Ops::iand(Ops::as_int(x), Ops::isplat(0x80000000u));
+            }
+
+            static inline reg flip_sign(reg x, ireg sign) {
+                return Ops::as_float(Ops::ixor(Ops::as_int(x), sign));
+            }
+
+            /*!
+             * Builds 2^n for n in [-126, 127].
+             */
+            static inline reg pow2(ireg n) {
+                return Ops::as_float(Ops::template shl<23>(Ops::iadd(n, Ops::isplat(127))));
+            }
+
+            static inline reg rsqrt(reg x) {
+                reg y = Ops::rsqrt_estimate(x);
+                // One Newton-Raphson step doubles the correct bits: y * (1.5 - x / 2 * y * y).
+                reg half_x_y = Ops::mul(Ops::mul(x, Ops::splat(0.5f)), y);
+                return Ops::mul(y, Ops::fmadd(Ops::splat(-1.f), Ops::mul(half_x_y, y), Ops::splat(1.5f)));
+            }
+
+            /*!
+             * Computes the sine and the cosine with the reduction and the polynomials of Cephes.
+             */
+            static inline void sincos(reg x, reg& sine, reg& cosine) {
+                ireg sign = sign_of(x);
+                x = abs(x);
+
+                // The octant, rounded up to even: x = j * pi / 4 + r with |r| <= pi / 4.
+                ireg j = Ops::truncate_to_int(Ops::mul(x, Ops::splat(1.27323954473516f)));
+                j = Ops::iand(Ops::iadd(j, Ops::isplat(1)), Ops::isplat(~1u));
+                reg y = Ops::to_float(j);
+                // pi / 4 in three parts (Cody-Waite), so j * part is exact.
+                x = Ops::fmadd(y, Ops::splat(-0.78515625f), x);
+                x = Ops::fmadd(y, Ops::splat(-2.4187564849853515625e-4f), x);
+                x = Ops::fmadd(y, Ops::splat(-3.77489497744594108e-8f), x);
+
+                auto sine_polynomial = Ops::is_zero(Ops::iand(j, Ops::isplat(2)));
+                ireg sine_sign = Ops::ixor(sign, Ops::template shl<29>(Ops::iand(j, Ops::isplat(4))));
+                ireg cosine_sign = Ops::template shl<29>(Ops::iand(Ops::ixor(Ops::isub(j, Ops::isplat(2)), Ops::isplat(4)), Ops::isplat(4)));
+
+                reg z = Ops::mul(x, x);
+                reg c = Ops::fmadd(Ops::fmadd(Ops::splat(2.443315711809948e-5f), z, Ops::splat(-1.388731625493765e-3f)), z,
+                                   Ops::splat(4.166664568298827e-2f));
+                c = Ops::fmadd(c, Ops::mul(z, z), Ops::fmadd(z, Ops::splat(-0.5f), Ops::splat(1.f)));
+                reg s = Ops::fmadd(Ops::fmadd(Ops::splat(-1.9515295891e-4f), z, Ops::splat(8.3321608736e-3f)), z, Ops::splat(-1.6666654611e-1f));
+                s = Ops::fmadd(Ops::mul(s, z), x, x);
+
+                sine = flip_sign(Ops::select(sine_polynomial, s, c), sine_sign);
+                cosine = flip_sign(Ops::select(sine_polynomial, c, s), cosine_sign);
+            }
+
+            static inline reg sin(reg x) {
+                reg sine, cosine;
+                sincos(x, sine, cosine);
+                return sine;
+            }
+
+            static inline reg cos(reg x) {
+                reg sine, cosine;
+                sincos(x, sine, cosine);
+                return cosine;
+            }
+
+            static inline reg atan2(reg y, reg x) {
+                reg ax = abs(x), ay = abs(y);
+                // atan(min / max) is in [0, pi / 4], the octant is restored afterwards.
+                reg t = Ops::div(Ops::min(ax, ay), Ops::max(ax, ay));
+                t = Ops::select(Ops::equal(Ops::max(ax, ay), Ops::splat(0.f)), Ops::splat(0.f), t);
+                auto above = Ops::less(Ops::splat(0.4142135623730950f), t);
+                t = Ops::select(above, Ops::div(Ops::sub(t, Ops::splat(1.f)), Ops::add(t, Ops::splat(1.f))), t);
+
+                reg z = Ops::mul(t, t);
+                reg p = Ops::fmadd(Ops::fmadd(Ops::splat(8.05374449538e-2f), z, Ops::splat(-1.38776856032e-1f)), z, Ops::splat(1.99777106478e-1f));
+                p = Ops::fmadd(p, z, Ops::splat(-3.33329491539e-1f));
+                reg a = Ops::add(Ops::fmadd(Ops::mul(p, z), t, t), Ops::select(above, Ops::splat(QUARTER_PI), Ops::splat(0.f)));
+
+                a = Ops::select(Ops::less(ax, ay), Ops::sub(Ops::splat(HALF_PI), a), a);
+                a = Ops::select(Ops::is_zero(sign_of(x)), a, Ops::sub(Ops::splat(PI), a));
+                return flip_sign(a, sign_of(y));
+            }
+
+            static inline reg exp(reg x) {
+                reg clamped = Ops::min(Ops::max(x, Ops::splat(-103.972084f)), Ops::splat(88.7228394f));
+                // x = n * ln(2) + r with |r| <= ln(2) / 2, ln(2) in two parts.
+                ireg n = Ops::round_to_int(Ops::mul(clamped, Ops::splat(1.44269504088896341f)));
+                reg nf = Ops::to_float(n);
+                reg r = Ops::fmadd(nf, Ops::splat(-0.693359375f), clamped);
+                r = Ops::fmadd(nf, Ops::splat(2.12194440e-4f), r);
+
+                reg p = Ops::fmadd(Ops::splat(1.9875691500e-4f), r, Ops::splat(1.3981999507e-3f));
+                p = Ops::fmadd(p, r, Ops::splat(8.3334519073e-3f));
+                p = Ops::fmadd(p, r, Ops::splat(4.1665795894e-2f));
+                p = Ops::fmadd(p, r, Ops::splat(1.6666665459e-1f));
+                p = Ops::fmadd(p, r, Ops::splat(5.0000001201e-1f));
+                p = Ops::fmadd(p, Ops::mul(r, r), Ops::add(r, Ops::splat(1.f)));
+
+                // 2^n in two factors: n reaches 128 for the largest results and -150 for the smallest subnormals.
+                ireg half = Ops::truncate_to_int(Ops::mul(nf, Ops::splat(0.5f)));
+                reg result = Ops::mul(Ops::mul(p, pow2(half)), pow2(Ops::isub(n, half)));
+                result = Ops::select(Ops::less(Ops::splat(88.7228394f), x), Ops::splat(std::numeric_limits<f32>::infinity()), result);
+                result = Ops::select(Ops::less(x, Ops::splat(-103.972084f)), Ops::splat(0.f), result);
+                return Ops::select(Ops::equal(x, x), result, x);
+            }
+
+            static inline reg log(reg x) {
+                // Subnormals are scaled by 2^23 first.
+                auto subnormal = Ops::less(x, Ops::splat(std::numeric_limits<f32>::min()));
+                reg scaled = Ops::select(subnormal, Ops::mul(x, Ops::splat(8388608.f)), x);
+
+                // x = m * 2^e with m in [0.5, 1).
+                ireg bits = Ops::as_int(scaled);
+                reg e = Ops::to_float(Ops::isub(Ops::template shr<23>(bits), Ops::isplat(126)));
+                e = Ops::select(subnormal, Ops::sub(e, Ops::splat(23.f)), e);
+                reg m = Ops::as_float(Ops::ior(Ops::iand(bits, Ops::isplat(0x007FFFFFu)), Ops::isplat(0x3F000000u)));
+                // Keep m - 1 in [sqrt(1/2) - 1, sqrt(2) - 1].
+                auto small = Ops::less(m, Ops::splat(0.707106781186547524f));
+                e = Ops::select(small, Ops::sub(e, Ops::splat(1.f)), e);
+                m = Ops::sub(Ops::select(small, Ops::add(m, m), m), Ops::splat(1.f));
+
+                reg z = Ops::mul(m, m);
+                reg p = Ops::fmadd(Ops::splat(7.0376836292e-2f), m, Ops::splat(-1.1514610310e-1f));
+                p = Ops::fmadd(p, m, Ops::splat(1.1676998740e-1f));
+                p = Ops::fmadd(p, m, Ops::splat(-1.2420140846e-1f));
+                p = Ops::fmadd(p, m, Ops::splat(1.4249322787e-1f));
+                p = Ops::fmadd(p, m, Ops::splat(-1.6668057665e-1f));
+                p = Ops::fmadd(p, m, Ops::splat(2.0000714765e-1f));
+                p = Ops::fmadd(p, m, Ops::splat(-2.4999993993e-1f));
+                p = Ops::fmadd(p, m, Ops::splat(3.3333331174e-1f));
+                p = Ops::mul(Ops::mul(p, m), z);
+                p = Ops::fmadd(e, Ops::splat(-2.12194440e-4f), p);
+                p = Ops::fmadd(z, Ops::splat(-0.5f), p);
+                reg result = Ops::fmadd(e, Ops::splat(0.693359375f), Ops::add(m, p));
+
+                result = Ops::select(Ops::less(x, Ops::splat(0.f)), Ops::splat(std::numeric_limits<f32>::quiet_NaN()), result);
+                result = Ops::select(Ops::equal(x, Ops::splat(0.f)), Ops::splat(-std::numeric_limits<f32>::infinity()), result);
+                result = Ops::select(Ops::equal(x, Ops::splat(std::numeric_limits<f32>::infinity())), x, result);
+                return Ops::select(Ops::equal(x, x), result, x);
+            }
+        };
+
+        typedef algorithms<scalar_ops> scalar;
+    }
+
+    /*!
+     * Approximates 1 / sqrt(x) with a hardware estimate refined by a Newton-Raphson step.
+     * Maximum error: 5 ULP for positive normal x. The result for 0 and infinity is not specified.
+     */
+    inline f32 rsqrt(f32 x) {
+        return internal::scalar::rsqrt(x);
+    }
+
+    /*!
+     * Computes the square root, correctly rounded: the hardware instruction is already the fastest way.
+     */
+    inline f32 sqrt(f32 x) {
+        return std::sqrt(x);
+    }
+
+    /*!
+     * Approximates the sine and the cosine of an angle.
+     * Maximum error: 2 ULP for |x| <= pi away from the zeros, and an absolute error of 1e-7 for |x| <= 8192.
+     * The precision drops for larger angles.
+     * @param x The angle in radians.
+     * @param sine The sine.
+     * @param cosine The cosine.
+     */
+    inline void sincos(f32 x, f32& sine, f32& cosine) {
+        internal::scalar::sincos(x, sine, cosine);
+    }
+
+    /*!
+     * Approximates the sine of an angle with the error bounds of sincos.
+     */
+    inline f32 sin(f32 x) {
+        return internal::scalar::sin(x);
+    }
+
+    /*!
+     * Approximates the cosine of an angle with the error bounds of sincos.
+     */
+    inline f32 cos(f32 x) {
+        return internal::scalar::cos(x);
+    }
+
+    /*!
+     * Approximates the angle of the point (x, y), in [-pi, pi].
+     * Maximum error: 4 ULP. Signed zeros are handled like std::atan2, infinite coordinates are not.
+     */
+    inline f32 atan2(f32 y, f32 x) {
+        return internal::scalar::atan2(y, x);
+    }
+
+    /*!
+     * Approximates e^x.
+     * Maximum error: 2 ULP, the result is infinity above 88.72 and 0 below -103.97.
+     */
+    inline f32 exp(f32 x) {
+        return internal::scalar::exp(x);
+    }
+
+    /*!
+     * Approximates the natural logarithm.
+     * Maximum error: 1 ULP, including subnormal x. log(0) is -infinity and the logarithm of a negative number is NaN.
+     */
+    inline f32 log(f32 x) {
+        return internal::scalar::log(x);
+    }
+
+    /*
+     * Batch kernels: each one processes count values, the output may be the input.
+     * They dispatch at runtime to the instruction set returned by get_simd_level() (see soa.h), with the error bounds of
+     * the scalar functions.
+     */
+
+    extern void LAMBDACOMMON_API rsqrt(const f32* in, f32* out, size_t count);
+
+    extern void LAMBDACOMMON_API sqrt(const f32* in, f32* out, size_t count);
+
+    extern void LAMBDACOMMON_API sin(const f32* in, f32* out, size_t count);
+
+    extern void LAMBDACOMMON_API cos(const f32* in, f32* out, size_t count);
+
+    extern void LAMBDACOMMON_API sincos(const f32* in, f32* sine, f32* cosine, size_t count);
+
+    extern void LAMBDACOMMON_API atan2(const f32* y, const f32* x, f32* out, size_t count);
+
+    extern void LAMBDACOMMON_API exp(const f32* in, f32* out, size_t count);
+
+    extern void LAMBDACOMMON_API log(const f32* in, f32* out, size_t count);
+}
+
+#endif //LAMBDACOMMON_FAST_H
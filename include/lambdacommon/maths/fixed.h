@@ -0,0 +1,428 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_FIXED_H
+#define LAMBDACOMMON_FIXED_H
+
+#include "tables.h"
+#include <string>
+
+/*
+ * fixed.h
+ *
+ * Fixed point numbers: integer arithmetic gives the same results to the bit on every machine and compiler, as needed by
+ * lockstep simulations, where floating point results depend on the instructions the compiler chose.
+ */
+
+namespace lambdacommon::maths
+{
+    /*!
+     * The behavior of the fixed point operations whose result is out of the range of the type.
+     */
+    enum class overflow : u8
+    {
+        /*! The result wraps around like unsigned integers, the fastest. */
+        wrap,
+        /*! The result is clamped to the range of the type. */
+        saturate
+    };
+
+    namespace internal
+    {
+        template<u32 Bits>
+        using fixed_storage = std::conditional_t<(Bits <= 8), i8, std::conditional_t<(Bits <= 16), i16, i32>>;
+
+        /*!
+         * The first quarter of the sine wave in 1024 steps in Q2.30, with one more entry for the interpolation.
+         */
+        inline constexpr auto FIXED_SINE_TABLE = make_table<i32, 1026>([](size_t i) {
+            return compile_time::sin(compile_time::PI / 2.0 * static_cast<f64>(std::min<size_t>(i, 1024)) / 1024.0) * 1073741824.0 + 0.5;
+        });
+
+        /*!
+         * The square roots of the integers below 512 in Q.8, the first guess of fixed_isqrt.
+         */
+        inline constexpr auto FIXED_SQRT_TABLE = make_table<u16, 512>([](size_t i) {
+            return compile_time::sqrt(static_cast<f64>(i)) * 256.0 + 0.5;
+        });
+
+        /*!
+         * Gets the square root of an integer below 2^62 rounded down: a guess from a table refined by Newton's method.
+         */
+        constexpr u64 fixed_isqrt(u64 value) {
+            if (value < 2)
+                return value;
+            u32 log = ilog2(value);
+            u32 shift = log >= 8 ? (log - 7) & ~1u : 0;
+            u64 root = (static_cast<u64>(FIXED_SQRT_TABLE[value >> shift]) << (shift / 2)) >> 8u;
+            // The guess is good to 8 bits, each step doubles them.
+            for (int i = 0; i < 3; i++)
+                root = (root + value / root) / 2;
+            while (root * root > value)
+                root--;
+            while ((root + 1) * (root + 1) <= value)
+                root++;
+            return root;
+        }
+
+        /*!
+         * Gets the sine of an angle given in turns in Q0.32, in Q2.30, interpolated linearly in the table.
+         */
+        constexpr i32 fixed_sine(u32 phase) {
+            u32 quadrant = phase >> 30u;
+            u32 position = phase & 0x3FFFFFFFu;
+            if (quadrant & 1u)
+                position = 0x40000000u - position;
+            u32 index = position >> 20u, fraction = position & 0xFFFFFu;
+            i64 a = FIXED_SINE_TABLE[index], b = FIXED_SINE_TABLE[index + 1];
+            auto value = static_cast<i32>(a + (((b - a) * fraction + (1 << 19)) >> 20u));
+            return quadrant & 2u ? -value : value;
+        }
+    }
+
+    /*!
+     * Represents a signed fixed point number.
+     * The operations round to nearest like the conversions from floating point numbers, except the division which truncates
+     * toward zero like the integer division.
+     * @tparam IntBits The count of bits of the integer part, the sign bit included.
+     * @tparam FracBits The count of bits of the fraction part.
+     * @tparam Overflow The behavior of the operations when their result is out of range.
+     */
+    template<u32 IntBits, u32 FracBits, overflow Overflow = overflow::wrap>
+    class fixed
+    {
+        static_assert(IntBits >= 1 && IntBits + FracBits <= 32, "fixed requires a sign bit and at most 32 bits.");
+
+    public:
+        typedef internal::fixed_storage<IntBits + FracBits> raw_type;
+
+        static constexpr u32 BITS = IntBits + FracBits;
+        static constexpr u32 FRACTION_BITS = FracBits;
+        static constexpr bool SATURATE = Overflow == overflow::saturate;
+        static constexpr i64 RAW_MIN = -(i64{1} << (BITS - 1));
+        static constexpr i64 RAW_MAX = (i64{1} << (BITS - 1)) - 1;
+        static constexpr i64 ONE = i64{1} << FracBits;
+
+    private:
+        raw_type _raw = 0;
+
+        /*!
+         * Narrows a result computed with a wider integer type according to the overflow behavior.
+         */
+        static constexpr raw_type narrow(i64 value) {
+            if constexpr (SATURATE)
+                return static_cast<raw_type>(value < RAW_MIN ? RAW_MIN : (value > RAW_MAX ? RAW_MAX : value));
+            else
+                // Keeps the low bits and extends their sign.
+                return static_cast<raw_type>(static_cast<i64>(static_cast<u64>(value) << (64 - BITS)) >> (64 - BITS));
+        }
+
+        template<typename I>
+        static constexpr raw_type from_integer(I value) {
+            if constexpr (SATURATE) {
+                if constexpr (std::is_signed_v<I>) {
+                    if (static_cast<i64>(value) < (RAW_MIN >> FracBits))
+                        return static_cast<raw_type>(RAW_MIN);
+                }
+                if (value > 0 && static_cast<u64>(value) > static_cast<u64>(RAW_MAX >> FracBits))
+                    return static_cast<raw_type>(RAW_MAX);
+            }
+            return narrow(static_cast<i64>(static_cast<u64>(value) << FracBits));
+        }
+
+        static constexpr raw_type from_floating(f64 value) {
+            if (value != value)
+                return 0;
+            f64 scaled = value * static_cast<f64>(ONE) + 0.5;
+            // Clamped first, the conversion of a double out of the range of i64 is undefined.
+            scaled = scaled > 0x1p62 ? 0x1p62 : (scaled < -0x1p62 ? -0x1p62 : scaled);
+            auto floor = static_cast<i64>(scaled);
+            if (static_cast<f64>(floor) > scaled)
+                floor--;
+            return narrow(floor);
+        }
+
+    public:
+        constexpr fixed() = default;
+
+        template<typename I, std::enable_if_t<std::is_integral_v<I>, int> = 0>
+        constexpr fixed(I value) : _raw(from_integer(value)) {}
+
+        /*!
+         * Converts a floating point number, rounded to nearest: do it once, at load time, for the results to be
+         * deterministic.
+         */
+        template<typename F, std::enable_if_t<std::is_floating_point_v<F>, int> = 0>
+        constexpr explicit fixed(F value) : _raw(from_floating(static_cast<f64>(value))) {}
+
+        /*!
+         * Creates a fixed point number from its representation.
+         * @param raw The value multiplied by 2^FracBits.
+         * @return The fixed point number.
+         */
+        static constexpr fixed from_raw(raw_type raw) {
+            fixed result;
+            result._raw = raw;
+            return result;
+        }
+
+        constexpr raw_type raw() const {
+            return _raw;
+        }
+
+        template<typename F, std::enable_if_t<std::is_floating_point_v<F>, int> = 0>
+        constexpr explicit operator F() const {
+            return static_cast<F>(_raw) / static_cast<F>(ONE);
+        }
+
+        /*!
+         * Converts to an integer, truncated toward zero.
+         */
+        template<typename I, std::enable_if_t<std::is_integral_v<I>, int> = 0>
+        constexpr explicit operator I() const {
+            return static_cast<I>(_raw / ONE);
+        }
+
+        constexpr fixed operator+() const {
+            return *this;
+        }
+
+        constexpr fixed operator-() const {
+            return from_raw(narrow(-static_cast<i64>(_raw)));
+        }
+
+        friend constexpr fixed operator+(fixed a, fixed b) {
+            return from_raw(narrow(static_cast<i64>(a._raw) + b._raw));
+        }
+
+        friend constexpr fixed operator-(fixed a, fixed b) {
+            return from_raw(narrow(static_cast<i64>(a._raw) - b._raw));
+        }
+
+        friend constexpr fixed operator*(fixed a, fixed b) {
+            i64 product = static_cast<i64>(a._raw) * b._raw;
+            if constexpr (FracBits > 0)
+                product += i64{1} << (FracBits - 1);
+            return from_raw(narrow(product >> FracBits));
+        }
+
+        /*!
+         * Divides two numbers, a division by zero gives the largest or the lowest number according to the sign of the
+         * dividend, or zero.
+         */
+        friend constexpr fixed operator/(fixed a, fixed b) {
+            if (b._raw == 0)
+                return from_raw(static_cast<raw_type>(a._raw < 0 ? RAW_MIN : (a._raw > 0 ? RAW_MAX : 0)));
+            return from_raw(narrow(static_cast<i64>(a._raw) * ONE / b._raw));
+        }
+
+        constexpr fixed& operator+=(fixed other) {
+            return *this = *this + other;
+        }
+
+        constexpr fixed& operator-=(fixed other) {
+            return *this = *this - other;
+        }
+
+        constexpr fixed& operator*=(fixed other) {
+            return *this = *this * other;
+        }
+
+        constexpr fixed& operator/=(fixed other) {
+            return *this = *this / other;
+        }
+
+        friend constexpr bool operator==(fixed a, fixed b) {
+            return a._raw == b._raw;
+        }
+
+        friend constexpr bool operator!=(fixed a, fixed b) {
+            return a._raw != b._raw;
+        }
+
+        friend constexpr bool operator<(fixed a, fixed b) {
+            return a._raw < b._raw;
+        }
+
+        friend constexpr bool operator<=(fixed a, fixed b) {
+            return a._raw <= b._raw;
+        }
+
+        friend constexpr bool operator>(fixed a, fixed b) {
+            return a._raw > b._raw;
+        }
+
+        friend constexpr bool operator>=(fixed a, fixed b) {
+            return a._raw >= b._raw;
+        }
+    };
+
+    /*! Q16.16, the usual type for positions. */
+    typedef fixed<16, 16> fixed32;
+    typedef fixed<16, 16, overflow::saturate> fixed32_saturate;
+    /*! Q8.8. */
+    typedef fixed<8, 8> fixed16;
+
+    template<u32 I, u32 F, overflow O>
+    constexpr fixed<I, F, O> floor(fixed<I, F, O> number) {
+        typedef typename fixed<I, F, O>::raw_type raw_type;
+        return fixed<I, F, O>::from_raw(static_cast<raw_type>(number.raw() & ~static_cast<raw_type>(fixed<I, F, O>::ONE - 1)));
+    }
+
+    /*!
+     * Gets the square root of a fixed point number, rounded down.
+     * @return The square root, 0 for negative numbers.
+     */
+    template<u32 I, u32 F, overflow O>
+    constexpr fixed<I, F, O> sqrt(fixed<I, F, O> number) {
+        typedef fixed<I, F, O> type;
+        if (number.raw() <= 0)
+            return type{};
+        // sqrt(raw / 2^F) * 2^F = sqrt(raw * 2^F).
+        auto root = static_cast<i64>(internal::fixed_isqrt(static_cast<u64>(number.raw()) << F));
+        return type::from_raw(static_cast<typename type::raw_type>(root > type::RAW_MAX ? type::RAW_MAX : root));
+    }
+
+    namespace internal
+    {
+        /*!
+         * Converts an angle in radians in Q.F to turns in Q0.32: only the low 64 bits of the product are needed.
+         */
+        template<u32 F>
+        constexpr u32 fixed_phase(i64 raw) {
+            constexpr auto TURNS = static_cast<u64>(static_cast<f64>(u64{1} << (63 - F)) / compile_time::PI + 0.5);
+            return static_cast<u32>((static_cast<u64>(raw) * TURNS) >> 32u);
+        }
+
+        template<typename Fixed>
+        constexpr Fixed fixed_from_q30(i32 value) {
+            constexpr u32 F = Fixed::FRACTION_BITS;
+            i64 raw;
+            if constexpr (F >= 30)
+                raw = static_cast<i64>(value) << (F - 30);
+            else
+                raw = (static_cast<i64>(value) + (i64{1} << (29 - F))) >> (30 - F);
+            return Fixed::from_raw(static_cast<typename Fixed::raw_type>(raw > Fixed::RAW_MAX ? Fixed::RAW_MAX : raw));
+        }
+    }
+
+    /*!
+     * Gets the sine of an angle in radians, interpolated in a table.
+     * The error of fixed32 is below 3e-5 over [-10, 10], most of it is the rounding to its 16 fraction bits.
+     */
+    template<u32 I, u32 F, overflow O>
+    constexpr fixed<I, F, O> sin(fixed<I, F, O> radians) {
+        return internal::fixed_from_q30<fixed<I, F, O>>(internal::fixed_sine(internal::fixed_phase<F>(radians.raw())));
+    }
+
+    template<u32 I, u32 F, overflow O>
+    constexpr fixed<I, F, O> cos(fixed<I, F, O> radians) {
+        return internal::fixed_from_q30<fixed<I, F, O>>(internal::fixed_sine(internal::fixed_phase<F>(radians.raw()) + 0x40000000u));
+    }
+
+    template<u32 I, u32 F, overflow O>
+    std::string to_string(fixed<I, F, O> number) {
+        return std::to_string(static_cast<f64>(number));
+    }
+
+    /*
+     * Batch operations on arrays of fixed point numbers: the types of 32 bits use the integer instructions of the
+     * instruction set returned by get_simd_level(), with the same results as the scalar operators.
+     */
+
+    namespace internal
+    {
+        extern void LAMBDACOMMON_API fixed_add(const i32* a, const i32* b, i32* out, size_t count, bool saturate);
+
+        extern void LAMBDACOMMON_API fixed_sub(const i32* a, const i32* b, i32* out, size_t count, bool saturate);
+
+        extern void LAMBDACOMMON_API fixed_multiply(const i32* a, const i32* b, i32* out, size_t count, u32 frac_bits, bool saturate);
+
+        template<u32 I, u32 F>
+        constexpr bool has_fixed_kernels = I + F == 32 && F > 0;
+    }
+
+    template<u32 I, u32 F, overflow O>
+    void add(const fixed<I, F, O>* a, const fixed<I, F, O>* b, fixed<I, F, O>* out, size_t count) {
+        if constexpr (internal::has_fixed_kernels<I, F>)
+            internal::fixed_add(reinterpret_cast<const i32*>(a), reinterpret_cast<const i32*>(b), reinterpret_cast<i32*>(out), count,
+                                O == overflow::saturate);
+        else
+            for (size_t i = 0; i < count; i++)
+                out[i] = a[i] + b[i];
+    }
+
+    template<u32 I, u32 F, overflow O>
+    void sub(const fixed<I, F, O>* a, const fixed<I, F, O>* b, fixed<I, F, O>* out, size_t count) {
+        if constexpr (internal::has_fixed_kernels<I, F>)
+            internal::fixed_sub(reinterpret_cast<const i32*>(a), reinterpret_cast<const i32*>(b), reinterpret_cast<i32*>(out), count,
+                                O == overflow::saturate);
+        else
+            for (size_t i = 0; i < count; i++)
+                out[i] = a[i] - b[i];
+    }
+
+    template<u32 I, u32 F, overflow O>
+    void multiply(const fixed<I, F, O>* a, const fixed<I, F, O>* b, fixed<I, F, O>* out, size_t count) {
+        if constexpr (internal::has_fixed_kernels<I, F>)
+            internal::fixed_multiply(reinterpret_cast<const i32*>(a), reinterpret_cast<const i32*>(b), reinterpret_cast<i32*>(out), count, F,
+                                     O == overflow::saturate);
+        else
+            for (size_t i = 0; i < count; i++)
+                out[i] = a[i] * b[i];
+    }
+}
+
+namespace std
+{
+    template<lambdacommon::u32 I, lambdacommon::u32 F, lambdacommon::maths::overflow O>
+    class numeric_limits<lambdacommon::maths::fixed<I, F, O>>
+    {
+        typedef lambdacommon::maths::fixed<I, F, O> type;
+
+    public:
+        static constexpr bool is_specialized = true;
+        static constexpr bool is_signed = true;
+        static constexpr bool is_integer = false;
+        static constexpr bool is_exact = true;
+        static constexpr bool has_infinity = false;
+        static constexpr bool has_quiet_NaN = false;
+        static constexpr bool has_signaling_NaN = false;
+        static constexpr bool is_bounded = true;
+        static constexpr bool is_modulo = O == lambdacommon::maths::overflow::wrap;
+        static constexpr int radix = 2;
+        static constexpr int digits = static_cast<int>(I + F - 1);
+
+        static constexpr type min() {
+            return lowest();
+        }
+
+        static constexpr type lowest() {
+            return type::from_raw(static_cast<typename type::raw_type>(type::RAW_MIN));
+        }
+
+        static constexpr type max() {
+            return type::from_raw(static_cast<typename type::raw_type>(type::RAW_MAX));
+        }
+
+        static constexpr type epsilon() {
+            return type::from_raw(1);
+        }
+
+        static constexpr type infinity() {
+            return type{};
+        }
+
+        static constexpr type quiet_NaN() {
+            return type{};
+        }
+    };
+}
+
+#endif //LAMBDACOMMON_FIXED_H
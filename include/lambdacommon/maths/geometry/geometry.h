@@ -11,6 +11,8 @@
 #define LAMBDACOMMON_GEOMETRY_H
 
 #include "vector.h"
+#include "vec.h"
+#include "transform.h"
 
 namespace lambdacommon
 {
@@ -52,7 +52,9 @@ namespace lambdacommon
         }
 
         std::string to_string() const override {
-            return std::move("{\"x\":" + std::to_string(_x) + '}');
+            // The other numeric types, like maths::fixed, have their to_string found by argument-dependent lookup.
+            using std::to_string;
+            return std::move("{\"x\":" + to_string(_x) + '}');
         }
 
         bool operator==(const Point1D<T>& other) const {
@@ -103,7 +105,8 @@ namespace lambdacommon
         }
 
         std::string to_string() const override {
-            return std::move("{\"x\":" + std::to_string(this->_x) + ",\"y\":" + std::to_string(this->_y) + '}');
+            using std::to_string;
+            return std::move("{\"x\":" + to_string(this->_x) + ",\"y\":" + to_string(this->_y) + '}');
         }
 
         bool operator==(const Point2D<T>& other) const {
@@ -155,7 +158,8 @@ namespace lambdacommon
         }
 
         std::string to_string() const override {
-            return std::move("{\"x\":" + std::to_string(this->_x) + ",\"y\":" + std::to_string(this->_y) + ",\"z\":" + std::to_string(this->_z) + '}');
+            using std::to_string;
+            return std::move("{\"x\":" + to_string(this->_x) + ",\"y\":" + to_string(this->_y) + ",\"z\":" + to_string(this->_z) + '}');
         }
 
         bool operator==(const Point3D<T>& other) const {
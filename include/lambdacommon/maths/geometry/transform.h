@@ -0,0 +1,708 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_TRANSFORM_H
+#define LAMBDACOMMON_TRANSFORM_H
+
+#include "vec.h"
+
+/*
+ * transform.h
+ *
+ * Matrices and quaternions for the transforms of a scene, value types like vec.
+ * Matrices are stored column by column and multiply column vectors: `a * b` applies b then a.
+ * The operations of mat4<float> use SSE2 or NEON when the build targets them.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LAMBDACOMMON_TRANSFORM_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#  define LAMBDACOMMON_TRANSFORM_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace lambdacommon
+{
+    namespace internal
+    {
+        /*
+         * The 4x4 single precision operations, over 16 floats stored column by column.
+         * The output may be one of the inputs.
+         */
+
+        inline void mat4_multiply(const f32* a, const f32* b, f32* out) {
+#if defined(LAMBDACOMMON_TRANSFORM_SSE2)
+            __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+            for (size_t column = 0; column < 16; column += 4) {
+                __m128 c = _mm_loadu_ps(b + column);
+                __m128 result = _mm_mul_ps(a0, _mm_shuffle_ps(c, c, 0x00));
+                result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_shuffle_ps(c, c, 0x55)));
+                result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_shuffle_ps(c, c, 0xAA)));
+                result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_shuffle_ps(c, c, 0xFF)));
+                _mm_storeu_ps(out + column, result);
+            }
+#elif defined(LAMBDACOMMON_TRANSFORM_NEON)
+            float32x4_t a0 = vld1q_f32(a), a1 = vld1q_f32(a + 4), a2 = vld1q_f32(a + 8), a3 = vld1q_f32(a + 12);
+            for (size_t column = 0; column < 16; column += 4) {
+                float32x4_t c = vld1q_f32(b + column);
+                float32x4_t result = vmulq_laneq_f32(a0, c, 0);
+                result = vfmaq_laneq_f32(result, a1, c, 1);
+                result = vfmaq_laneq_f32(result, a2, c, 2);
+                result = vfmaq_laneq_f32(result, a3, c, 3);
+                vst1q_f32(out + column, result);
+            }
+#else
+            f32 result[16];
+            for (size_t column = 0; column < 4; column++)
+                for (size_t row = 0; row < 4; row++)
+                    result[column * 4 + row] = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1] + a[8 + row] * b[column * 4 + 2] +
+                                               a[12 + row] * b[column * 4 + 3];
+            for (size_t i = 0; i < 16; i++)
+                out[i] = result[i];
+#endif
+        }
+
+        /*!
+         * Transforms a 4D vector: m[0..3] * v.x + m[4..7] * v.y + m[8..11] * v.z + m[12..15] * v.w.
+         */
+        inline void mat4_transform(const f32* m, const f32* v, f32* out) {
+#if defined(LAMBDACOMMON_TRANSFORM_SSE2)
+            __m128 result = _mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(v[0]));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(v[1])));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(v[2])));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(m + 12), _mm_set1_ps(v[3])));
+            _mm_storeu_ps(out, result);
+#elif defined(LAMBDACOMMON_TRANSFORM_NEON)
+            float32x4_t c = vld1q_f32(v);
+            float32x4_t result = vmulq_laneq_f32(vld1q_f32(m), c, 0);
+            result = vfmaq_laneq_f32(result, vld1q_f32(m + 4), c, 1);
+            result = vfmaq_laneq_f32(result, vld1q_f32(m + 8), c, 2);
+            result = vfmaq_laneq_f32(result, vld1q_f32(m + 12), c, 3);
+            vst1q_f32(out, result);
+#else
+            f32 result[4];
+            for (size_t row = 0; row < 4; row++)
+                result[row] = m[row] * v[0] + m[4 + row] * v[1] + m[8 + row] * v[2] + m[12 + row] * v[3];
+            for (size_t i = 0; i < 4; i++)
+                out[i] = result[i];
+#endif
+        }
+
+        inline void mat4_transpose(const f32* m, f32* out) {
+#if defined(LAMBDACOMMON_TRANSFORM_SSE2)
+            __m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _mm_storeu_ps(out, c0);
+            _mm_storeu_ps(out + 4, c1);
+            _mm_storeu_ps(out + 8, c2);
+            _mm_storeu_ps(out + 12, c3);
+#elif defined(LAMBDACOMMON_TRANSFORM_NEON)
+            // The de-interleaving load is a transposition.
+            float32x4x4_t rows = vld4q_f32(m);
+            vst1q_f32(out, rows.val[0]);
+            vst1q_f32(out + 4, rows.val[1]);
+            vst1q_f32(out + 8, rows.val[2]);
+            vst1q_f32(out + 12, rows.val[3]);
+#else
+            f32 result[16];
+            for (size_t column = 0; column < 4; column++)
+                for (size_t row = 0; row < 4; row++)
+                    result[row * 4 + column] = m[column * 4 + row];
+            for (size_t i = 0; i < 16; i++)
+                out[i] = result[i];
+#endif
+        }
+
+        /*!
+         * Inverts a 4x4 matrix with the 2x2 sub-matrices (Schur complement) method, which works on rows and columns alike
+         * since the inverse of the transpose is the transpose of the inverse.
+         * @tparam T The type of the elements.
+         */
+        template<typename T>
+        inline void mat4_inverse_scalar(const T* m, T* out) {
+            T a00 = m[0], a01 = m[1], a02 = m[2], a03 = m[3];
+            T a10 = m[4], a11 = m[5], a12 = m[6], a13 = m[7];
+            T a20 = m[8], a21 = m[9], a22 = m[10], a23 = m[11];
+            T a30 = m[12], a31 = m[13], a32 = m[14], a33 = m[15];
+
+            T s0 = a00 * a11 - a10 * a01, s1 = a00 * a12 - a10 * a02, s2 = a00 * a13 - a10 * a03;
+            T s3 = a01 * a12 - a11 * a02, s4 = a01 * a13 - a11 * a03, s5 = a02 * a13 - a12 * a03;
+            T c5 = a22 * a33 - a32 * a23, c4 = a21 * a33 - a31 * a23, c3 = a21 * a32 - a31 * a22;
+            T c2 = a20 * a33 - a30 * a23, c1 = a20 * a32 - a30 * a22, c0 = a20 * a31 - a30 * a21;
+            T inv = T(1) / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+            out[0] = (a11 * c5 - a12 * c4 + a13 * c3) * inv;
+            out[1] = (-a01 * c5 + a02 * c4 - a03 * c3) * inv;
+            out[2] = (a31 * s5 - a32 * s4 + a33 * s3) * inv;
+            out[3] = (-a21 * s5 + a22 * s4 - a23 * s3) * inv;
+            out[4] = (-a10 * c5 + a12 * c2 - a13 * c1) * inv;
+            out[5] = (a00 * c5 - a02 * c2 + a03 * c1) * inv;
+            out[6] = (-a30 * s5 + a32 * s2 - a33 * s1) * inv;
+            out[7] = (a20 * s5 - a22 * s2 + a23 * s1) * inv;
+            out[8] = (a10 * c4 - a11 * c2 + a13 * c0) * inv;
+            out[9] = (-a00 * c4 + a01 * c2 - a03 * c0) * inv;
+            out[10] = (a30 * s4 - a31 * s2 + a33 * s0) * inv;
+            out[11] = (-a20 * s4 + a21 * s2 - a23 * s0) * inv;
+            out[12] = (-a10 * c3 + a11 * c1 - a12 * c0) * inv;
+            out[13] = (a00 * c3 - a01 * c1 + a02 * c0) * inv;
+            out[14] = (-a30 * s3 + a31 * s1 - a32 * s0) * inv;
+            out[15] = (a20 * s3 - a21 * s1 + a22 * s0) * inv;
+        }
+
+#ifdef LAMBDACOMMON_TRANSFORM_SSE2
+#  define LAMBDACOMMON_SWIZZLE(v, x, y, z, w) _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(w, z, y, x)))
+#  define LAMBDACOMMON_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+
+        /*
+         * 2x2 matrices in a register: | v0 v1 |
+         *                             | v2 v3 |
+         */
+
+        inline __m128 mat2_multiply(__m128 a, __m128 b) {
+            return _mm_add_ps(_mm_mul_ps(a, LAMBDACOMMON_SWIZZLE(b, 0, 3, 0, 3)),
+                              _mm_mul_ps(LAMBDACOMMON_SWIZZLE(a, 1, 0, 3, 2), LAMBDACOMMON_SWIZZLE(b, 2, 1, 2, 1)));
+        }
+
+        /*!
+         * Multiplies the adjugate of a by b.
+         */
+        inline __m128 mat2_adjugate_multiply(__m128 a, __m128 b) {
+            return _mm_sub_ps(_mm_mul_ps(LAMBDACOMMON_SWIZZLE(a, 3, 3, 0, 0), b),
+                              _mm_mul_ps(LAMBDACOMMON_SWIZZLE(a, 1, 1, 2, 2), LAMBDACOMMON_SWIZZLE(b, 2, 3, 0, 1)));
+        }
+
+        /*!
+         * Multiplies a by the adjugate of b.
+         */
+        inline __m128 mat2_multiply_adjugate(__m128 a, __m128 b) {
+            return _mm_sub_ps(_mm_mul_ps(a, LAMBDACOMMON_SWIZZLE(b, 3, 0, 3, 0)),
+                              _mm_mul_ps(LAMBDACOMMON_SWIZZLE(a, 1, 0, 3, 2), LAMBDACOMMON_SWIZZLE(b, 2, 1, 2, 1)));
+        }
+#endif
+
+        inline void mat4_inverse(const f32* m, f32* out) {
+#ifdef LAMBDACOMMON_TRANSFORM_SSE2
+            __m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+            // The four 2x2 blocks.
+            __m128 a = _mm_movelh_ps(c0, c1), b = _mm_movehl_ps(c1, c0);
+            __m128 c = _mm_movelh_ps(c2, c3), d = _mm_movehl_ps(c3, c2);
+
+            // The determinants of the blocks: |A| |B| |C| |D|.
+            __m128 determinants = _mm_sub_ps(_mm_mul_ps(LAMBDACOMMON_SHUFFLE(c0, c2, 0, 2, 0, 2), LAMBDACOMMON_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+                                             _mm_mul_ps(LAMBDACOMMON_SHUFFLE(c0, c2, 1, 3, 1, 3), LAMBDACOMMON_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+            __m128 det_a = LAMBDACOMMON_SWIZZLE(determinants, 0, 0, 0, 0), det_b = LAMBDACOMMON_SWIZZLE(determinants, 1, 1, 1, 1);
+            __m128 det_c = LAMBDACOMMON_SWIZZLE(determinants, 2, 2, 2, 2), det_d = LAMBDACOMMON_SWIZZLE(determinants, 3, 3, 3, 3);
+
+            __m128 d_c = mat2_adjugate_multiply(d, c);
+            __m128 a_b = mat2_adjugate_multiply(a, b);
+            __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_multiply(b, d_c));
+            __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2_multiply(c, a_b));
+            __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_multiply_adjugate(d, a_b));
+            __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_multiply_adjugate(a, d_c));
+
+            // |M| = |A| |D| + |B| |C| - tr((A# B) (D# C))
+            __m128 trace = _mm_mul_ps(a_b, LAMBDACOMMON_SWIZZLE(d_c, 0, 2, 1, 3));
+            trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+            trace = _mm_add_ps(trace, LAMBDACOMMON_SWIZZLE(trace, 1, 0, 0, 0));
+            __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), LAMBDACOMMON_SWIZZLE(trace, 0, 0, 0, 0));
+            __m128 inverse_det = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), det);
+
+            x = _mm_mul_ps(x, inverse_det);
+            y = _mm_mul_ps(y, inverse_det);
+            z = _mm_mul_ps(z, inverse_det);
+            w = _mm_mul_ps(w, inverse_det);
+
+            // The adjugates of the blocks, reassembled.
+            _mm_storeu_ps(out, LAMBDACOMMON_SHUFFLE(x, y, 3, 1, 3, 1));
+            _mm_storeu_ps(out + 4, LAMBDACOMMON_SHUFFLE(x, y, 2, 0, 2, 0));
+            _mm_storeu_ps(out + 8, LAMBDACOMMON_SHUFFLE(z, w, 3, 1, 3, 1));
+            _mm_storeu_ps(out + 12, LAMBDACOMMON_SHUFFLE(z, w, 2, 0, 2, 0));
+#else
+            mat4_inverse_scalar(m, out);
+#endif
+        }
+
+#undef LAMBDACOMMON_SWIZZLE
+#undef LAMBDACOMMON_SHUFFLE
+    }
+
+    template<typename T>
+    struct quat;
+
+    /*!
+     * Represents a 3x3 matrix, for rotations and scales without translation.
+     * @tparam T The type of the elements.
+     */
+    template<typename T>
+    struct mat3
+    {
+        static_assert(std::is_floating_point_v<T>, "The elements of a matrix must be floating point numbers.");
+
+        typedef T value_type;
+
+        vec<T, 3> columns[3];
+
+        static constexpr mat3 identity() {
+            return {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}};
+        }
+
+        static constexpr mat3 scale(const vec<T, 3>& factors) {
+            return {{{factors.x, 0, 0}, {0, factors.y, 0}, {0, 0, factors.z}}};
+        }
+
+        /*!
+         * Creates the rotation matrix of a quaternion.
+         * @param rotation The rotation, a unit quaternion.
+         * @return The rotation matrix.
+         */
+        static constexpr mat3 rotation(const quat<T>& rotation);
+
+        constexpr vec<T, 3>& operator[](size_t column) {
+            return columns[column];
+        }
+
+        constexpr const vec<T, 3>& operator[](size_t column) const {
+            return columns[column];
+        }
+
+        constexpr T& operator()(size_t row, size_t column) {
+            return columns[column][row];
+        }
+
+        constexpr const T& operator()(size_t row, size_t column) const {
+            return columns[column][row];
+        }
+
+        std::string to_string() const {
+            return '[' + columns[0].to_string() + ',' + columns[1].to_string() + ',' + columns[2].to_string() + ']';
+        }
+
+        friend constexpr vec<T, 3> operator*(const mat3& m, const vec<T, 3>& v) {
+            return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z;
+        }
+
+        friend constexpr mat3 operator*(const mat3& a, const mat3& b) {
+            return {{a * b.columns[0], a * b.columns[1], a * b.columns[2]}};
+        }
+
+        friend constexpr bool operator==(const mat3& a, const mat3& b) {
+            return a.columns[0] == b.columns[0] && a.columns[1] == b.columns[1] && a.columns[2] == b.columns[2];
+        }
+
+        friend constexpr bool operator!=(const mat3& a, const mat3& b) {
+            return !(a == b);
+        }
+    };
+
+    /*!
+     * Represents a 4x4 matrix, for affine and projective transforms.
+     * @tparam T The type of the elements.
+     */
+    template<typename T>
+    struct mat4
+    {
+        static_assert(std::is_floating_point_v<T>, "The elements of a matrix must be floating point numbers.");
+
+        typedef T value_type;
+
+        vec<T, 4> columns[4];
+
+        static constexpr mat4 identity() {
+            return {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+        }
+
+        static constexpr mat4 translation(const vec<T, 3>& offset) {
+            return {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {offset.x, offset.y, offset.z, 1}}};
+        }
+
+        static constexpr mat4 scale(const vec<T, 3>& factors) {
+            return {{{factors.x, 0, 0, 0}, {0, factors.y, 0, 0}, {0, 0, factors.z, 0}, {0, 0, 0, 1}}};
+        }
+
+        /*!
+         * Creates an affine transform from a 3x3 matrix and a translation.
+         * @param linear The rotation and scale part.
+         * @param offset The translation.
+         * @return The transform.
+         */
+        static constexpr mat4 affine(const mat3<T>& linear, const vec<T, 3>& offset = {}) {
+            return {{{linear[0].x, linear[0].y, linear[0].z, 0}, {linear[1].x, linear[1].y, linear[1].z, 0},
+                     {linear[2].x, linear[2].y, linear[2].z, 0}, {offset.x, offset.y, offset.z, 1}}};
+        }
+
+        static constexpr mat4 rotation(const quat<T>& rotation) {
+            return affine(mat3<T>::rotation(rotation));
+        }
+
+        /*!
+         * Composes a transform which scales, then rotates, then translates, as translation * rotation * scale without the
+         * matrix products.
+         * @param offset The translation.
+         * @param rotation The rotation, a unit quaternion.
+         * @param factors The scale factors.
+         * @return The transform.
+         */
+        static constexpr mat4 compose(const vec<T, 3>& offset, const quat<T>& rotation, const vec<T, 3>& factors) {
+            auto linear = mat3<T>::rotation(rotation);
+            return affine({{linear[0] * factors.x, linear[1] * factors.y, linear[2] * factors.z}}, offset);
+        }
+
+        constexpr vec<T, 4>& operator[](size_t column) {
+            return columns[column];
+        }
+
+        constexpr const vec<T, 4>& operator[](size_t column) const {
+            return columns[column];
+        }
+
+        constexpr T& operator()(size_t row, size_t column) {
+            return columns[column][row];
+        }
+
+        constexpr const T& operator()(size_t row, size_t column) const {
+            return columns[column][row];
+        }
+
+        /*!
+         * Gets the elements, stored column by column.
+         * @return The 16 elements.
+         */
+        inline T* data() {
+            return &columns[0].x;
+        }
+
+        inline const T* data() const {
+            return &columns[0].x;
+        }
+
+        /*!
+         * Gets the upper-left 3x3 matrix: the rotation and scale of an affine transform.
+         * @return The 3x3 matrix.
+         */
+        constexpr mat3<T> to_mat3() const {
+            return {{{columns[0].x, columns[0].y, columns[0].z}, {columns[1].x, columns[1].y, columns[1].z},
+                     {columns[2].x, columns[2].y, columns[2].z}}};
+        }
+
+        /*!
+         * Gets the translation of an affine transform.
+         * @return The translation.
+         */
+        constexpr vec<T, 3> get_translation() const {
+            return {columns[3].x, columns[3].y, columns[3].z};
+        }
+
+        std::string to_string() const {
+            return '[' + columns[0].to_string() + ',' + columns[1].to_string() + ',' + columns[2].to_string() + ',' + columns[3].to_string() + ']';
+        }
+
+        friend inline vec<T, 4> operator*(const mat4& m, const vec<T, 4>& v) {
+            if constexpr (std::is_same_v<T, f32>) {
+                vec<T, 4> result;
+                internal::mat4_transform(m.data(), &v.x, &result.x);
+                return result;
+            } else
+                return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z + m.columns[3] * v.w;
+        }
+
+        friend inline mat4 operator*(const mat4& a, const mat4& b) {
+            mat4 result;
+            if constexpr (std::is_same_v<T, f32>)
+                internal::mat4_multiply(a.data(), b.data(), result.data());
+            else
+                for (size_t i = 0; i < 4; i++)
+                    result.columns[i] = a * b.columns[i];
+            return result;
+        }
+
+        mat4& operator*=(const mat4& other) {
+            return *this = *this * other;
+        }
+
+        friend constexpr bool operator==(const mat4& a, const mat4& b) {
+            return a.columns[0] == b.columns[0] && a.columns[1] == b.columns[1] && a.columns[2] == b.columns[2] && a.columns[3] == b.columns[3];
+        }
+
+        friend constexpr bool operator!=(const mat4& a, const mat4& b) {
+            return !(a == b);
+        }
+    };
+
+    /*!
+     * Represents a rotation as a quaternion: (x, y, z) is the axis scaled by sin(angle / 2) and w is cos(angle / 2).
+     * @tparam T The type of the components.
+     */
+    template<typename T>
+    struct alignas(internal::vec_alignment<T, 4>()) quat
+    {
+        static_assert(std::is_floating_point_v<T>, "The components of a quaternion must be floating point numbers.");
+
+        typedef T value_type;
+
+        T x, y, z, w;
+
+        static constexpr quat identity() {
+            return {0, 0, 0, 1};
+        }
+
+        /*!
+         * Creates the rotation around an axis.
+         * @param axis The axis, a unit vector.
+         * @param angle The angle in radians.
+         * @return The rotation.
+         */
+        static inline quat from_axis_angle(const vec<T, 3>& axis, T angle) {
+            T s = std::sin(angle / 2);
+            return {axis.x * s, axis.y * s, axis.z * s, std::cos(angle / 2)};
+        }
+
+        /*!
+         * Gets the vector part of the quaternion.
+         * @return The vector part.
+         */
+        constexpr vec<T, 3> get_vector() const {
+            return {x, y, z};
+        }
+
+        std::string to_string() const {
+            return '(' + std::to_string(x) + ';' + std::to_string(y) + ';' + std::to_string(z) + ';' + std::to_string(w) + ')';
+        }
+
+        /*!
+         * Multiplies two quaternions, the result rotates by b then by a.
+         */
+        friend constexpr quat operator*(const quat& a, const quat& b) {
+            return {a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                    a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                    a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                    a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+        }
+
+        quat& operator*=(const quat& other) {
+            return *this = *this * other;
+        }
+
+        friend constexpr quat operator+(const quat& a, const quat& b) {
+            return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+        }
+
+        friend constexpr quat operator-(const quat& a, const quat& b) {
+            return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+        }
+
+        friend constexpr quat operator*(const quat& q, T scalar) {
+            return {q.x * scalar, q.y * scalar, q.z * scalar, q.w * scalar};
+        }
+
+        friend constexpr quat operator-(const quat& q) {
+            return {-q.x, -q.y, -q.z, -q.w};
+        }
+
+        friend constexpr bool operator==(const quat& a, const quat& b) {
+            return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+        }
+
+        friend constexpr bool operator!=(const quat& a, const quat& b) {
+            return !(a == b);
+        }
+    };
+
+    typedef mat3<float> mat3f;
+    typedef mat3<double> mat3d;
+    typedef mat4<float> mat4f;
+    typedef mat4<double> mat4d;
+    typedef quat<float> quatf;
+    typedef quat<double> quatd;
+
+    template<typename T>
+    constexpr mat3<T> mat3<T>::rotation(const quat<T>& rotation) {
+        T xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+        T xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+        T wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+        return {{{1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy)},
+                 {2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx)},
+                 {2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy)}}};
+    }
+
+    /*
+     * Matrix operations.
+     */
+
+    template<typename T>
+    constexpr mat3<T> transpose(const mat3<T>& m) {
+        return {{{m[0].x, m[1].x, m[2].x}, {m[0].y, m[1].y, m[2].y}, {m[0].z, m[1].z, m[2].z}}};
+    }
+
+    template<typename T>
+    constexpr T determinant(const mat3<T>& m) {
+        return dot(m[0], cross(m[1], m[2]));
+    }
+
+    /*!
+     * Inverts a 3x3 matrix, the matrix must be invertible.
+     */
+    template<typename T>
+    constexpr mat3<T> inverse(const mat3<T>& m) {
+        // The rows of the inverse are the cross products of the columns divided by the determinant.
+        auto r0 = cross(m[1], m[2]), r1 = cross(m[2], m[0]), r2 = cross(m[0], m[1]);
+        T inverse_det = T(1) / dot(m[0], r0);
+        return transpose(mat3<T>{{r0 * inverse_det, r1 * inverse_det, r2 * inverse_det}});
+    }
+
+    template<typename T>
+    inline mat4<T> transpose(const mat4<T>& m) {
+        mat4<T> result;
+        if constexpr (std::is_same_v<T, f32>)
+            internal::mat4_transpose(m.data(), result.data());
+        else
+            for (size_t column = 0; column < 4; column++)
+                for (size_t row = 0; row < 4; row++)
+                    result(column, row) = m(row, column);
+        return result;
+    }
+
+    template<typename T>
+    constexpr T determinant(const mat4<T>& m) {
+        T s0 = m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0), s1 = m(0, 0) * m(2, 1) - m(0, 1) * m(2, 0);
+        T s2 = m(0, 0) * m(3, 1) - m(0, 1) * m(3, 0), s3 = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+        T s4 = m(1, 0) * m(3, 1) - m(1, 1) * m(3, 0), s5 = m(2, 0) * m(3, 1) - m(2, 1) * m(3, 0);
+        T c5 = m(2, 2) * m(3, 3) - m(2, 3) * m(3, 2), c4 = m(1, 2) * m(3, 3) - m(1, 3) * m(3, 2);
+        T c3 = m(1, 2) * m(2, 3) - m(1, 3) * m(2, 2), c2 = m(0, 2) * m(3, 3) - m(0, 3) * m(3, 2);
+        T c1 = m(0, 2) * m(2, 3) - m(0, 3) * m(2, 2), c0 = m(0, 2) * m(1, 3) - m(0, 3) * m(1, 2);
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    /*!
+     * Inverts a 4x4 matrix, the matrix must be invertible.
+     * affine_inverse is cheaper for affine transforms.
+     */
+    template<typename T>
+    inline mat4<T> inverse(const mat4<T>& m) {
+        mat4<T> result;
+        if constexpr (std::is_same_v<T, f32>)
+            internal::mat4_inverse(m.data(), result.data());
+        else
+            internal::mat4_inverse_scalar(m.data(), result.data());
+        return result;
+    }
+
+    /*!
+     * Inverts an affine transform, whose last row is (0, 0, 0, 1).
+     */
+    template<typename T>
+    constexpr mat4<T> affine_inverse(const mat4<T>& m) {
+        auto linear = inverse(m.to_mat3());
+        return mat4<T>::affine(linear, -(linear * m.get_translation()));
+    }
+
+    /*!
+     * Transforms a point, applying the translation.
+     * The matrix must be affine, projections need the division by w of `m * vec4`.
+     */
+    template<typename T>
+    inline point<T, 3> transform_point(const mat4<T>& m, const point<T, 3>& p) {
+        auto result = m * vec<T, 4>{p.x, p.y, p.z, 1};
+        return {result.x, result.y, result.z};
+    }
+
+    /*!
+     * Transforms a direction, ignoring the translation.
+     */
+    template<typename T>
+    inline vec<T, 3> transform_vector(const mat4<T>& m, const vec<T, 3>& v) {
+        auto result = m * vec<T, 4>{v.x, v.y, v.z, 0};
+        return {result.x, result.y, result.z};
+    }
+
+    template<typename T>
+    inline Point3D<T> transform_point(const mat4<T>& m, const Point3D<T>& p) {
+        return to_point3d(transform_point(m, to_point(p)));
+    }
+
+    template<typename T>
+    inline Vector3D<T> transform_vector(const mat4<T>& m, const Vector3D<T>& v) {
+        return to_vector3d(transform_vector(m, to_vec(v)));
+    }
+
+    /*
+     * Quaternion operations.
+     */
+
+    template<typename T>
+    constexpr T dot(const quat<T>& a, const quat<T>& b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    }
+
+    template<typename T>
+    inline T length(const quat<T>& q) {
+        return std::sqrt(dot(q, q));
+    }
+
+    template<typename T>
+    inline quat<T> normalize(const quat<T>& q) {
+        return q * (T(1) / length(q));
+    }
+
+    template<typename T>
+    constexpr quat<T> conjugate(const quat<T>& q) {
+        return {-q.x, -q.y, -q.z, q.w};
+    }
+
+    /*!
+     * Inverts a quaternion, the conjugate is enough for unit quaternions.
+     */
+    template<typename T>
+    constexpr quat<T> inverse(const quat<T>& q) {
+        return conjugate(q) * (T(1) / dot(q, q));
+    }
+
+    /*!
+     * Rotates a vector by a unit quaternion.
+     */
+    template<typename T>
+    constexpr vec<T, 3> rotate(const quat<T>& q, const vec<T, 3>& v) {
+        auto axis = q.get_vector();
+        auto t = cross(axis, v) * T(2);
+        return v + t * q.w + cross(axis, t);
+    }
+
+    template<typename T>
+    inline Vector3D<T> rotate(const quat<T>& q, const Vector3D<T>& v) {
+        return to_vector3d(rotate(q, to_vec(v)));
+    }
+
+    /*!
+     * Interpolates two rotations along the shortest arc at constant angular speed.
+     * @param a The rotation at 0, a unit quaternion.
+     * @param b The rotation at 1, a unit quaternion.
+     * @param t The interpolation factor.
+     * @return The interpolated rotation.
+     */
+    template<typename T>
+    inline quat<T> slerp(const quat<T>& a, quat<T> b, T t) {
+        T cosine = dot(a, b);
+        // q and -q are the same rotation, take the shortest arc.
+        if (cosine < 0) {
+            b = -b;
+            cosine = -cosine;
+        }
+        // Nearly parallel: sin(angle) vanishes, a normalized linear interpolation is as accurate.
+        if (cosine > T(0.9995))
+            return normalize(a + (b - a) * t);
+        T angle = std::acos(cosine);
+        T sine = std::sqrt(1 - cosine * cosine);
+        return a * (std::sin((1 - t) * angle) / sine) + b * (std::sin(t * angle) / sine);
+    }
+
+    static_assert(std::is_trivially_copyable_v<mat4f> && std::is_standard_layout_v<mat4f> && std::is_aggregate_v<mat4f>);
+    static_assert(sizeof(mat4f) == 64 && alignof(mat4f) == 16 && sizeof(mat3f) == 36 && sizeof(quatf) == 16);
+}
+
+#endif //LAMBDACOMMON_TRANSFORM_H
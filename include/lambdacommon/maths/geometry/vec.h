@@ -0,0 +1,514 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_VEC_H
+#define LAMBDACOMMON_VEC_H
+
+#include "vector.h"
+#include "../../sizes.h"
+#include <cmath>
+#include <type_traits>
+
+/*
+ * vec.h
+ *
+ * Plain value types for vectors, points and extents: unlike Vector3D, Point3D or Size3D they have no virtual methods,
+ * they are aggregates, trivially copyable and standard-layout, so they can be stored by millions in flat arrays,
+ * copied with memcpy into GPU or network buffers and vectorized by the compiler.
+ */
+
+namespace lambdacommon
+{
+    namespace internal
+    {
+        /*!
+         * Gets the alignment of a vector: the whole vector when its size is a power of two up to 16 bytes so it can be loaded
+         * with a single instruction, else the alignment of a component so 3-component vectors stay tightly packed.
+         */
+        template<typename T, size_t N>
+        constexpr size_t vec_alignment() {
+            constexpr size_t size = sizeof(T) * N;
+            return size <= 16 && (size & (size - 1)) == 0 ? size : alignof(T);
+        }
+
+        template<typename T, size_t N>
+        struct coordinates
+        {
+            T values[N];
+
+            constexpr T& at(size_t index) {
+                return values[index];
+            }
+
+            constexpr const T& at(size_t index) const {
+                return values[index];
+            }
+        };
+
+        template<typename T>
+        struct coordinates<T, 1>
+        {
+            T x;
+
+            constexpr T& at(size_t) {
+                return x;
+            }
+
+            constexpr const T& at(size_t) const {
+                return x;
+            }
+        };
+
+        template<typename T>
+        struct coordinates<T, 2>
+        {
+            T x, y;
+
+            constexpr T& at(size_t index) {
+                return index == 0 ? x : y;
+            }
+
+            constexpr const T& at(size_t index) const {
+                return index == 0 ? x : y;
+            }
+        };
+
+        template<typename T>
+        struct coordinates<T, 3>
+        {
+            T x, y, z;
+
+            constexpr T& at(size_t index) {
+                return index == 0 ? x : (index == 1 ? y : z);
+            }
+
+            constexpr const T& at(size_t index) const {
+                return index == 0 ? x : (index == 1 ? y : z);
+            }
+        };
+
+        template<typename T>
+        struct coordinates<T, 4>
+        {
+            T x, y, z, w;
+
+            constexpr T& at(size_t index) {
+                return index == 0 ? x : (index == 1 ? y : (index == 2 ? z : w));
+            }
+
+            constexpr const T& at(size_t index) const {
+                return index == 0 ? x : (index == 1 ? y : (index == 2 ? z : w));
+            }
+        };
+
+        template<typename T, size_t N>
+        struct dimensions : coordinates<T, N>
+        {
+        };
+
+        template<typename T>
+        struct dimensions<T, 2>
+        {
+            T width, height;
+
+            constexpr T& at(size_t index) {
+                return index == 0 ? width : height;
+            }
+
+            constexpr const T& at(size_t index) const {
+                return index == 0 ? width : height;
+            }
+        };
+
+        template<typename T>
+        struct dimensions<T, 3>
+        {
+            T width, height, depth;
+
+            constexpr T& at(size_t index) {
+                return index == 0 ? width : (index == 1 ? height : depth);
+            }
+
+            constexpr const T& at(size_t index) const {
+                return index == 0 ? width : (index == 1 ? height : depth);
+            }
+        };
+
+        struct vec_kind
+        {
+            template<typename T, size_t N>
+            using storage = coordinates<T, N>;
+        };
+
+        struct point_kind
+        {
+            template<typename T, size_t N>
+            using storage = coordinates<T, N>;
+        };
+
+        struct extent_kind
+        {
+            template<typename T, size_t N>
+            using storage = dimensions<T, N>;
+        };
+    }
+
+    /*!
+     * Represents a fixed-size value type with N components, the common base of vec, point and extent.
+     * It is an aggregate: `vec<float, 3> v{1.f, 2.f, 3.f};`.
+     * @tparam T The type of the components.
+     * @tparam N The count of components.
+     * @tparam Kind The kind of the value, values of different kinds do not mix by accident.
+     */
+    template<typename T, size_t N, typename Kind>
+    struct alignas(internal::vec_alignment<T, N>()) basic_vec : Kind::template storage<T, N>
+    {
+        static_assert(std::is_arithmetic_v<T>, "The components of a vector must be arithmetic.");
+        static_assert(N > 0, "A vector must have at least one component.");
+
+        typedef T value_type;
+        typedef basic_vec<T, N, std::conditional_t<std::is_same_v<Kind, internal::point_kind>, internal::vec_kind, Kind>> difference_type;
+        static constexpr size_t SIZE = N;
+
+        /*!
+         * Creates a value with every component set to the same value.
+         * @param value The value of the components.
+         * @return The new value.
+         */
+        static constexpr basic_vec splat(T value) {
+            basic_vec result{};
+            for (size_t i = 0; i < N; i++)
+                result[i] = value;
+            return result;
+        }
+
+        constexpr T& operator[](size_t index) {
+            return this->at(index);
+        }
+
+        constexpr const T& operator[](size_t index) const {
+            return this->at(index);
+        }
+
+        constexpr size_t size() const {
+            return N;
+        }
+
+        /*!
+         * Converts the components to another type.
+         * @tparam U The new type of the components.
+         * @return The converted value.
+         */
+        template<typename U>
+        constexpr basic_vec<U, N, Kind> cast() const {
+            basic_vec<U, N, Kind> result{};
+            for (size_t i = 0; i < N; i++)
+                result[i] = static_cast<U>((*this)[i]);
+            return result;
+        }
+
+        /*!
+         * Gets the sum of the components.
+         * @return The sum of the components.
+         */
+        constexpr T sum() const {
+            T result = 0;
+            for (size_t i = 0; i < N; i++)
+                result += (*this)[i];
+            return result;
+        }
+
+        /*!
+         * Gets the product of the components, which is the area or the volume of an extent.
+         * @return The product of the components.
+         */
+        constexpr T product() const {
+            T result = 1;
+            for (size_t i = 0; i < N; i++)
+                result *= (*this)[i];
+            return result;
+        }
+
+        std::string to_string() const {
+            std::string result = "(";
+            for (size_t i = 0; i < N; i++) {
+                if (i != 0)
+                    result += ';';
+                result += std::to_string((*this)[i]);
+            }
+            return result + ')';
+        }
+
+        constexpr basic_vec& operator+=(const basic_vec& other) {
+            for (size_t i = 0; i < N; i++)
+                (*this)[i] += other[i];
+            return *this;
+        }
+
+        constexpr basic_vec& operator-=(const basic_vec& other) {
+            for (size_t i = 0; i < N; i++)
+                (*this)[i] -= other[i];
+            return *this;
+        }
+
+        constexpr basic_vec& operator*=(const basic_vec& other) {
+            for (size_t i = 0; i < N; i++)
+                (*this)[i] *= other[i];
+            return *this;
+        }
+
+        constexpr basic_vec& operator/=(const basic_vec& other) {
+            for (size_t i = 0; i < N; i++)
+                (*this)[i] /= other[i];
+            return *this;
+        }
+
+        constexpr basic_vec& operator*=(T scalar) {
+            for (size_t i = 0; i < N; i++)
+                (*this)[i] *= scalar;
+            return *this;
+        }
+
+        constexpr basic_vec& operator/=(T scalar) {
+            for (size_t i = 0; i < N; i++)
+                (*this)[i] /= scalar;
+            return *this;
+        }
+
+        friend constexpr basic_vec operator+(basic_vec self, const basic_vec& other) {
+            return self += other;
+        }
+
+        /*!
+         * Subtracts two values, the difference of two points is a vector.
+         */
+        friend constexpr difference_type operator-(const basic_vec& self, const basic_vec& other) {
+            difference_type result{};
+            for (size_t i = 0; i < N; i++)
+                result[i] = self[i] - other[i];
+            return result;
+        }
+
+        friend constexpr basic_vec operator*(basic_vec self, const basic_vec& other) {
+            return self *= other;
+        }
+
+        friend constexpr basic_vec operator/(basic_vec self, const basic_vec& other) {
+            return self /= other;
+        }
+
+        friend constexpr basic_vec operator*(basic_vec self, T scalar) {
+            return self *= scalar;
+        }
+
+        friend constexpr basic_vec operator*(T scalar, basic_vec self) {
+            return self *= scalar;
+        }
+
+        friend constexpr basic_vec operator/(basic_vec self, T scalar) {
+            return self /= scalar;
+        }
+
+        friend constexpr basic_vec operator-(basic_vec self) {
+            for (size_t i = 0; i < N; i++)
+                self[i] = -self[i];
+            return self;
+        }
+
+        friend constexpr bool operator==(const basic_vec& a, const basic_vec& b) {
+            for (size_t i = 0; i < N; i++)
+                if (a[i] != b[i])
+                    return false;
+            return true;
+        }
+
+        friend constexpr bool operator!=(const basic_vec& a, const basic_vec& b) {
+            return !(a == b);
+        }
+    };
+
+    /*!
+     * Represents a vector with N components, named x, y, z and w up to 4 components.
+     */
+    template<typename T, size_t N>
+    using vec = basic_vec<T, N, internal::vec_kind>;
+
+    /*!
+     * Represents a point with N coordinates, named x, y, z and w up to 4 coordinates.
+     * The difference of two points is a vector, and a point moved by a vector is a point.
+     */
+    template<typename T, size_t N>
+    using point = basic_vec<T, N, internal::point_kind>;
+
+    /*!
+     * Represents an extent with N dimensions, named width, height and depth up to 3 dimensions.
+     */
+    template<typename T, size_t N>
+    using extent = basic_vec<T, N, internal::extent_kind>;
+
+    typedef vec<float, 2> vec2f;
+    typedef vec<float, 3> vec3f;
+    typedef vec<float, 4> vec4f;
+    typedef vec<double, 2> vec2d;
+    typedef vec<double, 3> vec3d;
+    typedef vec<double, 4> vec4d;
+    typedef vec<i32, 2> vec2i;
+    typedef vec<i32, 3> vec3i;
+    typedef point<float, 2> point2f;
+    typedef point<float, 3> point3f;
+    typedef point<i32, 2> point2i;
+    typedef point<i32, 3> point3i;
+    typedef extent<float, 2> extent2f;
+    typedef extent<u32, 2> extent2u;
+    typedef extent<u32, 3> extent3u;
+
+    template<typename T, size_t N>
+    constexpr point<T, N> operator+(point<T, N> a, const vec<T, N>& b) {
+        for (size_t i = 0; i < N; i++)
+            a[i] += b[i];
+        return a;
+    }
+
+    template<typename T, size_t N>
+    constexpr point<T, N> operator-(point<T, N> a, const vec<T, N>& b) {
+        for (size_t i = 0; i < N; i++)
+            a[i] -= b[i];
+        return a;
+    }
+
+    /*!
+     * Calculates the dot product of two vectors.
+     */
+    template<typename T, size_t N>
+    constexpr T dot(const vec<T, N>& a, const vec<T, N>& b) {
+        T result = 0;
+        for (size_t i = 0; i < N; i++)
+            result += a[i] * b[i];
+        return result;
+    }
+
+    /*!
+     * Calculates the cross product of two 3D vectors.
+     */
+    template<typename T>
+    constexpr vec<T, 3> cross(const vec<T, 3>& a, const vec<T, 3>& b) {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    template<typename T, size_t N>
+    constexpr T length_squared(const vec<T, N>& v) {
+        return dot(v, v);
+    }
+
+    /*!
+     * Calculates the length of a vector, as a double for integral components.
+     */
+    template<typename T, size_t N>
+    inline auto length(const vec<T, N>& v) {
+        return std::sqrt(length_squared(v));
+    }
+
+    /*!
+     * Normalizes a vector, the vector must not be null.
+     */
+    template<typename T, size_t N>
+    inline vec<T, N> normalize(const vec<T, N>& v) {
+        static_assert(std::is_floating_point_v<T>, "Only vectors of floating point components can be normalized.");
+        return v / length(v);
+    }
+
+    /*!
+     * Gets the component-wise minimum of two values.
+     */
+    template<typename T, size_t N, typename Kind>
+    constexpr basic_vec<T, N, Kind> min(basic_vec<T, N, Kind> a, const basic_vec<T, N, Kind>& b) {
+        for (size_t i = 0; i < N; i++)
+            a[i] = b[i] < a[i] ? b[i] : a[i];
+        return a;
+    }
+
+    /*!
+     * Gets the component-wise maximum of two values.
+     */
+    template<typename T, size_t N, typename Kind>
+    constexpr basic_vec<T, N, Kind> max(basic_vec<T, N, Kind> a, const basic_vec<T, N, Kind>& b) {
+        for (size_t i = 0; i < N; i++)
+            a[i] = a[i] < b[i] ? b[i] : a[i];
+        return a;
+    }
+
+    /*
+     * Conversions from and to the object types.
+     */
+
+    template<typename T>
+    inline vec<T, 2> to_vec(const Vector2D<T>& v) {
+        return {v.get_x(), v.get_y()};
+    }
+
+    template<typename T>
+    inline vec<T, 3> to_vec(const Vector3D<T>& v) {
+        return {v.get_x(), v.get_y(), v.get_z()};
+    }
+
+    template<typename T>
+    inline point<T, 2> to_point(const Point2D<T>& p) {
+        return {p.get_x(), p.get_y()};
+    }
+
+    template<typename T>
+    inline point<T, 3> to_point(const Point3D<T>& p) {
+        return {p.get_x(), p.get_y(), p.get_z()};
+    }
+
+    template<typename T>
+    inline extent<T, 2> to_extent(const Size2D<T>& size) {
+        return {size.get_width(), size.get_height()};
+    }
+
+    template<typename T>
+    inline extent<T, 3> to_extent(const Size3D<T>& size) {
+        return {size.get_width(), size.get_height(), size.get_depth()};
+    }
+
+    template<typename T>
+    inline Vector2D<T> to_vector2d(const vec<T, 2>& v) {
+        return {v.x, v.y};
+    }
+
+    template<typename T>
+    inline Vector3D<T> to_vector3d(const vec<T, 3>& v) {
+        return {v.x, v.y, v.z};
+    }
+
+    template<typename T>
+    inline Point2D<T> to_point2d(const point<T, 2>& p) {
+        return {p.x, p.y};
+    }
+
+    template<typename T>
+    inline Point3D<T> to_point3d(const point<T, 3>& p) {
+        return {p.x, p.y, p.z};
+    }
+
+    template<typename T>
+    inline Size2D<T> to_size2d(const extent<T, 2>& e) {
+        return {e.width, e.height};
+    }
+
+    template<typename T>
+    inline Size3D<T> to_size3d(const extent<T, 3>& e) {
+        return {e.width, e.height, e.depth};
+    }
+
+    static_assert(std::is_trivially_copyable_v<vec3f> && std::is_standard_layout_v<vec3f> && std::is_aggregate_v<vec3f>);
+    static_assert(sizeof(vec3f) == 12 && sizeof(vec4f) == 16 && alignof(vec4f) == 16 && sizeof(point3f) == 12);
+}
+
+#endif //LAMBDACOMMON_VEC_H
@@ -13,6 +13,7 @@
 #include "point.h"
 #include "../../maths.h"
 #include <cmath>
+#include <type_traits>
 
 namespace lambdacommon
 {
@@ -60,7 +61,8 @@ namespace lambdacommon
         }
 
         std::string to_string() const override {
-            return std::move('(' + std::to_string(this->x) + ')');
+            using std::to_string;
+            return std::move('(' + to_string(this->x) + ')');
         }
 
         bool operator==(const Vector1D<T>& other) const {
@@ -127,7 +129,16 @@ namespace lambdacommon
         }
 
         T get_standard() const override {
-            return static_cast<T>(sqrt(pow(this->x, 2) + pow(this->y, 2)));
+            // Floating point vectors stay in their precision, integer vectors are computed in double precision.
+            if constexpr (std::is_floating_point_v<T>)
+                return std::sqrt(this->x * this->x + this->y * this->y);
+            else if constexpr (std::is_integral_v<T>)
+                return static_cast<T>(std::sqrt(static_cast<f64>(this->x) * this->x + static_cast<f64>(this->y) * this->y));
+            else {
+                // The other numeric types, like maths::fixed, stay in their arithmetic with their own sqrt.
+                using std::sqrt;
+                return sqrt(this->x * this->x + this->y * this->y);
+            }
         }
 
         bool is_null() const override {
@@ -135,7 +146,8 @@ namespace lambdacommon
         }
 
         std::string to_string() const override {
-            return '(' + std::to_string(this->x) + ';' + std::to_string(this->y) + ')';
+            using std::to_string;
+            return '(' + to_string(this->x) + ';' + to_string(this->y) + ')';
         }
 
         bool operator==(const Vector2D<T>& other) const {
@@ -214,7 +226,15 @@ namespace lambdacommon
         }
 
         T get_standard() const override {
-            return static_cast<T>(sqrt(pow(this->x, 2) + pow(this->y, 2) + pow(this->z, 2)));
+            if constexpr (std::is_floating_point_v<T>)
+                return std::sqrt(this->x * this->x + this->y * this->y + this->z * this->z);
+            else if constexpr (std::is_integral_v<T>)
+                return static_cast<T>(std::sqrt(static_cast<f64>(this->x) * this->x + static_cast<f64>(this->y) * this->y +
+                                                static_cast<f64>(this->z) * this->z));
+            else {
+                using std::sqrt;
+                return sqrt(this->x * this->x + this->y * this->y + this->z * this->z);
+            }
         }
 
         bool is_null() const override {
@@ -222,7 +242,8 @@ namespace lambdacommon
         }
 
         std::string to_string() const override {
-            return '(' + std::to_string(this->x) + ';' + std::to_string(this->y) + ';' + std::to_string(this->z) + ')';
+            using std::to_string;
+            return '(' + to_string(this->x) + ';' + to_string(this->y) + ';' + to_string(this->z) + ')';
         }
 
         bool operator==(const Vector3D<T>& other) const {
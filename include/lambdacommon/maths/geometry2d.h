@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_GEOMETRY2D_H
+#define LAMBDACOMMON_GEOMETRY2D_H
+
+#include "parallel.h"
+#include "geometry/vec.h"
+#include <utility>
+#include <vector>
+
+/*
+ * geometry2d.h
+ *
+ * Computational geometry over flat arrays of 2D points.
+ * A polygon is the array of its vertices, closed by the edge from the last vertex to the first one.
+ * The results are indices in the input arrays, written in vectors given by the caller: they are cleared and filled again,
+ * so their capacity is reused from one call to the other. The work memory comes the same way from scratch buffers.
+ * The orientation tests are computed in double precision.
+ */
+
+namespace lambdacommon::maths::geometry2d
+{
+    /*!
+     * Represents the work memory of the algorithms, reused between calls to avoid allocating.
+     * Its content is meaningless between two calls, a scratch buffer must not be shared by two threads.
+     */
+    struct scratch_buffer
+    {
+        std::vector<u32> indices;
+        std::vector<u32> links;
+        std::vector<u8> flags;
+        std::vector<f32> values;
+    };
+
+    struct segment2f
+    {
+        point2f a;
+        point2f b;
+    };
+
+    /*!
+     * Gets twice the signed area of the triangle abc.
+     * @return A positive value if the triangle turns counter-clockwise, negative if it turns clockwise, 0 if it is flat.
+     */
+    inline f64 orientation(const point2f& a, const point2f& b, const point2f& c) {
+        return (static_cast<f64>(b.x) - a.x) * (static_cast<f64>(c.y) - a.y) - (static_cast<f64>(b.y) - a.y) * (static_cast<f64>(c.x) - a.x);
+    }
+
+    /*!
+     * Gets the signed area of a polygon with the shoelace formula.
+     * @param polygon The vertices of the polygon.
+     * @return The area, positive if the polygon turns counter-clockwise.
+     */
+    extern f64 LAMBDACOMMON_API signed_area(span<const point2f> polygon);
+
+    inline f64 area(span<const point2f> polygon) {
+        return std::abs(signed_area(polygon));
+    }
+
+    /*!
+     * Checks whether two segments intersect, touching included.
+     */
+    extern bool LAMBDACOMMON_API intersects(const segment2f& a, const segment2f& b);
+
+    /*!
+     * Computes the convex hull of points with Andrew's monotone chain.
+     * @param points The points.
+     * @param hull The indices of the vertices of the hull, counter-clockwise from the lowest then leftmost point, without
+     * collinear points.
+     * @param scratch The work memory.
+     */
+    extern void LAMBDACOMMON_API convex_hull(span<const point2f> points, std::vector<u32>& hull, scratch_buffer& scratch);
+
+    /*!
+     * Simplifies a polyline with the Ramer–Douglas–Peucker algorithm.
+     * @param polyline The points of the polyline.
+     * @param epsilon The largest distance between the polyline and its simplification.
+     * @param kept The indices of the kept points, in increasing order, with the first and the last points.
+     * @param scratch The work memory.
+     */
+    extern void LAMBDACOMMON_API simplify(span<const point2f> polyline, f32 epsilon, std::vector<u32>& kept, scratch_buffer& scratch);
+
+    /*!
+     * Checks whether a point is inside a polygon with the even-odd rule, with the scalar code of the batch test.
+     */
+    extern bool LAMBDACOMMON_API contains(span<const point2f> polygon, const point2f& point);
+
+    /*!
+     * Tests many points against a polygon with the even-odd rule.
+     * It dispatches at runtime to the instruction set returned by get_simd_level(), the points on the boundary of the
+     * polygon may be classified differently by two instruction sets.
+     * @param polygon The vertices of the polygon.
+     * @param points The points.
+     * @param out 1 for the points inside the polygon, 0 for the others, resized to the count of points.
+     * @param scratch The work memory.
+     */
+    extern void LAMBDACOMMON_API contains(span<const point2f> polygon, span<const point2f> points, std::vector<u8>& out,
+                                          scratch_buffer& scratch);
+
+    /*!
+     * Finds the pairs of intersecting segments, touching included, by sweeping a line across their extents.
+     * @param segments The segments.
+     * @param pairs The pairs of indices of intersecting segments, the lower index first, sorted.
+     * @param scratch The work memory.
+     */
+    extern void LAMBDACOMMON_API find_intersections(span<const segment2f> segments, std::vector<std::pair<u32, u32>>& pairs,
+                                                    scratch_buffer& scratch);
+
+    /*!
+     * Triangulates a simple polygon by ear clipping, turning in either direction.
+     * Degenerate polygons still give count - 2 triangles, some of them possibly flat or overlapping.
+     * @param polygon The vertices of the polygon.
+     * @param triangles The indices of the vertices of the triangles, three per triangle, turning like the polygon.
+     * @param scratch The work memory.
+     */
+    extern void LAMBDACOMMON_API triangulate(span<const point2f> polygon, std::vector<u32>& triangles, scratch_buffer& scratch);
+}
+
+#endif //LAMBDACOMMON_GEOMETRY2D_H
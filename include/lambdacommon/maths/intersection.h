@@ -0,0 +1,295 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_INTERSECTION_H
+#define LAMBDACOMMON_INTERSECTION_H
+
+#include "soa.h"
+#include "spatial.h"
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+/*
+ * intersection.h
+ *
+ * Ray intersection tests against packets of shapes stored as structures of arrays, see soa.h.
+ * Every test gives the distance along the ray at which it enters the shape, expressed in lengths of the direction of the
+ * ray: 0 if the origin of the ray is inside the shape, and infinity if the ray misses the shape within its maximum distance.
+ */
+
+namespace lambdacommon::maths
+{
+    /*!
+     * Represents a ray, a half-line starting at an origin.
+     */
+    struct ray3f
+    {
+        point3f origin;
+        /*! The direction, must not be null, its length is the unit of the distances. */
+        vec3f direction;
+        /*! The maximum distance, the shapes farther are missed. */
+        f32 t_max = std::numeric_limits<f32>::infinity();
+
+        /*!
+         * Gets the point at a distance along the ray.
+         * @param t The distance.
+         * @return The point.
+         */
+        constexpr point3f at(f32 t) const {
+            return origin + direction * t;
+        }
+
+        constexpr vec3f inverse_direction() const {
+            return {1.f / direction.x, 1.f / direction.y, 1.f / direction.z};
+        }
+    };
+
+    /*!
+     * Creates a ray from the object types.
+     * @param origin The origin.
+     * @param direction The direction.
+     * @param t_max The maximum distance.
+     * @return The ray.
+     */
+    inline ray3f to_ray(const Point3D<f32>& origin, const Vector3D<f32>& direction, f32 t_max = std::numeric_limits<f32>::infinity()) {
+        return {to_point(origin), to_vec(direction), t_max};
+    }
+
+    /*!
+     * Represents an array of boxes stored as structures of arrays of their corners.
+     */
+    class aabb_soa
+    {
+    private:
+        vec3_soa<f32> _min, _max;
+
+    public:
+        inline size_t size() const {
+            return _min.size();
+        }
+
+        inline bool empty() const {
+            return _min.empty();
+        }
+
+        void reserve(size_t capacity) {
+            _min.reserve(capacity);
+            _max.reserve(capacity);
+        }
+
+        void clear() {
+            _min.clear();
+            _max.clear();
+        }
+
+        void push_back(const spatial::aabb3f& box) {
+            _min.push_back({box.min.x, box.min.y, box.min.z});
+            _max.push_back({box.max.x, box.max.y, box.max.z});
+        }
+
+        inline spatial::aabb3f get(size_t index) const {
+            auto minimum = _min.get(index), maximum = _max.get(index);
+            return {{minimum.x, minimum.y, minimum.z}, {maximum.x, maximum.y, maximum.z}};
+        }
+
+        inline const vec3_soa<f32>& min() const {
+            return _min;
+        }
+
+        inline const vec3_soa<f32>& max() const {
+            return _max;
+        }
+    };
+
+    /*!
+     * Represents an array of rays stored as structures of arrays, with the inverses of their directions for the slab tests.
+     */
+    class ray_soa
+    {
+    private:
+        vec3_soa<f32> _origin, _direction, _inverse_direction;
+        vec3_soa<f32>::component_array _t_max;
+
+    public:
+        inline size_t size() const {
+            return _origin.size();
+        }
+
+        inline bool empty() const {
+            return _origin.empty();
+        }
+
+        void reserve(size_t capacity) {
+            _origin.reserve(capacity);
+            _direction.reserve(capacity);
+            _inverse_direction.reserve(capacity);
+            _t_max.reserve(capacity);
+        }
+
+        void clear() {
+            _origin.clear();
+            _direction.clear();
+            _inverse_direction.clear();
+            _t_max.clear();
+        }
+
+        void push_back(const ray3f& ray) {
+            _origin.push_back({ray.origin.x, ray.origin.y, ray.origin.z});
+            _direction.push_back(ray.direction);
+            _inverse_direction.push_back(ray.inverse_direction());
+            _t_max.push_back(ray.t_max);
+        }
+
+        inline ray3f get(size_t index) const {
+            auto origin = _origin.get(index);
+            return {{origin.x, origin.y, origin.z}, _direction.get(index), _t_max[index]};
+        }
+
+        inline const vec3_soa<f32>& origin() const {
+            return _origin;
+        }
+
+        inline const vec3_soa<f32>& direction() const {
+            return _direction;
+        }
+
+        inline const vec3_soa<f32>& inverse_direction() const {
+            return _inverse_direction;
+        }
+
+        inline const f32* t_max() const {
+            return _t_max.data();
+        }
+    };
+
+    /*!
+     * Represents an array of triangles stored as structures of arrays of a vertex and the edges from it to the two others.
+     */
+    class triangle_soa
+    {
+    private:
+        vec3_soa<f32> _vertex, _edge1, _edge2;
+
+    public:
+        inline size_t size() const {
+            return _vertex.size();
+        }
+
+        inline bool empty() const {
+            return _vertex.empty();
+        }
+
+        void reserve(size_t capacity) {
+            _vertex.reserve(capacity);
+            _edge1.reserve(capacity);
+            _edge2.reserve(capacity);
+        }
+
+        void clear() {
+            _vertex.clear();
+            _edge1.clear();
+            _edge2.clear();
+        }
+
+        void push_back(const point3f& a, const point3f& b, const point3f& c) {
+            _vertex.push_back({a.x, a.y, a.z});
+            _edge1.push_back(b - a);
+            _edge2.push_back(c - a);
+        }
+
+        inline const vec3_soa<f32>& vertex() const {
+            return _vertex;
+        }
+
+        inline const vec3_soa<f32>& edge1() const {
+            return _edge1;
+        }
+
+        inline const vec3_soa<f32>& edge2() const {
+            return _edge2;
+        }
+    };
+
+    /*!
+     * Represents an array of spheres stored as structures of arrays.
+     */
+    class sphere_soa
+    {
+    private:
+        vec3_soa<f32> _center;
+        vec3_soa<f32>::component_array _radius;
+
+    public:
+        inline size_t size() const {
+            return _center.size();
+        }
+
+        inline bool empty() const {
+            return _center.empty();
+        }
+
+        void reserve(size_t capacity) {
+            _center.reserve(capacity);
+            _radius.reserve(capacity);
+        }
+
+        void clear() {
+            _center.clear();
+            _radius.clear();
+        }
+
+        void push_back(const point3f& center, f32 radius) {
+            _center.push_back({center.x, center.y, center.z});
+            _radius.push_back(radius);
+        }
+
+        inline const vec3_soa<f32>& center() const {
+            return _center;
+        }
+
+        inline const f32* radius() const {
+            return _radius.data();
+        }
+    };
+
+    /*
+     * Single tests, with the scalar code of the batch kernels.
+     */
+
+    extern f32 LAMBDACOMMON_API intersect(const ray3f& ray, const spatial::aabb3f& box);
+
+    /*!
+     * Tests a ray against a triangle, both faces included.
+     */
+    extern f32 LAMBDACOMMON_API intersect(const ray3f& ray, const point3f& a, const point3f& b, const point3f& c);
+
+    extern f32 LAMBDACOMMON_API intersect(const ray3f& ray, const point3f& center, f32 radius);
+
+    /*
+     * Batch tests: the output is resized to the count of tests.
+     * They dispatch at runtime to the instruction set returned by get_simd_level().
+     */
+
+    extern void LAMBDACOMMON_API intersect(const ray3f& ray, const aabb_soa& boxes, std::vector<f32>& out);
+
+    extern void LAMBDACOMMON_API intersect(const ray_soa& rays, const spatial::aabb3f& box, std::vector<f32>& out);
+
+    extern void LAMBDACOMMON_API intersect(const ray3f& ray, const triangle_soa& triangles, std::vector<f32>& out);
+
+    extern void LAMBDACOMMON_API intersect(const ray3f& ray, const sphere_soa& spheres, std::vector<f32>& out);
+}
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_INTERSECTION_H
@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_NOISE_H
+#define LAMBDACOMMON_NOISE_H
+
+#include "parallel.h"
+
+/*
+ * noise.h
+ *
+ * Procedural noises in 2, 3 and 4 dimensions, layered in octaves or not, sampled at points or filling whole grids.
+ * The output only depends on the settings and on the coordinates: it is the same with any count of threads, and the
+ * instruction sets only differ by the rounding of the fused multiply-adds.
+ * The noises are in about [-1, 1], the coordinates multiplied by the frequency must stay within the range of i32.
+ */
+
+namespace lambdacommon::maths::noise
+{
+    enum noise_type : u8
+    {
+        /*! Random values at the lattice points, interpolated: blocky. */
+        NOISE_VALUE,
+        /*! Random gradients at the lattice points, interpolated (Perlin's improved noise): aligned on the axes. */
+        NOISE_PERLIN,
+        /*! Random gradients at the corners of a simplex lattice, summed with a radial falloff: isotropic and cheaper in 3D and 4D. */
+        NOISE_SIMPLEX
+    };
+
+    enum fractal_type : u8
+    {
+        FRACTAL_NONE,
+        /*! Fractional Brownian motion: the octaves are summed. */
+        FRACTAL_FBM,
+        /*! The octaves are folded around 0 then summed: sharp ridges, for mountains. */
+        FRACTAL_RIDGED
+    };
+
+    /*!
+     * Represents the settings of a noise.
+     */
+    struct noise_settings
+    {
+        noise_type type = NOISE_SIMPLEX;
+        i32 seed = 1337;
+        /*! The scale of the coordinates, the inverse of the size of a feature. */
+        f32 frequency = 0.01f;
+        fractal_type fractal = FRACTAL_NONE;
+        /*! The count of layers of a fractal noise, each one with its own seed. */
+        u32 octaves = 3;
+        /*! The factor of the frequency from an octave to the next one. */
+        f32 lacunarity = 2.f;
+        /*! The factor of the amplitude from an octave to the next one. */
+        f32 gain = 0.5f;
+    };
+
+    /*
+     * Single samples, with the scalar code of the batch kernels.
+     */
+
+    extern f32 LAMBDACOMMON_API sample(const noise_settings& settings, f32 x, f32 y);
+
+    extern f32 LAMBDACOMMON_API sample(const noise_settings& settings, f32 x, f32 y, f32 z);
+
+    extern f32 LAMBDACOMMON_API sample(const noise_settings& settings, f32 x, f32 y, f32 z, f32 w);
+
+    /*
+     * Batch samples at points given as arrays of coordinates.
+     * They dispatch at runtime to the instruction set returned by get_simd_level().
+     */
+
+    extern void LAMBDACOMMON_API sample(const noise_settings& settings, const f32* x, const f32* y, f32* out, size_t count);
+
+    extern void LAMBDACOMMON_API sample(const noise_settings& settings, const f32* x, const f32* y, const f32* z, f32* out, size_t count);
+
+    extern void LAMBDACOMMON_API sample(const noise_settings& settings, const f32* x, const f32* y, const f32* z, const f32* w, f32* out,
+                                        size_t count);
+
+    /*
+     * Grid fills: the grids are stored row by row, then slice by slice, and the sample (i, j, k) is taken at
+     * (x + i, y + j, z + k). The samples are split across the threads of the pool.
+     */
+
+    /*!
+     * Fills an image of width by height samples.
+     */
+    extern void LAMBDACOMMON_API fill(const noise_settings& settings, f32* out, u32 width, u32 height, f32 x, f32 y,
+                                      system::thread_pool& pool);
+
+    extern void LAMBDACOMMON_API fill(const noise_settings& settings, f32* out, u32 width, u32 height, u32 depth, f32 x, f32 y,
+                                      f32 z, system::thread_pool& pool);
+
+    /*!
+     * Fills a grid of width by height by depth samples of the 4D noise at a fixed w, to animate a 3D noise along w.
+     */
+    extern void LAMBDACOMMON_API fill(const noise_settings& settings, f32* out, u32 width, u32 height, u32 depth, f32 x, f32 y,
+                                      f32 z, f32 w, system::thread_pool& pool);
+
+    /*
+     * Grid fills with the thread pool of maths::parallel.
+     */
+
+    inline void fill(const noise_settings& settings, f32* out, u32 width, u32 height, f32 x, f32 y) {
+        fill(settings, out, width, height, x, y, parallel::get_thread_pool());
+    }
+
+    inline void fill(const noise_settings& settings, f32* out, u32 width, u32 height, u32 depth, f32 x, f32 y, f32 z) {
+        fill(settings, out, width, height, depth, x, y, z, parallel::get_thread_pool());
+    }
+
+    inline void fill(const noise_settings& settings, f32* out, u32 width, u32 height, u32 depth, f32 x, f32 y, f32 z, f32 w) {
+        fill(settings, out, width, height, depth, x, y, z, w, parallel::get_thread_pool());
+    }
+}
+
+#endif //LAMBDACOMMON_NOISE_H
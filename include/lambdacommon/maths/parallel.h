@@ -0,0 +1,422 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_PARALLEL_H
+#define LAMBDACOMMON_PARALLEL_H
+
+#include "../maths.h"
+#include "../system/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * parallel.h
+ *
+ * Reductions and transforms of arrays split across a thread pool.
+ * The arrays are cut in blocks of a fixed size whatever the count of threads, the partial results of the blocks are then
+ * combined in the same order: a reduction gives the same result, to the bit, on every run and with any count of threads.
+ * The functions must not be called from a task of the pool they use, the caller waits for the tasks.
+ */
+
+namespace lambdacommon::maths
+{
+    /*!
+     * Represents a view of a contiguous array, std::span is only available since C++20.
+     * @tparam T The type of the elements, const for a read-only view.
+     */
+    template<typename T>
+    class span
+    {
+    private:
+        T* _data = nullptr;
+        size_t _size = 0;
+
+        template<typename Container>
+        using enable_if_compatible = std::enable_if_t<std::is_convertible_v<decltype(std::declval<Container&>().data()), T*>>;
+
+    public:
+        typedef T element_type;
+        typedef std::remove_cv_t<T> value_type;
+        typedef T* iterator;
+
+        constexpr span() = default;
+
+        constexpr span(T* data, size_t size) : _data(data), _size(size) {}
+
+        template<size_t N>
+        constexpr span(T (& array)[N]) : _data(array), _size(N) {}
+
+        template<typename Container, typename = enable_if_compatible<Container>>
+        constexpr span(Container& container) : _data(container.data()), _size(container.size()) {}
+
+        template<typename Container, typename = enable_if_compatible<const Container>>
+        constexpr span(const Container& container) : _data(container.data()), _size(container.size()) {}
+
+        constexpr T* data() const {
+            return _data;
+        }
+
+        constexpr size_t size() const {
+            return _size;
+        }
+
+        constexpr bool empty() const {
+            return _size == 0;
+        }
+
+        constexpr iterator begin() const {
+            return _data;
+        }
+
+        constexpr iterator end() const {
+            return _data + _size;
+        }
+
+        constexpr T& operator[](size_t index) const {
+            return _data[index];
+        }
+
+        /*!
+         * Gets a view of a part of the array.
+         * @param offset The index of the first element.
+         * @param count The count of elements, the rest of the array by default.
+         * @return The view.
+         */
+        constexpr span<T> subspan(size_t offset, size_t count = std::numeric_limits<size_t>::max()) const {
+            return {_data + offset, std::min(count, _size - offset)};
+        }
+    };
+
+    template<typename T, size_t N>
+    span(T (&)[N]) -> span<T>;
+
+    template<typename Container>
+    span(Container&) -> span<std::remove_pointer_t<decltype(std::declval<Container&>().data())>>;
+
+    template<typename Container>
+    span(const Container&) -> span<std::remove_pointer_t<decltype(std::declval<const Container&>().data())>>;
+
+    namespace parallel
+    {
+        /*!
+         * Gets the thread pool shared by the functions without a pool parameter, it has one thread per CPU core.
+         * @return The shared thread pool.
+         */
+        extern system::thread_pool& LAMBDACOMMON_API get_thread_pool();
+
+        namespace internal
+        {
+            /*! The count of elements of a block, fixed so that the results do not depend on the count of threads. */
+            constexpr size_t BLOCK_SIZE = 8192;
+            /*! The count of independent accumulators, enough to fill the widest vector registers. */
+            constexpr size_t LANES = 8;
+            constexpr size_t PAIRWISE_BASE = 16 * LANES;
+
+            /*!
+             * Reduces a range in a tree: the error of a floating point sum grows with the logarithm of the count instead of
+             * the count. The leaves accumulate in independent lanes the compiler can keep in vector registers.
+             */
+            template<typename R, typename F, typename Combine>
+            R pairwise_reduce(size_t begin, size_t end, const R& identity, F& element, Combine& combine) {
+                if (end - begin > PAIRWISE_BASE) {
+                    size_t middle = begin + (end - begin) / 2 / LANES * LANES;
+                    return combine(pairwise_reduce(begin, middle, identity, element, combine),
+                                   pairwise_reduce(middle, end, identity, element, combine));
+                }
+                R lanes[LANES];
+                std::fill_n(lanes, LANES, identity);
+                // A counted loop, the compilers only vectorize the lanes then.
+                size_t rows = (end - begin) / LANES;
+                for (size_t row = 0; row < rows; row++)
+                    for (size_t j = 0; j < LANES; j++)
+                        lanes[j] = combine(lanes[j], element(begin + row * LANES + j));
+                size_t i = begin + rows * LANES;
+                R result = combine(combine(combine(lanes[0], lanes[1]), combine(lanes[2], lanes[3])),
+                                   combine(combine(lanes[4], lanes[5]), combine(lanes[6], lanes[7])));
+                for (; i < end; i++)
+                    result = combine(result, element(i));
+                return result;
+            }
+
+            inline void check_sizes(size_t a, size_t b) {
+                if (a != b)
+                    throw std::invalid_argument("The arrays must have the same size, got " + std::to_string(a) + " and " +
+                                                std::to_string(b) + ".");
+            }
+
+            inline void check_output(size_t out, size_t size) {
+                if (out < size)
+                    throw std::invalid_argument("The output must hold " + std::to_string(size) + " elements, got " +
+                                                std::to_string(out) + ".");
+            }
+
+            inline size_t task_count(const system::thread_pool& pool, size_t count) {
+                return std::min(pool.size(), (count + BLOCK_SIZE - 1) / BLOCK_SIZE);
+            }
+
+            /*!
+             * Splits a range in task_count() ranges of whole blocks and runs them in parallel, the first one on the calling
+             * thread.
+             * @param func The function taking the index of the task, the beginning and the end of its range.
+             */
+            template<typename F>
+            void for_each_range(system::thread_pool& pool, size_t count, F func) {
+                size_t tasks = task_count(pool, count), blocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+                auto run = [&func, tasks, blocks, count](size_t task) {
+                    func(task, blocks * task / tasks * BLOCK_SIZE, std::min(count, blocks * (task + 1) / tasks * BLOCK_SIZE));
+                };
+                if (tasks <= 1) {
+                    func(0, 0, count);
+                    return;
+                }
+                std::vector<std::future<void>> futures;
+                futures.reserve(tasks - 1);
+                try {
+                    for (size_t task = 1; task < tasks; task++)
+                        futures.push_back(pool.submit([&run, task]() { run(task); }));
+                    run(0);
+                } catch (...) {
+                    // The submitted tasks reference this frame, they must end before it unwinds.
+                    for (auto& future : futures)
+                        future.wait();
+                    throw;
+                }
+                for (auto& future : futures)
+                    future.wait();
+                for (auto& future : futures)
+                    future.get();
+            }
+        }
+
+        /*!
+         * Reduces elements with an associative function: each block is reduced in a tree, then the results of the blocks.
+         * @param pool The thread pool.
+         * @param count The count of elements.
+         * @param identity The identity of the reduction, the result if there is no element.
+         * @param element The function giving the element at an index.
+         * @param combine The associative function combining two partial results.
+         * @return The result of the reduction.
+         */
+        template<typename R, typename F, typename Combine>
+        R reduce(system::thread_pool& pool, size_t count, const R& identity, F element, Combine combine) {
+            std::vector<R> partials((count + internal::BLOCK_SIZE - 1) / internal::BLOCK_SIZE, identity);
+            internal::for_each_range(pool, count, [&](size_t, size_t begin, size_t end) {
+                for (size_t block = begin; block < end; block += internal::BLOCK_SIZE)
+                    partials[block / internal::BLOCK_SIZE] = internal::pairwise_reduce(block, std::min(end, block + internal::BLOCK_SIZE),
+                                                                                       identity, element, combine);
+            });
+            auto partial = [&partials](size_t index) { return partials[index]; };
+            return internal::pairwise_reduce(0, partials.size(), identity, partial, combine);
+        }
+
+        /*!
+         * Sums the results of a function applied to each element.
+         * @param func The function, the type of its result is the type of the sum.
+         */
+        template<typename T, typename F>
+        auto transform_sum(system::thread_pool& pool, span<T> values, F func) {
+            typedef std::decay_t<decltype(func(values[0]))> result_type;
+            const T* data = values.data();
+            return reduce(pool, values.size(), result_type{}, [data, &func](size_t i) { return func(data[i]); },
+                          [](const result_type& a, const result_type& b) { return a + b; });
+        }
+
+        template<typename T, typename F>
+        auto transform_sum(span<T> values, F func) {
+            return transform_sum(get_thread_pool(), values, func);
+        }
+
+        template<typename T>
+        std::remove_cv_t<T> sum(system::thread_pool& pool, span<T> values) {
+            return transform_sum(pool, values, [](std::remove_cv_t<T> value) { return value; });
+        }
+
+        template<typename T>
+        std::remove_cv_t<T> sum(span<T> values) {
+            return sum(get_thread_pool(), values);
+        }
+
+        /*!
+         * Gets the arithmetic mean, the integers are summed as doubles.
+         * @return The mean, NaN if there is no element.
+         */
+        template<typename T>
+        auto mean(system::thread_pool& pool, span<T> values) {
+            typedef std::conditional_t<std::is_floating_point_v<std::remove_cv_t<T>>, std::remove_cv_t<T>, f64> result_type;
+            auto total = transform_sum(pool, values, [](std::remove_cv_t<T> value) { return static_cast<result_type>(value); });
+            return values.empty() ? std::numeric_limits<result_type>::quiet_NaN() : total / static_cast<result_type>(values.size());
+        }
+
+        template<typename T>
+        auto mean(span<T> values) {
+            return mean(get_thread_pool(), values);
+        }
+
+        /*!
+         * Gets the dot product of two arrays of the same size.
+         * @throws std::invalid_argument If the arrays have different sizes.
+         */
+        template<typename T, typename U>
+        auto dot(system::thread_pool& pool, span<T> a, span<U> b) {
+            typedef decltype(a[0] * b[0]) result_type;
+            const T* left = a.data();
+            const U* right = b.data();
+            internal::check_sizes(a.size(), b.size());
+            return reduce(pool, a.size(), result_type{}, [left, right](size_t i) { return left[i] * right[i]; },
+                          [](result_type x, result_type y) { return x + y; });
+        }
+
+        template<typename T, typename U>
+        auto dot(span<T> a, span<U> b) {
+            return dot(get_thread_pool(), a, b);
+        }
+
+        /*!
+         * Gets the smallest element, NaN are ignored.
+         * @return The smallest element, infinity or the largest value of the type if there is no element.
+         */
+        template<typename T>
+        std::remove_cv_t<T> min(system::thread_pool& pool, span<T> values) {
+            typedef std::remove_cv_t<T> value_type;
+            typedef std::numeric_limits<value_type> limits;
+            const T* data = values.data();
+            return reduce(pool, values.size(), limits::has_infinity ? limits::infinity() : limits::max(), [data](size_t i) { return data[i]; },
+                          [](value_type a, value_type b) { return b < a ? b : a; });
+        }
+
+        template<typename T>
+        std::remove_cv_t<T> min(span<T> values) {
+            return min(get_thread_pool(), values);
+        }
+
+        /*!
+         * Gets the largest element, NaN are ignored.
+         * @return The largest element, minus infinity or the lowest value of the type if there is no element.
+         */
+        template<typename T>
+        std::remove_cv_t<T> max(system::thread_pool& pool, span<T> values) {
+            typedef std::remove_cv_t<T> value_type;
+            typedef std::numeric_limits<value_type> limits;
+            const T* data = values.data();
+            return reduce(pool, values.size(), limits::has_infinity ? -limits::infinity() : limits::lowest(), [data](size_t i) { return data[i]; },
+                          [](value_type a, value_type b) { return a < b ? b : a; });
+        }
+
+        template<typename T>
+        std::remove_cv_t<T> max(span<T> values) {
+            return max(get_thread_pool(), values);
+        }
+
+        /*!
+         * Gets the smallest and the largest elements in one pass, see min() and max().
+         */
+        template<typename T>
+        std::pair<std::remove_cv_t<T>, std::remove_cv_t<T>> min_max(system::thread_pool& pool, span<T> values) {
+            typedef std::remove_cv_t<T> value_type;
+            typedef std::numeric_limits<value_type> limits;
+            typedef std::pair<value_type, value_type> result_type;
+            const T* data = values.data();
+            result_type identity{limits::has_infinity ? limits::infinity() : limits::max(), limits::has_infinity ? -limits::infinity() : limits::lowest()};
+            return reduce(pool, values.size(), identity, [data](size_t i) { return result_type{data[i], data[i]}; },
+                          [](const result_type& a, const result_type& b) {
+                              return result_type{b.first < a.first ? b.first : a.first, a.second < b.second ? b.second : a.second};
+                          });
+        }
+
+        template<typename T>
+        std::pair<std::remove_cv_t<T>, std::remove_cv_t<T>> min_max(span<T> values) {
+            return min_max(get_thread_pool(), values);
+        }
+
+        /*!
+         * Counts the elements in bins of the same width.
+         * @param min The lower bound of the first bin.
+         * @param max The upper bound of the last bin, included.
+         * @param bins The count of bins.
+         * @return The count of elements in each bin, the elements out of [min, max] and NaN are not counted.
+         */
+        template<typename T>
+        std::vector<size_t> histogram(system::thread_pool& pool, span<T> values, std::remove_cv_t<T> min, std::remove_cv_t<T> max, size_t bins) {
+            std::vector<std::vector<size_t>> counts(std::max<size_t>(1, internal::task_count(pool, values.size())), std::vector<size_t>(bins));
+            if (bins == 0 || !(min < max))
+                return counts[0];
+            f64 lower = static_cast<f64>(min), upper = static_cast<f64>(max), scale = static_cast<f64>(bins) / (upper - lower);
+            const T* data = values.data();
+            internal::for_each_range(pool, values.size(), [&](size_t task, size_t begin, size_t end) {
+                auto& local = counts[task];
+                for (size_t i = begin; i < end; i++) {
+                    f64 value = static_cast<f64>(data[i]);
+                    if (value >= lower && value <= upper)
+                        local[std::min(bins - 1, static_cast<size_t>((value - lower) * scale))]++;
+                }
+            });
+            for (size_t task = 1; task < counts.size(); task++)
+                for (size_t bin = 0; bin < bins; bin++)
+                    counts[0][bin] += counts[task][bin];
+            return counts[0];
+        }
+
+        template<typename T>
+        std::vector<size_t> histogram(span<T> values, std::remove_cv_t<T> min, std::remove_cv_t<T> max, size_t bins) {
+            return histogram(get_thread_pool(), values, min, max, bins);
+        }
+
+        /*!
+         * Applies a function to each element.
+         * @param in The input elements.
+         * @param out The output elements, at least as many as the input elements, may be the input.
+         * @param func The function.
+         * @throws std::invalid_argument If the output is smaller than the input.
+         */
+        template<typename T, typename U, typename F>
+        void transform(system::thread_pool& pool, span<T> in, span<U> out, F func) {
+            internal::check_output(out.size(), in.size());
+            T* input = in.data();
+            U* output = out.data();
+            internal::for_each_range(pool, in.size(), [input, output, &func](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    output[i] = func(input[i]);
+            });
+        }
+
+        template<typename T, typename U, typename F>
+        void transform(span<T> in, span<U> out, F func) {
+            transform(get_thread_pool(), in, out, func);
+        }
+
+        /*!
+         * Applies a function to each pair of elements of two arrays of the same size.
+         * @throws std::invalid_argument If the arrays have different sizes or the output is smaller than them.
+         */
+        template<typename T, typename U, typename V, typename F>
+        void transform(system::thread_pool& pool, span<T> a, span<U> b, span<V> out, F func) {
+            internal::check_sizes(a.size(), b.size());
+            internal::check_output(out.size(), a.size());
+            T* left = a.data();
+            U* right = b.data();
+            V* output = out.data();
+            internal::for_each_range(pool, a.size(), [left, right, output, &func](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    output[i] = func(left[i], right[i]);
+            });
+        }
+
+        template<typename T, typename U, typename V, typename F>
+        void transform(span<T> a, span<U> b, span<V> out, F func) {
+            transform(get_thread_pool(), a, b, out, func);
+        }
+    }
+}
+
+#endif //LAMBDACOMMON_PARALLEL_H
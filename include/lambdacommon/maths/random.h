@@ -0,0 +1,539 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_RANDOM_H
+#define LAMBDACOMMON_RANDOM_H
+
+#include "tables.h"
+#include "geometry/vec.h"
+#include <cmath>
+
+/*
+ * random.h
+ *
+ * Random generators and distributions for simulations: fast, deterministic on every platform for a given seed, but not
+ * suitable for cryptography.
+ * The generators satisfy UniformRandomBitGenerator, so they also work with the std distributions.
+ */
+
+namespace lambdacommon::maths::random
+{
+    namespace internal
+    {
+        constexpr u64 rotl(u64 x, u32 k) {
+            return (x << k) | (x >> (64u - k));
+        }
+
+        constexpr u64 splitmix64(u64& state) {
+            u64 z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31u);
+        }
+
+        /*!
+         * Multiplies two 64-bit integers into a 128-bit product.
+         * @param a The left operand.
+         * @param b The right operand.
+         * @param high The high half of the product.
+         * @return The low half of the product.
+         */
+        constexpr u64 multiply_full(u64 a, u64 b, u64& high) {
+#ifdef __SIZEOF_INT128__
+            __extension__ typedef unsigned __int128 native_u128;
+            auto product = static_cast<native_u128>(a) * b;
+            high = static_cast<u64>(product >> 64u);
+            return static_cast<u64>(product);
+#else
+            u64 low_low = (a & 0xFFFFFFFFu) * (b & 0xFFFFFFFFu), high_low = (a >> 32u) * (b & 0xFFFFFFFFu);
+            u64 low_high = (a & 0xFFFFFFFFu) * (b >> 32u), high_high = (a >> 32u) * (b >> 32u);
+            u64 cross = (low_low >> 32u) + (high_low & 0xFFFFFFFFu) + low_high;
+            high = high_high + (high_low >> 32u) + (cross >> 32u);
+            return (cross << 32u) | (low_low & 0xFFFFFFFFu);
+#endif
+        }
+
+        struct uint128
+        {
+            u64 high;
+            u64 low;
+
+            friend constexpr uint128 operator+(const uint128& a, const uint128& b) {
+                u64 low = a.low + b.low;
+                return {a.high + b.high + (low < a.low), low};
+            }
+
+            friend constexpr uint128 operator*(const uint128& a, const uint128& b) {
+                u64 high = 0;
+                u64 low = multiply_full(a.low, b.low, high);
+                return {high + a.high * b.low + a.low * b.high, low};
+            }
+
+            friend constexpr bool operator==(const uint128& a, const uint128& b) {
+                return a.high == b.high && a.low == b.low;
+            }
+
+            friend constexpr bool operator!=(const uint128& a, const uint128& b) {
+                return !(a == b);
+            }
+        };
+
+        /*!
+         * Gets a double in [0, 1) from the 53 high bits of an integer.
+         */
+        constexpr f64 to_unit_f64(u64 bits) {
+            return static_cast<f64>(bits >> 11u) * 0x1p-53;
+        }
+
+        /*!
+         * Gets a double in (0, 1) from the 52 high bits of an integer, for logarithms.
+         */
+        constexpr f64 to_open_unit_f64(u64 bits) {
+            return (static_cast<f64>(bits >> 12u) + 0.5) * 0x1p-52;
+        }
+
+        /*!
+         * Represents the layers of a ziggurat: x[i] is the right edge of layer i and f[i] the density at x[i].
+         * Layer 0 is the base strip, the area beyond x[1] included.
+         */
+        struct ziggurat
+        {
+            std::array<f64, 257> x;
+            std::array<f64, 257> f;
+        };
+
+        /*!
+         * Builds a ziggurat of 256 layers of the same area (Marsaglia and Tsang).
+         * @param r The right edge of the last layer.
+         * @param v The area of a layer.
+         * @param exponential True for the exponential density exp(-x), false for the normal density exp(-x² / 2).
+         * @return The ziggurat.
+         */
+        constexpr ziggurat make_ziggurat(f64 r, f64 v, bool exponential) {
+            auto density = [exponential](f64 x) { return compile_time::exp(exponential ? -x : -x * x / 2); };
+            auto inverse = [exponential](f64 y) {
+                return exponential ? -compile_time::log(y) : compile_time::sqrt(-2 * compile_time::log(y));
+            };
+            ziggurat result{};
+            result.x[0] = v / density(r);
+            result.x[1] = r;
+            for (size_t i = 2; i < 256; i++)
+                result.x[i] = inverse(v / result.x[i - 1] + density(result.x[i - 1]));
+            result.x[256] = 0;
+            for (size_t i = 0; i < 257; i++)
+                result.f[i] = density(result.x[i]);
+            return result;
+        }
+
+        inline constexpr ziggurat NORMAL_ZIGGURAT = make_ziggurat(3.6541528853610088, 0.00492867323399, false);
+        inline constexpr ziggurat EXPONENTIAL_ZIGGURAT = make_ziggurat(7.69711747013104972, 0.0039496598225815571993, true);
+    }
+
+    /*!
+     * Represents a xoshiro256++ generator (Blackman and Vigna): 256 bits of state, a period of 2^256 - 1.
+     */
+    class xoshiro256pp
+    {
+    private:
+        u64 _state[4];
+
+    public:
+        typedef u64 result_type;
+
+        static constexpr u64 DEFAULT_SEED = 0x853C49E6748FEA9Bull;
+
+        /*!
+         * Seeds the generator, the state is expanded from the seed with SplitMix64.
+         * @param seed The seed.
+         */
+        constexpr explicit xoshiro256pp(u64 seed = DEFAULT_SEED) : _state() {
+            for (auto& word : _state)
+                word = internal::splitmix64(seed);
+        }
+
+        /*!
+         * Sets the state of the generator, which must not be only zeros.
+         */
+        constexpr xoshiro256pp(u64 s0, u64 s1, u64 s2, u64 s3) : _state{s0, s1, s2, s3} {}
+
+        static constexpr u64 min() {
+            return 0;
+        }
+
+        static constexpr u64 max() {
+            return std::numeric_limits<u64>::max();
+        }
+
+        constexpr u64 operator()() {
+            u64 result = internal::rotl(_state[0] + _state[3], 23) + _state[0];
+            u64 t = _state[1] << 17u;
+            _state[2] ^= _state[0];
+            _state[3] ^= _state[1];
+            _state[1] ^= _state[2];
+            _state[0] ^= _state[3];
+            _state[2] ^= t;
+            _state[3] = internal::rotl(_state[3], 45);
+            return result;
+        }
+
+    private:
+        constexpr void jump(const u64 (& polynomial)[4]) {
+            u64 state[4] = {};
+            for (u64 word : polynomial)
+                for (u32 bit = 0; bit < 64; bit++) {
+                    if (word & (u64{1} << bit))
+                        for (size_t i = 0; i < 4; i++)
+                            state[i] ^= _state[i];
+                    (*this)();
+                }
+            for (size_t i = 0; i < 4; i++)
+                _state[i] = state[i];
+        }
+
+    public:
+        /*!
+         * Advances the generator by 2^128 outputs: jumping k times gives the k-th of 2^128 non-overlapping streams,
+         * for example one per thread.
+         */
+        constexpr void jump() {
+            constexpr u64 JUMP[4] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+            jump(JUMP);
+        }
+
+        /*!
+         * Advances the generator by 2^192 outputs, to split streams which are then split with jump().
+         */
+        constexpr void long_jump() {
+            constexpr u64 LONG_JUMP[4] = {0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull, 0x77710069854EE241ull, 0x39109BB02ACBE635ull};
+            jump(LONG_JUMP);
+        }
+
+        /*!
+         * Gets the 4 words of the state.
+         */
+        constexpr const u64* get_state() const {
+            return _state;
+        }
+
+        friend constexpr bool operator==(const xoshiro256pp& a, const xoshiro256pp& b) {
+            return a._state[0] == b._state[0] && a._state[1] == b._state[1] && a._state[2] == b._state[2] && a._state[3] == b._state[3];
+        }
+
+        friend constexpr bool operator!=(const xoshiro256pp& a, const xoshiro256pp& b) {
+            return !(a == b);
+        }
+    };
+
+    /*!
+     * Represents a PCG64 generator (O'Neill): a 128-bit linear congruential generator with the XSL RR output function.
+     * Every stream has a period of 2^128 and advance() skips ahead in logarithmic time.
+     */
+    class pcg64
+    {
+    private:
+        static constexpr internal::uint128 MULTIPLIER = {0x2360ED051FC65DA4ull, 0x4385DF649FCCF645ull};
+
+        internal::uint128 _state;
+        internal::uint128 _increment;
+
+        constexpr void step() {
+            _state = _state * MULTIPLIER + _increment;
+        }
+
+    public:
+        typedef u64 result_type;
+
+        static constexpr u64 DEFAULT_SEED = 0xCAFEF00DD15EA5E5ull;
+
+        /*!
+         * Seeds the generator.
+         * @param seed The seed.
+         * @param stream The stream, generators of different streams give unrelated outputs from the same seed.
+         */
+        constexpr explicit pcg64(u64 seed = DEFAULT_SEED, u64 stream = 0) : _state{0, 0}, _increment{stream >> 63u, (stream << 1u) | 1u} {
+            step();
+            _state = _state + internal::uint128{0, seed};
+            step();
+        }
+
+        static constexpr u64 min() {
+            return 0;
+        }
+
+        static constexpr u64 max() {
+            return std::numeric_limits<u64>::max();
+        }
+
+        constexpr u64 operator()() {
+            step();
+            u64 value = _state.high ^ _state.low;
+            u32 rotation = static_cast<u32>(_state.high >> 58u);
+            return (value >> rotation) | (value << ((64u - rotation) & 63u));
+        }
+
+        /*!
+         * Advances the generator as if it was called a count of times.
+         * @param delta The count of outputs to skip.
+         */
+        constexpr void advance(u64 delta) {
+            internal::uint128 multiplier = MULTIPLIER, increment = _increment;
+            internal::uint128 accumulated_multiplier{0, 1}, accumulated_increment{0, 0};
+            while (delta) {
+                if (delta & 1u) {
+                    accumulated_multiplier = accumulated_multiplier * multiplier;
+                    accumulated_increment = accumulated_increment * multiplier + increment;
+                }
+                increment = (multiplier + internal::uint128{0, 1}) * increment;
+                multiplier = multiplier * multiplier;
+                delta >>= 1u;
+            }
+            _state = accumulated_multiplier * _state + accumulated_increment;
+        }
+
+        friend constexpr bool operator==(const pcg64& a, const pcg64& b) {
+            return a._state == b._state && a._increment == b._increment;
+        }
+
+        friend constexpr bool operator!=(const pcg64& a, const pcg64& b) {
+            return !(a == b);
+        }
+    };
+
+    /*!
+     * Represents 8 interleaved xoshiro256++ generators, advanced together by the batch kernels to fill whole buffers.
+     * Lane i starts from the state of the seed generator jumped i times, the output interleaves the lanes: it is the same on
+     * every instruction set and the same whether it is drawn one by one or by buffers.
+     */
+    class LAMBDACOMMON_API xoshiro256pp_x8
+    {
+    public:
+        typedef u64 result_type;
+
+        static constexpr size_t LANES = 8;
+
+    private:
+        static constexpr size_t BUFFER_SIZE = LANES * 32;
+
+        u64 _state[4 * LANES];
+        u64 _buffer[BUFFER_SIZE];
+        size_t _position = BUFFER_SIZE;
+
+        void refill();
+
+    public:
+        explicit xoshiro256pp_x8(u64 seed = xoshiro256pp::DEFAULT_SEED);
+
+        /*!
+         * Creates the lanes from a generator, call long_jump() on it between two threads to give each one its own streams.
+         * @param generator The generator of the first lane.
+         */
+        explicit xoshiro256pp_x8(xoshiro256pp generator);
+
+        static constexpr u64 min() {
+            return 0;
+        }
+
+        static constexpr u64 max() {
+            return std::numeric_limits<u64>::max();
+        }
+
+        inline u64 operator()() {
+            if (_position == BUFFER_SIZE)
+                refill();
+            return _buffer[_position++];
+        }
+
+        void fill(u64* out, size_t count);
+
+        /*!
+         * Fills a buffer with floats uniformly distributed in [0, 1).
+         */
+        void fill_uniform(f32* out, size_t count);
+
+        /*!
+         * Fills a buffer with doubles uniformly distributed in [0, 1).
+         */
+        void fill_uniform(f64* out, size_t count);
+
+        void fill_normal(f32* out, size_t count, f32 mean = 0.f, f32 standard_deviation = 1.f);
+
+        void fill_exponential(f32* out, size_t count, f32 lambda = 1.f);
+    };
+
+    /*
+     * Distributions, over any generator of 64-bit integers.
+     */
+
+    /*!
+     * Gets a float uniformly distributed in [0, 1).
+     */
+    template<typename Generator>
+    constexpr f32 uniform_f32(Generator& generator) {
+        return static_cast<f32>(generator() >> 40u) * 0x1p-24f;
+    }
+
+    /*!
+     * Gets a double uniformly distributed in [0, 1).
+     */
+    template<typename Generator>
+    constexpr f64 uniform_f64(Generator& generator) {
+        return internal::to_unit_f64(generator());
+    }
+
+    /*!
+     * Gets a number uniformly distributed in [min, max).
+     */
+    template<typename T, typename Generator>
+    constexpr T uniform_real(Generator& generator, T min, T max) {
+        static_assert(std::is_floating_point_v<T>, "uniform_real requires a floating point type.");
+        if constexpr (std::is_same_v<T, f32>)
+            return min + (max - min) * uniform_f32(generator);
+        else
+            return min + (max - min) * static_cast<T>(uniform_f64(generator));
+    }
+
+    /*!
+     * Gets an integer uniformly distributed in [min, max], without bias and usually without division (Lemire).
+     */
+    template<typename T, typename Generator>
+    constexpr T uniform_int(Generator& generator, T min, T max) {
+        static_assert(std::is_integral_v<T> && sizeof(T) <= sizeof(u64), "uniform_int requires an integer type of 64 bits at most.");
+        typedef std::make_unsigned_t<T> unsigned_type;
+        u64 range = static_cast<u64>(static_cast<unsigned_type>(static_cast<unsigned_type>(max) - static_cast<unsigned_type>(min))) + 1;
+        if (range == 0)
+            return static_cast<T>(generator());
+        u64 high = 0;
+        u64 low = internal::multiply_full(generator(), range, high);
+        if (low < range) {
+            u64 threshold = (0 - range) % range;
+            while (low < threshold)
+                low = internal::multiply_full(generator(), range, high);
+        }
+        return static_cast<T>(static_cast<unsigned_type>(static_cast<unsigned_type>(min) + high));
+    }
+
+    /*!
+     * Gets a number from the standard normal distribution with the ziggurat method.
+     */
+    template<typename Generator>
+    f64 normal(Generator& generator) {
+        auto& table = internal::NORMAL_ZIGGURAT;
+        for (;;) {
+            u64 bits = generator();
+            size_t layer = bits & 0xFFu;
+            f64 u = 2 * internal::to_unit_f64(bits) - 1;
+            f64 x = u * table.x[layer];
+            if (std::abs(x) < table.x[layer + 1])
+                return x;
+            if (layer == 0) {
+                // The tail beyond R, sampled with Marsaglia's method.
+                f64 tail_x, tail_y;
+                do {
+                    tail_x = std::log(internal::to_open_unit_f64(generator())) / table.x[1];
+                    tail_y = std::log(internal::to_open_unit_f64(generator()));
+                } while (-2 * tail_y < tail_x * tail_x);
+                return u < 0 ? tail_x - table.x[1] : table.x[1] - tail_x;
+            }
+            if (table.f[layer + 1] + (table.f[layer] - table.f[layer + 1]) * uniform_f64(generator) < std::exp(-x * x / 2))
+                return x;
+        }
+    }
+
+    template<typename T, typename Generator>
+    T normal(Generator& generator, T mean, T standard_deviation) {
+        return mean + standard_deviation * static_cast<T>(normal(generator));
+    }
+
+    /*!
+     * Gets a number from the exponential distribution with the ziggurat method.
+     * @param lambda The rate, the inverse of the mean.
+     */
+    template<typename T = f64, typename Generator>
+    T exponential(Generator& generator, T lambda = 1) {
+        auto& table = internal::EXPONENTIAL_ZIGGURAT;
+        for (;;) {
+            u64 bits = generator();
+            size_t layer = bits & 0xFFu;
+            f64 x = internal::to_unit_f64(bits) * table.x[layer];
+            if (x < table.x[layer + 1])
+                return static_cast<T>(x) / lambda;
+            if (layer == 0)
+                return static_cast<T>(table.x[1] - std::log(internal::to_open_unit_f64(generator()))) / lambda;
+            if (table.f[layer + 1] + (table.f[layer] - table.f[layer + 1]) * uniform_f64(generator) < std::exp(-x))
+                return static_cast<T>(x) / lambda;
+        }
+    }
+
+    /*
+     * Sampling of points and directions.
+     */
+
+    /*!
+     * Gets a point uniformly distributed in a box.
+     * @param min The minimum corner of the box.
+     * @param max The maximum corner of the box.
+     */
+    template<typename T, size_t N, typename Generator>
+    point<T, N> uniform_point(Generator& generator, const point<T, N>& min, const point<T, N>& max) {
+        point<T, N> result = min;
+        for (size_t i = 0; i < N; i++)
+            result[i] = uniform_real(generator, min[i], max[i]);
+        return result;
+    }
+
+    template<typename T, typename Generator>
+    Point2D<T> uniform_point(Generator& generator, const Point2D<T>& min, const Point2D<T>& max) {
+        return to_point2d(uniform_point(generator, to_point(min), to_point(max)));
+    }
+
+    template<typename T, typename Generator>
+    Point3D<T> uniform_point(Generator& generator, const Point3D<T>& min, const Point3D<T>& max) {
+        return to_point3d(uniform_point(generator, to_point(min), to_point(max)));
+    }
+
+    /*!
+     * Gets a 2D vector of length 1 with a uniformly distributed direction.
+     */
+    template<typename T = f32, typename Generator>
+    vec<T, 2> unit_vector2(Generator& generator) {
+        T angle = uniform_real(generator, T(0), static_cast<T>(2 * compile_time::PI));
+        return {std::cos(angle), std::sin(angle)};
+    }
+
+    /*!
+     * Gets a 3D vector of length 1 with a uniformly distributed direction.
+     */
+    template<typename T = f32, typename Generator>
+    vec<T, 3> unit_vector3(Generator& generator) {
+        T z = uniform_real(generator, T(-1), T(1));
+        T angle = uniform_real(generator, T(0), static_cast<T>(2 * compile_time::PI));
+        T radius = std::sqrt(std::max(T(0), 1 - z * z));
+        return {radius * std::cos(angle), radius * std::sin(angle), z};
+    }
+
+    /*!
+     * Gets a point uniformly distributed in the disk of radius 1 centered on the origin.
+     */
+    template<typename T = f32, typename Generator>
+    point<T, 2> in_unit_disk(Generator& generator) {
+        auto direction = unit_vector2<T>(generator) * std::sqrt(uniform_real(generator, T(0), T(1)));
+        return {direction.x, direction.y};
+    }
+
+    /*!
+     * Gets a point uniformly distributed in the ball of radius 1 centered on the origin.
+     */
+    template<typename T = f32, typename Generator>
+    point<T, 3> in_unit_ball(Generator& generator) {
+        auto direction = unit_vector3<T>(generator) * std::cbrt(uniform_real(generator, T(0), T(1)));
+        return {direction.x, direction.y, direction.z};
+    }
+}
+
+#endif //LAMBDACOMMON_RANDOM_H
@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_RECT_PACKER_H
+#define LAMBDACOMMON_RECT_PACKER_H
+
+#include "../sizes.h"
+#include "../system/thread_pool.h"
+#include <optional>
+#include <vector>
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+/*
+ * rect_packer.h
+ *
+ * Packing of rectangles in pages, for texture atlases of glyphs or sprites (Jylänki, "A Thousand Ways to Pack the Bin").
+ */
+
+namespace lambdacommon::maths
+{
+    enum pack_algorithm : u8
+    {
+        /*! Keeps every maximal free rectangle: the densest, slower with many rectangles. */
+        PACK_MAX_RECTS,
+        /*! Keeps the top edge of the packed rectangles: fast, wastes the space under overhangs. */
+        PACK_SKYLINE
+    };
+
+    /*!
+     * The rule choosing where a rectangle goes, the skyline algorithm only supports PACK_BOTTOM_LEFT and PACK_BEST_AREA_FIT
+     * which minimizes the space wasted under the rectangle, and uses PACK_BOTTOM_LEFT for the others.
+     */
+    enum pack_heuristic : u8
+    {
+        /*! The free rectangle whose shorter leftover side is the shortest. */
+        PACK_BEST_SHORT_SIDE_FIT,
+        /*! The free rectangle whose longer leftover side is the shortest. */
+        PACK_BEST_LONG_SIDE_FIT,
+        /*! The smallest free rectangle. */
+        PACK_BEST_AREA_FIT,
+        /*! The lowest position, then the leftmost one (Tetris). */
+        PACK_BOTTOM_LEFT,
+        /*! The position touching the most edges of the page and of the packed rectangles. */
+        PACK_CONTACT_POINT
+    };
+
+    /*!
+     * Represents the place of a rectangle: its page, its position and its size, swapped if it was rotated.
+     */
+    struct packed_rect
+    {
+        u32 page;
+        u32 x;
+        u32 y;
+        u32 width;
+        u32 height;
+        bool rotated;
+
+        bool operator==(const packed_rect& other) const {
+            return page == other.page && x == other.x && y == other.y && width == other.width && height == other.height &&
+                   rotated == other.rotated;
+        }
+    };
+
+    /*!
+     * Represents the options of a packing.
+     */
+    struct pack_options
+    {
+        pack_algorithm algorithm = PACK_MAX_RECTS;
+        pack_heuristic heuristic = PACK_BEST_SHORT_SIDE_FIT;
+        /*! Allows rotating the rectangles by 90 degrees. */
+        bool allow_rotation = true;
+        /*! The space left between two rectangles, not along the edges of the page. */
+        u32 padding = 0;
+        /*! The maximum count of pages, 0 for no limit. */
+        u32 max_pages = 0;
+    };
+
+    /*!
+     * Represents the result of an offline packing.
+     */
+    struct pack_result
+    {
+        /*! The places of the rectangles in the input order, std::nullopt for the ones which could not be placed. */
+        std::vector<std::optional<packed_rect>> rects;
+        u32 pages = 0;
+        /*! The area of the packed rectangles divided by the area of the pages. */
+        f64 occupancy = 0;
+        /*! The options of the packing kept. */
+        pack_options chosen;
+    };
+
+    /*!
+     * Represents a packer placing rectangles one by one in pages of the same size, opening pages as they are needed.
+     */
+    class LAMBDACOMMON_API rect_packer
+    {
+    private:
+        struct rect
+        {
+            u32 x, y, width, height;
+        };
+
+        struct skyline_node
+        {
+            u32 x, y, width;
+        };
+
+        struct page
+        {
+            std::vector<rect> free;
+            std::vector<rect> used;
+            std::vector<skyline_node> skyline;
+            u64 used_area = 0;
+        };
+
+        struct candidate
+        {
+            rect place;
+            bool rotated;
+            /*! The skyline node the rectangle starts on. */
+            size_t node;
+            u64 primary, secondary;
+        };
+
+        Size2D<u32> _page_size;
+        pack_options _options;
+        std::vector<page> _pages;
+
+        page new_page() const;
+
+        void find_max_rects(const page& target, u32 width, u32 height, bool rotated, std::optional<candidate>& best) const;
+
+        void find_skyline(const page& target, u32 width, u32 height, bool rotated, std::optional<candidate>& best) const;
+
+        void place_max_rects(page& target, const rect& place);
+
+        void place_skyline(page& target, size_t node, const rect& place);
+
+        std::optional<candidate> find(const page& target, u32 width, u32 height) const;
+
+    public:
+        explicit rect_packer(const Size2D<u32>& page_size, const pack_options& options = {});
+
+        /*!
+         * Places a rectangle in the first open page where it fits, or in a new page.
+         * Empty rectangles take no space and are placed at the origin of the first page.
+         * @param size The size of the rectangle.
+         * @return The place of the rectangle, or std::nullopt if it is larger than a page or all the pages are full.
+         */
+        std::optional<packed_rect> insert(const Size2D<u32>& size);
+
+        void clear();
+
+        const Size2D<u32>& get_page_size() const;
+
+        const pack_options& get_options() const;
+
+        u32 get_page_count() const;
+
+        /*!
+         * Gets the area of the packed rectangles divided by the area of the pages.
+         * @return The occupancy, 0 if there is no page.
+         */
+        f64 get_occupancy() const;
+
+        f64 get_occupancy(u32 page) const;
+
+        /*!
+         * Packs rectangles known in advance: each combination of algorithm, heuristic and sort order of the rectangles
+         * is tried in parallel, the result with the fewest pages and then the smallest bounding box on the last page is
+         * kept. The result does not depend on the count of threads.
+         * @param sizes The sizes of the rectangles.
+         * @param page_size The size of the pages.
+         * @param options The options, the algorithm and the heuristic are ignored.
+         * @param pool The thread pool.
+         * @return The result of the packing.
+         */
+        static pack_result pack(const std::vector<Size2D<u32>>& sizes, const Size2D<u32>& page_size, const pack_options& options,
+                           system::thread_pool& pool);
+
+        /*!
+         * Packs rectangles known in advance with the thread pool of maths::parallel.
+         */
+        static pack_result pack(const std::vector<Size2D<u32>>& sizes, const Size2D<u32>& page_size, const pack_options& options = {});
+    };
+}
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_RECT_PACKER_H
@@ -0,0 +1,258 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_SOA_H
+#define LAMBDACOMMON_SOA_H
+
+#include "geometry/transform.h"
+#include <new>
+#include <vector>
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+namespace lambdacommon::maths
+{
+    /*!
+     * Represents the instruction sets used by the batch kernels, from the slowest to the fastest.
+     */
+    enum simd_level : u8
+    {
+        SIMD_SCALAR = 0,
+        SIMD_SSE2,
+        SIMD_NEON,
+        SIMD_AVX2,
+        SIMD_AVX512
+    };
+
+    /*!
+     * Gets the best instruction set supported by both the processor and the build.
+     * @return The best supported instruction set.
+     */
+    extern simd_level LAMBDACOMMON_API get_supported_simd_level();
+
+    /*!
+     * Gets the instruction set used by the batch kernels, the best supported one by default.
+     * @return The instruction set in use.
+     */
+    extern simd_level LAMBDACOMMON_API get_simd_level();
+
+    /*!
+     * Sets the instruction set used by the batch kernels, mostly to compare them or to test the fallbacks.
+     * @param level The instruction set, lowered to the best supported one.
+     * @return The instruction set in use.
+     */
+    extern simd_level LAMBDACOMMON_API set_simd_level(simd_level level);
+
+    extern const char* LAMBDACOMMON_API get_simd_level_name(simd_level level);
+
+    /*!
+     * Allocates memory aligned for the widest vector registers (64 bytes).
+     * @tparam T The type of the elements.
+     */
+    template<typename T>
+    struct simd_allocator
+    {
+        typedef T value_type;
+        static constexpr size_t ALIGNMENT = 64;
+
+        simd_allocator() = default;
+
+        template<typename U>
+        simd_allocator(const simd_allocator<U>&) noexcept {}
+
+        T* allocate(size_t count) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(ALIGNMENT)));
+        }
+
+        void deallocate(T* pointer, size_t) noexcept {
+            ::operator delete(pointer, std::align_val_t(ALIGNMENT));
+        }
+
+        template<typename U>
+        bool operator==(const simd_allocator<U>&) const noexcept {
+            return true;
+        }
+
+        template<typename U>
+        bool operator!=(const simd_allocator<U>&) const noexcept {
+            return false;
+        }
+    };
+
+    /*!
+     * Represents an array of 3D vectors stored as a structure of arrays: every X, then every Y, then every Z.
+     * This is the layout the batch kernels work on, each register holds the same component of several vectors.
+     * @tparam T The type of the components.
+     */
+    template<typename T>
+    class vec3_soa
+    {
+    public:
+        typedef std::vector<T, simd_allocator<T>> component_array;
+
+    private:
+        component_array _x, _y, _z;
+
+    public:
+        vec3_soa() = default;
+
+        /*!
+         * Creates an array of null vectors.
+         * @param size The count of vectors.
+         */
+        explicit vec3_soa(size_t size) : _x(size), _y(size), _z(size) {}
+
+        inline size_t size() const {
+            return _x.size();
+        }
+
+        inline bool empty() const {
+            return _x.empty();
+        }
+
+        void resize(size_t size) {
+            _x.resize(size);
+            _y.resize(size);
+            _z.resize(size);
+        }
+
+        void reserve(size_t capacity) {
+            _x.reserve(capacity);
+            _y.reserve(capacity);
+            _z.reserve(capacity);
+        }
+
+        void clear() {
+            _x.clear();
+            _y.clear();
+            _z.clear();
+        }
+
+        void push_back(const vec<T, 3>& value) {
+            _x.push_back(value.x);
+            _y.push_back(value.y);
+            _z.push_back(value.z);
+        }
+
+        /*!
+         * Gathers a vector.
+         * @param index The index of the vector.
+         * @return The vector.
+         */
+        inline vec<T, 3> get(size_t index) const {
+            return {_x[index], _y[index], _z[index]};
+        }
+
+        /*!
+         * Scatters a vector.
+         * @param index The index of the vector.
+         * @param value The vector.
+         */
+        inline void set(size_t index, const vec<T, 3>& value) {
+            _x[index] = value.x;
+            _y[index] = value.y;
+            _z[index] = value.z;
+        }
+
+        inline T* x() {
+            return _x.data();
+        }
+
+        inline const T* x() const {
+            return _x.data();
+        }
+
+        inline T* y() {
+            return _y.data();
+        }
+
+        inline const T* y() const {
+            return _y.data();
+        }
+
+        inline T* z() {
+            return _z.data();
+        }
+
+        inline const T* z() const {
+            return _z.data();
+        }
+    };
+
+    /*
+     * Batch kernels: each one processes every vector of its inputs, which must have the same size or std::invalid_argument is thrown.
+     * The output may be one of the inputs, and is resized to the size of the inputs.
+     * They dispatch at runtime to the instruction set returned by get_simd_level().
+     */
+
+    extern void LAMBDACOMMON_API add(const vec3_soa<f32>& a, const vec3_soa<f32>& b, vec3_soa<f32>& out);
+
+    extern void LAMBDACOMMON_API sub(const vec3_soa<f32>& a, const vec3_soa<f32>& b, vec3_soa<f32>& out);
+
+    extern void LAMBDACOMMON_API scale(const vec3_soa<f32>& a, f32 factor, vec3_soa<f32>& out);
+
+    extern void LAMBDACOMMON_API cross(const vec3_soa<f32>& a, const vec3_soa<f32>& b, vec3_soa<f32>& out);
+
+    /*!
+     * Normalizes every vector, null vectors give NaN components like a scalar division would.
+     */
+    extern void LAMBDACOMMON_API normalize(const vec3_soa<f32>& a, vec3_soa<f32>& out);
+
+    extern void LAMBDACOMMON_API dot(const vec3_soa<f32>& a, const vec3_soa<f32>& b, std::vector<f32>& out);
+
+    extern void LAMBDACOMMON_API length(const vec3_soa<f32>& a, std::vector<f32>& out);
+
+    extern void LAMBDACOMMON_API distance(const vec3_soa<f32>& a, const vec3_soa<f32>& b, std::vector<f32>& out);
+
+    /*!
+     * Transforms points by an affine matrix, applying its translation.
+     */
+    extern void LAMBDACOMMON_API transform_points(const mat4f& matrix, const vec3_soa<f32>& points, vec3_soa<f32>& out);
+
+    /*!
+     * Transforms directions by an affine matrix, ignoring its translation.
+     */
+    extern void LAMBDACOMMON_API transform_vectors(const mat4f& matrix, const vec3_soa<f32>& vectors, vec3_soa<f32>& out);
+
+    /*!
+     * Transforms an array of points by an affine matrix, applying its translation.
+     * @param matrix The matrix.
+     * @param points The points.
+     * @param out The transformed points, may be points.
+     * @param count The count of points.
+     */
+    extern void LAMBDACOMMON_API transform_points(const mat4f& matrix, const point3f* points, point3f* out, size_t count);
+
+    /*!
+     * Multiplies matrices by the same matrix, like the local transforms of the children of a node by the transform of the node.
+     * @param a The left matrix.
+     * @param b The right matrices.
+     * @param out The products a * b[i], may be b.
+     * @param count The count of matrices.
+     */
+    extern void LAMBDACOMMON_API multiply(const mat4f& a, const mat4f* b, mat4f* out, size_t count);
+
+    /*!
+     * Multiplies matrices pairwise.
+     * @param a The left matrices.
+     * @param b The right matrices.
+     * @param out The products a[i] * b[i], may be b.
+     * @param count The count of matrices.
+     */
+    extern void LAMBDACOMMON_API multiply(const mat4f* a, const mat4f* b, mat4f* out, size_t count);
+}
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_SOA_H
@@ -0,0 +1,382 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_SOA_EXPRESSION_H
+#define LAMBDACOMMON_SOA_EXPRESSION_H
+
+#include "soa.h"
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+/*
+ * soa_expression.h
+ *
+ * Lazy arithmetic over the arrays of soa.h: `evaluate(a + b - c * k, out)` computes every vector in a single pass, without
+ * any temporary array. The operators only build an expression, which references its operands: it must be evaluated
+ * before they are destroyed or resized, and temporary arrays are rejected.
+ * The pass goes by blocks of a few elements the compiler can keep in vector registers, the functions of map() are inlined
+ * in it like the built-in operations.
+ */
+
+namespace lambdacommon::maths
+{
+    /*!
+     * The base of the expressions: the operators only apply to them and to the arrays, and are found through it.
+     */
+    struct expression_tag
+    {};
+
+    namespace internal
+    {
+        /*! The size of the operands without one, like the constants. */
+        constexpr size_t UNSIZED = std::numeric_limits<size_t>::max();
+
+        /*! The count of elements evaluated at once. */
+        constexpr size_t EXPRESSION_BLOCK = 16;
+
+        template<typename T>
+        class soa_terminal : public expression_tag
+        {
+        private:
+            const T* _x;
+            const T* _y;
+            const T* _z;
+            size_t _size;
+
+        public:
+            explicit soa_terminal(const vec3_soa<T>& array) : _x(array.x()), _y(array.y()), _z(array.z()), _size(array.size()) {}
+
+            inline size_t size() const {
+                return _size;
+            }
+
+            inline vec<T, 3> get(size_t index) const {
+                return {_x[index], _y[index], _z[index]};
+            }
+        };
+
+        template<typename T>
+        class array_terminal : public expression_tag
+        {
+        private:
+            const T* _data;
+            size_t _size;
+
+        public:
+            array_terminal(const T* data, size_t size) : _data(data), _size(size) {}
+
+            inline size_t size() const {
+                return _size;
+            }
+
+            inline T get(size_t index) const {
+                return _data[index];
+            }
+        };
+
+        template<typename T>
+        class constant : public expression_tag
+        {
+        private:
+            T _value;
+
+        public:
+            explicit constant(const T& value) : _value(value) {}
+
+            inline size_t size() const {
+                return UNSIZED;
+            }
+
+            inline T get(size_t) const {
+                return _value;
+            }
+        };
+
+        /*!
+         * Represents a function applied to the elements of its operands.
+         */
+        template<typename F, typename... E>
+        class map_expression : public expression_tag
+        {
+        private:
+            F _func;
+            std::tuple<E...> _operands;
+
+        public:
+            explicit map_expression(F func, E... operands) : _func(std::move(func)), _operands(std::move(operands)...) {}
+
+            inline size_t size() const {
+                return std::apply([](const auto& ... operand) { return std::min({UNSIZED, operand.size()...}); }, _operands);
+            }
+
+            inline auto get(size_t index) const {
+                return std::apply([this, index](const auto& ... operand) { return _func(operand.get(index)...); }, _operands);
+            }
+        };
+
+        template<typename T>
+        struct is_vec : std::false_type
+        {};
+
+        template<typename T, size_t N>
+        struct is_vec<vec<T, N>> : std::true_type
+        {};
+
+        template<typename T>
+        constexpr bool is_expression_v = std::is_base_of_v<expression_tag, std::decay_t<T>>;
+
+        template<typename T>
+        struct is_soa : std::false_type
+        {};
+
+        template<typename T>
+        struct is_soa<vec3_soa<T>> : std::true_type
+        {};
+
+        /*!
+         * Checks whether a type can be an operand: an expression, an array, a number or a vector.
+         */
+        template<typename T>
+        constexpr bool is_operand_v = is_expression_v<T> || is_soa<std::decay_t<T>>::value || std::is_arithmetic_v<std::decay_t<T>> ||
+                                      is_vec<std::decay_t<T>>::value;
+
+        /*!
+         * Checks whether a deduced operand type is a temporary array, which an expression would reference after its destruction.
+         */
+        template<typename T>
+        constexpr bool is_temporary_soa_v = is_soa<std::decay_t<T>>::value && !std::is_lvalue_reference_v<T>;
+
+        /*!
+         * Enables the operators if one of the operands is an expression or an array, the others being operands.
+         * A temporary array is rejected like by lazy().
+         */
+        template<typename... A>
+        using enable_if_lazy = std::enable_if_t<(is_operand_v<A> && ...) && ((is_expression_v<A> || is_soa<std::decay_t<A>>::value) || ...)
+                                                && !(is_temporary_soa_v<A> || ...)>;
+
+        template<typename T>
+        inline auto to_expression(const T& operand) {
+            if constexpr (is_expression_v<T>)
+                return operand;
+            else if constexpr (is_soa<T>::value)
+                return soa_terminal<typename T::component_array::value_type>(operand);
+            else
+                return constant<T>(operand);
+        }
+
+        template<typename F, typename... A>
+        inline auto make_map(F func, const A& ... operands) {
+            return map_expression<F, decltype(to_expression(operands))...>(std::move(func), to_expression(operands)...);
+        }
+
+        struct plus
+        {
+            template<typename A, typename B>
+            inline auto operator()(const A& a, const B& b) const { return a + b; }
+        };
+
+        struct minus
+        {
+            template<typename A, typename B>
+            inline auto operator()(const A& a, const B& b) const { return a - b; }
+        };
+
+        struct multiplies
+        {
+            template<typename A, typename B>
+            inline auto operator()(const A& a, const B& b) const { return a * b; }
+        };
+
+        struct divides
+        {
+            template<typename A, typename B>
+            inline auto operator()(const A& a, const B& b) const { return a / b; }
+        };
+
+        struct negate
+        {
+            template<typename A>
+            inline auto operator()(const A& a) const { return -a; }
+        };
+
+        struct dot_product
+        {
+            template<typename T, size_t N>
+            inline T operator()(const vec<T, N>& a, const vec<T, N>& b) const { return lambdacommon::dot(a, b); }
+        };
+
+        struct cross_product
+        {
+            template<typename T>
+            inline vec<T, 3> operator()(const vec<T, 3>& a, const vec<T, 3>& b) const { return lambdacommon::cross(a, b); }
+        };
+
+        struct length_of
+        {
+            template<typename T, size_t N>
+            inline auto operator()(const vec<T, N>& a) const { return lambdacommon::length(a); }
+        };
+
+        struct normalized
+        {
+            template<typename T, size_t N>
+            inline vec<T, N> operator()(const vec<T, N>& a) const { return lambdacommon::normalize(a); }
+        };
+    }
+
+    /*!
+     * Wraps an array of numbers, like weights, to use it in an expression.
+     * @param data The numbers.
+     * @param size The count of numbers.
+     * @return The expression.
+     */
+    template<typename T>
+    inline internal::array_terminal<T> lazy(const T* data, size_t size) {
+        return {data, size};
+    }
+
+    template<typename T, typename A>
+    inline internal::array_terminal<T> lazy(const std::vector<T, A>& array) {
+        return {array.data(), array.size()};
+    }
+
+    template<typename T>
+    inline internal::soa_terminal<T> lazy(const vec3_soa<T>& array) {
+        return internal::soa_terminal<T>(array);
+    }
+
+    /*!
+     * The expressions reference the arrays, they would dangle on a temporary one.
+     */
+    template<typename T, typename A>
+    internal::array_terminal<T> lazy(const std::vector<T, A>&& array) = delete;
+
+    template<typename T>
+    internal::soa_terminal<T> lazy(const vec3_soa<T>&& array) = delete;
+
+    /*!
+     * Applies a function to the elements of operands, lazily: it gets a vec<T, 3> for an array of vectors and a number for
+     * an array of numbers, and is inlined in the evaluation pass.
+     * @param func The function, taking an element of each operand.
+     * @param operands The operands: expressions, arrays, numbers or vectors, the last two being the same for every element.
+     * @return The expression.
+     */
+    template<typename F, typename... A, typename = internal::enable_if_lazy<A...>>
+    inline auto map(F func, A&& ... operands) {
+        return internal::make_map(std::move(func), operands...);
+    }
+
+    template<typename A, typename B, typename = internal::enable_if_lazy<A, B>>
+    inline auto operator+(A&& a, B&& b) {
+        return internal::make_map(internal::plus{}, a, b);
+    }
+
+    template<typename A, typename B, typename = internal::enable_if_lazy<A, B>>
+    inline auto operator-(A&& a, B&& b) {
+        return internal::make_map(internal::minus{}, a, b);
+    }
+
+    /*!
+     * Multiplies component-wise two vectors, or a vector by a number.
+     */
+    template<typename A, typename B, typename = internal::enable_if_lazy<A, B>>
+    inline auto operator*(A&& a, B&& b) {
+        return internal::make_map(internal::multiplies{}, a, b);
+    }
+
+    template<typename A, typename B, typename = internal::enable_if_lazy<A, B>>
+    inline auto operator/(A&& a, B&& b) {
+        return internal::make_map(internal::divides{}, a, b);
+    }
+
+    template<typename A, typename = internal::enable_if_lazy<A>>
+    inline auto operator-(A&& a) {
+        return internal::make_map(internal::negate{}, a);
+    }
+
+    /*
+     * The vector functions of vec.h, lazily.
+     */
+
+    template<typename A, typename B, typename = internal::enable_if_lazy<A, B>>
+    inline auto dot(A&& a, B&& b) {
+        return internal::make_map(internal::dot_product{}, a, b);
+    }
+
+    template<typename A, typename B, typename = internal::enable_if_lazy<A, B>>
+    inline auto cross(A&& a, B&& b) {
+        return internal::make_map(internal::cross_product{}, a, b);
+    }
+
+    template<typename A, typename = internal::enable_if_lazy<A>>
+    inline auto length(A&& a) {
+        return internal::make_map(internal::length_of{}, a);
+    }
+
+    template<typename A, typename = internal::enable_if_lazy<A>>
+    inline auto normalize(A&& a) {
+        return internal::make_map(internal::normalized{}, a);
+    }
+
+    /*!
+     * Evaluates an expression of vectors in a single pass.
+     * @param expression The expression, its operands should have the same size: it is truncated to the smallest one.
+     * @param out The result, resized to the size of the expression, may be one of the operands.
+     */
+    template<typename E, typename T, typename = std::enable_if_t<internal::is_expression_v<E>>>
+    void evaluate(const E& expression, vec3_soa<T>& out) {
+        static_assert(std::is_convertible_v<decltype(expression.get(0)), vec<T, 3>>, "The expression must give vectors.");
+        size_t size = expression.size();
+        out.resize(size);
+        T* x = out.x(), * y = out.y(), * z = out.z();
+        size_t i = 0;
+        // Each block is computed in arrays on the stack before it is stored, so the compiler does not have to check
+        // whether the output overlaps the operands to vectorize it.
+        for (; i + internal::EXPRESSION_BLOCK <= size; i += internal::EXPRESSION_BLOCK) {
+            T block_x[internal::EXPRESSION_BLOCK], block_y[internal::EXPRESSION_BLOCK], block_z[internal::EXPRESSION_BLOCK];
+            for (size_t j = 0; j < internal::EXPRESSION_BLOCK; j++) {
+                vec<T, 3> value = expression.get(i + j);
+                block_x[j] = value.x;
+                block_y[j] = value.y;
+                block_z[j] = value.z;
+            }
+            std::copy_n(block_x, internal::EXPRESSION_BLOCK, x + i);
+            std::copy_n(block_y, internal::EXPRESSION_BLOCK, y + i);
+            std::copy_n(block_z, internal::EXPRESSION_BLOCK, z + i);
+        }
+        for (; i < size; i++)
+            out.set(i, expression.get(i));
+    }
+
+    /*!
+     * Evaluates an expression of numbers in a single pass.
+     * @param expression The expression, its operands should have the same size: it is truncated to the smallest one.
+     * @param out The result, resized to the size of the expression, may be one of the operands.
+     */
+    template<typename E, typename T, typename A, typename = std::enable_if_t<internal::is_expression_v<E>>>
+    void evaluate(const E& expression, std::vector<T, A>& out) {
+        static_assert(std::is_convertible_v<decltype(expression.get(0)), T>, "The expression must give numbers.");
+        size_t size = expression.size();
+        out.resize(size);
+        T* data = out.data();
+        size_t i = 0;
+        for (; i + internal::EXPRESSION_BLOCK <= size; i += internal::EXPRESSION_BLOCK) {
+            T block[internal::EXPRESSION_BLOCK];
+            for (size_t j = 0; j < internal::EXPRESSION_BLOCK; j++)
+                block[j] = static_cast<T>(expression.get(i + j));
+            std::copy_n(block, internal::EXPRESSION_BLOCK, data + i);
+        }
+        for (; i < size; i++)
+            data[i] = static_cast<T>(expression.get(i));
+    }
+}
+
+#endif //LAMBDACOMMON_SOA_EXPRESSION_H
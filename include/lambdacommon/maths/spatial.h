@@ -0,0 +1,1102 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_SPATIAL_H
+#define LAMBDACOMMON_SPATIAL_H
+
+#include "geometry/vec.h"
+#include "../system/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+/*
+ * spatial.h
+ *
+ * Spatial indexes answering nearest-neighbour, radius and box queries without scanning every element.
+ * Their queries are const and can run concurrently, the batch overloads spread them over a thread pool.
+ * The batch overloads must not be called from a task of the same pool, they wait for their own tasks.
+ */
+
+namespace lambdacommon::maths::spatial
+{
+    /*!
+     * The index returned when a query finds nothing.
+     */
+    constexpr size_t npos = static_cast<size_t>(-1);
+
+    /*!
+     * Represents an axis-aligned bounding box.
+     * @tparam T The type of the coordinates.
+     * @tparam N The count of dimensions.
+     */
+    template<typename T, size_t N>
+    struct aabb
+    {
+        point<T, N> min;
+        point<T, N> max;
+
+        /*!
+         * Gets a box containing nothing, expanding it by a point gives the box of that point.
+         * @return The empty box.
+         */
+        static constexpr aabb empty() {
+            return {point<T, N>::splat(std::numeric_limits<T>::max()), point<T, N>::splat(std::numeric_limits<T>::lowest())};
+        }
+
+        /*!
+         * Gets the box of the points within a distance of a center on every axis.
+         * @param center The center.
+         * @param radius The distance.
+         * @return The box.
+         */
+        static constexpr aabb around(const point<T, N>& center, T radius) {
+            aabb result{center, center};
+            for (size_t i = 0; i < N; i++) {
+                result.min[i] -= radius;
+                result.max[i] += radius;
+            }
+            return result;
+        }
+
+        constexpr bool is_empty() const {
+            for (size_t i = 0; i < N; i++)
+                if (max[i] < min[i])
+                    return true;
+            return false;
+        }
+
+        constexpr void expand(const point<T, N>& p) {
+            for (size_t i = 0; i < N; i++) {
+                if (p[i] < min[i]) min[i] = p[i];
+                if (max[i] < p[i]) max[i] = p[i];
+            }
+        }
+
+        constexpr void expand(const aabb& other) {
+            for (size_t i = 0; i < N; i++) {
+                if (other.min[i] < min[i]) min[i] = other.min[i];
+                if (max[i] < other.max[i]) max[i] = other.max[i];
+            }
+        }
+
+        constexpr point<T, N> center() const {
+            point<T, N> result = min;
+            for (size_t i = 0; i < N; i++)
+                result[i] = (min[i] + max[i]) / 2;
+            return result;
+        }
+
+        constexpr vec<T, N> size() const {
+            return max - min;
+        }
+
+        /*!
+         * Gets the measure of the boundary of the box: its surface area in 3D and its perimeter in 2D.
+         * @return The measure of the boundary, 0 for an empty box.
+         */
+        constexpr T surface_area() const {
+            static_assert(N == 2 || N == 3, "The surface area is only defined for 2D and 3D boxes.");
+            if (is_empty())
+                return 0;
+            auto extent = size();
+            if constexpr (N == 2)
+                return 2 * (extent.x + extent.y);
+            else
+                return 2 * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+        }
+
+        constexpr bool contains(const point<T, N>& p) const {
+            for (size_t i = 0; i < N; i++)
+                if (p[i] < min[i] || max[i] < p[i])
+                    return false;
+            return true;
+        }
+
+        constexpr bool contains(const aabb& other) const {
+            for (size_t i = 0; i < N; i++)
+                if (other.min[i] < min[i] || max[i] < other.max[i])
+                    return false;
+            return true;
+        }
+
+        constexpr bool intersects(const aabb& other) const {
+            for (size_t i = 0; i < N; i++)
+                if (other.max[i] < min[i] || max[i] < other.min[i])
+                    return false;
+            return true;
+        }
+
+        /*!
+         * Gets the squared distance from a point to the box.
+         * @param p The point.
+         * @return The squared distance, 0 if the box contains the point.
+         */
+        constexpr T distance_squared(const point<T, N>& p) const {
+            T result = 0;
+            for (size_t i = 0; i < N; i++) {
+                T d = p[i] < min[i] ? min[i] - p[i] : (max[i] < p[i] ? p[i] - max[i] : 0);
+                result += d * d;
+            }
+            return result;
+        }
+
+        friend constexpr bool operator==(const aabb& a, const aabb& b) {
+            return a.min == b.min && a.max == b.max;
+        }
+
+        friend constexpr bool operator!=(const aabb& a, const aabb& b) {
+            return !(a == b);
+        }
+    };
+
+    typedef aabb<f32, 2> aabb2f;
+    typedef aabb<f32, 3> aabb3f;
+    typedef aabb<f64, 2> aabb2d;
+    typedef aabb<f64, 3> aabb3d;
+
+    namespace internal
+    {
+        template<typename T, size_t N>
+        constexpr T distance_squared(const point<T, N>& a, const point<T, N>& b) {
+            T result = 0;
+            for (size_t i = 0; i < N; i++) {
+                T d = a[i] - b[i];
+                result += d * d;
+            }
+            return result;
+        }
+
+        /*!
+         * Keeps the k nearest candidates in a max-heap on the distance, ties broken by index.
+         */
+        template<typename T>
+        class nearest_heap
+        {
+        private:
+            std::vector<std::pair<T, size_t>>& _heap;
+            size_t _k;
+
+        public:
+            nearest_heap(std::vector<std::pair<T, size_t>>& storage, size_t k) : _heap(storage), _k(k) {
+                _heap.clear();
+            }
+
+            /*!
+             * Gets the distance a candidate must beat to be kept.
+             */
+            inline T worst() const {
+                return _heap.size() < _k ? std::numeric_limits<T>::infinity() : _heap.front().first;
+            }
+
+            inline void push(T distance, size_t index) {
+                if (_heap.size() < _k) {
+                    _heap.emplace_back(distance, index);
+                    std::push_heap(_heap.begin(), _heap.end());
+                } else if (std::pair<T, size_t>{distance, index} < _heap.front()) {
+                    std::pop_heap(_heap.begin(), _heap.end());
+                    _heap.back() = {distance, index};
+                    std::push_heap(_heap.begin(), _heap.end());
+                }
+            }
+
+            /*!
+             * Writes the indices from the nearest to the farthest.
+             */
+            void write(std::vector<size_t>& out) {
+                std::sort_heap(_heap.begin(), _heap.end());
+                out.clear();
+                for (auto& candidate : _heap)
+                    out.push_back(candidate.second);
+            }
+        };
+
+        /*!
+         * Splits [0, count) into chunks run on the pool, or inline when a single chunk is enough.
+         * @param pool The thread pool.
+         * @param count The count of items.
+         * @param func The function called with the bounds of each chunk.
+         */
+        template<typename F>
+        void parallel_chunks(system::thread_pool& pool, size_t count, F func) {
+            constexpr size_t MIN_CHUNK = 64;
+            size_t chunks = std::min(pool.size() * 4, (count + MIN_CHUNK - 1) / MIN_CHUNK);
+            if (chunks <= 1) {
+                func(0, count);
+                return;
+            }
+            std::vector<std::future<void>> futures;
+            futures.reserve(chunks);
+            try {
+                for (size_t i = 0; i < chunks; i++) {
+                    size_t begin = count * i / chunks, end = count * (i + 1) / chunks;
+                    futures.push_back(pool.submit([&func, begin, end]() { func(begin, end); }));
+                }
+            } catch (...) {
+                // The submitted chunks reference this frame, they must end before it unwinds.
+                for (auto& future : futures)
+                    future.wait();
+                throw;
+            }
+            for (auto& future : futures)
+                future.wait();
+            for (auto& future : futures)
+                future.get();
+        }
+    }
+
+    /*!
+     * Represents a static k-d tree over points.
+     * The tree is implicit: the points are reordered so that every subtree is a contiguous range whose median point is
+     * the node, only the split axis of each node is stored. Small ranges are leaves scanned linearly.
+     * @tparam T The type of the coordinates, must be a floating point type.
+     * @tparam N The count of dimensions.
+     */
+    template<typename T, size_t N>
+    class kd_tree
+    {
+        static_assert(std::is_floating_point_v<T>, "kd_tree requires floating point coordinates.");
+
+    public:
+        typedef point<T, N> point_type;
+        typedef aabb<T, N> box_type;
+
+        static constexpr size_t LEAF_SIZE = 8;
+
+    private:
+        std::vector<point_type> _points;
+        std::vector<size_t> _indices;
+        std::vector<u8> _axes;
+
+        struct range
+        {
+            size_t begin;
+            size_t end;
+            T bound;
+        };
+
+        void build(const point_type* points, size_t begin, size_t end) {
+            if (end - begin <= LEAF_SIZE)
+                return;
+            auto bounds = box_type::empty();
+            for (size_t i = begin; i < end; i++)
+                bounds.expand(points[_indices[i]]);
+            auto extent = bounds.size();
+            u8 axis = 0;
+            for (u8 i = 1; i < N; i++)
+                if (extent[axis] < extent[i])
+                    axis = i;
+            size_t middle = begin + (end - begin) / 2;
+            std::nth_element(_indices.begin() + begin, _indices.begin() + middle, _indices.begin() + end, [points, axis](size_t a, size_t b) {
+                return points[a][axis] < points[b][axis];
+            });
+            _axes[middle] = axis;
+            build(points, begin, middle);
+            build(points, middle + 1, end);
+        }
+
+        template<typename Visitor>
+        void visit_nearest(const point_type& p, Visitor& visitor) const {
+            range stack[128];
+            size_t top = 0;
+            stack[top++] = {0, _points.size(), 0};
+            while (top) {
+                auto current = stack[--top];
+                if (current.bound > visitor.worst())
+                    continue;
+                if (current.end - current.begin <= LEAF_SIZE) {
+                    for (size_t i = current.begin; i < current.end; i++)
+                        visitor.push(internal::distance_squared(p, _points[i]), i);
+                    continue;
+                }
+                size_t middle = current.begin + (current.end - current.begin) / 2;
+                u8 axis = _axes[middle];
+                T diff = p[axis] - _points[middle][axis];
+                visitor.push(internal::distance_squared(p, _points[middle]), middle);
+                T far_bound = std::max(current.bound, diff * diff);
+                if (diff < 0) {
+                    stack[top++] = {middle + 1, current.end, far_bound};
+                    stack[top++] = {current.begin, middle, current.bound};
+                } else {
+                    stack[top++] = {current.begin, middle, far_bound};
+                    stack[top++] = {middle + 1, current.end, current.bound};
+                }
+            }
+        }
+
+        template<typename Accept, typename Descend>
+        void visit_ranges(Accept accept, Descend descend) const {
+            range stack[128];
+            size_t top = 0;
+            if (!_points.empty())
+                stack[top++] = {0, _points.size(), 0};
+            while (top) {
+                auto current = stack[--top];
+                if (current.end - current.begin <= LEAF_SIZE) {
+                    for (size_t i = current.begin; i < current.end; i++)
+                        accept(i);
+                    continue;
+                }
+                size_t middle = current.begin + (current.end - current.begin) / 2;
+                u8 axis = _axes[middle];
+                T split = _points[middle][axis];
+                accept(middle);
+                auto sides = descend(axis, split);
+                if (sides.first)
+                    stack[top++] = {current.begin, middle, 0};
+                if (sides.second)
+                    stack[top++] = {middle + 1, current.end, 0};
+            }
+        }
+
+    public:
+        kd_tree() = default;
+
+        /*!
+         * Builds a tree over points.
+         * @param points The points, the queries return their indices in this array.
+         * @param count The count of points.
+         */
+        kd_tree(const point_type* points, size_t count) : _points(count), _indices(count), _axes(count) {
+            std::iota(_indices.begin(), _indices.end(), size_t{0});
+            build(points, 0, count);
+            for (size_t i = 0; i < count; i++)
+                _points[i] = points[_indices[i]];
+        }
+
+        explicit kd_tree(const std::vector<point_type>& points) : kd_tree(points.data(), points.size()) {}
+
+        inline size_t size() const {
+            return _points.size();
+        }
+
+        inline bool empty() const {
+            return _points.empty();
+        }
+
+        /*!
+         * Finds the nearest point.
+         * @param p The query point.
+         * @return The index of the nearest point, or npos if the tree is empty.
+         */
+        size_t nearest(const point_type& p) const {
+            struct
+            {
+                T best = std::numeric_limits<T>::infinity();
+                size_t index = npos;
+
+                inline T worst() const {
+                    return best;
+                }
+
+                inline void push(T distance, size_t i) {
+                    if (distance < best) {
+                        best = distance;
+                        index = i;
+                    }
+                }
+            } visitor;
+            if (!_points.empty())
+                visit_nearest(p, visitor);
+            return visitor.index == npos ? npos : _indices[visitor.index];
+        }
+
+        /*!
+         * Finds the k nearest points.
+         * @param p The query point.
+         * @param k The count of points to find.
+         * @param out The indices of the points from the nearest to the farthest, fewer than k if the tree is smaller.
+         */
+        void k_nearest(const point_type& p, size_t k, std::vector<size_t>& out) const {
+            std::vector<std::pair<T, size_t>> storage;
+            storage.reserve(k);
+            internal::nearest_heap<T> heap{storage, k};
+            if (k && !_points.empty())
+                visit_nearest(p, heap);
+            heap.write(out);
+            for (auto& index : out)
+                index = _indices[index];
+        }
+
+        /*!
+         * Finds the points within a distance.
+         * @param p The query point.
+         * @param radius The distance.
+         * @param out The indices of the points, in no particular order.
+         */
+        void radius(const point_type& p, T radius, std::vector<size_t>& out) const {
+            out.clear();
+            T squared = radius * radius;
+            visit_ranges([&](size_t i) {
+                if (internal::distance_squared(p, _points[i]) <= squared)
+                    out.push_back(_indices[i]);
+            }, [&](u8 axis, T split) {
+                return std::make_pair(p[axis] - radius <= split, split <= p[axis] + radius);
+            });
+        }
+
+        /*!
+         * Finds the points inside a box, bounds included.
+         * @param box The box.
+         * @param out The indices of the points, in no particular order.
+         */
+        void box(const box_type& box, std::vector<size_t>& out) const {
+            out.clear();
+            visit_ranges([&](size_t i) {
+                if (box.contains(_points[i]))
+                    out.push_back(_indices[i]);
+            }, [&](u8 axis, T split) {
+                return std::make_pair(box.min[axis] <= split, split <= box.max[axis]);
+            });
+        }
+
+        /*!
+         * Finds the nearest point of several query points in parallel.
+         * @param pool The thread pool.
+         * @param points The query points.
+         * @param count The count of query points.
+         * @param out The index of the nearest point of each query point, npos if the tree is empty.
+         */
+        void nearest(system::thread_pool& pool, const point_type* points, size_t count, size_t* out) const {
+            internal::parallel_chunks(pool, count, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    out[i] = nearest(points[i]);
+            });
+        }
+
+        /*!
+         * Finds the k nearest points of several query points in parallel.
+         * @param pool The thread pool.
+         * @param points The query points.
+         * @param count The count of query points.
+         * @param k The count of points to find for each query point.
+         * @param out The k indices of each query point from the nearest to the farthest, padded with npos.
+         */
+        void k_nearest(system::thread_pool& pool, const point_type* points, size_t count, size_t k, size_t* out) const {
+            internal::parallel_chunks(pool, count, [&](size_t begin, size_t end) {
+                std::vector<size_t> result;
+                for (size_t i = begin; i < end; i++) {
+                    k_nearest(points[i], k, result);
+                    std::fill(std::copy(result.begin(), result.end(), out + i * k), out + (i + 1) * k, npos);
+                }
+            });
+        }
+
+        /*!
+         * Finds the points within a distance of several query points in parallel.
+         * @param pool The thread pool.
+         * @param points The query points.
+         * @param count The count of query points.
+         * @param radius The distance.
+         * @param out The indices found for each query point.
+         */
+        void radius(system::thread_pool& pool, const point_type* points, size_t count, T radius, std::vector<std::vector<size_t>>& out) const {
+            out.resize(count);
+            internal::parallel_chunks(pool, count, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    this->radius(points[i], radius, out[i]);
+            });
+        }
+
+        /*!
+         * Finds the points inside several boxes in parallel.
+         * @param pool The thread pool.
+         * @param boxes The boxes.
+         * @param count The count of boxes.
+         * @param out The indices found for each box.
+         */
+        void box(system::thread_pool& pool, const box_type* boxes, size_t count, std::vector<std::vector<size_t>>& out) const {
+            out.resize(count);
+            internal::parallel_chunks(pool, count, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    box(boxes[i], out[i]);
+            });
+        }
+    };
+
+    /*!
+     * Represents a uniform grid of cells hashed by their coordinates, to index moving points.
+     * Moving a point within its cell only updates its position, moving it to another cell is a constant time removal
+     * and insertion. Queries visit the cells overlapping their area, so the cell size should be near the usual query radius.
+     * @tparam T The type of the coordinates, must be a floating point type.
+     * @tparam N The count of dimensions.
+     */
+    template<typename T, size_t N>
+    class spatial_hash
+    {
+        static_assert(std::is_floating_point_v<T>, "spatial_hash requires floating point coordinates.");
+
+    public:
+        typedef point<T, N> point_type;
+        typedef aabb<T, N> box_type;
+        typedef point<i32, N> cell_type;
+
+    private:
+        struct cell_hash
+        {
+            size_t operator()(const cell_type& cell) const {
+                u64 hash = 0;
+                for (size_t i = 0; i < N; i++)
+                    hash = (hash ^ static_cast<u32>(cell[i])) * 0x9E3779B97F4A7C15ull;
+                return static_cast<size_t>(hash ^ (hash >> 32u));
+            }
+        };
+
+        struct entry
+        {
+            size_t id;
+            point_type position;
+        };
+
+        T _cell_size;
+        T _inverse_cell_size;
+        std::unordered_map<cell_type, std::vector<entry>, cell_hash> _cells;
+        std::unordered_map<size_t, cell_type> _locations;
+
+        template<typename F>
+        void for_each_cell(const cell_type& first, const cell_type& last, F func) const {
+            cell_type cell = first;
+            for (;;) {
+                auto it = _cells.find(cell);
+                if (it != _cells.end())
+                    func(cell, it->second);
+                size_t axis = 0;
+                while (axis < N && cell[axis] == last[axis]) {
+                    cell[axis] = first[axis];
+                    axis++;
+                }
+                if (axis == N)
+                    return;
+                cell[axis]++;
+            }
+        }
+
+    public:
+        /*!
+         * Creates an empty grid.
+         * @param cell_size The size of the cells on every axis.
+         */
+        explicit spatial_hash(T cell_size) : _cell_size(cell_size), _inverse_cell_size(1 / cell_size) {}
+
+        inline T cell_size() const {
+            return _cell_size;
+        }
+
+        inline size_t size() const {
+            return _locations.size();
+        }
+
+        inline bool empty() const {
+            return _locations.empty();
+        }
+
+        /*!
+         * Gets the cell containing a position.
+         * @param position The position.
+         * @return The coordinates of the cell.
+         */
+        cell_type get_cell(const point_type& position) const {
+            cell_type cell;
+            for (size_t i = 0; i < N; i++)
+                cell[i] = static_cast<i32>(std::floor(position[i] * _inverse_cell_size));
+            return cell;
+        }
+
+        /*!
+         * Inserts a point, or moves it if the identifier is already present.
+         * @param id The identifier of the point.
+         * @param position The position of the point.
+         */
+        void insert(size_t id, const point_type& position) {
+            auto cell = get_cell(position);
+            auto location = _locations.find(id);
+            if (location != _locations.end()) {
+                auto& entries = _cells[location->second];
+                auto it = std::find_if(entries.begin(), entries.end(), [id](const entry& e) { return e.id == id; });
+                if (location->second == cell) {
+                    it->position = position;
+                    return;
+                }
+                *it = entries.back();
+                entries.pop_back();
+                if (entries.empty())
+                    _cells.erase(location->second);
+                location->second = cell;
+            } else
+                _locations.emplace(id, cell);
+            _cells[cell].push_back({id, position});
+        }
+
+        /*!
+         * Moves a point, same as insert.
+         */
+        inline void update(size_t id, const point_type& position) {
+            insert(id, position);
+        }
+
+        /*!
+         * Removes a point.
+         * @param id The identifier of the point.
+         * @return True if the point was present, else false.
+         */
+        bool remove(size_t id) {
+            auto location = _locations.find(id);
+            if (location == _locations.end())
+                return false;
+            auto cell = _cells.find(location->second);
+            auto& entries = cell->second;
+            auto it = std::find_if(entries.begin(), entries.end(), [id](const entry& e) { return e.id == id; });
+            *it = entries.back();
+            entries.pop_back();
+            if (entries.empty())
+                _cells.erase(cell);
+            _locations.erase(location);
+            return true;
+        }
+
+        void clear() {
+            _cells.clear();
+            _locations.clear();
+        }
+
+        /*!
+         * Finds the points within a distance.
+         * @param p The query point.
+         * @param radius The distance.
+         * @param out The identifiers of the points, in no particular order.
+         */
+        void radius(const point_type& p, T radius, std::vector<size_t>& out) const {
+            out.clear();
+            T squared = radius * radius;
+            auto bounds = box_type::around(p, radius);
+            for_each_cell(get_cell(bounds.min), get_cell(bounds.max), [&](const cell_type&, const std::vector<entry>& entries) {
+                for (auto& e : entries)
+                    if (internal::distance_squared(p, e.position) <= squared)
+                        out.push_back(e.id);
+            });
+        }
+
+        /*!
+         * Finds the points inside a box, bounds included.
+         * @param box The box.
+         * @param out The identifiers of the points, in no particular order.
+         */
+        void box(const box_type& box, std::vector<size_t>& out) const {
+            out.clear();
+            for_each_cell(get_cell(box.min), get_cell(box.max), [&](const cell_type&, const std::vector<entry>& entries) {
+                for (auto& e : entries)
+                    if (box.contains(e.position))
+                        out.push_back(e.id);
+            });
+        }
+
+        /*!
+         * Finds the k nearest points by searching rings of cells around the query point.
+         * @param p The query point.
+         * @param k The count of points to find.
+         * @param out The identifiers of the points from the nearest to the farthest, fewer than k if the grid is smaller.
+         */
+        void k_nearest(const point_type& p, size_t k, std::vector<size_t>& out) const {
+            std::vector<std::pair<T, size_t>> storage;
+            storage.reserve(k);
+            internal::nearest_heap<T> heap{storage, k};
+            auto visit = [&](const std::vector<entry>& entries) {
+                for (auto& e : entries)
+                    heap.push(internal::distance_squared(p, e.position), e.id);
+            };
+            if (k == 0 || _locations.empty()) {
+                heap.write(out);
+                return;
+            }
+            auto center = get_cell(p);
+            auto ring_of = [&center](const cell_type& cell) {
+                i32 ring = 0;
+                for (size_t i = 0; i < N; i++)
+                    ring = std::max(ring, std::abs(cell[i] - center[i]));
+                return ring;
+            };
+            size_t visited = 0;
+            for (i32 ring = 0;; ring++) {
+                // Once the block of cells around the ring outgrows the grid, scanning the grid is cheaper.
+                u64 block_cells = 1;
+                for (size_t i = 0; i < N; i++)
+                    block_cells *= static_cast<u64>(2 * ring + 1);
+                if (block_cells >= _cells.size()) {
+                    for (auto& cell : _cells)
+                        if (ring_of(cell.first) >= ring)
+                            visit(cell.second);
+                    break;
+                }
+                cell_type first = center, last = center;
+                for (size_t i = 0; i < N; i++) {
+                    first[i] -= ring;
+                    last[i] += ring;
+                }
+                for_each_cell(first, last, [&](const cell_type& cell, const std::vector<entry>& entries) {
+                    if (ring_of(cell) == ring) {
+                        visited += entries.size();
+                        visit(entries);
+                    }
+                });
+                if (visited == _locations.size())
+                    break;
+                // The cells beyond this ring are at least ring cells away from the query point.
+                T reach = ring * _cell_size;
+                if (heap.worst() <= reach * reach)
+                    break;
+            }
+            heap.write(out);
+        }
+
+        /*!
+         * Finds the points within a distance of several query points in parallel.
+         * @param pool The thread pool.
+         * @param points The query points.
+         * @param count The count of query points.
+         * @param radius The distance.
+         * @param out The identifiers found for each query point.
+         */
+        void radius(system::thread_pool& pool, const point_type* points, size_t count, T radius, std::vector<std::vector<size_t>>& out) const {
+            out.resize(count);
+            internal::parallel_chunks(pool, count, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    this->radius(points[i], radius, out[i]);
+            });
+        }
+
+        /*!
+         * Finds the k nearest points of several query points in parallel.
+         * @param pool The thread pool.
+         * @param points The query points.
+         * @param count The count of query points.
+         * @param k The count of points to find for each query point.
+         * @param out The k identifiers of each query point from the nearest to the farthest, padded with npos.
+         */
+        void k_nearest(system::thread_pool& pool, const point_type* points, size_t count, size_t k, size_t* out) const {
+            internal::parallel_chunks(pool, count, [&](size_t begin, size_t end) {
+                std::vector<size_t> result;
+                for (size_t i = begin; i < end; i++) {
+                    k_nearest(points[i], k, result);
+                    std::fill(std::copy(result.begin(), result.end(), out + i * k), out + (i + 1) * k, npos);
+                }
+            });
+        }
+    };
+
+    /*!
+     * Represents a bounding volume hierarchy over boxes, built with the surface area heuristic.
+     * The nodes are stored depth-first: the left child of a node follows it, and leaves reference a contiguous range
+     * of the boxes, which are stored in leaf order.
+     * @tparam T The type of the coordinates, must be a floating point type.
+     * @tparam N The count of dimensions, 2 or 3.
+     */
+    template<typename T, size_t N>
+    class bvh
+    {
+        static_assert(std::is_floating_point_v<T>, "bvh requires floating point coordinates.");
+        static_assert(N == 2 || N == 3, "bvh requires 2D or 3D boxes.");
+
+    public:
+        typedef point<T, N> point_type;
+        typedef aabb<T, N> box_type;
+
+        static constexpr u32 MAX_LEAF_SIZE = 8;
+        static constexpr u32 BINS = 16;
+        /*! Below this depth the nodes are split at the median, which bounds the depth of the traversal stacks. */
+        static constexpr u32 MAX_SAH_DEPTH = 64;
+
+    private:
+        struct node
+        {
+            box_type bounds;
+            /*! The first box of a leaf, or the right child of an inner node. */
+            u32 first;
+            /*! The count of boxes of a leaf, 0 for an inner node. */
+            u32 count;
+        };
+
+        std::vector<node> _nodes;
+        std::vector<box_type> _boxes;
+        std::vector<u32> _indices;
+
+        void build(const box_type* boxes, u32 begin, u32 end, u32 depth) {
+            u32 index = static_cast<u32>(_nodes.size());
+            _nodes.push_back({box_type::empty(), begin, end - begin});
+            auto centroids = box_type::empty();
+            for (u32 i = begin; i < end; i++) {
+                _nodes[index].bounds.expand(boxes[_indices[i]]);
+                centroids.expand(boxes[_indices[i]].center());
+            }
+            u32 count = end - begin;
+            if (count <= 2)
+                return;
+
+            // Bins the centroids on every axis and sweeps the bins to find the cheapest split.
+            T best_cost = std::numeric_limits<T>::infinity();
+            size_t best_axis = 0;
+            u32 best_split = 0;
+            for (size_t axis = 0; axis < N && depth < MAX_SAH_DEPTH; axis++) {
+                T extent = centroids.max[axis] - centroids.min[axis];
+                if (extent <= 0)
+                    continue;
+                T scale = BINS / extent;
+                box_type bin_bounds[BINS];
+                u32 bin_counts[BINS] = {};
+                std::fill(std::begin(bin_bounds), std::end(bin_bounds), box_type::empty());
+                for (u32 i = begin; i < end; i++) {
+                    auto& box = boxes[_indices[i]];
+                    auto bin = std::min(BINS - 1, static_cast<u32>((box.center()[axis] - centroids.min[axis]) * scale));
+                    bin_counts[bin]++;
+                    bin_bounds[bin].expand(box);
+                }
+                T left_costs[BINS - 1];
+                auto accumulated = box_type::empty();
+                u32 accumulated_count = 0;
+                for (u32 i = 0; i < BINS - 1; i++) {
+                    accumulated.expand(bin_bounds[i]);
+                    accumulated_count += bin_counts[i];
+                    left_costs[i] = accumulated.surface_area() * accumulated_count;
+                }
+                accumulated = box_type::empty();
+                accumulated_count = 0;
+                for (u32 i = BINS - 1; i > 0; i--) {
+                    accumulated.expand(bin_bounds[i]);
+                    accumulated_count += bin_counts[i];
+                    T cost = left_costs[i - 1] + accumulated.surface_area() * accumulated_count;
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_split = i;
+                    }
+                }
+            }
+
+            // A leaf costs an intersection per box, a split costs a traversal step plus the expected intersections.
+            T area = _nodes[index].bounds.surface_area();
+            bool split_found = best_cost < std::numeric_limits<T>::infinity();
+            if (split_found && area > 0 && 1 + best_cost / area >= count && count <= MAX_LEAF_SIZE)
+                return;
+
+            u32 middle;
+            if (split_found) {
+                T scale = BINS / (centroids.max[best_axis] - centroids.min[best_axis]);
+                T origin = centroids.min[best_axis];
+                auto it = std::partition(_indices.begin() + begin, _indices.begin() + end, [&](u32 i) {
+                    return std::min(BINS - 1, static_cast<u32>((boxes[i].center()[best_axis] - origin) * scale)) < best_split;
+                });
+                middle = static_cast<u32>(it - _indices.begin());
+            } else if (count <= MAX_LEAF_SIZE)
+                return;
+            else
+                // Every centroid is the same or the hierarchy is too deep, any split is as good.
+                middle = begin + count / 2;
+            if (middle == begin || middle == end)
+                middle = begin + count / 2;
+
+            _nodes[index].count = 0;
+            build(boxes, begin, middle, depth + 1);
+            _nodes[index].first = static_cast<u32>(_nodes.size());
+            build(boxes, middle, end, depth + 1);
+        }
+
+        /*!
+         * Visits the leaves whose bounds pass a test.
+         */
+        template<typename Test, typename Visit>
+        void traverse(Test test, Visit visit) const {
+            if (_nodes.empty())
+                return;
+            u32 stack[128];
+            size_t top = 0;
+            stack[top++] = 0;
+            while (top) {
+                u32 index = stack[--top];
+                auto& current = _nodes[index];
+                if (!test(current.bounds))
+                    continue;
+                if (current.count) {
+                    for (u32 i = current.first; i < current.first + current.count; i++)
+                        if (test(_boxes[i]))
+                            visit(i);
+                    continue;
+                }
+                stack[top++] = current.first;
+                stack[top++] = index + 1;
+            }
+        }
+
+    public:
+        bvh() = default;
+
+        /*!
+         * Builds a hierarchy over boxes.
+         * @param boxes The boxes, the queries return their indices in this array.
+         * @param count The count of boxes.
+         */
+        bvh(const box_type* boxes, size_t count) : _boxes(count), _indices(count) {
+            std::iota(_indices.begin(), _indices.end(), 0u);
+            if (count) {
+                _nodes.reserve(2 * count);
+                build(boxes, 0, static_cast<u32>(count), 0);
+            }
+            for (size_t i = 0; i < count; i++)
+                _boxes[i] = boxes[_indices[i]];
+        }
+
+        explicit bvh(const std::vector<box_type>& boxes) : bvh(boxes.data(), boxes.size()) {}
+
+        inline size_t size() const {
+            return _boxes.size();
+        }
+
+        inline bool empty() const {
+            return _boxes.empty();
+        }
+
+        /*!
+         * Gets the bounds of every box.
+         * @return The bounds, empty if there is no box.
+         */
+        box_type get_bounds() const {
+            return _nodes.empty() ? box_type::empty() : _nodes[0].bounds;
+        }
+
+        /*!
+         * Updates the boxes without rebuilding the hierarchy, queries stay exact but slow down if the boxes moved a lot.
+         * @param boxes The new boxes, in the same order and count as those given at construction.
+         */
+        void refit(const box_type* boxes) {
+            for (size_t i = 0; i < _boxes.size(); i++)
+                _boxes[i] = boxes[_indices[i]];
+            // Children are stored after their parent.
+            for (size_t i = _nodes.size(); i-- > 0;) {
+                auto& current = _nodes[i];
+                if (current.count) {
+                    current.bounds = box_type::empty();
+                    for (u32 j = current.first; j < current.first + current.count; j++)
+                        current.bounds.expand(_boxes[j]);
+                } else {
+                    current.bounds = _nodes[i + 1].bounds;
+                    current.bounds.expand(_nodes[current.first].bounds);
+                }
+            }
+        }
+
+        /*!
+         * Finds the boxes intersecting a box, touching included.
+         * @param box The box.
+         * @param out The indices of the boxes, in no particular order.
+         */
+        void query(const box_type& box, std::vector<size_t>& out) const {
+            out.clear();
+            traverse([&](const box_type& bounds) { return bounds.intersects(box); }, [&](u32 i) { out.push_back(_indices[i]); });
+        }
+
+        /*!
+         * Finds the boxes containing a point.
+         * @param p The point.
+         * @param out The indices of the boxes, in no particular order.
+         */
+        void query(const point_type& p, std::vector<size_t>& out) const {
+            out.clear();
+            traverse([&](const box_type& bounds) { return bounds.contains(p); }, [&](u32 i) { out.push_back(_indices[i]); });
+        }
+
+        /*!
+         * Finds the boxes within a distance of a point.
+         * @param p The point.
+         * @param radius The distance.
+         * @param out The indices of the boxes, in no particular order.
+         */
+        void radius(const point_type& p, T radius, std::vector<size_t>& out) const {
+            out.clear();
+            T squared = radius * radius;
+            traverse([&](const box_type& bounds) { return bounds.distance_squared(p) <= squared; }, [&](u32 i) { out.push_back(_indices[i]); });
+        }
+
+        /*!
+         * Finds the k boxes nearest to a point, visiting the nearest nodes first.
+         * @param p The point.
+         * @param k The count of boxes to find.
+         * @param out The indices of the boxes from the nearest to the farthest, fewer than k if the hierarchy is smaller.
+         */
+        void k_nearest(const point_type& p, size_t k, std::vector<size_t>& out) const {
+            std::vector<std::pair<T, size_t>> storage;
+            storage.reserve(k);
+            internal::nearest_heap<T> heap{storage, k};
+            if (k && !_nodes.empty()) {
+                std::pair<T, u32> stack[128];
+                size_t top = 0;
+                stack[top++] = {_nodes[0].bounds.distance_squared(p), 0};
+                while (top) {
+                    auto current = stack[--top];
+                    if (current.first > heap.worst())
+                        continue;
+                    auto& n = _nodes[current.second];
+                    if (n.count) {
+                        for (u32 i = n.first; i < n.first + n.count; i++)
+                            heap.push(_boxes[i].distance_squared(p), _indices[i]);
+                        continue;
+                    }
+                    std::pair<T, u32> left{_nodes[current.second + 1].bounds.distance_squared(p), current.second + 1};
+                    std::pair<T, u32> right{_nodes[n.first].bounds.distance_squared(p), n.first};
+                    if (right.first < left.first)
+                        std::swap(left, right);
+                    stack[top++] = right;
+                    stack[top++] = left;
+                }
+            }
+            heap.write(out);
+        }
+
+        /*!
+         * Finds the boxes intersecting several boxes in parallel.
+         * @param pool The thread pool.
+         * @param boxes The query boxes.
+         * @param count The count of query boxes.
+         * @param out The indices found for each query box.
+         */
+        void query(system::thread_pool& pool, const box_type* boxes, size_t count, std::vector<std::vector<size_t>>& out) const {
+            out.resize(count);
+            internal::parallel_chunks(pool, count, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    query(boxes[i], out[i]);
+            });
+        }
+
+        /*!
+         * Finds the k boxes nearest to several points in parallel.
+         * @param pool The thread pool.
+         * @param points The query points.
+         * @param count The count of query points.
+         * @param k The count of boxes to find for each query point.
+         * @param out The k indices of each query point from the nearest to the farthest, padded with npos.
+         */
+        void k_nearest(system::thread_pool& pool, const point_type* points, size_t count, size_t k, size_t* out) const {
+            internal::parallel_chunks(pool, count, [&](size_t begin, size_t end) {
+                std::vector<size_t> result;
+                for (size_t i = begin; i < end; i++) {
+                    k_nearest(points[i], k, result);
+                    std::fill(std::copy(result.begin(), result.end(), out + i * k), out + (i + 1) * k, npos);
+                }
+            });
+        }
+    };
+
+    typedef kd_tree<f32, 2> kd_tree2f;
+    typedef kd_tree<f32, 3> kd_tree3f;
+    typedef spatial_hash<f32, 2> spatial_hash2f;
+    typedef spatial_hash<f32, 3> spatial_hash3f;
+    typedef bvh<f32, 2> bvh2f;
+    typedef bvh<f32, 3> bvh3f;
+}
+
+#endif //LAMBDACOMMON_SPATIAL_H
@@ -0,0 +1,202 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_TABLES_H
+#define LAMBDACOMMON_TABLES_H
+
+#include "../maths.h"
+#include <array>
+
+/*
+ * tables.h
+ *
+ * Lookup tables generated at compile time: declare them as `static constexpr` and they are stored in the binary
+ * instead of being filled at startup.
+ */
+
+namespace lambdacommon::maths
+{
+    /*!
+     * Transcendental functions usable in constant expressions, to generate tables.
+     * They work in double precision with series expansions, accurate to a few ULP but slow at runtime: use the std
+     * functions or maths::fast there.
+     */
+    namespace compile_time
+    {
+        constexpr f64 PI = 3.14159265358979323846;
+        constexpr f64 LN2 = 0.69314718055994530942;
+
+        /*!
+         * Calculates the square root of a number with Newton's method.
+         * @param number The number, must not be negative.
+         * @return The square root.
+         */
+        constexpr f64 sqrt(f64 number) {
+            if (!(number >= 0.0))
+                return std::numeric_limits<f64>::quiet_NaN();
+            if (number == 0.0 || number > std::numeric_limits<f64>::max())
+                return number;
+            f64 result = number > 1.0 ? number : 1.0;
+            for (;;) {
+                f64 next = 0.5 * (result + number / result);
+                if (next >= result)
+                    return result;
+                result = next;
+            }
+        }
+
+        /*!
+         * Calculates the sine of an angle.
+         * @param radians The angle in radians.
+         * @return The sine.
+         */
+        constexpr f64 sin(f64 radians) {
+            // Reduces to [-pi, pi], then to [-pi/2, pi/2] with sin(x) = sin(pi - x).
+            f64 turns = radians / (2.0 * PI);
+            f64 x = radians - static_cast<f64>(static_cast<i64>(turns + (turns < 0.0 ? -0.5 : 0.5))) * (2.0 * PI);
+            if (x > PI / 2.0)
+                x = PI - x;
+            else if (x < -PI / 2.0)
+                x = -PI - x;
+            f64 square = x * x;
+            f64 term = x;
+            f64 result = x;
+            for (int i = 2; i <= 22; i += 2) {
+                term *= -square / (i * (i + 1));
+                result += term;
+            }
+            return result;
+        }
+
+        /*!
+         * Calculates the cosine of an angle.
+         * @param radians The angle in radians.
+         * @return The cosine.
+         */
+        constexpr f64 cos(f64 radians) {
+            return sin(radians + PI / 2.0);
+        }
+
+        /*!
+         * Calculates the exponential of a number.
+         * @param number The number.
+         * @return e raised to the number.
+         */
+        constexpr f64 exp(f64 number) {
+            if (number > 709.8)
+                return std::numeric_limits<f64>::infinity();
+            if (number < -745.2)
+                return 0.0;
+            // exp(x) = 2^k * exp(r) with |r| <= ln(2) / 2.
+            auto k = static_cast<i32>(number / LN2 + (number < 0.0 ? -0.5 : 0.5));
+            f64 r = (number - k * 6.93147180369123816490e-01) - k * 1.90821492927058770002e-10;
+            f64 term = 1.0;
+            f64 result = 1.0;
+            for (int i = 1; i <= 18; i++) {
+                term *= r / i;
+                result += term;
+            }
+            for (; k > 0; k--)
+                result *= 2.0;
+            for (; k < 0; k++)
+                result *= 0.5;
+            return result;
+        }
+
+        /*!
+         * Calculates the natural logarithm of a number.
+         * @param number The number, must be positive.
+         * @return The natural logarithm, -infinity for 0 and NaN for negative numbers.
+         */
+        constexpr f64 log(f64 number) {
+            if (number == 0.0)
+                return -std::numeric_limits<f64>::infinity();
+            if (!(number > 0.0))
+                return std::numeric_limits<f64>::quiet_NaN();
+            if (number > std::numeric_limits<f64>::max())
+                return number;
+            // log(x) = e * ln(2) + log(m) with m in [sqrt(1/2), sqrt(2)], then log(m) = 2 * atanh((m - 1) / (m + 1)).
+            i32 exponent = 0;
+            f64 mantissa = number;
+            while (mantissa > 1.41421356237309504880) {
+                mantissa *= 0.5;
+                exponent++;
+            }
+            while (mantissa < 0.70710678118654752440) {
+                mantissa *= 2.0;
+                exponent--;
+            }
+            f64 z = (mantissa - 1.0) / (mantissa + 1.0);
+            f64 square = z * z;
+            f64 term = z;
+            f64 result = z;
+            for (int i = 3; i <= 31; i += 2) {
+                term *= square;
+                result += term / i;
+            }
+            return exponent * LN2 + 2.0 * result;
+        }
+
+        /*!
+         * Raises a number to a power.
+         * @param base The base, must not be negative.
+         * @param exponent The exponent.
+         * @return The base raised to the exponent.
+         */
+        constexpr f64 pow(f64 base, f64 exponent) {
+            if (exponent == 0.0)
+                return 1.0;
+            if (base == 0.0)
+                return exponent > 0.0 ? 0.0 : std::numeric_limits<f64>::infinity();
+            return exp(exponent * log(base));
+        }
+    }
+
+    /*!
+     * Generates a lookup table.
+     * @tparam T The type of the entries.
+     * @tparam N The count of entries.
+     * @tparam Generator The type of the generator.
+     * @param generator Returns the entry of an index, must be usable in constant expressions.
+     * @return The table.
+     */
+    template<typename T, size_t N, typename Generator>
+    constexpr std::array<T, N> make_table(Generator generator) {
+        std::array<T, N> table{};
+        for (size_t i = 0; i < N; i++)
+            table[i] = static_cast<T>(generator(i));
+        return table;
+    }
+
+    /*!
+     * Generates a table of the sine over one period: entry i is sin(2 * pi * i / N).
+     * @tparam T The type of the entries.
+     * @tparam N The count of entries, a power of two allows wrapping an index with a mask.
+     * @return The table.
+     */
+    template<typename T, size_t N>
+    constexpr std::array<T, N> make_sin_table() {
+        return make_table<T, N>([](size_t i) {
+            return compile_time::sin(2.0 * compile_time::PI * static_cast<f64>(i) / static_cast<f64>(N));
+        });
+    }
+
+    /*!
+     * Generates a gamma correction table for 8-bit channels: entry i is round(255 * (i / 255) ^ gamma).
+     * @param gamma The exponent, 2.2 to decode and 1 / 2.2 to encode for example.
+     * @return The table.
+     */
+    constexpr std::array<u8, 256> make_gamma_table(f64 gamma) {
+        return make_table<u8, 256>([gamma](size_t i) {
+            return 255.0 * compile_time::pow(static_cast<f64>(i) / 255.0, gamma) + 0.5;
+        });
+    }
+}
+
+#endif //LAMBDACOMMON_TABLES_H
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_THREAD_POOL_H
+#define LAMBDACOMMON_THREAD_POOL_H
+
+#include "../types.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(push)
+#  pragma warning(disable:4251)
+#endif
+
+namespace lambdacommon::system
+{
+    /*!
+     * Represents a fixed-size pool of worker threads running tasks in submission order.
+     */
+    class LAMBDACOMMON_API thread_pool
+    {
+    public:
+        typedef std::function<void()> task;
+
+    private:
+        std::vector<std::thread> _workers;
+        std::deque<task> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _available;
+        bool _stopping = false;
+
+        void work();
+
+    public:
+        /*!
+         * Creates a new thread pool.
+         * @param threads The count of threads, 0 to use one thread per CPU core.
+         */
+        explicit thread_pool(u32 threads = 0);
+
+        thread_pool(const thread_pool& other) = delete;
+
+        /*!
+         * Runs the remaining tasks and joins the threads.
+         */
+        ~thread_pool();
+
+        /*!
+         * Gets the count of threads.
+         * @return The count of threads.
+         */
+        size_t size() const;
+
+        /*!
+         * Queues a task.
+         * @param callback The task.
+         */
+        void post(task callback);
+
+        /*!
+         * Queues a function and gets a future of its result.
+         * @param func The function.
+         * @return The future of the result of the function.
+         */
+        template<typename F>
+        auto submit(F&& func) -> std::future<decltype(func())> {
+            auto packaged = std::make_shared<std::packaged_task<decltype(func())()>>(std::forward<F>(func));
+            auto future = packaged->get_future();
+            post([packaged]() { (*packaged)(); });
+            return future;
+        }
+
+        thread_pool& operator=(const thread_pool& other) = delete;
+    };
+}
+
+#ifdef LAMBDA_WINDOWS
+#  pragma warning(pop)
+#endif
+
+#endif //LAMBDACOMMON_THREAD_POOL_H
@@ -0,0 +1,347 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_URI_ROUTER_H
+#define LAMBDACOMMON_URI_ROUTER_H
+
+#include "../types.h"
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lambdacommon::uri
+{
+    /*!
+     * Represents a captured route parameter, the value is a view of the matched path.
+     */
+    struct route_parameter
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    /*!
+     * Represents the result of a route lookup.
+     * @tparam T The type of the route values.
+     */
+    template<typename T>
+    class route_match
+    {
+    public:
+        static constexpr size_t MAX_PARAMETERS = 16;
+
+    private:
+        const T* _value = nullptr;
+        std::array<route_parameter, MAX_PARAMETERS> _parameters{};
+        size_t _parameter_count = 0;
+
+        template<typename>
+        friend class router;
+
+    public:
+        /*!
+         * Gets the value of the matched route.
+         * @return The value, or nullptr if no route matched.
+         */
+        inline const T* get() const {
+            return _value;
+        }
+
+        inline const T& operator*() const {
+            return *_value;
+        }
+
+        inline const T* operator->() const {
+            return _value;
+        }
+
+        inline explicit operator bool() const {
+            return _value != nullptr;
+        }
+
+        inline size_t get_parameter_count() const {
+            return _parameter_count;
+        }
+
+        inline const route_parameter* begin() const {
+            return _parameters.data();
+        }
+
+        inline const route_parameter* end() const {
+            return _parameters.data() + _parameter_count;
+        }
+
+        /*!
+         * Gets the value of a captured parameter.
+         * @param name The name of the parameter, without the ':' or '*'.
+         * @return The value of the parameter, or an empty optional if the route has no such parameter.
+         */
+        std::optional<std::string_view> get_parameter(std::string_view name) const {
+            for (size_t i = 0; i < _parameter_count; i++)
+                if (_parameters[i].name == name)
+                    return _parameters[i].value;
+            return std::nullopt;
+        }
+    };
+
+    /*!
+     * Dispatches request paths to values with a radix tree per method.
+     *
+     * A route pattern is made of static text, ":name" parameters capturing a non-empty segment and a trailing "*name"
+     * wildcard capturing the rest of the path, for example "/users/:id/files/" followed by "*path". The parameters and the wildcard
+     * must start a segment, elsewhere ':' and '*' are static text.
+     * Static text is preferred over parameters, and parameters over wildcards.
+     * Matching never allocates. It usually costs the length of the path, but a failed static branch is backtracked to try
+     * the parameters and the wildcard, so overlapping routes may visit a segment more than once.
+     * @tparam T The type of the values.
+     */
+    template<typename T>
+    class router
+    {
+    private:
+        static constexpr u32 NO_NODE = ~u32(0);
+
+        struct node
+        {
+            /*!
+             * The static text of the node, empty for parameters and wildcards.
+             */
+            std::string prefix;
+            /*!
+             * The name of the parameter or of the wildcard.
+             */
+            std::string name;
+            /*!
+             * The first character of each static child, in the order of the children.
+             */
+            std::string indices;
+            std::vector<u32> children;
+            u32 parameter = NO_NODE;
+            u32 wildcard = NO_NODE;
+            std::optional<T> value;
+        };
+
+        struct table
+        {
+            std::string method;
+            // Nodes are stored contiguously and linked with indices, the root is always the first node.
+            std::vector<node> nodes;
+        };
+
+        std::vector<table> _tables;
+        size_t _size = 0;
+
+        static size_t common_prefix_length(std::string_view a, std::string_view b) {
+            size_t length = 0;
+            while (length < a.size() && length < b.size() && a[length] == b[length])
+                length++;
+            return length;
+        }
+
+        /*!
+         * Gets the length of the static text at the start of a pattern, up to the next parameter or wildcard.
+         */
+        static size_t static_length(std::string_view pattern) {
+            for (size_t i = 0; i < pattern.size(); i++)
+                if ((pattern[i] == ':' || pattern[i] == '*') && (i == 0 || pattern[i - 1] == '/'))
+                    return i;
+            return pattern.size();
+        }
+
+        static u32 new_node(std::vector<node>& nodes) {
+            nodes.emplace_back();
+            return static_cast<u32>(nodes.size() - 1);
+        }
+
+        /*!
+         * Inserts static text under the given node, splitting the edges as needed.
+         * @return The node ending with the text.
+         */
+        static u32 insert_static(std::vector<node>& nodes, u32 current, std::string_view text) {
+            while (!text.empty()) {
+                auto index = nodes[current].indices.find(text[0]);
+                if (index == std::string::npos) {
+                    u32 child = new_node(nodes);
+                    nodes[child].prefix = std::string(text);
+                    nodes[current].indices += text[0];
+                    nodes[current].children.push_back(child);
+                    return child;
+                }
+
+                u32 child = nodes[current].children[index];
+                size_t common = common_prefix_length(nodes[child].prefix, text);
+                if (common < nodes[child].prefix.size()) {
+                    // Split the edge to the child.
+                    u32 split = new_node(nodes);
+                    nodes[split].prefix = nodes[child].prefix.substr(0, common);
+                    nodes[child].prefix.erase(0, common);
+                    nodes[split].indices += nodes[child].prefix[0];
+                    nodes[split].children.push_back(child);
+                    nodes[current].children[index] = split;
+                    child = split;
+                }
+                current = child;
+                text.remove_prefix(common);
+            }
+            return current;
+        }
+
+        static u32 insert_named(std::vector<node>& nodes, u32 current, u32 node::* link, std::string_view name, std::string_view pattern) {
+            if (name.empty())
+                throw std::invalid_argument("The route '" + std::string(pattern) + "' has an unnamed parameter.");
+            if (nodes[current].*link == NO_NODE) {
+                u32 child = new_node(nodes);
+                nodes[child].name = std::string(name);
+                nodes[current].*link = child;
+            } else if (nodes[nodes[current].*link].name != name)
+                throw std::invalid_argument("The route '" + std::string(pattern) + "' conflicts with the parameter '" + nodes[nodes[current].*link].name + "'.");
+            return nodes[current].*link;
+        }
+
+        table& get_table(std::string_view method) {
+            for (auto& t : _tables)
+                if (t.method == method)
+                    return t;
+            _tables.push_back({std::string(method), std::vector<node>(1)});
+            return _tables.back();
+        }
+
+        static bool match_node(const std::vector<node>& nodes, u32 current, std::string_view path, route_match<T>& result) {
+            const node& n = nodes[current];
+            if (path.empty() && n.value) {
+                result._value = &*n.value;
+                return true;
+            }
+
+            if (!path.empty()) {
+                auto index = n.indices.find(path[0]);
+                if (index != std::string::npos) {
+                    const node& child = nodes[n.children[index]];
+                    if (path.compare(0, child.prefix.size(), child.prefix) == 0 &&
+                        match_node(nodes, n.children[index], path.substr(child.prefix.size()), result))
+                        return true;
+                }
+            }
+
+            if (n.parameter != NO_NODE) {
+                auto segment = path.substr(0, path.find('/'));
+                if (!segment.empty()) {
+                    size_t count = result._parameter_count;
+                    result._parameters[count] = {nodes[n.parameter].name, segment};
+                    result._parameter_count++;
+                    if (match_node(nodes, n.parameter, path.substr(segment.size()), result))
+                        return true;
+                    result._parameter_count = count;
+                }
+            }
+
+            if (n.wildcard != NO_NODE) {
+                result._parameters[result._parameter_count++] = {nodes[n.wildcard].name, path};
+                result._value = &*nodes[n.wildcard].value;
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        /*!
+         * Adds or replaces a route.
+         * @param method The method of the route, or "*" to match any method without a route of its own.
+         * @param pattern The pattern of the route.
+         * @param value The value.
+         */
+        void add(std::string_view method, std::string_view pattern, T value) {
+            auto& nodes = get_table(method).nodes;
+            u32 current = 0;
+            size_t parameters = 0;
+            auto rest = pattern;
+            for (;;) {
+                auto length = static_length(rest);
+                current = insert_static(nodes, current, rest.substr(0, length));
+                rest.remove_prefix(length);
+                if (rest.empty())
+                    break;
+                if (++parameters > route_match<T>::MAX_PARAMETERS)
+                    throw std::invalid_argument("The route '" + std::string(pattern) + "' has too many parameters.");
+
+                auto name_end = rest.find('/');
+                auto name = rest.substr(1, name_end == std::string_view::npos ? std::string_view::npos : name_end - 1);
+                if (rest[0] == '*') {
+                    if (name_end != std::string_view::npos)
+                        throw std::invalid_argument("The wildcard of the route '" + std::string(pattern) + "' is not at the end.");
+                    current = insert_named(nodes, current, &node::wildcard, name.empty() ? "*" : name, pattern);
+                    break;
+                }
+                current = insert_named(nodes, current, &node::parameter, name, pattern);
+                rest.remove_prefix(1 + name.size());
+            }
+            if (!nodes[current].value)
+                _size++;
+            nodes[current].value = std::move(value);
+        }
+
+        /*!
+         * Finds the route matching a path.
+         * @param method The method of the request, its routes take priority over the routes of any method.
+         * @param path The path, the captured parameters are views of it.
+         * @return The match, empty if no route matched.
+         */
+        route_match<T> match(std::string_view method, std::string_view path) const {
+            route_match<T> result;
+            for (const auto& t : _tables)
+                if (t.method == method && match_node(t.nodes, 0, path, result))
+                    return result;
+            result._parameter_count = 0;
+            for (const auto& t : _tables)
+                if (t.method == "*" && match_node(t.nodes, 0, path, result))
+                    return result;
+            return {};
+        }
+
+        /*!
+         * Gets the methods having a route matching a path, for the Allow header of a 405 response.
+         * @param path The path.
+         * @return The methods.
+         */
+        std::vector<std::string_view> get_allowed_methods(std::string_view path) const {
+            std::vector<std::string_view> methods;
+            for (const auto& t : _tables) {
+                route_match<T> result;
+                if (match_node(t.nodes, 0, path, result))
+                    methods.emplace_back(t.method);
+            }
+            return methods;
+        }
+
+        /*!
+         * Gets the count of routes.
+         * @return The count of routes.
+         */
+        size_t size() const {
+            return _size;
+        }
+
+        bool empty() const {
+            return _size == 0;
+        }
+
+        /*!
+         * Removes every route.
+         */
+        void clear() {
+            _tables.clear();
+            _size = 0;
+        }
+    };
+}
+
+#endif //LAMBDACOMMON_URI_ROUTER_H
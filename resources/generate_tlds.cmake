@@ -0,0 +1,34 @@
+# Generates the TLD table included by src/connection/address.cpp from a plain list file.
+#
+# Usage: cmake -DTLDS_INPUT=<tlds.txt> -DTLDS_OUTPUT=<tlds.inc> -P generate_tlds.cmake
+
+if (NOT TLDS_INPUT OR NOT TLDS_OUTPUT)
+    message(FATAL_ERROR "TLDS_INPUT and TLDS_OUTPUT must be defined.")
+endif ()
+
+file(STRINGS ${TLDS_INPUT} TLDS_LINES)
+
+set(TLDS)
+foreach (LINE ${TLDS_LINES})
+    string(STRIP "${LINE}" LINE)
+    if (LINE STREQUAL "" OR LINE MATCHES "^#")
+        continue()
+    endif ()
+    string(TOLOWER "${LINE}" LINE)
+    if (NOT LINE MATCHES "^[a-z0-9-]+$")
+        message(WARNING "Skipping invalid TLD '${LINE}'.")
+        continue()
+    endif ()
+    list(APPEND TLDS "${LINE}")
+endforeach ()
+list(REMOVE_DUPLICATES TLDS)
+list(SORT TLDS)
+list(LENGTH TLDS TLDS_COUNT)
+
+set(TLDS_CONTENT "// Generated by resources/generate_tlds.cmake from resources/tlds.txt, do not edit.\n// ${TLDS_COUNT} top-level domains.\n")
+foreach (TLD ${TLDS})
+    string(APPEND TLDS_CONTENT "\"${TLD}\",\n")
+endforeach ()
+
+file(WRITE ${TLDS_OUTPUT} "${TLDS_CONTENT}")
+message(STATUS "Generated ${TLDS_OUTPUT} with ${TLDS_COUNT} top-level domains.")
@@ -0,0 +1,441 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+/*
+ * A static file server serving a FileResourcesManager tree over HTTP/1.1.
+ *
+ * Usage: lambdacommon_static_server <root directory> [port] [threads] [default domain]
+ *
+ * A request path "/<domain>/<name>" is mapped to the resource "<domain>:<name>", a path with a single segment or ending
+ * with a slash uses the default domain and "index.html". Each thread runs its own event loop with its own listener
+ * sharing the port (SO_REUSEPORT), its own connections and its own cache, so the threads never share any state.
+ * Small files are served from an LRU cache, the other files are sent with sendfile.
+ */
+
+#include <lambdacommon/connection/event_loop.h>
+#include <lambdacommon/connection/http.h>
+#include <lambdacommon/resources.h>
+#include <atomic>
+#include <cctype>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace lambdacommon;
+using namespace lambdacommon::connection;
+
+#define MAX_CACHED_FILE_SIZE 65536
+#define CACHE_CAPACITY (32 * 1048576)
+#define READ_BUFFER_SIZE 16384
+
+static std::atomic_bool stop_requested{false};
+
+static std::string_view get_content_type(std::string_view path) {
+    static const std::pair<std::string_view, std::string_view> TYPES[] = {
+            {".html", "text/html; charset=utf-8"},
+            {".css",  "text/css; charset=utf-8"},
+            {".js",   "application/javascript"},
+            {".json", "application/json"},
+            {".txt",  "text/plain; charset=utf-8"},
+            {".svg",  "image/svg+xml"},
+            {".png",  "image/png"},
+            {".jpg",  "image/jpeg"},
+            {".ico",  "image/x-icon"},
+            {".wasm", "application/wasm"}
+    };
+    for (auto[extension, type] : TYPES)
+        if (lstring::ends_with_ignore_case(std::string(path), std::string(extension)))
+            return type;
+    return "application/octet-stream";
+}
+
+/*!
+ * Decodes the percent-encoded bytes of a path.
+ * @return The decoded path, or an empty optional if the path is malformed.
+ */
+static std::optional<std::string> decode_path(std::string_view path) {
+    std::string result;
+    result.reserve(path.size());
+    for (size_t i = 0; i < path.size(); i++) {
+        if (path[i] != '%') {
+            result += path[i];
+            continue;
+        }
+        if (i + 2 >= path.size() || !std::isxdigit(static_cast<u8>(path[i + 1])) || !std::isxdigit(static_cast<u8>(path[i + 2])))
+            return std::nullopt;
+        auto byte = static_cast<char>(std::stoi(std::string(path.substr(i + 1, 2)), nullptr, 16));
+        if (byte == '\0')
+            return std::nullopt;
+        result += byte;
+        i += 2;
+    }
+    return result;
+}
+
+/*!
+ * Maps a request path to a resource identifier.
+ * @return The identifier, or an empty optional if the path tries to escape the resources tree.
+ */
+static std::optional<Identifier> to_identifier(std::string_view target_path, const std::string& default_domain) {
+    auto path = decode_path(target_path);
+    if (!path || path->empty() || path->front() != '/')
+        return std::nullopt;
+    // An empty segment would make the name absolute and replace the root of the resources once joined.
+    for (const auto& segment : lstring::split(path->substr(1), '/'))
+        if (segment.empty() || segment == "." || segment == ".." || segment.find('\\') != std::string::npos)
+            return std::nullopt;
+
+    auto name = path->substr(1);
+    if (name.empty() || name.back() == '/')
+        name += "index.html";
+    if (name.front() == '/' || name.find('\\') != std::string::npos)
+        return std::nullopt;
+    auto separator = name.find('/');
+    if (separator == std::string::npos)
+        return Identifier{default_domain, name};
+    return Identifier{name.substr(0, separator), name.substr(separator + 1)};
+}
+
+/*!
+ * Checks whether a path resolves, symbolic links included, inside a directory.
+ * @param root The resolved directory, ending with a slash.
+ */
+static bool is_inside(const std::string& root, const std::string& path) {
+    char resolved[PATH_MAX];
+    if (::realpath(path.c_str(), resolved) == nullptr)
+        return false;
+    return lstring::starts_with(resolved, root);
+}
+
+/*!
+ * Represents a LRU cache of small files, owned by a single event loop.
+ */
+class file_cache
+{
+private:
+    typedef std::chrono::steady_clock clock;
+
+    struct entry
+    {
+        std::string path;
+        std::string content;
+        time_t modified;
+        clock::time_point checked;
+    };
+
+    std::list<entry> _entries;
+    std::unordered_map<std::string_view, std::list<entry>::iterator> _index;
+    size_t _size = 0;
+    size_t _capacity;
+
+public:
+    explicit file_cache(size_t capacity) : _capacity(capacity) {}
+
+    /*!
+     * Gets a cached file, revalidated against the file system at most once per second.
+     */
+    const std::string* get(const std::string& path) {
+        auto it = _index.find(path);
+        if (it == _index.end())
+            return nullptr;
+        auto now = clock::now();
+        auto& cached = *it->second;
+        if (cached.checked + std::chrono::seconds(1) < now) {
+            struct stat status{};
+            if (::stat(path.c_str(), &status) == -1 || status.st_mtime != cached.modified ||
+                static_cast<size_t>(status.st_size) != cached.content.size()) {
+                _size -= cached.content.size();
+                auto entry_it = it->second;
+                _index.erase(it);
+                _entries.erase(entry_it);
+                return nullptr;
+            }
+            cached.checked = now;
+        }
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return &cached.content;
+    }
+
+    const std::string& put(const std::string& path, std::string content, time_t modified) {
+        while (!_entries.empty() && _size + content.size() > _capacity) {
+            _size -= _entries.back().content.size();
+            _index.erase(_entries.back().path);
+            _entries.pop_back();
+        }
+        _size += content.size();
+        _entries.push_front({path, std::move(content), modified, clock::now()});
+        _index[_entries.front().path] = _entries.begin();
+        return _entries.front().content;
+    }
+};
+
+/*!
+ * Represents a client connection and its pending response.
+ */
+struct client
+{
+    tcp_stream stream;
+    std::string input;
+    http::request_parser parser;
+    std::string output;
+    size_t output_offset = 0;
+    int file_fd = -1;
+    u64 file_offset = 0;
+    u64 file_remaining = 0;
+    bool close_after = false;
+
+    explicit client(tcp_stream stream) : stream(std::move(stream)) {}
+
+    ~client() {
+        if (file_fd != -1)
+            ::close(file_fd);
+    }
+};
+
+/*!
+ * Represents the state of a single event loop: its listener, its clients and its cache.
+ */
+class server_worker
+{
+private:
+    event_loop& _loop;
+    FileResourcesManager _resources;
+    std::string _root;
+    std::string _default_domain;
+    tcp_listener _listener;
+    std::unordered_map<int, std::unique_ptr<client>> _clients;
+    file_cache _cache{CACHE_CAPACITY};
+
+    void write_head(client& client, u16 status, std::string_view reason, std::string_view content_type, u64 length) {
+        client.output += "HTTP/1.1 ";
+        client.output += std::to_string(status);
+        client.output += ' ';
+        client.output += reason;
+        client.output += "\r\nServer: lambdacommon\r\nContent-Type: ";
+        client.output += content_type;
+        client.output += "\r\nContent-Length: ";
+        client.output += std::to_string(length);
+        client.output += client.close_after ? "\r\nConnection: close\r\n\r\n" : "\r\n\r\n";
+    }
+
+    void respond_error(client& client, u16 status, std::string_view reason) {
+        write_head(client, status, reason, "text/plain; charset=utf-8", reason.size());
+        client.output += reason;
+    }
+
+    void respond(client& client) {
+        auto& parser = client.parser;
+        client.close_after = !parser.is_keep_alive();
+        bool head = parser.get_method() == "HEAD";
+        if (!head && parser.get_method() != "GET") {
+            client.close_after = true;
+            respond_error(client, 405, "Method Not Allowed");
+            return;
+        }
+        // Request bodies are not expected, the connection is closed rather than skipping them.
+        if (parser.is_chunked() || parser.get_content_length().value_or(0) != 0) {
+            client.close_after = true;
+            respond_error(client, 400, "Bad Request");
+            return;
+        }
+
+        auto identifier = to_identifier(parser.get_target().get_path(), _default_domain);
+        if (!identifier) {
+            respond_error(client, 400, "Bad Request");
+            return;
+        }
+        auto path = _resources.get_resource_path(*identifier, "").to_string();
+        auto content_type = get_content_type(path);
+
+        if (auto cached = _cache.get(path)) {
+            write_head(client, 200, "OK", content_type, cached->size());
+            if (!head)
+                client.output += *cached;
+            return;
+        }
+
+        int fd = is_inside(_root, path) ? ::open(path.c_str(), O_RDONLY | O_CLOEXEC) : -1;
+        struct stat status{};
+        if (fd == -1 || ::fstat(fd, &status) == -1 || !S_ISREG(status.st_mode)) {
+            if (fd != -1)
+                ::close(fd);
+            respond_error(client, 404, "Not Found");
+            return;
+        }
+        auto size = static_cast<u64>(status.st_size);
+        write_head(client, 200, "OK", content_type, size);
+
+        if (size <= MAX_CACHED_FILE_SIZE) {
+            std::string content(size, '\0');
+            auto read = ::pread(fd, content.data(), content.size(), 0);
+            ::close(fd);
+            if (read != static_cast<ssize_t>(size)) {
+                client.close_after = true;
+                return;
+            }
+            const auto& stored = _cache.put(path, std::move(content), status.st_mtime);
+            if (!head)
+                client.output += stored;
+        } else if (head)
+            ::close(fd);
+        else {
+            client.file_fd = fd;
+            client.file_offset = 0;
+            client.file_remaining = size;
+        }
+    }
+
+    /*!
+     * Parses the buffered requests and queues their responses, pipelined requests are answered in order.
+     */
+    void process(client& client) {
+        while (client.file_fd == -1 && !client.close_after) {
+            auto status = client.parser.parse(client.input);
+            if (status == http::INCOMPLETE)
+                return;
+            if (status == http::INVALID) {
+                client.close_after = true;
+                respond_error(client, 400, "Bad Request");
+                return;
+            }
+            respond(client);
+            client.input.erase(0, client.parser.get_head_size());
+            client.parser.reset();
+        }
+    }
+
+    /*!
+     * Writes the pending response.
+     * @return True if everything was written, false if the socket is full.
+     */
+    bool flush(client& client) {
+        while (client.output_offset < client.output.size()) {
+            auto written = client.stream.write(client.output.data() + client.output_offset, client.output.size() - client.output_offset);
+            if (!written)
+                return false;
+            client.output_offset += *written;
+        }
+        client.output.clear();
+        client.output_offset = 0;
+
+        while (client.file_remaining > 0) {
+            auto sent = client.stream.send_file(client.file_fd, client.file_offset, client.file_remaining);
+            if (!sent)
+                return false;
+            if (*sent == 0) {
+                // The file was truncated, the announced length cannot be honored.
+                client.close_after = true;
+                client.file_remaining = 0;
+                break;
+            }
+            client.file_remaining -= *sent;
+        }
+        if (client.file_fd != -1) {
+            ::close(client.file_fd);
+            client.file_fd = -1;
+        }
+        return true;
+    }
+
+    void on_event(int fd, u32 events) {
+        auto it = _clients.find(fd);
+        if (it == _clients.end())
+            return;
+        auto& client = *it->second;
+        try {
+            if (events & READABLE) {
+                char buffer[READ_BUFFER_SIZE];
+                while (auto read = client.stream.read(buffer, sizeof(buffer))) {
+                    if (*read == 0) {
+                        close(fd);
+                        return;
+                    }
+                    client.input.append(buffer, *read);
+                }
+            } else if (events & CLOSED) {
+                close(fd);
+                return;
+            }
+            // Writing the responses may free the way for the next pipelined requests.
+            for (;;) {
+                process(client);
+                if (!flush(client))
+                    return;
+                if (client.close_after) {
+                    close(fd);
+                    return;
+                }
+                if (client.parser.parse(client.input) != http::COMPLETE)
+                    return;
+            }
+        } catch (const std::exception&) {
+            close(fd);
+        }
+    }
+
+    void on_accept() {
+        while (auto stream = _listener.accept()) {
+            int fd = stream->get_fd();
+            stream->set_no_delay(true);
+            _clients[fd] = std::make_unique<client>(std::move(*stream));
+            _loop.add(fd, READABLE | WRITABLE, [this, fd](u32 events) { on_event(fd, events); });
+        }
+    }
+
+    void close(int fd) {
+        _loop.remove(fd);
+        _clients.erase(fd);
+    }
+
+public:
+    server_worker(event_loop& loop, const FileResourcesManager& resources, std::string default_domain, const Address& address) :
+            _loop(loop), _resources(resources), _default_domain(std::move(default_domain)), _listener(address, true) {
+        char root[PATH_MAX];
+        if (::realpath(_resources.get_working_directory().to_string().c_str(), root) == nullptr)
+            throw std::system_error(errno, std::generic_category(), "Cannot resolve the root directory");
+        _root = root;
+        if (_root.back() != '/')
+            _root += '/';
+        _loop.add(_listener.get_fd(), READABLE, [this](u32) { on_accept(); });
+    }
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <root directory> [port] [threads] [default domain]" << std::endl;
+        return 1;
+    }
+    FileResourcesManager resources{fs::path(argv[1])};
+    port_t port = argc > 2 ? static_cast<port_t>(std::stoi(argv[2])) : 8080;
+    u32 threads = argc > 3 ? static_cast<u32>(std::stoul(argv[3])) : 0;
+    std::string default_domain = argc > 4 ? argv[4] : "static";
+    Address address{"127.0.0.1", port};
+
+    std::signal(SIGINT, [](int) { stop_requested = true; });
+    std::signal(SIGTERM, [](int) { stop_requested = true; });
+
+    event_loop_group group{threads};
+    std::vector<std::unique_ptr<server_worker>> workers(group.size());
+    group.start([&](event_loop& loop, size_t index) {
+        workers[index] = std::make_unique<server_worker>(loop, resources, default_domain, address);
+    });
+    std::cout << "Serving " << resources.get_working_directory().to_string() << " on http://" << address.to_string()
+              << " with " << group.size() << " event loops." << std::endl;
+
+    while (!stop_requested)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    group.stop();
+    return 0;
+}
@@ -8,110 +8,283 @@
  */
 
 #include "../../include/lambdacommon/connection/address.h"
-#include <sstream>
+#include <array>
+#include <string_view>
 #include <tuple>
 #include <utility>
 
-#ifdef LAMBDA_WINDOWS
-#  include <WS2tcpip.h>
-#  pragma comment(lib, "Ws2_32.lib")
-#else
-#  ifdef LAMBDA_BSD
-#    include <netinet/in.h>
-#    include <sys/socket.h>
-#  endif
-#  include <arpa/inet.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LAMBDA_ADDRESS_SSE2
+#  include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#  include <intrin.h>
 #endif
 
+
 namespace lambdacommon
 {
-    Address::Address(host host, port_t port) : _host(std::move(host)), _port(port) {}
+    /*
+     * Domain names
+     */
 
-    Address::Address(const Address& address) : _host(address._host), _port(address._port) {}
+    /*!
+     * The known top-level domains, generated from resources/tlds.txt (sorted, lower case).
+     */
+    static constexpr std::string_view TLDS[] = {
+#include "tlds.inc"
+    };
+    static constexpr size_t TLDS_COUNT = sizeof(TLDS) / sizeof(std::string_view);
+    // Keeps the load factor under 25% so lookups almost always hit on the first probe.
+    static constexpr size_t TLD_TABLE_SIZE = 8192;
+    static_assert(TLDS_COUNT * 4 <= TLD_TABLE_SIZE && TLDS_COUNT < 0xFFFF, "The TLD table is too small, please increase TLD_TABLE_SIZE.");
 
-    Address::Address(Address&& address) noexcept : _host(std::move(address._host)), _port(address._port) {}
+    static constexpr char to_lower_ascii(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+    }
 
-    Address::~Address() = default;
+    /*!
+     * Case-insensitive FNV-1a hash used by the TLD table.
+     */
+    static constexpr u32 tld_hash(std::string_view label) {
+        u32 hash = 2166136261u;
+        for (char c : label) {
+            hash ^= static_cast<u8>(to_lower_ascii(c));
+            hash *= 16777619u;
+        }
+        return hash;
+    }
 
-    const host& Address::get_host() const {
-        return _host;
+    /*!
+     * Open addressing table of indices in TLDS (offset by one, 0 marks an empty slot), built at compile time.
+     */
+    static constexpr std::array<u16, TLD_TABLE_SIZE> build_tld_table() {
+        std::array<u16, TLD_TABLE_SIZE> table{};
+        for (size_t i = 0; i < TLDS_COUNT; i++) {
+            size_t slot = tld_hash(TLDS[i]) & (TLD_TABLE_SIZE - 1);
+            while (table[slot] != 0)
+                slot = (slot + 1) & (TLD_TABLE_SIZE - 1);
+            table[slot] = static_cast<u16>(i + 1);
+        }
+        return table;
     }
 
-    port_t Address::get_port() const {
-        return _port;
+    static constexpr std::array<u16, TLD_TABLE_SIZE> TLD_TABLE = build_tld_table();
+
+    /*!
+     * Checks whether the given label is a known top-level domain (case insensitive).
+     * @param label The label to check.
+     * @return True if the label is a known top-level domain, else false.
+     */
+    static bool is_tld(std::string_view label) {
+        if (label.empty() || label.size() > 63)
+            return false;
+        size_t slot = tld_hash(label) & (TLD_TABLE_SIZE - 1);
+        while (TLD_TABLE[slot] != 0) {
+            auto tld = TLDS[TLD_TABLE[slot] - 1];
+            if (tld.size() == label.size()) {
+                size_t i = 0;
+                while (i < tld.size() && tld[i] == to_lower_ascii(label[i]))
+                    i++;
+                if (i == tld.size())
+                    return true;
+            }
+            slot = (slot + 1) & (TLD_TABLE_SIZE - 1);
+        }
+        return false;
     }
 
-    bool Address::is_ipv4() const {
-#ifdef __MINGW32__
-        char d;
-        short ip1, ip2, ip3, ip4;
-        std::stringstream ss;
-        ss << _host;
-        ss >> ip1 >> d >> ip2 >> d >> ip3 >> d >> ip4 >> d;
-        ss.str("");
-        ss.clear();
-        ss << (ip1 & 0xFF) << "." << (ip2 & 0xFF) << "." << (ip3 & 0xFF) << "." << (ip4 & 0xFF);
-        return ss.str() == _host;
+    /*!
+     * Bit set with one bit per character of a host name (253 characters at most).
+     */
+    struct host_mask
+    {
+        u64 words[4] = {0, 0, 0, 0};
+
+        inline void set(size_t i) {
+            words[i >> 6] |= u64(1) << (i & 63);
+        }
+
+        inline void set_chunk(size_t offset, u32 bits) {
+            // Offsets are multiples of 16, so a chunk never crosses a word.
+            words[offset >> 6] |= static_cast<u64>(bits) << (offset & 63);
+        }
+
+        inline host_mask shift_left() const {
+            return {{words[0] << 1, (words[1] << 1) | (words[0] >> 63), (words[2] << 1) | (words[1] >> 63), (words[3] << 1) | (words[2] >> 63)}};
+        }
+
+        inline host_mask shift_right() const {
+            return {{(words[0] >> 1) | (words[1] << 63), (words[1] >> 1) | (words[2] << 63), (words[2] >> 1) | (words[3] << 63), words[3] >> 1}};
+        }
+
+        inline host_mask operator&(const host_mask& other) const {
+            return {{words[0] & other.words[0], words[1] & other.words[1], words[2] & other.words[2], words[3] & other.words[3]}};
+        }
+
+        inline host_mask operator|(const host_mask& other) const {
+            return {{words[0] | other.words[0], words[1] | other.words[1], words[2] | other.words[2], words[3] | other.words[3]}};
+        }
+
+        inline bool any() const {
+            return (words[0] | words[1] | words[2] | words[3]) != 0;
+        }
+    };
+
+    static inline u32 count_trailing_zeros(u64 bits) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<u32>(index);
 #else
-        struct sockaddr_in sa{};
-        return inet_pton(AF_INET, _host.c_str(), &(sa.sin_addr)) != 0;
+        return static_cast<u32>(__builtin_ctzll(bits));
 #endif
     }
 
-    bool Address::is_ipv6() const {
-#ifdef __MINGW32__
-        const char *s = _host.c_str();
-        int colons = 0, segsize = 0, i, ix = static_cast<int>(_host.length());
-        if (s[0] == ':' || s[ix - 1] == ':') return false;
-
-        for (colons = 0, i = 0, segsize = 0; i < ix; i++)
-        {
-            if (s[i] == ':')
-            {
-                segsize = 0;
-                colons++;
+#ifdef LAMBDA_ADDRESS_SSE2
+    /*!
+     * Classifies 16 characters at once.
+     */
+    static inline void classify_host_chunk(const char* chunk, u32& valid, u32& dots, u32& hyphens) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chunk));
+        // Unsigned range checks: (c - low) <= (high - low).
+        const __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        const __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8('z' - 'a')), letter);
+        const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        const __m128i is_dot = _mm_cmpeq_epi8(c, _mm_set1_epi8('.'));
+        const __m128i is_hyphen = _mm_cmpeq_epi8(c, _mm_set1_epi8('-'));
+        valid = static_cast<u32>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(is_letter, is_digit), _mm_or_si128(is_dot, is_hyphen))));
+        dots = static_cast<u32>(_mm_movemask_epi8(is_dot));
+        hyphens = static_cast<u32>(_mm_movemask_epi8(is_hyphen));
+    }
+#endif
+
+    /*!
+     * Validates the syntax of a host name (RFC 1123 labels separated with dots).
+     * @param host The host name.
+     * @param tld_offset The offset of the last label, set only if the host name is valid.
+     * @return True if the host name is valid, else false.
+     */
+    static bool is_hostname_valid(std::string_view host, size_t& tld_offset) {
+        const size_t length = host.size();
+        if (length == 0 || length > 253)
+            return false;
+
+        host_mask dots, hyphens;
+#ifdef LAMBDA_ADDRESS_SSE2
+        for (size_t i = 0; i < length; i += 16) {
+            u32 valid, chunk_dots, chunk_hyphens;
+            const size_t remaining = length - i;
+            if (remaining >= 16)
+                classify_host_chunk(host.data() + i, valid, chunk_dots, chunk_hyphens);
+            else {
+                // Never read past the end of the host, pad the tail with zeros which are invalid characters.
+                char tail[16] = {};
+                for (size_t j = 0; j < remaining; j++)
+                    tail[j] = host[i + j];
+                classify_host_chunk(tail, valid, chunk_dots, chunk_hyphens);
+                valid |= ~((u32(1) << remaining) - 1) & 0xFFFF;
             }
-            else if (('0' <= s[i] && s[i] <= '9') || ('a' <= s[i] && s[i] <= 'f'))//|| ('A' <= s[i] && s[i] <='F')
-                segsize++;
-            else
-                return false;
-            if (segsize >= 5) return false;
+            if (valid != 0xFFFF)
+                return false; // Invalid char...
+            dots.set_chunk(i, chunk_dots);
+            hyphens.set_chunk(i, chunk_hyphens);
         }
-        return colons <= 7;
 #else
-        struct sockaddr_in6 sa{};
-        return inet_pton(AF_INET6, _host.c_str(), &(sa.sin6_addr)) != 0;
+        for (size_t i = 0; i < length; i++) {
+            char c = host[i];
+            if (c == '.')
+                dots.set(i);
+            else if (c == '-')
+                hyphens.set(i);
+            else if (!(('0' <= c && c <= '9') || ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z')))
+                return false; // Invalid char...
+        }
 #endif
-    }
 
-    bool Address::is_domain_valid() const {
-        static const std::string tlds = "|com|net|org|edu|gov|int|mil|ac|ad|ae|af|ag|ai|al|am|an|ao|aq|ar|arpa|at|au|ax|az|ba|bb|bd|be|bf|bg|bh|bi|bj|bm|bn|bo|br|bs|bt|bv|bw|by|bz|ca|cc|cd|cf|cg|ch|ci|ck|cl|cm|cn|co|cr|cu|cv|cx|cy|cz|de|dj|dk|dm|do|dz|ec|ee|eg|er|es|et|eu|fi|fj|fk|fm|fo|fr|ga|gb|gd|ge|gf|gg|gh|gi|gl|gm|gn|gp|gq|gr|gs|gt|gu|gw|gy|hk|hm|hn|hr|ht|hu|id|ie|il|im|in|io|iq|ir|is|it|je|jm|jo|jp|ke|kg|kh|ki|km|kn|kp|kr|kw|ky|kz|la|lb|lc|li|lk|lr|ls|lt|lu|lv|ly|ma|mc|md|me|mg|mh|mk|ml|mm|mn|mo|mp|mq|ms|mt|mu|mv|mw|mx|my|mz|na|nc|ne|nf|ng|ni|nl|no|np|nr|nu|nz|om|pa|pe|pf|pg|ph|pk|pl|pm|pn|pr|ps|pt|pw|py|qa|re|ro|rs|ru|rw|sa|sb|sc|sd|se|sg|sh|si|sj|sk|sl|sm|sn|so|sr|st|su|sv|sy|sz|tc|td|tf|tg|th|tj|tk|tl|tm|tn|to|tp|tr|tt|tv|tw|tz|ua|ug|uk|us|uy|uz|va|vc|ve|vg|vi|vn|vu|wf|ws|ye|yt|za|zm|zw|aw|as|mr|bl|bq|cw|eh|mf|ss|sx|um|aaa|aarp|abarth|abb|abbott|abbvie|abc|able|abogado|abudhabi|academy|accenture|accountant|accountants|acer|aco|active|actor|adac|ads|adult|aeg|aero|aetna|afamilycompany|afl|africa|africamagic|agakhan|agency|aig|aigo|airbus|airforce|airtel|akdn|alcon|alfaromeo|alibaba|alipay|allfinanz|allfinanzberater|allfinanzberatung|allstate|ally|alsace|alstom|amazon|americanexpress|americanfamily|amex|amfam|amica|amp|amsterdam|analytics|and|android|anquan|ansons|anthem|antivirus|aol|apartments|app|apple|aquarelle|aquitaine|arab|aramco|archi|architect|are|army|art|arte|asda|asia|associates|astrium|athleta|attorney|auction|audi|audible|audio|auspost|author|auto|autoinsurance|autos|avery|avianca|axa|axis|azure|baby|baidu|banamex|bananarepublic|band|bank|banque|bar|barcelona|barclaycard|barclays|barefoot|bargains|baseball|basketball|bauhaus|bayern|bbb|bbc|bbt|bbva|bcg|bcn|beats|beauty|beer|beknown|bentley|berlin|best|bestbuy|bet|bharti|bible|bid|bike|bing|bingo|bio|biz|black|blackfriday|blanco|blockbuster|blog|bloomberg|bloomingdales|blue|bms|bmw|bnl|bnpparibas|boats|boehringer|bofa|bom|bond|boo|book|booking|boots|bosch|bostik|boston|bot|boutique|box|bradesco|bridgestone|broadway|broker|brother|brussels|budapest|bugatti|buick|build|builders|business|buy|buzz|bway|bzh|cab|cadillac|cafe|cal|call|calvinklein|cam|camera|camp|canalplus|cancerresearch|canon|capetown|capital|capitalone|caravan|cards|care|career|careers|caremore|carinsurance|cars|cartier|casa|case|caseih|cash|cashbackbonus|casino|cat|catalonia|catering|catholic|cba|cbn|cbre|cbs|ceb|center|ceo|cern|cfa|cfd|chanel|changiairport|channel|charity|chartis|chase|chat|chatr|cheap|chesapeake|chevrolet|chevy|chintai|city|chk|chloe|christmas|chrome|chrysler|church|cialis|cimb|cipriani|circle|cisco|citadel|citi|citic|cityeats|claims|cleaning|click|clinic|clinique|clothing|club|clubmed|coach|codes|coffee|college|cologne|com|comcast|commbank|community|company|compare|computer|comsec|condos|connectors|construction|consulting|contact|contractors|cooking|cookingchannel|cool|coop|corsica|country|coupon|coupons|courses|credit|creditcard|creditunion|cricket|crown|crs|cruise|cruises|csc|cuisinella|cymru|cyou|dabur|dad|dance|data|date|dating|datsun|day|dclk|dds|deal|dealer|deals|degree|delivery|dell|delmonte|deloitte|delta|democrat|dental|dentist|desi|design|deutschepost|dhl|diamonds|diet|digikey|digital|direct|directory|discount|discover|dish|diy|dnb|dnp|docomo|docs|doctor|dodge|dog|doha|domains|doosan|dot|dotafrica|download|drive|dstv|dtv|dubai|duck|dunlop|duns|dupont|durban|dvag|dvr|dwg|earth|eat|eco|ecom|edeka|education|edu|email|emerck|emerson|energy|engineer|engineering|enterprises|epost|epson|equipment|ericsson|erni|esq|est|estate|esurance|etisalat|eurovision|eus|events|everbank|exchange|expert|exposed|express|extraspace|fage|fail|fairwinds|faith|family|fan|fans|farm|farmers|fashion|fast|fedex|feedback|ferrari|ferrero|fiat|fidelity|fido|film|final|finance|financial|financialaid|finish|fire|firestone|firmdale|fish|fishing|fitness|flickr|flights|flir|florist|flowers|fls|flsmidth|fly|foo|food|foodnetwork|football|ford|forex|forsale|forum|foundation|fox|free|fresenius|frl|frogans|frontdoor|frontier|ftr|fujitsu|fujixerox|fun|fund|furniture|futbol|fyi|gai|gal|gallery|gallo|gallup|game|games|gap|garden|garnier|gay|gbiz|gcc|gdn|gea|gecompany|ged|gent|genting|george|ggee|gift|gifts|gives|giving|glade|glass|gle|glean|global|globalx|globo|gmail|gmbh|gmc|gmo|gmx|godaddy|gold|goldpoint|golf|goo|goodhands|goodyear|goog|google|gop|got|gotv|grainger|graphics|gratis|gree|green|gripe|grocery|group|guardian|guardianlife|guardianmedia|gucci|guge|guide|guitars|guru|hair|halal|hamburg|hangout|haus|hbo|hdfc|hdfcbank|health|healthcare|heart|heinz|help|helsinki|here|hermes|hgtv|hilton|hiphop|hisamitsu|hitachi|hiv|hkt|hockey|holdings|holiday|homedepot|homegoods|homes|homesense|honda|honeywell|horse|host|hosting|hoteis|hotel|hoteles|hotels|hotmail|house|how|htc|hughes|hyatt|hyundai|ibm|icbc|ice|icu|idn|ieee|ifm|iinet|ikano|imamat|imdb|immo|immobilien|indians|industries|infiniti|info|infosys|infy|ing|ink|institute|insurance|insure|intel|international|intuit|investments|ipiranga|ira|irish|iselect|islam|ismaili|ist|istanbul|itau|itv|iveco|iwc|jaguar|java|jcb|jcp|jeep|jetzt|jewelry|jio|jlc|jll|jmp|jnj|jobs|joburg|jot|joy|jpmorgan|jpmorganchase|jprs|juegos|juniper|justforu|kaufen|kddi|kerastase|kerryhotels|kerrylogisitics|kerryproperties|ketchup|kfh|kia|kid|kids|kiehls|kim|kinder|kindle|kitchen|kiwi|koeln|komatsu|konami|kone|kosher|kpmg|kpn|krd|kred|ksb|kuokgroup|kyknet|kyoto|lacaixa|ladbrokes|lamborghini|lamer|lancaster|lancia|lancome|land|landrover|lanxess|lat|latino|latrobe|lawyer|lds|lease|leclerc|lefrak|legal|lego|lexus|lgbt|liaison|lidl|life|lifeinsurance|lifestyle|lighting|lightning|like|lilly|limited|limo|lincoln|linde|link|lipsy|live|livestrong|living|lixil|llc|loan|loans|locker|locus|loft|lol|london|loreal|lotte|lotto|love|lpl|lplfinancial|ltd|ltda|lundbeck|lupin|luxe|luxury|macys|madrid|maif|maison|makeup|man|management|mango|map|market|marketing|markets|marriott|marshalls|maserati|mattel|maybelline|mba|mcd|mcdonalds|mckinsey|media|medical|meet|melbourne|meme|memorial|men|menu|meo|merck|merckmsd|metlife|miami|microsoft|mih|mii|mini|mint|mit|mitek|mitsubishi|mlb|mls|mnet|mobi|mobile|mobily|moda|moe|mom|monash|money|monster|montblanc|mopar|mormon|mortgage|moscow|moto|motorcycles|mov|movie|movistar|mozaic|mrmuscle|mrporter|mtn|mtpc|mtr|multichoice|museum|music|mutual|mutualfunds|mutuelle|mzansimagic|nab|nadex|nagoya|name|naspers|nationwide|natura|navy|nba|nec|net|netaporter|netbank|netflix|network|neustar|new|newholland|news|next|nextdirect|nexus|nfl|ngo|nhk|nico|nike|nikon|ninja|nissan|nissay|nokia|northlandinsurance|northwesternmutual|norton|now|nowruz|nowtv|nra|nrw|ntt|nyc|obi|observer|off|okinawa|olayan|olayangroup|oldnavy|ollo|olympus|omega|ong|onl|online|onyourside|ooo|open|oracle|orange|org|organic|orientexpress|origins|osaka|otsuka|ott|overheidnl|ovh|page|pamperedchef|panasonic|panerai|paris|pars|partners|parts|party|passagens|patagonia|patch|pay|payu|pccw|persiangulf|pets|pfizer|pharmacy|phd|philips|phone|photo|photography|photos|physio|piaget|pics|pictet|pictures|pid|pin|ping|pink|pioneer|piperlime|pitney|pizza|place|play|playstation|plumbing|plus|pnc|pohl|poker|politie|polo|porn|post|pramerica|praxi|press|prime|pro|prod|productions|prof|progressive|promo|properties|property|protection|pru|prudential|pub|pwc|qpon|qtel|quebec|quest|qvc|racing|radio|raid|ram|read|realestate|realtor|realty|recipes|red|redken|redstone|redumbrella|rehab|reise|reisen|reit|ren|rent|rentals|repair|report|republican|rest|restaurant|retirement|review|reviews|rexroth|rich|richardli|ricoh|rightathome|ril|rio|rip|rmit|rocher|rocks|rockwool|rodeo|rogers|roma|room|rsvp|rugby|ruhr|run|rwe|ryukyu|saarland|safe|safety|safeway|sakura|sale|salon|samsclub|samsung|sandvik|sandvikcoromant|sanofi|sap|sapo|sapphire|sarl|sas|save|saxo|sbi|sbs|sca|scb|schaeffler|schedule|schmidt|scholarhips|scholarships|schule|schwarz|schwarzgroup|science|scjohnson|scor|scot|search|seat|security|seek|select|sener|services|ses|seven|sew|sex|sexy|sfr|shangrila|sharp|shell|shia|shiksha|shirriam|shoes|shop|shopping|shopyourway|shouji|show|showtime|shriram|silk|sina|singles|ski|skin|skolkovo|sky|skydrive|skype|sling|smart|smile|sncf|soccer|social|softbank|software|sohu|solar|solutions|song|sony|soy|spa|space|spiegel|sport|sports|spot|spreadbetting|srt|stada|staples|star|starhub|statebank|statefarm|statoil|stc|stcgroup|stockholm|storage|store|stream|stroke|studio|study|style|sucks|supersport|supplies|supply|support|surf|surgery|suzuki|svr|swatch|swiftcover|swiss|symantec|systems|sydney|tab|taipei|talk|taobao|target|tata|tatamotors|tatar|tattoo|tax|taxi|tci|tdk|team|technology|tel|telecity|telefonica|temasek|tennis|terra|teva|thai|thd|theater|theatre|theguardian|thehartford|tiaa|tickets|tienda|tiffany|tips|tires|tirol|tjmaxx|tjx|tkmaxx|tmall|today|tokyo|tools|top|toray|toshiba|total|tour|tours|town|toyota|toys|trade|tradershotels|trading|training|transformers|translations|transunion|travel|travelchannel|travelers|travelersinsurance|travelguard|trust|trv|tube|tui|tunes|tushu|tvs|ubank|ubs|uconnect|ultrabook|ummah|unicom|unicorn|university|uno|uol|ups|vacations|vana|vanguard|vanish|vegas|ventures|verisign|versicherung|vet|viajes|video|vig|viking|villas|vin|vip|virgin|visa|vision|vista|vistaprint|viva|vivo|vlaanderen|vodka|volkswagen|volvo|vons|vote|voting|voto|voyage|vuelos|wales|walmart|walter|wang|wanggou|warman|watch|watches|weather|weatherchannel|web|webcam|weber|webjet|webs|website|wed|wedding|weibo|weir|whoswho|wien|wiki|williamhill|wilmar|windows|wine|winners|wme|wolterskluwer|world|woodside|work|works|wow|wtc|wtf|xbox|xerox|xfinity|xihuan|xin|xn--11b4c3d|xn--1ck2e1b|xn--1qqw23a|xn--30rr7y|xn--3bst00m|xn--3ds443g|xn--3e0b707e|xn--3oq18vl8pn36a|xn--3pxu8k|xn--42c2d9a|xn--45brj9c|xn--45q11c|xn--4gbrim|xn--4gq48lf9j|xn--54b7fta0cc|xn--55qw42g|xn--55qx5d|xn--55qx5d8y0buji4b870u|xn--5su34j936bgsg|xn--5tzm5g|xn--6frz82g|xn--6qq986b3x1|xn--6qq986b3xl|xn--6rtwn|xn--80adxhks|xn--80ao21a|xn--80aqecdr1a|xn--80asehdb|xn--80aswg|xn--8y0a063a|xn--90a3ac|xn--9et52u|xn--9krt00a|xn--b4w605ferd|xn--bck1b9a5dre4c|xn--c1avg|xn--c1yn36f|xn--c2br7g|xn--cck2b3b|xn--cckwcxetd|xn--cg4bki|xn--clchc0ea0b2g2a9gcd|xn--czr694b|xn--czrs0t|xn--czru2d|xn--d1acj3b|xn--dkwm73cwpn|xn--eckvdtc9d|xn--efvy88h|xn--estv75g|xn--fct429k|xn--fes124c|xn--fhbei|xn--fiq228c5hs|xn--fiq64b|xn--fiQ64b|xn--fiQ64B|xn--fiqs8s|xn--fiqz9s|xn--fjq720a|xn--flw351e|xn--fpcrj9c3d|xn--fzc2c9e2c|xn--fzys8d69uvgm|xn--g2xx48c|xn--gckr3f0f|xn--gecrj9c|xn--gk3at1e|xn--h2brj9c|xn--hdb9cza1b|xn--hxt035cmppuel|xn--hxt035czzpffl|xn--hxt814e|xn--i1b6b1a6a2e|xn--imr513n|xn--io0a7i|xn--j1aef|xn--j1amh|xn--j6w193g|xn--j6w470d71issc|xn--jlq480n2rg|xn--jlq61u9w7b|xn--jvr189m|xn--kcrx77d1x4a|xn--kcrx7bb75ajk3b|xn--kprw13d|xn--kpry57d|xn--kpu716f|xn--kput3i|xn--lgbbat1ad8j|xn--mgb9awbf|xn--mgba3a3ejt|xn--mgba3a4f16a|xn--mgba7c0bbn0a|xn--mgbaakc7dvf|xn--mgbaam7a8h|xn--mgbab2bd|xn--mgbai9azgqp6j|xn--mgbayh7gpa|xn--mgbb9fbpob|xn--mgbbh1a71e|xn--mgbc0a9azcg|xn--mgbca7dzdo|xn--mgberp4a5d4ar|xn--mgbi4ecexp|xn--mgbt3dhd|xn--mgbv6cfpo|xn--mgbx4cd0ab|xn--mk1bu44c|xn--mxtq1m|xn--ngbc5azd|xn--ngbe9e0a|xn--ngbrx|xn--node|xn--nqv7f|xn--nqv7fs00ema|xn--nyqy26a|xn--o3cw4h|xn--ogbpf8fl|xn--otu796d|xn--p1acf|xn--p1ai|xn--pbt977c|xn--pgb3ceoj|xn--pgbs0dh|xn--pssy2u|xn--q9jyb4c|xn--qcka1pmc|xn--rhqv96g|xn--rovu88b|xn--s9brj9c|xn--ses554g|xn--t60b56a|xn--tckwe|xn--tiq49xqyj|xn--tqq33ed31aqia|xn--unup4y|xn--vermgensberater-ctb|xn--vermgensberatung-pwb|xn--vhquv|xn--vuq861b|xn--w4r85el8fhu5dnra|xn--w4rs40l|xn--wgbh1c|xn--wgbl6a|xn--xhq521b|xn--xkc2al3hye2a|xn--xkc2dl3a5ee0h|xn--yfro4i67o|xn--ygbi2ammx|xn--zfr164b|xn—3ds443g|xn—fiq228c5hs|xperia|xxx|xyz|yachts|yahoo|yamaxun|yandex|yellowpages|yodobashi|yoga|yokohama|you|youtube|yun|zappos|zara|zero|zip|zippo|zone|zuerich|zulu|";
-        const char* s = _host.c_str();
-        size_t segsize = 0, i, ix = _host.length();
-        if (s[0] == '.' || s[ix - 1] == '.' || ix > 253)
+        host_mask first, last;
+        first.set(0);
+        last.set(length - 1);
+        // Fail for .abc.com, abc.com. and abc..com
+        if ((dots & (first | last | dots.shift_right())).any())
+            return false;
+        // Labels cannot start or end with an hyphen.
+        if ((hyphens & (first | last | dots.shift_left() | dots.shift_right())).any())
             return false;
-        for (i = 0, segsize = 0; i < ix; i++) {
-            if (s[i] == '.') {
-                if (segsize == 0) // Fail for abc..com
-                    return false;
-                segsize = 0;
-            } else if (('0' <= s[i] && s[i] <= '9')
-                       || ('a' <= s[i] && s[i] <= 'z')
-                       || ('A' <= s[i] && s[i] <= 'Z')
-                       || (s[i] == '-' && segsize != 0 && i + 1 < ix && s[i + 1] != '.')
-                    ) {
-                segsize++;
-            } else
-                return false; // Invalid char...
 
-            if (segsize > 63)
-                return false;
+        size_t label_start = 0;
+        for (size_t word = 0; word < 4; word++) {
+            u64 bits = dots.words[word];
+            while (bits != 0) {
+                size_t dot = (word << 6) + count_trailing_zeros(bits);
+                if (dot - label_start > 63)
+                    return false;
+                label_start = dot + 1;
+                bits &= bits - 1;
+            }
         }
+        if (length - label_start > 63)
+            return false;
+
+        tld_offset = label_start;
+        return true;
+    }
+
+    Address::Address(host host, port_t port) : _host(std::move(host)), _port(port) {
+        parse_host();
+    }
+
+    Address::Address(const Address& address) = default;
+
+    Address::Address(Address&& address) noexcept : _host(std::move(address._host)), _port(address._port), _type(address._type), _ip(address._ip) {}
+
+    Address::~Address() = default;
+
+    void Address::parse_host() {
+        _ip = ip_address();
+        if (auto ipv4 = ip_address::parse_v4(_host)) {
+            _type = IPv4;
+            _ip = *ipv4;
+        } else if (auto ipv6 = ip_address::parse_v6(_host)) {
+            _type = IPv6;
+            _ip = *ipv6;
+        } else if (is_domain_valid())
+            _type = DOMAIN_NAME;
+        else if (is_empty())
+            _type = AddressType::EMPTY;
+        else
+            _type = INVALID;
+    }
+
+    const host& Address::get_host() const {
+        return _host;
+    }
+
+    port_t Address::get_port() const {
+        return _port;
+    }
+
+    bool Address::is_ipv4() const {
+        return _type == IPv4;
+    }
+
+    bool Address::is_ipv6() const {
+        return _type == IPv6;
+    }
 
-        std::stringstream ss;
-        ss << "|" << _host.substr(ix - segsize) << "|"; // Get last domain segment.
+    bool Address::is_domain_valid() const {
+        std::string_view host = _host;
+        size_t tld_offset;
+        if (!is_hostname_valid(host, tld_offset))
+            return false;
+        return is_tld(host.substr(tld_offset));
+    }
 
-        return tlds.find(ss.str()) != std::string::npos;
+    std::optional<ip_address> Address::get_ip_address() const {
+        if (_type == IPv4 || _type == IPv6)
+            return _ip;
+        return std::nullopt;
     }
 
     bool Address::is_empty() const {
@@ -119,16 +292,7 @@ namespace lambdacommon
     }
 
     AddressType Address::get_type() const {
-        if (is_ipv4())
-            return IPv4;
-        else if (is_ipv6())
-            return IPv6;
-        else if (is_domain_valid())
-            return DOMAIN_NAME;
-        else if (is_empty())
-            return AddressType::EMPTY;
-        else
-            return INVALID;
+        return _type;
     }
 
     bool Address::is_null() const {
@@ -158,6 +322,8 @@ namespace lambdacommon
         if (this != &other) {
             _host = other._host;
             _port = other._port;
+            _type = other._type;
+            _ip = other._ip;
         }
         return *this;
     }
@@ -166,6 +332,8 @@ namespace lambdacommon
         if (this != &other) {
             _host = std::move(other._host);
             _port = other._port;
+            _type = other._type;
+            _ip = other._ip;
         }
         return *this;
     }
@@ -0,0 +1,403 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/connection/buffer_chain.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace lambdacommon::connection
+{
+    /*
+     * slab
+     */
+
+    // 256 slabs of 16 KiB, 4 MiB at most kept free in the shared list.
+    static constexpr size_t MAX_CACHED_SLABS = 256;
+    // The count of slabs moved at once between a thread cache and the shared list, a thread keeps at most twice as many.
+    static constexpr size_t SLAB_BATCH = 32;
+
+    static slab* allocate_slab(size_t capacity) {
+        void* memory = ::operator new(sizeof(slab) + capacity);
+        auto s = new(memory) slab;
+        s->capacity = static_cast<u32>(capacity);
+        return s;
+    }
+
+    static void free_slab(slab* s) {
+        s->~slab();
+        ::operator delete(s);
+    }
+
+    /*!
+     * Free slabs of the default capacity shared by every thread, the thread caches refill from it and spill to it by batches.
+     */
+    struct slab_free_list
+    {
+        std::mutex mutex;
+        std::vector<slab*> free;
+
+        slab_free_list() {
+            free.reserve(MAX_CACHED_SLABS);
+        }
+
+        /*!
+         * Takes up to SLAB_BATCH slabs.
+         */
+        void take(std::vector<slab*>& slabs) {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t count = std::min(SLAB_BATCH, free.size());
+            slabs.insert(slabs.end(), free.end() - count, free.end());
+            free.resize(free.size() - count);
+        }
+
+        /*!
+         * Gives the last slabs of a vector from an index, the ones over the limit are freed.
+         */
+        void give(std::vector<slab*>& slabs, size_t from) {
+            size_t kept;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                kept = std::min(slabs.size() - from, MAX_CACHED_SLABS - free.size());
+                free.insert(free.end(), slabs.begin() + from, slabs.begin() + from + kept);
+            }
+            for (size_t i = from + kept; i < slabs.size(); i++)
+                free_slab(slabs[i]);
+            slabs.resize(from);
+        }
+    };
+
+    /*!
+     * Gets the shared free list, it is never destroyed so the slabs released during the static destruction still have one.
+     */
+    static slab_free_list& get_free_list() {
+        static auto* free_list = new slab_free_list;
+        return *free_list;
+    }
+
+    /*!
+     * The free slabs of a thread, taken without any lock. A slab released by another thread than the one which acquired it
+     * simply joins the cache of the releasing thread.
+     */
+    struct slab_cache
+    {
+        std::vector<slab*> slabs;
+
+        slab_cache() {
+            slabs.reserve(SLAB_BATCH * 2);
+        }
+
+        ~slab_cache();
+    };
+
+    // Trivially destructible, so it stays valid after the cache of the thread is destroyed.
+    static thread_local bool slab_cache_destroyed = false;
+
+    slab_cache::~slab_cache() {
+        slab_cache_destroyed = true;
+        get_free_list().give(slabs, 0);
+    }
+
+    static slab_cache* get_slab_cache() {
+        if (slab_cache_destroyed)
+            return nullptr;
+        static thread_local slab_cache cache;
+        return &cache;
+    }
+
+    slab* slab::acquire(size_t capacity) {
+        slab* s = nullptr;
+        if (capacity <= DEFAULT_CAPACITY) {
+            if (auto cache = get_slab_cache()) {
+                if (cache->slabs.empty())
+                    get_free_list().take(cache->slabs);
+                if (!cache->slabs.empty()) {
+                    s = cache->slabs.back();
+                    cache->slabs.pop_back();
+                }
+            }
+            if (!s)
+                s = allocate_slab(DEFAULT_CAPACITY);
+        } else
+            s = allocate_slab(capacity);
+        s->references.store(1, std::memory_order_relaxed);
+        return s;
+    }
+
+    void slab::release(slab* s) {
+        if (s->references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        if (s->capacity != DEFAULT_CAPACITY) {
+            free_slab(s);
+            return;
+        }
+        auto cache = get_slab_cache();
+        if (!cache) {
+            // The thread is exiting, the slab goes straight to the shared list.
+            std::vector<slab*> single{s};
+            get_free_list().give(single, 0);
+            return;
+        }
+        cache->slabs.push_back(s);
+        if (cache->slabs.size() > SLAB_BATCH * 2)
+            get_free_list().give(cache->slabs, SLAB_BATCH);
+    }
+
+    /*
+     * buffer_slice
+     */
+
+    buffer_slice::buffer_slice(slab* s, u32 offset, u32 length) : _slab(s), _offset(offset), _length(length) {}
+
+    buffer_slice::buffer_slice(const buffer_slice& other) : _slab(other._slab), _offset(other._offset), _length(other._length) {
+        if (_slab)
+            _slab->references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    buffer_slice::buffer_slice(buffer_slice&& other) noexcept : _slab(other._slab), _offset(other._offset), _length(other._length) {
+        other._slab = nullptr;
+    }
+
+    buffer_slice::~buffer_slice() {
+        if (_slab)
+            slab::release(_slab);
+    }
+
+    size_t buffer_slice::get_writable() const {
+        // Writing in place is only safe if no other slice can see the slab.
+        if (!_slab || _slab->references.load(std::memory_order_acquire) != 1)
+            return 0;
+        return _slab->capacity - (_offset + _length);
+    }
+
+    buffer_slice& buffer_slice::operator=(const buffer_slice& other) {
+        if (this != &other) {
+            if (other._slab)
+                other._slab->references.fetch_add(1, std::memory_order_relaxed);
+            if (_slab)
+                slab::release(_slab);
+            _slab = other._slab;
+            _offset = other._offset;
+            _length = other._length;
+        }
+        return *this;
+    }
+
+    buffer_slice& buffer_slice::operator=(buffer_slice&& other) noexcept {
+        if (this != &other) {
+            if (_slab)
+                slab::release(_slab);
+            _slab = other._slab;
+            _offset = other._offset;
+            _length = other._length;
+            other._slab = nullptr;
+        }
+        return *this;
+    }
+
+    /*
+     * buffer_chain
+     */
+
+    buffer_chain::buffer_chain(buffer_chain&& other) noexcept : _slices(std::move(other._slices)), _size(other._size) {
+        other._slices.clear();
+        other._size = 0;
+    }
+
+    size_t buffer_chain::size() const {
+        return _size;
+    }
+
+    bool buffer_chain::empty() const {
+        return _size == 0;
+    }
+
+    size_t buffer_chain::get_slice_count() const {
+        return _slices.size();
+    }
+
+    void buffer_chain::append(const void* data, size_t size) {
+        auto bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            auto[area, area_size] = prepare(1);
+            size_t count = std::min(area_size, size);
+            std::memcpy(area, bytes, count);
+            commit(count);
+            bytes += count;
+            size -= count;
+        }
+    }
+
+    void buffer_chain::append(const buffer_chain& other) {
+        if (this == &other) {
+            buffer_chain copy(other);
+            append(copy);
+            return;
+        }
+        for (const auto& slice : other._slices)
+            if (slice._length != 0)
+                _slices.push_back(slice);
+        _size += other._size;
+    }
+
+    void buffer_chain::append(buffer_slice slice) {
+        if (slice._slab == nullptr || slice._length == 0)
+            return;
+        _size += slice._length;
+        _slices.push_back(std::move(slice));
+    }
+
+    std::pair<char*, size_t> buffer_chain::prepare(size_t min_size) {
+        if (!_slices.empty()) {
+            auto& last = _slices.back();
+            size_t writable = last.get_writable();
+            if (writable >= min_size && writable != 0)
+                return {last._slab->data() + last._offset + last._length, writable};
+        }
+        auto s = slab::acquire(min_size);
+        _slices.emplace_back(s, 0, 0);
+        return {s->data(), s->capacity};
+    }
+
+    void buffer_chain::commit(size_t size) {
+        if (_slices.empty())
+            return;
+        auto& last = _slices.back();
+        if (size == 0 && last._length == 0) {
+            _slices.pop_back();
+            return;
+        }
+        last._length += static_cast<u32>(size);
+        _size += size;
+    }
+
+    void buffer_chain::consume(size_t size) {
+        size = std::min(size, _size);
+        _size -= size;
+        while (!_slices.empty()) {
+            auto& first = _slices.front();
+            if (first._length > size) {
+                first._offset += static_cast<u32>(size);
+                first._length -= static_cast<u32>(size);
+                return;
+            }
+            size -= first._length;
+            _slices.pop_front();
+        }
+    }
+
+    buffer_chain buffer_chain::slice(size_t offset, size_t length) const {
+        buffer_chain result;
+        for (const auto& slice : _slices) {
+            if (length == 0)
+                break;
+            if (offset >= slice._length) {
+                offset -= slice._length;
+                continue;
+            }
+            auto count = std::min<size_t>(slice._length - offset, length);
+            slice._slab->references.fetch_add(1, std::memory_order_relaxed);
+            result._slices.emplace_back(slice._slab, static_cast<u32>(slice._offset + offset), static_cast<u32>(count));
+            result._size += count;
+            length -= count;
+            offset = 0;
+        }
+        return result;
+    }
+
+    std::string_view buffer_chain::front() const {
+        for (const auto& slice : _slices)
+            if (slice._length != 0)
+                return slice.view();
+        return {};
+    }
+
+    std::string_view buffer_chain::contiguous(size_t size) {
+        size = std::min(size, _size);
+        if (size == 0)
+            return {};
+        while (_slices.front()._length == 0)
+            _slices.pop_front();
+        if (_slices.front()._length >= size)
+            return {_slices.front().data(), size};
+
+        // The bytes span several slices, coalesce them into a single slab.
+        auto s = slab::acquire(size);
+        copy_to(s->data(), size);
+        consume(size);
+        _slices.emplace_front(s, 0, static_cast<u32>(size));
+        _size += size;
+        return {s->data(), size};
+    }
+
+    size_t buffer_chain::copy_to(void* out, size_t size) const {
+        auto bytes = static_cast<char*>(out);
+        size_t copied = 0;
+        for (const auto& slice : _slices) {
+            if (copied == size)
+                break;
+            auto count = std::min<size_t>(slice._length, size - copied);
+            std::memcpy(bytes + copied, slice.data(), count);
+            copied += count;
+        }
+        return copied;
+    }
+
+    size_t buffer_chain::get_segments(std::string_view* out, size_t max) const {
+        size_t count = 0;
+        for (const auto& slice : _slices) {
+            if (count == max)
+                break;
+            if (slice._length != 0)
+                out[count++] = slice.view();
+        }
+        return count;
+    }
+
+#if !defined(LAMBDA_WINDOWS) && !defined(LAMBDA_WASM)
+
+    size_t buffer_chain::get_iovecs(iovec* out, size_t max) const {
+        size_t count = 0;
+        for (const auto& slice : _slices) {
+            if (count == max)
+                break;
+            if (slice._length != 0) {
+                out[count].iov_base = const_cast<char*>(slice.data());
+                out[count].iov_len = slice._length;
+                count++;
+            }
+        }
+        return count;
+    }
+
+#endif
+
+    void buffer_chain::clear() {
+        _slices.clear();
+        _size = 0;
+    }
+
+    std::string buffer_chain::to_string() const {
+        std::string result(_size, '\0');
+        copy_to(result.data(), _size);
+        return result;
+    }
+
+    buffer_chain& buffer_chain::operator=(buffer_chain&& other) noexcept {
+        if (this != &other) {
+            _slices = std::move(other._slices);
+            _size = other._size;
+            other._slices.clear();
+            other._size = 0;
+        }
+        return *this;
+    }
+}
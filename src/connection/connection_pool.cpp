@@ -0,0 +1,412 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/connection/connection_pool.h"
+
+#ifdef LAMBDA_HAS_SOCKETS
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <poll.h>
+#include <sys/socket.h>
+
+#define WHEEL_SIZE 256
+
+namespace lambdacommon::connection
+{
+    namespace internal
+    {
+        /*!
+         * The connections of an address. An idle slot packs the idle timestamp in its high half and the file descriptor + 1 in its low half,
+         * 0 being an empty slot.
+         */
+        struct pool_host
+        {
+            Address address;
+            u32 slot_count;
+            std::unique_ptr<std::atomic<u64>[]> slots;
+            std::atomic<u32> open{0};
+            std::atomic<u32> waiters{0};
+            std::mutex mutex;
+            std::condition_variable available;
+
+            pool_host(const Address& address, u32 slot_count) : address(address), slot_count(slot_count),
+                                                                slots(new std::atomic<u64>[slot_count]) {
+                for (u32 i = 0; i < slot_count; i++)
+                    slots[i].store(0, std::memory_order_relaxed);
+            }
+
+            bool has_idle() const {
+                for (u32 i = 0; i < slot_count; i++)
+                    if (slots[i].load(std::memory_order_relaxed) != 0)
+                        return true;
+                return false;
+            }
+
+            /*!
+             * Wakes up the waiters after a slot or the open count changed. The mutex orders the change with the check of a waiter
+             * about to sleep: it either sees the change or is already waiting.
+             */
+            void notify() {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (waiters.load(std::memory_order_relaxed) != 0)
+                    available.notify_all();
+            }
+        };
+    }
+
+    using internal::pool_host;
+
+    static inline u64 pack_slot(int fd, u64 time_ms) {
+        return (time_ms << 32) | static_cast<u32>(fd + 1);
+    }
+
+    static inline int unpack_fd(u64 value) {
+        return static_cast<int>(static_cast<u32>(value)) - 1;
+    }
+
+    /*!
+     * Checks whether an idle connection is still usable: the peer must not have closed it nor sent unexpected data.
+     */
+    static bool is_alive(int fd) {
+        char byte;
+        auto result = ::recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+        return result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+
+    static tcp_stream connect_blocking(const Address& address, std::chrono::milliseconds timeout) {
+        auto stream = tcp_stream::connect(address);
+        pollfd fd{stream.get_fd(), POLLOUT, 0};
+        int result;
+        do {
+            result = ::poll(&fd, 1, static_cast<int>(timeout.count()));
+        } while (result == -1 && errno == EINTR);
+        if (result == -1)
+            throw std::system_error(errno, std::generic_category(), "Cannot wait for the connection");
+        if (result == 0)
+            throw std::system_error(ETIMEDOUT, std::generic_category(), "Cannot connect to " + address.to_string());
+        if (int error = stream.get_error())
+            throw std::system_error(error, std::generic_category(), "Cannot connect to " + address.to_string());
+        return stream;
+    }
+
+    /*
+     * timer_wheel
+     */
+
+    /*!
+     * Hashed timer wheel of idle slots. An entry only evicts its slot if the slot still holds the same value,
+     * entries of connections checked out in the meantime are simply dropped.
+     */
+    struct connection_pool::timer_wheel
+    {
+        struct entry
+        {
+            pool_host* host;
+            u32 slot;
+            u64 value;
+            u64 deadline;
+        };
+
+        u64 resolution;
+        u64 current = 0;
+        std::vector<entry> buckets[WHEEL_SIZE];
+
+        explicit timer_wheel(u64 resolution) : resolution(resolution) {}
+
+        void add(const entry& e) {
+            u64 tick = std::max(e.deadline / resolution, current);
+            buckets[tick % WHEEL_SIZE].push_back(e);
+        }
+
+        template<typename F>
+        void advance(u64 now, F&& expire) {
+            u64 target = now / resolution;
+            if (target < current)
+                return;
+            // Past a full turn every bucket is visited once.
+            u64 first = target - current >= WHEEL_SIZE ? target - WHEEL_SIZE + 1 : current;
+            for (u64 tick = first; tick <= target; tick++) {
+                auto& bucket = buckets[tick % WHEEL_SIZE];
+                size_t kept = 0;
+                for (auto& e : bucket) {
+                    if (e.deadline <= now)
+                        expire(e);
+                    else
+                        bucket[kept++] = e;
+                }
+                bucket.resize(kept);
+            }
+            current = target + 1;
+        }
+    };
+
+    /*
+     * pooled_connection
+     */
+
+    pooled_connection::pooled_connection(connection_pool* pool, pool_host* host, tcp_stream stream, bool reused)
+            : _pool(pool), _host(host), _stream(std::move(stream)), _reused(reused) {}
+
+    pooled_connection::pooled_connection(pooled_connection&& other) noexcept : _pool(other._pool), _host(other._host),
+                                                                               _stream(std::move(other._stream)), _reused(other._reused) {
+        other._pool = nullptr;
+    }
+
+    pooled_connection::~pooled_connection() {
+        release();
+    }
+
+    void pooled_connection::discard() {
+        if (_pool) {
+            _pool->_discarded++;
+            _pool->close(*_host, _stream);
+            _pool = nullptr;
+        }
+    }
+
+    void pooled_connection::release() {
+        if (_pool) {
+            if (_stream.is_open())
+                _pool->give_back(*_host, std::move(_stream));
+            else
+                _pool->close(*_host, _stream);
+            _pool = nullptr;
+        }
+    }
+
+    pooled_connection& pooled_connection::operator=(pooled_connection&& other) noexcept {
+        if (this != &other) {
+            release();
+            _pool = other._pool;
+            _host = other._host;
+            _stream = std::move(other._stream);
+            _reused = other._reused;
+            other._pool = nullptr;
+        }
+        return *this;
+    }
+
+    /*
+     * connection_pool
+     */
+
+    connection_pool::connection_pool(connection_pool_options options) : _options(std::move(options)),
+                                                                       _epoch(std::chrono::steady_clock::now()) {
+        if (_options.max_per_host == 0 || _options.max_hosts == 0)
+            throw std::invalid_argument("The connection pool limits must be greater than 0.");
+        if (!_options.connector)
+            _options.connector = connect_blocking;
+
+        size_t size = 1;
+        while (size < static_cast<size_t>(_options.max_hosts) * 2)
+            size <<= 1;
+        _mask = size - 1;
+        _table.reset(new std::atomic<pool_host*>[size]);
+        for (size_t i = 0; i < size; i++)
+            _table[i].store(nullptr, std::memory_order_relaxed);
+        _hosts.reserve(_options.max_hosts);
+
+        _wheel = std::make_unique<timer_wheel>(static_cast<u64>(get_tick_interval().count()));
+    }
+
+    connection_pool::~connection_pool() {
+        clear();
+    }
+
+    u64 connection_pool::now_ms() const {
+        return static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _epoch).count());
+    }
+
+    pool_host* connection_pool::find_host(const Address& address) const {
+        size_t index = std::hash<Address>()(address) & _mask;
+        for (size_t probes = 0; probes <= _mask; probes++, index = (index + 1) & _mask) {
+            auto host = _table[index].load(std::memory_order_acquire);
+            if (host == nullptr)
+                return nullptr;
+            if (host->address == address)
+                return host;
+        }
+        return nullptr;
+    }
+
+    pool_host& connection_pool::get_host(const Address& address) {
+        if (auto host = find_host(address))
+            return *host;
+
+        std::lock_guard<std::mutex> lock(_hosts_mutex);
+        if (auto host = find_host(address))
+            return *host;
+        if (_hosts.size() == _options.max_hosts)
+            throw std::length_error("The connection pool cannot hold more than " + std::to_string(_options.max_hosts) + " addresses.");
+        _hosts.push_back(std::make_unique<pool_host>(address, _options.max_per_host));
+        auto host = _hosts.back().get();
+        size_t index = std::hash<Address>()(address) & _mask;
+        while (_table[index].load(std::memory_order_relaxed) != nullptr)
+            index = (index + 1) & _mask;
+        _table[index].store(host, std::memory_order_release);
+        return *host;
+    }
+
+    std::optional<tcp_stream> connection_pool::take_idle(pool_host& host) {
+        for (u32 i = 0; i < host.slot_count; i++) {
+            auto value = host.slots[i].load(std::memory_order_relaxed);
+            if (value != 0 && host.slots[i].compare_exchange_strong(value, 0))
+                return tcp_stream(unpack_fd(value));
+        }
+        return std::nullopt;
+    }
+
+    void connection_pool::give_back(pool_host& host, tcp_stream stream) {
+        auto now = now_ms();
+        auto value = pack_slot(stream.get_fd(), now);
+        for (u32 i = 0; i < host.slot_count; i++) {
+            u64 expected = 0;
+            if (host.slots[i].compare_exchange_strong(expected, value)) {
+                stream.release();
+                {
+                    std::lock_guard<std::mutex> lock(_wheel_mutex);
+                    _wheel->add({&host, i, value, now + static_cast<u64>(_options.idle_timeout.count())});
+                }
+                host.notify();
+                return;
+            }
+        }
+        // Every slot is taken, which only happens if connections were opened outside of the limit.
+        close(host, stream);
+    }
+
+    void connection_pool::close(pool_host& host, tcp_stream& stream) {
+        stream.close();
+        host.open--;
+        host.notify();
+    }
+
+    pooled_connection connection_pool::acquire(const Address& address) {
+        auto& host = get_host(address);
+        _checkouts++;
+
+        std::optional<std::chrono::steady_clock::time_point> wait_start;
+        auto record_wait = [&]() {
+            if (wait_start)
+                _wait_time_us += static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - *wait_start).count());
+        };
+
+        for (;;) {
+            while (auto stream = take_idle(host)) {
+                if (is_alive(stream->get_fd())) {
+                    _reused++;
+                    record_wait();
+                    return {this, &host, std::move(*stream), true};
+                }
+                _discarded++;
+                close(host, *stream);
+            }
+
+            u32 open = host.open.load();
+            while (open < _options.max_per_host) {
+                if (!host.open.compare_exchange_weak(open, open + 1))
+                    continue;
+                try {
+                    auto stream = _options.connector(address, _options.connect_timeout);
+                    _created++;
+                    record_wait();
+                    return {this, &host, std::move(stream), false};
+                } catch (...) {
+                    _connect_failures++;
+                    host.open--;
+                    host.notify();
+                    record_wait();
+                    throw;
+                }
+            }
+
+            // The limit is reached, wait for a connection to be given back or closed.
+            if (!wait_start) {
+                wait_start = std::chrono::steady_clock::now();
+                _waits++;
+            }
+            std::unique_lock<std::mutex> lock(host.mutex);
+            host.waiters++;
+            bool available = host.available.wait_until(lock, *wait_start + _options.wait_timeout, [&]() {
+                return host.has_idle() || host.open.load() < _options.max_per_host;
+            });
+            host.waiters--;
+            if (!available) {
+                record_wait();
+                throw std::system_error(ETIMEDOUT, std::generic_category(), "No connection to " + address.to_string() + " became available");
+            }
+        }
+    }
+
+    size_t connection_pool::tick() {
+        size_t count = 0;
+        std::lock_guard<std::mutex> lock(_wheel_mutex);
+        _wheel->advance(now_ms(), [&](const timer_wheel::entry& e) {
+            u64 expected = e.value;
+            if (e.host->slots[e.slot].compare_exchange_strong(expected, 0)) {
+                tcp_stream stream(unpack_fd(e.value));
+                close(*e.host, stream);
+                _evicted++;
+                count++;
+            }
+        });
+        return count;
+    }
+
+    void connection_pool::clear() {
+        std::lock_guard<std::mutex> lock(_hosts_mutex);
+        for (auto& host : _hosts) {
+            for (u32 i = 0; i < host->slot_count; i++) {
+                auto value = host->slots[i].exchange(0);
+                if (value != 0) {
+                    tcp_stream stream(unpack_fd(value));
+                    close(*host, stream);
+                }
+            }
+        }
+    }
+
+    size_t connection_pool::get_idle_count(const Address& address) const {
+        auto host = find_host(address);
+        if (host == nullptr)
+            return 0;
+        size_t count = 0;
+        for (u32 i = 0; i < host->slot_count; i++)
+            if (host->slots[i].load(std::memory_order_relaxed) != 0)
+                count++;
+        return count;
+    }
+
+    size_t connection_pool::get_open_count(const Address& address) const {
+        auto host = find_host(address);
+        return host == nullptr ? 0 : host->open.load();
+    }
+
+    std::chrono::milliseconds connection_pool::get_tick_interval() const {
+        return std::max(std::chrono::milliseconds(1), _options.idle_timeout / 128);
+    }
+
+    connection_pool_stats connection_pool::get_stats() const {
+        connection_pool_stats stats;
+        stats.checkouts = _checkouts.load();
+        stats.reused = _reused.load();
+        stats.created = _created.load();
+        stats.evicted = _evicted.load();
+        stats.discarded = _discarded.load();
+        stats.connect_failures = _connect_failures.load();
+        stats.waits = _waits.load();
+        stats.wait_time_us = _wait_time_us.load();
+        return stats;
+    }
+}
+
+#endif
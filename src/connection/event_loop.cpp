@@ -0,0 +1,297 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/connection/event_loop.h"
+
+#ifdef LAMBDA_HAS_EVENT_LOOP
+
+#include "../../include/lambdacommon/system/system.h"
+#include <cerrno>
+#include <system_error>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#define MAX_EVENTS 256
+
+namespace lambdacommon::connection
+{
+    static u32 to_epoll_events(u32 events) {
+        u32 epoll_events = EPOLLET | EPOLLRDHUP;
+        if (events & READABLE)
+            epoll_events |= EPOLLIN;
+        if (events & WRITABLE)
+            epoll_events |= EPOLLOUT;
+        return epoll_events;
+    }
+
+    static u32 from_epoll_events(u32 epoll_events) {
+        u32 events = 0;
+        if (epoll_events & EPOLLIN)
+            events |= READABLE;
+        if (epoll_events & EPOLLOUT)
+            events |= WRITABLE;
+        if (epoll_events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR))
+            events |= CLOSED;
+        return events;
+    }
+
+    static inline u64 to_event_data(int fd, u32 generation) {
+        return static_cast<u64>(generation) << 32u | static_cast<u32>(fd);
+    }
+
+    event_loop::event_loop() {
+        _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (_epoll_fd == -1)
+            throw std::system_error(errno, std::generic_category(), "Cannot create the epoll instance");
+        _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_wake_fd == -1) {
+            ::close(_epoll_fd);
+            throw std::system_error(errno, std::generic_category(), "Cannot create the wake up event");
+        }
+        // The wake up event is the only one of generation 0.
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.u64 = to_event_data(_wake_fd, 0);
+        epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wake_fd, &event);
+    }
+
+    event_loop::~event_loop() {
+        ::close(_wake_fd);
+        ::close(_epoll_fd);
+    }
+
+    void event_loop::wake() {
+        u64 one = 1;
+        [[maybe_unused]] auto result = ::write(_wake_fd, &one, sizeof(one));
+    }
+
+    void event_loop::add(int fd, u32 events, io_callback callback) {
+        u32 generation = _next_generation++;
+        if (_next_generation == 0)
+            _next_generation = 1;
+        epoll_event event{};
+        event.events = to_epoll_events(events);
+        event.data.u64 = to_event_data(fd, generation);
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1)
+            throw std::system_error(errno, std::generic_category(), "Cannot watch the file descriptor");
+        _handlers[fd] = {std::make_shared<io_callback>(std::move(callback)), generation};
+    }
+
+    void event_loop::modify(int fd, u32 events) {
+        auto handler = _handlers.find(fd);
+        if (handler == _handlers.end())
+            throw std::system_error(ENOENT, std::generic_category(), "Cannot modify the watched events");
+        epoll_event event{};
+        event.events = to_epoll_events(events);
+        event.data.u64 = to_event_data(fd, handler->second.generation);
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &event) == -1)
+            throw std::system_error(errno, std::generic_category(), "Cannot modify the watched events");
+    }
+
+    void event_loop::remove(int fd) {
+        if (_handlers.erase(fd) != 0)
+            epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    bool event_loop::is_watched(int fd) const {
+        return _handlers.count(fd) != 0;
+    }
+
+    event_loop::timer_id event_loop::set_timeout(clock::duration delay, task callback) {
+        auto id = _next_timer_id++;
+        _timer_entries[id] = {std::move(callback), clock::duration::zero()};
+        _timers.push({clock::now() + delay, id});
+        return id;
+    }
+
+    event_loop::timer_id event_loop::set_interval(clock::duration interval, task callback) {
+        auto id = _next_timer_id++;
+        _timer_entries[id] = {std::move(callback), interval};
+        _timers.push({clock::now() + interval, id});
+        return id;
+    }
+
+    bool event_loop::cancel_timer(timer_id id) {
+        // The heap entry is discarded lazily when it expires.
+        return _timer_entries.erase(id) != 0;
+    }
+
+    void event_loop::post(task callback) {
+        {
+            std::lock_guard<std::mutex> lock(_posted_mutex);
+            _posted.push_back(std::move(callback));
+        }
+        wake();
+    }
+
+    int event_loop::next_timeout(int timeout_ms) const {
+        if (_timers.empty())
+            return timeout_ms;
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(_timers.top().deadline - clock::now()).count();
+        // Round up so the timer is due when the loop wakes up.
+        int timer_ms = remaining <= 0 ? 0 : static_cast<int>(remaining + 1);
+        return timeout_ms < 0 ? timer_ms : std::min(timeout_ms, timer_ms);
+    }
+
+    size_t event_loop::run_timers() {
+        size_t count = 0;
+        auto now = clock::now();
+        while (!_timers.empty() && !(now < _timers.top().deadline)) {
+            auto expired = _timers.top();
+            _timers.pop();
+            auto entry = _timer_entries.find(expired.id);
+            if (entry == _timer_entries.end())
+                continue; // Cancelled.
+
+            task callback;
+            if (entry->second.interval == clock::duration::zero()) {
+                callback = std::move(entry->second.callback);
+                _timer_entries.erase(entry);
+            } else {
+                callback = entry->second.callback;
+                _timers.push({expired.deadline + entry->second.interval, expired.id});
+            }
+            callback();
+            count++;
+        }
+        return count;
+    }
+
+    size_t event_loop::run_posted() {
+        std::vector<task> posted;
+        {
+            std::lock_guard<std::mutex> lock(_posted_mutex);
+            posted.swap(_posted);
+        }
+        for (auto& callback : posted)
+            callback();
+        return posted.size();
+    }
+
+    size_t event_loop::run_once(int timeout_ms) {
+        epoll_event events[MAX_EVENTS];
+        int count = epoll_wait(_epoll_fd, events, MAX_EVENTS, next_timeout(timeout_ms));
+        if (count == -1 && errno != EINTR)
+            throw std::system_error(errno, std::generic_category(), "Cannot wait for events");
+
+        size_t called = 0;
+        for (int i = 0; i < count; i++) {
+            int fd = static_cast<int>(static_cast<u32>(events[i].data.u64));
+            u32 generation = static_cast<u32>(events[i].data.u64 >> 32u);
+            if (generation == 0) {
+                u64 value;
+                while (::read(_wake_fd, &value, sizeof(value)) > 0);
+                continue;
+            }
+            auto handler = _handlers.find(fd);
+            // Removed by a previous callback, which may also have watched a new file descriptor with the same number.
+            if (handler == _handlers.end() || handler->second.generation != generation)
+                continue;
+            // Keep the callback alive even if it removes itself.
+            auto callback = handler->second.callback;
+            (*callback)(from_epoll_events(events[i].events));
+            called++;
+        }
+        called += run_timers();
+        called += run_posted();
+        return called;
+    }
+
+    void event_loop::run() {
+        _running = true;
+        try {
+            while (!_stop_requested)
+                run_once();
+        } catch (...) {
+            _stop_requested = false;
+            _running = false;
+            throw;
+        }
+        _stop_requested = false;
+        _running = false;
+    }
+
+    void event_loop::stop() {
+        _stop_requested = true;
+        wake();
+    }
+
+    bool event_loop::is_running() const {
+        return _running;
+    }
+
+    /*
+     * event_loop_group
+     */
+
+    event_loop_group::event_loop_group(u32 count) {
+        if (count == 0)
+            count = std::max(1u, system::get_cpu_cores());
+        for (u32 i = 0; i < count; i++)
+            _loops.push_back(std::make_unique<event_loop>());
+    }
+
+    event_loop_group::~event_loop_group() {
+        join();
+    }
+
+    size_t event_loop_group::size() const {
+        return _loops.size();
+    }
+
+    event_loop& event_loop_group::get(size_t index) {
+        return *_loops.at(index);
+    }
+
+    void event_loop_group::start(const std::function<void(event_loop&, size_t)>& setup) {
+        u32 cores = std::max(1u, system::get_cpu_cores());
+        for (size_t i = 0; i < _loops.size(); i++) {
+            _threads.emplace_back([this, i, cores, setup]() {
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                CPU_SET(i % cores, &cpu_set);
+                pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+
+                // An exception must not escape the thread, it is kept for stop().
+                try {
+                    auto& loop = *_loops[i];
+                    if (setup)
+                        setup(loop, i);
+                    loop.run();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(_error_mutex);
+                    if (!_error)
+                        _error = std::current_exception();
+                }
+            });
+        }
+    }
+
+    void event_loop_group::join() {
+        for (auto& loop : _loops)
+            loop->stop();
+        for (auto& thread : _threads)
+            if (thread.joinable())
+                thread.join();
+        _threads.clear();
+    }
+
+    void event_loop_group::stop() {
+        join();
+        std::exception_ptr error;
+        std::swap(error, _error);
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+#endif
@@ -0,0 +1,465 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/connection/http.h"
+#include "../../include/lambdacommon/lstring.h"
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LAMBDA_HTTP_SSE2
+#  include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+namespace lambdacommon::connection::http
+{
+    /*!
+     * The token characters of RFC 7230, used by methods and header names.
+     */
+    static constexpr std::array<bool, 256> TOKEN_CHARS = []() {
+        std::array<bool, 256> table{};
+        for (int c = '0'; c <= '9'; c++)
+            table[c] = true;
+        for (int c = 'a'; c <= 'z'; c++)
+            table[c] = table[c - 32] = true;
+        for (char c : std::string_view("!#$%&'*+-.^_`|~"))
+            table[static_cast<u8>(c)] = true;
+        return table;
+    }();
+
+    static inline bool is_token(std::string_view value) {
+        if (value.empty())
+            return false;
+        for (char c : value)
+            if (!TOKEN_CHARS[static_cast<u8>(c)])
+                return false;
+        return true;
+    }
+
+    static inline bool is_control(char c) {
+        auto byte = static_cast<u8>(c);
+        return (byte < 0x20 && byte != '\t') || byte == 0x7F;
+    }
+
+    static inline u32 count_trailing_zeros(u32 mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return static_cast<u32>(__builtin_ctz(mask));
+#endif
+    }
+
+    /*!
+     * Finds the first control character (CR, LF or an invalid one) from an offset, 16 bytes at a time when SSE2 is available.
+     * @return The offset of the control character, or the size of the data.
+     */
+    static size_t find_control(const char* data, size_t offset, size_t size) {
+#ifdef LAMBDA_HTTP_SSE2
+        const auto max_control = _mm_set1_epi8(0x1F);
+        const auto tab = _mm_set1_epi8('\t');
+        const auto del = _mm_set1_epi8(0x7F);
+        for (; offset + 16 <= size; offset += 16) {
+            auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+            // Unsigned chunk <= 0x1F, except the horizontal tab, or DEL.
+            auto control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, max_control), max_control);
+            control = _mm_andnot_si128(_mm_cmpeq_epi8(chunk, tab), control);
+            control = _mm_or_si128(control, _mm_cmpeq_epi8(chunk, del));
+            auto mask = static_cast<u32>(_mm_movemask_epi8(control));
+            if (mask != 0)
+                return offset + count_trailing_zeros(mask);
+        }
+#endif
+        for (; offset < size; offset++)
+            if (is_control(data[offset]))
+                return offset;
+        return size;
+    }
+
+    static inline std::string_view trim_whitespaces(std::string_view value) {
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+            value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+            value.remove_suffix(1);
+        return value;
+    }
+
+    /*!
+     * Splits the next line, without its CRLF or LF.
+     */
+    static inline std::string_view next_line(std::string_view& lines) {
+        auto end = lines.find('\n');
+        auto line = lines.substr(0, end);
+        lines.remove_prefix(end == std::string_view::npos ? lines.size() : end + 1);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        return line;
+    }
+
+    static std::optional<u64> parse_content_length(std::string_view value) {
+        if (value.empty() || value.size() > 19)
+            return std::nullopt;
+        u64 length = 0;
+        for (char c : value) {
+            if (c < '0' || c > '9')
+                return std::nullopt;
+            length = length * 10 + static_cast<u64>(c - '0');
+        }
+        return length;
+    }
+
+    /*!
+     * Skips the empty lines allowed before a start line.
+     */
+    static size_t skip_leading_lines(std::string_view data) {
+        size_t start = 0;
+        while (start < data.size() && (data[start] == '\r' || data[start] == '\n'))
+            start++;
+        return start;
+    }
+
+    /*
+     * message_parser
+     */
+
+    message_parser::message_parser(size_t max_head_size) : _max_head_size(max_head_size) {}
+
+    parse_status message_parser::find_head_end(std::string_view data) {
+        auto bytes = data.data();
+        auto size = data.size();
+        size_t offset = std::max(_scanned, skip_leading_lines(data));
+        for (;;) {
+            offset = find_control(bytes, offset, size);
+            if (offset == size)
+                break;
+            char c = bytes[offset];
+            if (c == '\r') {
+                // A CR must be followed by a LF, which is checked once available.
+                if (offset + 1 < size && bytes[offset + 1] != '\n')
+                    return INVALID;
+                if (offset + 1 == size)
+                    break;
+                offset++;
+                continue;
+            }
+            if (c != '\n')
+                return INVALID;
+
+            // An empty line ends the head.
+            if (offset + 1 < size && bytes[offset + 1] == '\n') {
+                _head_size = offset + 2;
+                return COMPLETE;
+            }
+            if (offset + 2 < size && bytes[offset + 1] == '\r' && bytes[offset + 2] == '\n') {
+                _head_size = offset + 3;
+                return COMPLETE;
+            }
+            if (offset + 1 == size || (offset + 2 == size && bytes[offset + 1] == '\r'))
+                break;
+            offset++;
+        }
+
+        // Resume from the last byte which may start the end of the head.
+        _scanned = offset;
+        if (size > _max_head_size)
+            return INVALID;
+        return INCOMPLETE;
+    }
+
+    bool message_parser::parse_headers(std::string_view lines) {
+        _header_count = 0;
+        std::optional<u64> content_length;
+        bool transfer_encoding = false;
+        for (;;) {
+            auto line = next_line(lines);
+            if (line.empty())
+                // A message with both framings would be read differently by each hop, it is a request smuggling vector.
+                return !(transfer_encoding && content_length);
+            // Obsolete line folding is rejected.
+            if (line.front() == ' ' || line.front() == '\t')
+                return false;
+            auto colon = line.find(':');
+            if (colon == std::string_view::npos)
+                return false;
+            auto name = line.substr(0, colon);
+            if (!is_token(name) || _header_count == MAX_HEADERS)
+                return false;
+            auto value = trim_whitespaces(line.substr(colon + 1));
+            if (value.find('\r') != std::string_view::npos)
+                return false;
+
+            if (lstring::equals_ignore_case(name, "Transfer-Encoding"))
+                transfer_encoding = true;
+            else if (lstring::equals_ignore_case(name, "Content-Length")) {
+                // An invalid or ambiguous length would desynchronize the connection.
+                auto length = parse_content_length(value);
+                if (!length || (content_length && *content_length != *length))
+                    return false;
+                content_length = length;
+            }
+            _headers[_header_count++] = {name, value};
+        }
+    }
+
+    bool message_parser::parse_version(std::string_view version) {
+        if (version.size() != 8 || version.substr(0, 7) != "HTTP/1." || version[7] < '0' || version[7] > '9')
+            return false;
+        _minor_version = static_cast<u8>(version[7] - '0');
+        return true;
+    }
+
+    std::optional<std::string_view> message_parser::find_header(std::string_view name) const {
+        for (size_t i = 0; i < _header_count; i++)
+            if (lstring::equals_ignore_case(_headers[i].name, name))
+                return _headers[i].value;
+        return std::nullopt;
+    }
+
+    bool message_parser::has_header_token(std::string_view name, std::string_view token) const {
+        for (size_t i = 0; i < _header_count; i++) {
+            if (!lstring::equals_ignore_case(_headers[i].name, name))
+                continue;
+            auto value = _headers[i].value;
+            while (!value.empty()) {
+                auto comma = value.find(',');
+                if (lstring::equals_ignore_case(trim_whitespaces(value.substr(0, comma)), token))
+                    return true;
+                if (comma == std::string_view::npos)
+                    break;
+                value.remove_prefix(comma + 1);
+            }
+        }
+        return false;
+    }
+
+    std::optional<u64> message_parser::get_content_length() const {
+        if (auto value = find_header("Content-Length"))
+            return parse_content_length(*value);
+        return std::nullopt;
+    }
+
+    bool message_parser::is_chunked() const {
+        return has_header_token("Transfer-Encoding", "chunked");
+    }
+
+    bool message_parser::is_keep_alive() const {
+        if (_minor_version == 0)
+            return has_header_token("Connection", "keep-alive");
+        return !has_header_token("Connection", "close");
+    }
+
+    void message_parser::reset() {
+        _header_count = 0;
+        _head_size = 0;
+        _scanned = 0;
+        _minor_version = 1;
+    }
+
+    /*
+     * request_parser
+     */
+
+    request_parser::request_parser(size_t max_head_size) : message_parser(max_head_size) {}
+
+    parse_status request_parser::parse(std::string_view data) {
+        auto status = find_head_end(data);
+        if (status != COMPLETE)
+            return status;
+
+        auto head = data.substr(0, _head_size);
+        head.remove_prefix(skip_leading_lines(head));
+        auto line = next_line(head);
+
+        // method SP request-target SP HTTP-version
+        auto method_end = line.find(' ');
+        if (method_end == std::string_view::npos)
+            return INVALID;
+        _method = line.substr(0, method_end);
+        auto target_end = line.find(' ', method_end + 1);
+        if (!is_token(_method) || target_end == std::string_view::npos)
+            return INVALID;
+        auto raw_target = line.substr(method_end + 1, target_end - method_end - 1);
+        auto target = _method == "CONNECT" ? uri::uri_view::parse_authority_form(raw_target) : uri::uri_view::parse(raw_target);
+        if (!target || !parse_version(line.substr(target_end + 1)))
+            return INVALID;
+        _target = *target;
+
+        if (!parse_headers(head))
+            return INVALID;
+        return COMPLETE;
+    }
+
+    void request_parser::reset() {
+        message_parser::reset();
+        _method = {};
+        _target = {};
+    }
+
+    /*
+     * response_parser
+     */
+
+    response_parser::response_parser(size_t max_head_size) : message_parser(max_head_size) {}
+
+    parse_status response_parser::parse(std::string_view data) {
+        auto status = find_head_end(data);
+        if (status != COMPLETE)
+            return status;
+
+        auto head = data.substr(0, _head_size);
+        head.remove_prefix(skip_leading_lines(head));
+        auto line = next_line(head);
+
+        // HTTP-version SP status-code SP reason-phrase
+        if (line.size() < 12 || line[8] != ' ' || !parse_version(line.substr(0, 8)))
+            return INVALID;
+        _status = 0;
+        for (size_t i = 9; i < 12; i++) {
+            if (line[i] < '0' || line[i] > '9')
+                return INVALID;
+            _status = static_cast<u16>(_status * 10 + (line[i] - '0'));
+        }
+        if (line.size() > 12 && line[12] != ' ')
+            return INVALID;
+        _reason = line.size() > 13 ? line.substr(13) : std::string_view();
+
+        if (!parse_headers(head))
+            return INVALID;
+        return COMPLETE;
+    }
+
+    void response_parser::reset() {
+        message_parser::reset();
+        _status = 0;
+        _reason = {};
+    }
+
+    /*
+     * chunked_decoder
+     */
+
+    static inline int hex_value(char c) {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    parse_status chunked_decoder::decode(char* data, size_t& size) {
+        size_t src = 0, dst = 0;
+        for (;;) {
+            if (_state == DONE) {
+                _consumed = src;
+                size = dst;
+                return COMPLETE;
+            }
+            if (src == size)
+                break;
+            switch (_state) {
+                case SIZE: {
+                    int value = hex_value(data[src]);
+                    if (value < 0) {
+                        // The size ends with an extension, optionally preceded by whitespace, or with the line.
+                        char c = data[src];
+                        if (_digits == 0 || (c != ';' && c != ' ' && c != '\t' && c != '\r' && c != '\n'))
+                            return INVALID;
+                        _state = SIZE_EXTENSION;
+                        break;
+                    }
+                    // More than 15 digits would overflow.
+                    if (++_digits > 15)
+                        return INVALID;
+                    _chunk_size = _chunk_size * 16 + static_cast<u64>(value);
+                    src++;
+                    break;
+                }
+                case SIZE_EXTENSION: {
+                    // Chunk extensions are ignored.
+                    auto line_end = static_cast<const char*>(std::memchr(data + src, '\n', size - src));
+                    if (line_end == nullptr) {
+                        src = size;
+                        break;
+                    }
+                    src = static_cast<size_t>(line_end - data) + 1;
+                    _state = _chunk_size == 0 ? TRAILER_START : DATA;
+                    break;
+                }
+                case DATA: {
+                    auto count = static_cast<size_t>(std::min<u64>(_chunk_size, size - src));
+                    std::memmove(data + dst, data + src, count);
+                    dst += count;
+                    src += count;
+                    _chunk_size -= count;
+                    if (_chunk_size == 0)
+                        _state = DATA_CR;
+                    break;
+                }
+                case DATA_CR:
+                    if (data[src] != '\r')
+                        return INVALID;
+                    src++;
+                    _state = DATA_LF;
+                    break;
+                case DATA_LF:
+                    if (data[src] != '\n')
+                        return INVALID;
+                    src++;
+                    _digits = 0;
+                    _state = SIZE;
+                    break;
+                case TRAILER_START:
+                    if (data[src] == '\n') {
+                        src++;
+                        _state = DONE;
+                    } else if (data[src] == '\r') {
+                        src++;
+                        _state = TRAILER_LF;
+                    } else
+                        _state = TRAILER_LINE;
+                    break;
+                case TRAILER_LF:
+                    if (data[src] != '\n')
+                        return INVALID;
+                    src++;
+                    _state = DONE;
+                    break;
+                case TRAILER_LINE: {
+                    auto line_end = static_cast<const char*>(std::memchr(data + src, '\n', size - src));
+                    if (line_end == nullptr) {
+                        src = size;
+                        break;
+                    }
+                    src = static_cast<size_t>(line_end - data) + 1;
+                    _state = TRAILER_START;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        _consumed = src;
+        size = dst;
+        return INCOMPLETE;
+    }
+
+    void chunked_decoder::reset() {
+        _state = SIZE;
+        _digits = 0;
+        _chunk_size = 0;
+        _consumed = 0;
+    }
+}
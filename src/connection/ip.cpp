@@ -0,0 +1,368 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/connection/ip.h"
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+namespace lambdacommon
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    static inline int hex_value(char c) {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        else if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    static inline u32 count_leading_zeros(u64 bits) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, bits);
+        return 63 - static_cast<u32>(index);
+#else
+        return static_cast<u32>(__builtin_clzll(bits));
+#endif
+    }
+
+    /*!
+     * Parses an IPv4 address in dotted-decimal notation into 4 bytes.
+     */
+    static bool parse_v4_bytes(std::string_view str, u8* out) {
+        size_t i = 0;
+        for (int part = 0; part < 4; part++) {
+            if (part != 0) {
+                if (i >= str.size() || str[i] != '.')
+                    return false;
+                i++;
+            }
+            size_t start = i;
+            u32 value = 0;
+            while (i < str.size() && str[i] >= '0' && str[i] <= '9' && i - start < 3) {
+                value = value * 10 + static_cast<u32>(str[i] - '0');
+                i++;
+            }
+            // Reject empty parts, values over 255 and leading zeros (which some parsers read as octal).
+            if (i == start || value > 255 || (str[start] == '0' && i - start > 1))
+                return false;
+            out[part] = static_cast<u8>(value);
+        }
+        return i == str.size();
+    }
+
+    /*
+     * ip_address
+     */
+
+    u64 ip_address::get_high() const {
+        u64 value = 0;
+        for (size_t i = 0; i < 8; i++)
+            value = (value << 8) | _bytes[i];
+        return value;
+    }
+
+    u64 ip_address::get_low() const {
+        u64 value = 0;
+        for (size_t i = 8; i < 16; i++)
+            value = (value << 8) | _bytes[i];
+        return value;
+    }
+
+    bool ip_address::is_v4() const {
+        return get_high() == 0 && (get_low() >> 32) == 0xFFFF;
+    }
+
+    u32 ip_address::to_v4() const {
+        return static_cast<u32>(get_low());
+    }
+
+    bool ip_address::is_unspecified() const {
+        return (get_high() == 0 && get_low() == 0) || (is_v4() && to_v4() == 0);
+    }
+
+    bool ip_address::is_loopback() const {
+        if (is_v4())
+            return (to_v4() >> 24) == 127;
+        return get_high() == 0 && get_low() == 1;
+    }
+
+    ip_address ip_address::masked(u32 prefix_length) const {
+        ip_address result;
+        for (u32 i = 0; i < 16; i++) {
+            u32 bit = i * 8;
+            if (prefix_length >= bit + 8)
+                result._bytes[i] = _bytes[i];
+            else if (prefix_length > bit)
+                result._bytes[i] = static_cast<u8>(_bytes[i] & (0xFF << (8 - (prefix_length - bit))));
+        }
+        return result;
+    }
+
+    u32 ip_address::common_prefix_length(const ip_address& other) const {
+        u64 diff = get_high() ^ other.get_high();
+        if (diff != 0)
+            return count_leading_zeros(diff);
+        diff = get_low() ^ other.get_low();
+        if (diff != 0)
+            return 64 + count_leading_zeros(diff);
+        return 128;
+    }
+
+    size_t ip_address::format(char* buffer, size_t size) const {
+        char out[MAX_STRING_LENGTH + 1];
+        size_t length = 0;
+        if (is_v4()) {
+            for (size_t i = 12; i < 16; i++) {
+                if (i != 12)
+                    out[length++] = '.';
+                u8 value = _bytes[i];
+                if (value >= 100)
+                    out[length++] = static_cast<char>('0' + value / 100);
+                if (value >= 10)
+                    out[length++] = static_cast<char>('0' + (value / 10) % 10);
+                out[length++] = static_cast<char>('0' + value % 10);
+            }
+        } else {
+            u16 groups[8];
+            for (size_t i = 0; i < 8; i++)
+                groups[i] = static_cast<u16>((_bytes[i * 2] << 8) | _bytes[i * 2 + 1]);
+
+            // RFC 5952: compress the longest run of at least two zero groups, the first one on ties.
+            int best_start = -1, best_length = 0;
+            for (int i = 0; i < 8;) {
+                if (groups[i] != 0) {
+                    i++;
+                    continue;
+                }
+                int start = i;
+                while (i < 8 && groups[i] == 0)
+                    i++;
+                if (i - start > best_length && i - start >= 2) {
+                    best_start = start;
+                    best_length = i - start;
+                }
+            }
+
+            for (int i = 0; i < 8; i++) {
+                if (i == best_start) {
+                    out[length++] = ':';
+                    if (i == 0)
+                        out[length++] = ':';
+                    i += best_length - 1;
+                    continue;
+                }
+                u16 group = groups[i];
+                bool leading = true;
+                for (int shift = 12; shift >= 0; shift -= 4) {
+                    u16 digit = (group >> shift) & 0xF;
+                    if (leading && digit == 0 && shift != 0)
+                        continue;
+                    leading = false;
+                    out[length++] = HEX_DIGITS[digit];
+                }
+                if (i != 7)
+                    out[length++] = ':';
+            }
+        }
+
+        if (length > size)
+            return 0;
+        std::memcpy(buffer, out, length);
+        if (length < size)
+            buffer[length] = '\0';
+        return length;
+    }
+
+    std::string ip_address::to_string() const {
+        char buffer[MAX_STRING_LENGTH + 1];
+        return std::string(buffer, format(buffer, sizeof(buffer)));
+    }
+
+    bool ip_address::operator==(const ip_address& other) const {
+        return _bytes == other._bytes;
+    }
+
+    bool ip_address::operator!=(const ip_address& other) const {
+        return _bytes != other._bytes;
+    }
+
+    bool ip_address::operator<(const ip_address& other) const {
+        return _bytes < other._bytes;
+    }
+
+    ip_address ip_address::from_v4(u32 address) {
+        ip_address result;
+        result._bytes[10] = 0xFF;
+        result._bytes[11] = 0xFF;
+        result._bytes[12] = static_cast<u8>(address >> 24);
+        result._bytes[13] = static_cast<u8>(address >> 16);
+        result._bytes[14] = static_cast<u8>(address >> 8);
+        result._bytes[15] = static_cast<u8>(address);
+        return result;
+    }
+
+    std::optional<ip_address> ip_address::parse_v4(std::string_view str) {
+        ip_address result;
+        if (!parse_v4_bytes(str, result._bytes.data() + 12))
+            return std::nullopt;
+        result._bytes[10] = 0xFF;
+        result._bytes[11] = 0xFF;
+        return result;
+    }
+
+    std::optional<ip_address> ip_address::parse_v6(std::string_view str) {
+        if (str.size() < 2 || str.size() > MAX_STRING_LENGTH)
+            return std::nullopt;
+
+        ip_address result;
+        u8* bytes = result._bytes.data();
+        size_t i = 0, written = 0;
+        int compress_at = -1;
+
+        if (str[0] == ':') {
+            if (str[1] != ':')
+                return std::nullopt;
+            compress_at = 0;
+            i = 2;
+        }
+
+        while (i < str.size()) {
+            if (written == 16)
+                return std::nullopt;
+
+            size_t start = i;
+            u32 value = 0;
+            while (i < str.size() && i - start < 4) {
+                int digit = hex_value(str[i]);
+                if (digit < 0)
+                    break;
+                value = (value << 4) | static_cast<u32>(digit);
+                i++;
+            }
+
+            if (i < str.size() && str[i] == '.') {
+                // Embedded IPv4 address as the last 32 bits.
+                if (written > 12 || !parse_v4_bytes(str.substr(start), bytes + written))
+                    return std::nullopt;
+                written += 4;
+                i = str.size();
+                break;
+            }
+            if (i == start)
+                return std::nullopt;
+
+            bytes[written++] = static_cast<u8>(value >> 8);
+            bytes[written++] = static_cast<u8>(value);
+
+            if (i == str.size())
+                break;
+            if (str[i] != ':')
+                return std::nullopt;
+            i++;
+            if (i < str.size() && str[i] == ':') {
+                if (compress_at != -1)
+                    return std::nullopt;
+                compress_at = static_cast<int>(written);
+                i++;
+            } else if (i == str.size())
+                return std::nullopt; // Trailing single colon.
+        }
+
+        if (compress_at != -1) {
+            if (written == 16)
+                return std::nullopt;
+            size_t tail = written - static_cast<size_t>(compress_at);
+            std::memmove(bytes + 16 - tail, bytes + compress_at, tail);
+            std::memset(bytes + compress_at, 0, 16 - tail - static_cast<size_t>(compress_at));
+        } else if (written != 16)
+            return std::nullopt;
+        return result;
+    }
+
+    std::optional<ip_address> ip_address::parse(std::string_view str) {
+        if (str.find(':') != std::string_view::npos)
+            return parse_v6(str);
+        return parse_v4(str);
+    }
+
+    /*
+     * cidr
+     */
+
+    cidr::cidr(const ip_address& address, u32 prefix_length) {
+        u32 bits = address.is_v4() ? prefix_length + 96 : prefix_length;
+        if ((address.is_v4() && prefix_length > 32) || bits > 128)
+            throw std::out_of_range("The prefix length is out of range.");
+        _address = address.masked(bits);
+        _length = static_cast<u8>(bits);
+    }
+
+    const ip_address& cidr::get_address() const {
+        return _address;
+    }
+
+    u32 cidr::get_prefix_length() const {
+        return _address.is_v4() && _length >= 96 ? _length - 96u : _length;
+    }
+
+    bool cidr::contains(const ip_address& address) const {
+        return address.common_prefix_length(_address) >= _length;
+    }
+
+    std::string cidr::to_string() const {
+        return _address.to_string() + '/' + std::to_string(get_prefix_length());
+    }
+
+    bool cidr::operator==(const cidr& other) const {
+        return _length == other._length && _address == other._address;
+    }
+
+    bool cidr::operator!=(const cidr& other) const {
+        return !(*this == other);
+    }
+
+    std::optional<cidr> cidr::parse(std::string_view str) {
+        auto separator = str.find('/');
+        auto address_str = str.substr(0, separator);
+        bool v6 = address_str.find(':') != std::string_view::npos;
+        auto address = v6 ? ip_address::parse_v6(address_str) : ip_address::parse_v4(address_str);
+        if (!address)
+            return std::nullopt;
+
+        u32 max_length = v6 ? 128 : 32;
+        u32 length = max_length;
+        if (separator != std::string_view::npos) {
+            auto length_str = str.substr(separator + 1);
+            if (length_str.empty() || length_str.size() > 3)
+                return std::nullopt;
+            length = 0;
+            for (char c : length_str) {
+                if (c < '0' || c > '9')
+                    return std::nullopt;
+                length = length * 10 + static_cast<u32>(c - '0');
+            }
+            if (length > max_length)
+                return std::nullopt;
+        }
+
+        cidr result;
+        u32 bits = v6 ? length : length + 96;
+        result._address = address->masked(bits);
+        result._length = static_cast<u8>(bits);
+        return result;
+    }
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/connection/resolver.h"
+#include "../../include/lambdacommon/lstring.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#ifdef LAMBDA_WINDOWS
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#elif !defined(LAMBDA_WASM)
+#  include <netdb.h>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#endif
+
+namespace lambdacommon::connection
+{
+    class resolver_error_category : public std::error_category
+    {
+    public:
+        const char* name() const noexcept override {
+            return "resolver";
+        }
+
+        std::string message(int code) const override {
+#ifdef LAMBDA_WASM
+            return "Resolver error " + std::to_string(code);
+#else
+            return gai_strerror(code);
+#endif
+        }
+    };
+
+    const std::error_category& resolver_category() {
+        static const resolver_error_category category;
+        return category;
+    }
+
+    /*!
+     * Resolves a host name with getaddrinfo().
+     */
+    static std::vector<ip_address> lookup_host(const std::string& host) {
+        std::vector<ip_address> addresses;
+#ifdef LAMBDA_WASM
+        throw std::system_error(std::make_error_code(std::errc::not_supported), "Cannot resolve " + host);
+#else
+#  ifdef LAMBDA_WINDOWS
+        static const bool initialized = []() {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        (void) initialized;
+#  endif
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        // Restrict the socket type, else every address is listed once per type.
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* results = nullptr;
+        int error = getaddrinfo(host.c_str(), nullptr, &hints, &results);
+        if (error != 0) {
+            if (error == EAI_NONAME
+#  ifdef EAI_NODATA
+                || error == EAI_NODATA
+#  endif
+                    )
+                return addresses;
+#  ifdef EAI_SYSTEM
+            // The actual error is in errno.
+            if (error == EAI_SYSTEM)
+                throw std::system_error(errno, std::generic_category(), "Cannot resolve " + host);
+#  endif
+            throw std::system_error(error, resolver_category(), "Cannot resolve " + host);
+        }
+
+        for (auto info = results; info != nullptr; info = info->ai_next) {
+            ip_address address;
+            if (info->ai_family == AF_INET) {
+                auto sin = reinterpret_cast<const sockaddr_in*>(info->ai_addr);
+                address = ip_address::from_v4(ntohl(sin->sin_addr.s_addr));
+            } else if (info->ai_family == AF_INET6) {
+                auto sin6 = reinterpret_cast<const sockaddr_in6*>(info->ai_addr);
+                std::array<u8, 16> bytes{};
+                std::memcpy(bytes.data(), &sin6->sin6_addr, 16);
+                address = ip_address(bytes);
+            } else
+                continue;
+            if (std::find(addresses.begin(), addresses.end(), address) == addresses.end())
+                addresses.push_back(address);
+        }
+        freeaddrinfo(results);
+        return addresses;
+#endif
+    }
+
+    resolver::resolver(resolver_options options) : _options(std::move(options)), _pool(std::max(1u, _options.threads)) {
+        if (!_options.lookup)
+            _options.lookup = lookup_host;
+    }
+
+    void resolver::complete(const std::string& host, bool success) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _cache.find(host);
+        if (it != _cache.end()) {
+            it->second.pending = false;
+            it->second.expiration = clock::now() + (success ? _options.ttl : _options.negative_ttl);
+        }
+    }
+
+    void resolver::evict(clock::time_point now) {
+        for (auto it = _cache.begin(); it != _cache.end();) {
+            if (!it->second.pending && it->second.expiration < now)
+                it = _cache.erase(it);
+            else
+                ++it;
+        }
+        // Still full: drop completed entries, pending lookups are kept so their requests stay deduplicated.
+        for (auto it = _cache.begin(); it != _cache.end() && _cache.size() >= _options.max_entries;) {
+            if (!it->second.pending)
+                it = _cache.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    resolver::result resolver::resolve(const std::string& host) {
+        if (auto ip = ip_address::parse(host)) {
+            std::promise<std::vector<ip_address>> promise;
+            promise.set_value({*ip});
+            return promise.get_future().share();
+        }
+
+        auto key = lstring::to_lower_case(host);
+        auto now = clock::now();
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _cache.find(key);
+        if (it != _cache.end()) {
+            if (it->second.pending) {
+                _stats.joined++;
+                return it->second.addresses;
+            }
+            if (now < it->second.expiration) {
+                _stats.cache_hits++;
+                return it->second.addresses;
+            }
+            _cache.erase(it);
+        }
+
+        if (_cache.size() >= _options.max_entries)
+            evict(now);
+
+        auto promise = std::make_shared<std::promise<std::vector<ip_address>>>();
+        auto future = promise->get_future().share();
+        _cache[key] = {future, {}, true};
+        _stats.lookups++;
+        _pool.post([this, key, promise]() {
+            // The entry is completed before the promise is fulfilled, so a caller woken by the result already sees it cached.
+            std::vector<ip_address> addresses;
+            try {
+                addresses = _options.lookup(key);
+            } catch (...) {
+                complete(key, false);
+                promise->set_exception(std::current_exception());
+                return;
+            }
+            complete(key, !addresses.empty());
+            promise->set_value(std::move(addresses));
+        });
+        return future;
+    }
+
+    std::vector<Address> resolver::resolve(const Address& address) {
+        std::vector<Address> addresses;
+        for (const auto& ip : resolve(address.get_host()).get())
+            addresses.emplace_back(ip.to_string(), address.get_port());
+        return addresses;
+    }
+
+    std::optional<std::vector<ip_address>> resolver::get_cached(const std::string& host) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _cache.find(lstring::to_lower_case(host));
+        if (it == _cache.end() || it->second.pending || it->second.expiration < clock::now())
+            return std::nullopt;
+        try {
+            return it->second.addresses.get();
+        } catch (...) {
+            return std::nullopt;
+        }
+    }
+
+    void resolver::clear_cache() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto it = _cache.begin(); it != _cache.end();) {
+            if (!it->second.pending)
+                it = _cache.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    resolver_stats resolver::get_stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stats;
+    }
+}
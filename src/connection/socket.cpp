@@ -0,0 +1,393 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/connection/socket.h"
+
+#ifdef LAMBDA_HAS_SOCKETS
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef LAMBDA_LINUX
+#  include <sys/sendfile.h>
+#endif
+
+#ifdef IOV_MAX
+#  define MAX_IOVECS (IOV_MAX < 64 ? IOV_MAX : 64)
+#else
+#  define MAX_IOVECS 16
+#endif
+
+#if defined(LAMBDA_LINUX) && !defined(UDP_GRO)
+#  define UDP_GRO 104
+#endif
+
+#ifndef MSG_NOSIGNAL
+#  define MSG_NOSIGNAL 0
+#endif
+
+namespace lambdacommon::connection
+{
+    static inline bool would_block(int error) {
+        return error == EAGAIN || error == EWOULDBLOCK;
+    }
+
+    static inline std::system_error socket_error(const char* what) {
+        return std::system_error(errno, std::generic_category(), what);
+    }
+
+    /*!
+     * Creates a non-blocking and close-on-exec socket.
+     */
+    static int open_socket(int family, int type) {
+#ifdef SOCK_NONBLOCK
+        int fd = ::socket(family, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+#else
+        int fd = ::socket(family, type, 0);
+        if (fd != -1) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+#endif
+        if (fd == -1)
+            throw socket_error("Cannot create the socket");
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        return fd;
+    }
+
+    static void bind_socket(int fd, const Address& address, bool reuse_port) {
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (reuse_port) {
+#ifdef SO_REUSEPORT
+            if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == -1)
+                throw socket_error("Cannot set SO_REUSEPORT");
+#else
+            throw std::system_error(ENOTSUP, std::generic_category(), "SO_REUSEPORT is not supported");
+#endif
+        }
+        sockaddr_storage storage{};
+        auto length = to_sockaddr(address, storage);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&storage), length) == -1)
+            throw socket_error("Cannot bind the socket");
+    }
+
+    u32 LAMBDACOMMON_API to_sockaddr(const Address& address, sockaddr_storage& storage) {
+        auto ip = address.get_ip_address();
+        if (!ip)
+            throw std::invalid_argument("The address '" + address.get_host() + "' is not an IP address.");
+
+        std::memset(&storage, 0, sizeof(storage));
+        if (ip->is_v4()) {
+            auto sin = reinterpret_cast<sockaddr_in*>(&storage);
+            sin->sin_family = AF_INET;
+            sin->sin_port = htons(address.get_port());
+            std::memcpy(&sin->sin_addr, ip->get_bytes().data() + 12, 4);
+            return sizeof(sockaddr_in);
+        } else {
+            auto sin6 = reinterpret_cast<sockaddr_in6*>(&storage);
+            sin6->sin6_family = AF_INET6;
+            sin6->sin6_port = htons(address.get_port());
+            std::memcpy(&sin6->sin6_addr, ip->get_bytes().data(), 16);
+            return sizeof(sockaddr_in6);
+        }
+    }
+
+    Address LAMBDACOMMON_API from_sockaddr(const sockaddr_storage& storage) {
+        if (storage.ss_family == AF_INET) {
+            auto sin = reinterpret_cast<const sockaddr_in*>(&storage);
+            return {ip_address::from_v4(ntohl(sin->sin_addr.s_addr)).to_string(), ntohs(sin->sin_port)};
+        } else if (storage.ss_family == AF_INET6) {
+            auto sin6 = reinterpret_cast<const sockaddr_in6*>(&storage);
+            std::array<u8, 16> bytes{};
+            std::memcpy(bytes.data(), &sin6->sin6_addr, 16);
+            return {ip_address(bytes).to_string(), ntohs(sin6->sin6_port)};
+        }
+        return Address::EMPTY;
+    }
+
+    /*
+     * socket_handle
+     */
+
+    socket_handle::socket_handle(int fd) : _fd(fd) {}
+
+    socket_handle::socket_handle(socket_handle&& other) noexcept : _fd(other._fd) {
+        other._fd = -1;
+    }
+
+    socket_handle::~socket_handle() {
+        close();
+    }
+
+    int socket_handle::get_fd() const {
+        return _fd;
+    }
+
+    bool socket_handle::is_open() const {
+        return _fd != -1;
+    }
+
+    void socket_handle::close() {
+        if (_fd != -1) {
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+
+    int socket_handle::release() {
+        int fd = _fd;
+        _fd = -1;
+        return fd;
+    }
+
+    Address socket_handle::get_local_address() const {
+        sockaddr_storage storage{};
+        socklen_t length = sizeof(storage);
+        if (getsockname(_fd, reinterpret_cast<sockaddr*>(&storage), &length) == -1)
+            throw socket_error("Cannot get the local address");
+        return from_sockaddr(storage);
+    }
+
+    int socket_handle::get_error() const {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &length) == -1)
+            return errno;
+        return error;
+    }
+
+    socket_handle& socket_handle::operator=(socket_handle&& other) noexcept {
+        if (this != &other) {
+            close();
+            _fd = other._fd;
+            other._fd = -1;
+        }
+        return *this;
+    }
+
+    /*
+     * tcp_stream
+     */
+
+    tcp_stream::tcp_stream(int fd) : socket_handle(fd) {}
+
+    tcp_stream tcp_stream::connect(const Address& address) {
+        sockaddr_storage storage{};
+        auto length = to_sockaddr(address, storage);
+        tcp_stream stream(open_socket(storage.ss_family, SOCK_STREAM));
+        if (::connect(stream._fd, reinterpret_cast<sockaddr*>(&storage), length) == -1 && errno != EINPROGRESS)
+            throw socket_error("Cannot connect");
+        return stream;
+    }
+
+    std::optional<size_t> tcp_stream::read(void* buffer, size_t size) {
+        for (;;) {
+            auto result = ::recv(_fd, buffer, size, 0);
+            if (result >= 0)
+                return static_cast<size_t>(result);
+            if (errno == EINTR)
+                continue;
+            if (would_block(errno))
+                return std::nullopt;
+            throw socket_error("Cannot read from the stream");
+        }
+    }
+
+    std::optional<size_t> tcp_stream::write(const void* data, size_t size) {
+        for (;;) {
+            auto result = ::send(_fd, data, size, MSG_NOSIGNAL);
+            if (result >= 0)
+                return static_cast<size_t>(result);
+            if (errno == EINTR)
+                continue;
+            if (would_block(errno))
+                return std::nullopt;
+            throw socket_error("Cannot write to the stream");
+        }
+    }
+
+    std::optional<size_t> tcp_stream::read(buffer_chain& buffer, size_t max) {
+        auto[area, area_size] = buffer.prepare(1);
+        std::optional<size_t> result;
+        try {
+            result = read(area, std::min(area_size, max));
+        } catch (...) {
+            // Committing nothing drops the slice prepare() may have added.
+            buffer.commit(0);
+            throw;
+        }
+        buffer.commit(result ? *result : 0);
+        return result;
+    }
+
+    std::optional<size_t> tcp_stream::write(buffer_chain& buffer) {
+        iovec iovecs[MAX_IOVECS];
+        msghdr message{};
+        message.msg_iov = iovecs;
+        message.msg_iovlen = buffer.get_iovecs(iovecs, MAX_IOVECS);
+        if (message.msg_iovlen == 0)
+            return 0;
+        for (;;) {
+            auto result = ::sendmsg(_fd, &message, MSG_NOSIGNAL);
+            if (result >= 0) {
+                buffer.consume(static_cast<size_t>(result));
+                return static_cast<size_t>(result);
+            }
+            if (errno == EINTR)
+                continue;
+            if (would_block(errno))
+                return std::nullopt;
+            throw socket_error("Cannot write to the stream");
+        }
+    }
+
+    std::optional<size_t> tcp_stream::send_file(int file_fd, u64& offset, size_t count) {
+        for (;;) {
+#ifdef LAMBDA_LINUX
+            auto file_offset = static_cast<off_t>(offset);
+            auto result = ::sendfile(_fd, file_fd, &file_offset, count);
+#else
+            // Other systems go through a user space buffer.
+            char buffer[16384];
+            auto result = ::pread(file_fd, buffer, std::min(count, sizeof(buffer)), static_cast<off_t>(offset));
+            if (result > 0)
+                result = ::send(_fd, buffer, static_cast<size_t>(result), MSG_NOSIGNAL);
+#endif
+            if (result >= 0) {
+                offset += static_cast<u64>(result);
+                return static_cast<size_t>(result);
+            }
+            if (errno == EINTR)
+                continue;
+            if (would_block(errno))
+                return std::nullopt;
+            throw socket_error("Cannot send the file to the stream");
+        }
+    }
+
+    void tcp_stream::shutdown_write() {
+        ::shutdown(_fd, SHUT_WR);
+    }
+
+    void tcp_stream::set_no_delay(bool no_delay) {
+        int value = no_delay ? 1 : 0;
+        setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+    }
+
+    Address tcp_stream::get_peer_address() const {
+        sockaddr_storage storage{};
+        socklen_t length = sizeof(storage);
+        if (getpeername(_fd, reinterpret_cast<sockaddr*>(&storage), &length) == -1)
+            throw socket_error("Cannot get the peer address");
+        return from_sockaddr(storage);
+    }
+
+    /*
+     * tcp_listener
+     */
+
+    tcp_listener::tcp_listener(const Address& address, bool reuse_port, int backlog) {
+        sockaddr_storage storage{};
+        to_sockaddr(address, storage);
+        _fd = open_socket(storage.ss_family, SOCK_STREAM);
+        bind_socket(_fd, address, reuse_port);
+        if (::listen(_fd, backlog) == -1)
+            throw socket_error("Cannot listen");
+    }
+
+    std::optional<tcp_stream> tcp_listener::accept() {
+        for (;;) {
+#if defined(SOCK_NONBLOCK) && !defined(LAMBDA_MAC_OSX)
+            int fd = ::accept4(_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+            int fd = ::accept(_fd, nullptr, nullptr);
+            if (fd != -1) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+#endif
+            if (fd != -1)
+                return tcp_stream(fd);
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (would_block(errno))
+                return std::nullopt;
+            throw socket_error("Cannot accept a connection");
+        }
+    }
+
+    /*
+     * udp_socket
+     */
+
+    udp_socket::udp_socket(const Address& address, bool reuse_port) {
+        sockaddr_storage storage{};
+        to_sockaddr(address, storage);
+        _fd = open_socket(storage.ss_family, SOCK_DGRAM);
+        bind_socket(_fd, address, reuse_port);
+    }
+
+    std::optional<size_t> udp_socket::send_to(const void* data, size_t size, const Address& to) {
+        sockaddr_storage storage{};
+        auto length = to_sockaddr(to, storage);
+        for (;;) {
+            auto result = ::sendto(_fd, data, size, MSG_NOSIGNAL, reinterpret_cast<sockaddr*>(&storage), length);
+            if (result >= 0)
+                return static_cast<size_t>(result);
+            if (errno == EINTR)
+                continue;
+            if (would_block(errno))
+                return std::nullopt;
+            throw socket_error("Cannot send the datagram");
+        }
+    }
+
+    std::optional<size_t> udp_socket::receive_from(void* buffer, size_t size, Address* from) {
+        sockaddr_storage storage{};
+        socklen_t length = sizeof(storage);
+        for (;;) {
+            auto result = ::recvfrom(_fd, buffer, size, 0, reinterpret_cast<sockaddr*>(&storage), &length);
+            if (result >= 0) {
+                if (from)
+                    *from = from_sockaddr(storage);
+                return static_cast<size_t>(result);
+            }
+            if (errno == EINTR)
+                continue;
+            if (would_block(errno))
+                return std::nullopt;
+            throw socket_error("Cannot receive a datagram");
+        }
+    }
+
+    bool udp_socket::set_gro(bool enabled) {
+#ifdef LAMBDA_LINUX
+        int value = enabled ? 1 : 0;
+        return setsockopt(_fd, SOL_UDP, UDP_GRO, &value, sizeof(value)) == 0;
+#else
+        return !enabled;
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,310 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/connection/udp_batch.h"
+
+#ifdef LAMBDA_HAS_SOCKETS
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+#ifdef LAMBDA_LINUX
+#  ifndef UDP_SEGMENT
+#    define UDP_SEGMENT 103
+#  endif
+#  ifndef UDP_GRO
+#    define UDP_GRO 104
+#  endif
+#endif
+
+#ifndef MSG_NOSIGNAL
+#  define MSG_NOSIGNAL 0
+#endif
+
+// The kernel refuses to segment more than 64 datagrams or more than 64 KiB in a single message.
+#define MAX_SEGMENTS 64
+#define MAX_SEGMENTED_SIZE 65000
+
+namespace lambdacommon::connection
+{
+    static inline bool would_block(int error) {
+        return error == EAGAIN || error == EWOULDBLOCK;
+    }
+
+    static inline std::system_error socket_error(const char* what) {
+        return std::system_error(errno, std::generic_category(), what);
+    }
+
+#ifdef LAMBDA_LINUX
+    static constexpr size_t CONTROL_SIZE = CMSG_SPACE(sizeof(int));
+#endif
+
+    /*
+     * udp_receive_batch
+     */
+
+    udp_receive_batch::udp_receive_batch(size_t capacity, size_t buffer_size) : _capacity(capacity), _buffer_size(buffer_size),
+                                                                                _buffers(capacity * buffer_size), _sources(capacity) {
+        _datagrams.reserve(capacity);
+#ifdef LAMBDA_LINUX
+        _messages.resize(capacity);
+        _iovecs.resize(capacity);
+        _control.resize(capacity * CONTROL_SIZE);
+        for (size_t i = 0; i < capacity; i++) {
+            _iovecs[i].iov_base = _buffers.data() + i * buffer_size;
+            _iovecs[i].iov_len = buffer_size;
+            auto& header = _messages[i].msg_hdr;
+            header.msg_iov = &_iovecs[i];
+            header.msg_iovlen = 1;
+            header.msg_name = &_sources[i];
+        }
+#endif
+    }
+
+    std::optional<size_t> udp_receive_batch::receive(udp_socket& socket) {
+        _datagrams.clear();
+#ifdef LAMBDA_LINUX
+        // The kernel overwrites the lengths, reset them.
+        for (size_t i = 0; i < _capacity; i++) {
+            auto& header = _messages[i].msg_hdr;
+            header.msg_namelen = sizeof(sockaddr_storage);
+            header.msg_control = _control.data() + i * CONTROL_SIZE;
+            header.msg_controllen = CONTROL_SIZE;
+        }
+
+        int count;
+        for (;;) {
+            count = recvmmsg(socket.get_fd(), _messages.data(), static_cast<unsigned int>(_capacity), 0, nullptr);
+            if (count >= 0)
+                break;
+            if (errno == EINTR)
+                continue;
+            if (would_block(errno))
+                return std::nullopt;
+            throw socket_error("Cannot receive the datagrams");
+        }
+
+        for (int i = 0; i < count; i++) {
+            auto& header = _messages[i].msg_hdr;
+            u32 length = _messages[i].msg_len;
+            u32 segment_size = length;
+            for (auto cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+                if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                    int gso_size;
+                    std::memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+                    if (gso_size > 0)
+                        segment_size = static_cast<u32>(gso_size);
+                }
+            }
+
+            auto offset = static_cast<u32>(i * _buffer_size);
+            do {
+                u32 segment_length = std::min(segment_size, length);
+                _datagrams.push_back({offset, segment_length, static_cast<u32>(i)});
+                offset += segment_length;
+                length -= segment_length;
+            } while (length > 0);
+        }
+#else
+        for (size_t i = 0; i < _capacity; i++) {
+            socklen_t length = sizeof(sockaddr_storage);
+            auto result = ::recvfrom(socket.get_fd(), _buffers.data() + i * _buffer_size, _buffer_size, 0,
+                                     reinterpret_cast<sockaddr*>(&_sources[i]), &length);
+            if (result >= 0) {
+                _datagrams.push_back({static_cast<u32>(i * _buffer_size), static_cast<u32>(result), static_cast<u32>(i)});
+                continue;
+            }
+            if (errno == EINTR) {
+                i--;
+                continue;
+            }
+            if (would_block(errno))
+                break;
+            throw socket_error("Cannot receive the datagrams");
+        }
+        if (_datagrams.empty())
+            return std::nullopt;
+#endif
+        return _datagrams.size();
+    }
+
+    size_t udp_receive_batch::size() const {
+        return _datagrams.size();
+    }
+
+    std::string_view udp_receive_batch::get_data(size_t index) const {
+        auto& datagram = _datagrams[index];
+        return {_buffers.data() + datagram.offset, datagram.length};
+    }
+
+    const sockaddr_storage& udp_receive_batch::get_source_storage(size_t index) const {
+        return _sources[_datagrams[index].source];
+    }
+
+    Address udp_receive_batch::get_source(size_t index) const {
+        return from_sockaddr(get_source_storage(index));
+    }
+
+    /*
+     * udp_send_batch
+     */
+
+    udp_send_batch::udp_send_batch(size_t capacity, size_t buffer_size) : _capacity(capacity), _buffer_size(buffer_size),
+                                                                          _buffers(capacity * buffer_size), _destinations(capacity),
+                                                                          _destination_lengths(capacity), _iovecs(capacity) {
+        for (size_t i = 0; i < capacity; i++)
+            _iovecs[i].iov_base = _buffers.data() + i * buffer_size;
+#ifdef LAMBDA_LINUX
+        _messages.resize(capacity);
+        _runs.resize(capacity);
+        _control.resize(capacity * CONTROL_SIZE);
+#else
+        _segmentation = false;
+#endif
+    }
+
+    bool udp_send_batch::add(const void* data, size_t size, const Address& to) {
+        if (is_full() || size > _buffer_size)
+            return false;
+        _destination_lengths[_count] = to_sockaddr(to, _destinations[_count]);
+        std::memcpy(_iovecs[_count].iov_base, data, size);
+        _iovecs[_count].iov_len = size;
+        _count++;
+        return true;
+    }
+
+    bool udp_send_batch::add(const void* data, size_t size, const sockaddr_storage& to) {
+        if (is_full() || size > _buffer_size)
+            return false;
+        _destinations[_count] = to;
+        _destination_lengths[_count] = to.ss_family == AF_INET ? sizeof(sockaddr_in) : sizeof(sockaddr_in6);
+        std::memcpy(_iovecs[_count].iov_base, data, size);
+        _iovecs[_count].iov_len = size;
+        _count++;
+        return true;
+    }
+
+    std::optional<size_t> udp_send_batch::send(udp_socket& socket) {
+        size_t sent = 0;
+#ifdef LAMBDA_LINUX
+        while (_sent < _count) {
+            size_t message_count = 0;
+            bool segmented = false;
+            for (size_t i = _sent; i < _count; message_count++) {
+                // Group the following datagrams of the same size to the same destination, only the last one may be shorter.
+                size_t run = 1;
+                size_t segment_size = _iovecs[i].iov_len;
+                if (_segmentation) {
+                    size_t total = segment_size;
+                    while (i + run < _count && run < MAX_SEGMENTS) {
+                        size_t next = i + run;
+                        size_t length = _iovecs[next].iov_len;
+                        if (length > segment_size || length == 0 || total + length > MAX_SEGMENTED_SIZE
+                            || _destination_lengths[next] != _destination_lengths[i]
+                            || std::memcmp(&_destinations[next], &_destinations[i], _destination_lengths[i]) != 0)
+                            break;
+                        total += length;
+                        run++;
+                        if (length < segment_size)
+                            break;
+                    }
+                }
+
+                auto& header = _messages[message_count].msg_hdr;
+                header = {};
+                header.msg_name = &_destinations[i];
+                header.msg_namelen = _destination_lengths[i];
+                header.msg_iov = &_iovecs[i];
+                header.msg_iovlen = run;
+                if (run > 1) {
+                    header.msg_control = _control.data() + message_count * CONTROL_SIZE;
+                    header.msg_controllen = CMSG_SPACE(sizeof(u16));
+                    auto cmsg = CMSG_FIRSTHDR(&header);
+                    cmsg->cmsg_level = SOL_UDP;
+                    cmsg->cmsg_type = UDP_SEGMENT;
+                    cmsg->cmsg_len = CMSG_LEN(sizeof(u16));
+                    auto gso_size = static_cast<u16>(segment_size);
+                    std::memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+                    segmented = true;
+                }
+                _runs[message_count] = static_cast<u32>(run);
+                i += run;
+            }
+
+            int result = sendmmsg(socket.get_fd(), _messages.data(), static_cast<unsigned int>(message_count), MSG_NOSIGNAL);
+            if (result == -1) {
+                if (errno == EINTR)
+                    continue;
+                if (would_block(errno))
+                    break;
+                if (segmented && (errno == EINVAL || errno == EIO || errno == ENOPROTOOPT || errno == EOPNOTSUPP)) {
+                    // The kernel or the device does not support segmentation offload, fall back to one message per datagram.
+                    _segmentation = false;
+                    continue;
+                }
+                throw socket_error("Cannot send the datagrams");
+            }
+            for (int m = 0; m < result; m++) {
+                _sent += _runs[m];
+                sent += _runs[m];
+            }
+            if (static_cast<size_t>(result) < message_count)
+                break;
+        }
+#else
+        while (_sent < _count) {
+            auto result = ::sendto(socket.get_fd(), _iovecs[_sent].iov_base, _iovecs[_sent].iov_len, MSG_NOSIGNAL,
+                                   reinterpret_cast<sockaddr*>(&_destinations[_sent]), _destination_lengths[_sent]);
+            if (result >= 0) {
+                _sent++;
+                sent++;
+                continue;
+            }
+            if (errno == EINTR)
+                continue;
+            if (would_block(errno))
+                break;
+            throw socket_error("Cannot send the datagrams");
+        }
+#endif
+        if (_sent == _count)
+            clear();
+        if (sent == 0 && _count != 0)
+            return std::nullopt;
+        return sent;
+    }
+
+    size_t udp_send_batch::size() const {
+        return _count - _sent;
+    }
+
+    bool udp_send_batch::is_full() const {
+        return _count == _capacity;
+    }
+
+    void udp_send_batch::set_segmentation(bool enabled) {
+#ifdef LAMBDA_LINUX
+        _segmentation = enabled;
+#endif
+    }
+
+    bool udp_send_batch::is_segmentation_enabled() const {
+        return _segmentation;
+    }
+
+    void udp_send_batch::clear() {
+        _count = 0;
+        _sent = 0;
+    }
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include "../../include/lambdacommon/graphics/color.h"
 #include "../../include/lambdacommon/lstring.h"
 #include "../../include/lambdacommon/maths.h"
+#include "../maths/soa_kernels.h"
 #include <sstream>
 #include <iomanip>
 #include <tuple>
@@ -200,5 +201,53 @@ namespace lambdacommon
         Color LAMBDACOMMON_API from_int_rgba(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha) {
             return {(red / 255.f), (green / 255.f), (blue / 255.f), (alpha / 255.f)};
         }
+
+        /*
+         * The colors are converted as arrays of interleaved components.
+         */
+
+        color_rgba8 LAMBDACOMMON_API to_rgba8(const color_f32x4& color, alpha_conversion conversion) {
+            color_rgba8 result;
+            maths::internal::SCALAR_KERNELS.colors_to_rgba8(&color.red, &result.red, 1, conversion);
+            return result;
+        }
+
+        color_f32x4 LAMBDACOMMON_API to_f32x4(const color_rgba8& color, alpha_conversion conversion) {
+            color_f32x4 result;
+            maths::internal::SCALAR_KERNELS.colors_to_f32x4(&color.red, &result.red, 1, conversion);
+            return result;
+        }
+
+        void LAMBDACOMMON_API to_rgba8(const color_f32x4* in, color_rgba8* out, size_t count, alpha_conversion conversion) {
+            maths::internal::get_kernels().colors_to_rgba8(&in->red, &out->red, count, conversion);
+        }
+
+        void LAMBDACOMMON_API to_f32x4(const color_rgba8* in, color_f32x4* out, size_t count, alpha_conversion conversion) {
+            maths::internal::get_kernels().colors_to_f32x4(&in->red, &out->red, count, conversion);
+        }
+
+        constexpr size_t CHUNK_SIZE = 256;
+
+        /*!
+         * Converts colors in place through floats, by chunks on the stack.
+         * Premultiplying the bytes this way gives the exact (component * alpha + 127) / 255: the products are never halfway.
+         */
+        static void convert_in_place(color_rgba8* colors, size_t count, alpha_conversion conversion) {
+            const auto& kernels = maths::internal::get_kernels();
+            color_f32x4 buffer[CHUNK_SIZE];
+            for (size_t i = 0; i < count; i += CHUNK_SIZE) {
+                size_t chunk = std::min(CHUNK_SIZE, count - i);
+                kernels.colors_to_f32x4(&colors[i].red, &buffer->red, chunk, ALPHA_KEEP);
+                kernels.colors_to_rgba8(&buffer->red, &colors[i].red, chunk, conversion);
+            }
+        }
+
+        void LAMBDACOMMON_API premultiply(color_rgba8* colors, size_t count) {
+            convert_in_place(colors, count, ALPHA_PREMULTIPLY);
+        }
+
+        void LAMBDACOMMON_API unpremultiply(color_rgba8* colors, size_t count) {
+            convert_in_place(colors, count, ALPHA_UNPREMULTIPLY);
+        }
     }
 }
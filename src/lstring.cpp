@@ -15,6 +15,11 @@
 #include <codecvt>
 #include <locale>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LAMBDA_LSTRING_SSE2
+#  include <emmintrin.h>
+#endif
+
 #ifdef LAMBDA_WINDOWS
 #  pragma warning(push)
 #  pragma warning(disable:4101)
@@ -51,11 +56,38 @@ namespace lambdacommon
                 return false;
         }
 
-        bool LAMBDACOMMON_API equals_ignore_case(std::string const& a, std::string const& b) {
-            if (a.length() == b.length()) {
-                return std::equal(std::begin(a), std::end(a), std::begin(b), [](const char charA, const char charB) { return equals_ignore_case(charA, charB); });
-            } else
+        static inline char fold_ascii(char c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+        }
+
+#ifdef LAMBDA_LSTRING_SSE2
+        /*!
+         * Folds the ASCII upper case letters of 16 bytes to lower case.
+         */
+        static inline __m128i fold_ascii(__m128i chunk) {
+            // Shift 'A' to -128 so a signed comparison checks the 'A'-'Z' range.
+            auto shifted = _mm_sub_epi8(chunk, _mm_set1_epi8('A' - 128));
+            auto upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 26));
+            return _mm_or_si128(chunk, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+        }
+#endif
+
+        bool LAMBDACOMMON_API equals_ignore_case(std::string_view a, std::string_view b) {
+            if (a.length() != b.length())
                 return false;
+            size_t i = 0;
+#ifdef LAMBDA_LSTRING_SSE2
+            for (; i + 16 <= a.length(); i += 16) {
+                auto chunk_a = fold_ascii(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a.data() + i)));
+                auto chunk_b = fold_ascii(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b.data() + i)));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk_a, chunk_b)) != 0xFFFF)
+                    return false;
+            }
+#endif
+            for (; i < a.length(); i++)
+                if (fold_ascii(a[i]) != fold_ascii(b[i]))
+                    return false;
+            return true;
         }
 
         std::string LAMBDACOMMON_API to_lower_case(const std::string& from) {
@@ -112,7 +144,7 @@ namespace lambdacommon
         }
 
         bool LAMBDACOMMON_API starts_with_ignore_case(const std::string& str, const std::string& prefix) {
-            return starts_with(to_lower_case(str), to_lower_case(prefix));
+            return str.size() >= prefix.size() && equals_ignore_case(std::string_view(str).substr(0, prefix.size()), prefix);
         }
 
         bool LAMBDACOMMON_API ends_with(const std::string& str, const std::string& suffix) {
@@ -120,7 +152,7 @@ namespace lambdacommon
         }
 
         bool LAMBDACOMMON_API ends_with_ignore_case(const std::string& str, const std::string& suffix) {
-            return ends_with(to_lower_case(str), to_lower_case(suffix));
+            return str.size() >= suffix.size() && equals_ignore_case(std::string_view(str).substr(str.size() - suffix.size()), suffix);
         }
 
         const std::string LAMBDACOMMON_API merge_path(const std::string& parent, const std::string& child) {
@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/maths/fast.h"
+#include "soa_kernels.h"
+
+namespace lambdacommon::maths::fast
+{
+    void LAMBDACOMMON_API rsqrt(const f32* in, f32* out, size_t count) {
+        maths::internal::get_kernels().rsqrt(in, out, count);
+    }
+
+    void LAMBDACOMMON_API sqrt(const f32* in, f32* out, size_t count) {
+        maths::internal::get_kernels().sqrt(in, out, count);
+    }
+
+    void LAMBDACOMMON_API sin(const f32* in, f32* out, size_t count) {
+        maths::internal::get_kernels().sin(in, out, count);
+    }
+
+    void LAMBDACOMMON_API cos(const f32* in, f32* out, size_t count) {
+        maths::internal::get_kernels().cos(in, out, count);
+    }
+
+    void LAMBDACOMMON_API sincos(const f32* in, f32* sine, f32* cosine, size_t count) {
+        maths::internal::get_kernels().sincos(in, sine, cosine, count);
+    }
+
+    void LAMBDACOMMON_API atan2(const f32* y, const f32* x, f32* out, size_t count) {
+        maths::internal::get_kernels().atan2(y, x, out, count);
+    }
+
+    void LAMBDACOMMON_API exp(const f32* in, f32* out, size_t count) {
+        maths::internal::get_kernels().exp(in, out, count);
+    }
+
+    void LAMBDACOMMON_API log(const f32* in, f32* out, size_t count) {
+        maths::internal::get_kernels().log(in, out, count);
+    }
+}
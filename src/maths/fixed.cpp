@@ -0,0 +1,26 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/maths/fixed.h"
+#include "soa_kernels.h"
+
+namespace lambdacommon::maths::internal
+{
+    void LAMBDACOMMON_API fixed_add(const i32* a, const i32* b, i32* out, size_t count, bool saturate) {
+        get_kernels().fixed_add(a, b, out, count, saturate);
+    }
+
+    void LAMBDACOMMON_API fixed_sub(const i32* a, const i32* b, i32* out, size_t count, bool saturate) {
+        get_kernels().fixed_sub(a, b, out, count, saturate);
+    }
+
+    void LAMBDACOMMON_API fixed_multiply(const i32* a, const i32* b, i32* out, size_t count, u32 frac_bits, bool saturate) {
+        get_kernels().fixed_multiply(a, b, out, count, frac_bits, saturate);
+    }
+}
@@ -0,0 +1,282 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/maths/geometry2d.h"
+#include "soa_kernels.h"
+#include <numeric>
+
+namespace lambdacommon::maths::geometry2d
+{
+    f64 LAMBDACOMMON_API signed_area(span<const point2f> polygon) {
+        // Fanning from the first vertex keeps the products small when the polygon is far from the origin.
+        f64 result = 0.0;
+        for (size_t i = 2; i < polygon.size(); i++)
+            result += orientation(polygon[0], polygon[i - 1], polygon[i]);
+        return result / 2.0;
+    }
+
+    /*!
+     * Checks whether a point collinear with a segment lies within its bounding box.
+     */
+    static inline bool on_segment(const point2f& a, const point2f& b, const point2f& point) {
+        return std::min(a.x, b.x) <= point.x && point.x <= std::max(a.x, b.x) && std::min(a.y, b.y) <= point.y &&
+               point.y <= std::max(a.y, b.y);
+    }
+
+    static inline int sign(f64 value) {
+        return (value > 0.0) - (value < 0.0);
+    }
+
+    bool LAMBDACOMMON_API intersects(const segment2f& a, const segment2f& b) {
+        int d1 = sign(orientation(b.a, b.b, a.a)), d2 = sign(orientation(b.a, b.b, a.b));
+        int d3 = sign(orientation(a.a, a.b, b.a)), d4 = sign(orientation(a.a, a.b, b.b));
+        if (d1 * d2 < 0 && d3 * d4 < 0)
+            return true;
+        return (d1 == 0 && on_segment(b.a, b.b, a.a)) || (d2 == 0 && on_segment(b.a, b.b, a.b)) ||
+               (d3 == 0 && on_segment(a.a, a.b, b.a)) || (d4 == 0 && on_segment(a.a, a.b, b.b));
+    }
+
+    void LAMBDACOMMON_API convex_hull(span<const point2f> points, std::vector<u32>& hull, scratch_buffer& scratch) {
+        hull.clear();
+        if (points.empty())
+            return;
+        // A single point has no upper chain to end on it.
+        if (points.size() == 1) {
+            hull.push_back(0);
+            return;
+        }
+
+        auto& order = scratch.indices;
+        order.resize(points.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&points](u32 a, u32 b) {
+            const point2f& p = points[a], & q = points[b];
+            return p.y < q.y || (p.y == q.y && (p.x < q.x || (p.x == q.x && a < b)));
+        });
+
+        // The lower chain then the upper chain, each one drops the points not turning left.
+        for (u32 index : order) {
+            while (hull.size() >= 2 && orientation(points[hull[hull.size() - 2]], points[hull.back()], points[index]) <= 0.0)
+                hull.pop_back();
+            hull.push_back(index);
+        }
+        size_t lower = hull.size() + 1;
+        for (size_t i = order.size() - 1; i-- > 0;) {
+            while (hull.size() >= lower && orientation(points[hull[hull.size() - 2]], points[hull.back()], points[order[i]]) <= 0.0)
+                hull.pop_back();
+            hull.push_back(order[i]);
+        }
+        // The upper chain ends on the first point.
+        hull.pop_back();
+        if (hull.size() == 2 && points[hull[0]] == points[hull[1]])
+            hull.pop_back();
+    }
+
+    /*!
+     * Gets the squared distance between a point and a segment.
+     */
+    static f64 distance_squared(const point2f& a, const point2f& b, const point2f& point) {
+        f64 dx = static_cast<f64>(b.x) - a.x, dy = static_cast<f64>(b.y) - a.y;
+        f64 px = static_cast<f64>(point.x) - a.x, py = static_cast<f64>(point.y) - a.y;
+        f64 length = dx * dx + dy * dy;
+        f64 t = length > 0.0 ? maths::clamp((px * dx + py * dy) / length, 0.0, 1.0) : 0.0;
+        px -= t * dx;
+        py -= t * dy;
+        return px * px + py * py;
+    }
+
+    void LAMBDACOMMON_API simplify(span<const point2f> polyline, f32 epsilon, std::vector<u32>& kept, scratch_buffer& scratch) {
+        kept.clear();
+        size_t count = polyline.size();
+        if (count <= 2) {
+            for (u32 i = 0; i < count; i++)
+                kept.push_back(i);
+            return;
+        }
+
+        auto& keep = scratch.flags;
+        keep.assign(count, 0);
+        keep[0] = keep[count - 1] = 1;
+
+        // The ranges left to split are on a stack, as pairs of their first and last indices.
+        f64 threshold = static_cast<f64>(epsilon) * epsilon;
+        auto& ranges = scratch.links;
+        ranges.clear();
+        ranges.push_back(0);
+        ranges.push_back(static_cast<u32>(count - 1));
+        while (!ranges.empty()) {
+            u32 last = ranges.back();
+            ranges.pop_back();
+            u32 first = ranges.back();
+            ranges.pop_back();
+
+            f64 farthest = -1.0;
+            u32 split = first;
+            for (u32 i = first + 1; i < last; i++) {
+                f64 distance = distance_squared(polyline[first], polyline[last], polyline[i]);
+                if (distance > farthest) {
+                    farthest = distance;
+                    split = i;
+                }
+            }
+            if (farthest > threshold) {
+                keep[split] = 1;
+                ranges.insert(ranges.end(), {first, split, split, last});
+            }
+        }
+
+        for (u32 i = 0; i < count; i++)
+            if (keep[i])
+                kept.push_back(i);
+    }
+
+    /*!
+     * Writes an edge in the layout of the point in polygon kernel.
+     */
+    static inline void make_edge(const point2f& a, const point2f& b, f32* edge) {
+        edge[0] = a.x;
+        edge[1] = a.y;
+        edge[2] = a.y == b.y ? 0.f : (b.x - a.x) / (b.y - a.y);
+        edge[3] = std::min(a.y, b.y);
+        edge[4] = std::max(a.y, b.y);
+    }
+
+    constexpr size_t CHUNK_SIZE = 256;
+
+    bool LAMBDACOMMON_API contains(span<const point2f> polygon, const point2f& point) {
+        // The edges go through a chunk on the stack, the parities of the chunks are summed.
+        f32 edges[64 * maths::internal::POLYGON_EDGE_STRIDE];
+        u8 inside = 0;
+        for (size_t i = 0; i < polygon.size(); i += 64) {
+            size_t chunk = std::min<size_t>(64, polygon.size() - i);
+            for (size_t j = 0; j < chunk; j++)
+                make_edge(polygon[i + j], polygon[(i + j + 1) % polygon.size()], edges + j * maths::internal::POLYGON_EDGE_STRIDE);
+            u8 parity;
+            maths::internal::SCALAR_KERNELS.points_in_polygon(&point.x, &point.y, edges, chunk, &parity, 1);
+            inside ^= parity;
+        }
+        return inside != 0;
+    }
+
+    void LAMBDACOMMON_API contains(span<const point2f> polygon, span<const point2f> points, std::vector<u8>& out,
+                                  scratch_buffer& scratch) {
+        out.resize(points.size());
+        auto& edges = scratch.values;
+        edges.resize(polygon.size() * maths::internal::POLYGON_EDGE_STRIDE);
+        for (size_t i = 0; i < polygon.size(); i++)
+            make_edge(polygon[i], polygon[(i + 1) % polygon.size()], edges.data() + i * maths::internal::POLYGON_EDGE_STRIDE);
+
+        // The points are split into coordinate arrays by chunks small enough to stay in the L1 cache.
+        const auto& kernels = maths::internal::get_kernels();
+        f32 x[CHUNK_SIZE], y[CHUNK_SIZE];
+        for (size_t i = 0; i < points.size(); i += CHUNK_SIZE) {
+            size_t chunk = std::min(CHUNK_SIZE, points.size() - i);
+            for (size_t j = 0; j < chunk; j++) {
+                x[j] = points[i + j].x;
+                y[j] = points[i + j].y;
+            }
+            kernels.points_in_polygon(x, y, edges.data(), polygon.size(), out.data() + i, chunk);
+        }
+    }
+
+    void LAMBDACOMMON_API find_intersections(span<const segment2f> segments, std::vector<std::pair<u32, u32>>& pairs,
+                                            scratch_buffer& scratch) {
+        pairs.clear();
+        auto& order = scratch.indices;
+        order.resize(segments.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&segments](u32 a, u32 b) {
+            f32 left_a = std::min(segments[a].a.x, segments[a].b.x), left_b = std::min(segments[b].a.x, segments[b].b.x);
+            return left_a < left_b || (left_a == left_b && a < b);
+        });
+
+        // The sweep line moves from left to right, the active segments are the ones it crosses.
+        auto& active = scratch.links;
+        active.clear();
+        for (u32 index : order) {
+            const segment2f& segment = segments[index];
+            f32 left = std::min(segment.a.x, segment.b.x);
+            f32 bottom = std::min(segment.a.y, segment.b.y), top = std::max(segment.a.y, segment.b.y);
+
+            size_t kept = 0;
+            for (u32 other : active) {
+                const segment2f& candidate = segments[other];
+                if (std::max(candidate.a.x, candidate.b.x) < left)
+                    continue;
+                active[kept++] = other;
+                if (std::max(candidate.a.y, candidate.b.y) >= bottom && std::min(candidate.a.y, candidate.b.y) <= top &&
+                    intersects(segment, candidate))
+                    pairs.emplace_back(std::min(index, other), std::max(index, other));
+            }
+            active.resize(kept);
+            active.push_back(index);
+        }
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    void LAMBDACOMMON_API triangulate(span<const point2f> polygon, std::vector<u32>& triangles, scratch_buffer& scratch) {
+        triangles.clear();
+        size_t count = polygon.size();
+        if (count < 3)
+            return;
+        triangles.reserve((count - 2) * 3);
+
+        // The remaining vertices are a doubly linked ring, the clipped ones are unlinked.
+        auto& next = scratch.indices, & previous = scratch.links;
+        auto& reflex = scratch.flags;
+        next.resize(count);
+        previous.resize(count);
+        reflex.resize(count);
+        f64 turn = signed_area(polygon) < 0.0 ? -1.0 : 1.0;
+        auto is_convex = [&](u32 i) {
+            return turn * orientation(polygon[previous[i]], polygon[i], polygon[next[i]]) > 0.0;
+        };
+        for (u32 i = 0; i < count; i++) {
+            next[i] = static_cast<u32>((i + 1) % count);
+            previous[i] = static_cast<u32>((i + count - 1) % count);
+        }
+        for (u32 i = 0; i < count; i++)
+            reflex[i] = !is_convex(i);
+
+        // An ear is a convex vertex whose triangle contains no reflex vertex, only those may be inside.
+        auto is_ear = [&](u32 i) {
+            if (reflex[i])
+                return false;
+            const point2f& a = polygon[previous[i]], & b = polygon[i], & c = polygon[next[i]];
+            for (u32 j = next[next[i]]; j != previous[i]; j = next[j]) {
+                const point2f& p = polygon[j];
+                if (!reflex[j] || p == a || p == b || p == c)
+                    continue;
+                if (turn * orientation(a, b, p) >= 0.0 && turn * orientation(b, c, p) >= 0.0 && turn * orientation(c, a, p) >= 0.0)
+                    return false;
+            }
+            return true;
+        };
+
+        u32 current = 0;
+        size_t remaining = count, misses = 0;
+        while (remaining > 3) {
+            // Without any ear left the polygon is not simple, a vertex is clipped anyway to terminate.
+            if (!is_ear(current) && ++misses < remaining) {
+                current = next[current];
+                continue;
+            }
+            u32 before = previous[current], after = next[current];
+            triangles.insert(triangles.end(), {before, current, after});
+            next[before] = after;
+            previous[after] = before;
+            reflex[before] = !is_convex(before);
+            reflex[after] = !is_convex(after);
+            remaining--;
+            misses = 0;
+            current = after;
+        }
+        triangles.insert(triangles.end(), {previous[current], current, next[current]});
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/maths/intersection.h"
+#include "soa_kernels.h"
+
+namespace lambdacommon::maths
+{
+    namespace internal
+    {
+        static inline vec3_input in(const vec3_soa<f32>& v) {
+            return {v.x(), v.y(), v.z()};
+        }
+
+        static inline ray_input in(const ray3f& ray) {
+            auto inverse = ray.inverse_direction();
+            return {{ray.origin.x, ray.origin.y, ray.origin.z}, {ray.direction.x, ray.direction.y, ray.direction.z},
+                    {inverse.x, inverse.y, inverse.z}, ray.t_max};
+        }
+    }
+
+    f32 LAMBDACOMMON_API intersect(const ray3f& ray, const spatial::aabb3f& box) {
+        f32 minimum[3] = {box.min.x, box.min.y, box.min.z}, maximum[3] = {box.max.x, box.max.y, box.max.z};
+        f32 result;
+        internal::SCALAR_KERNELS.ray_boxes(internal::in(ray), {{minimum, minimum + 1, minimum + 2}, {maximum, maximum + 1, maximum + 2}},
+                                           &result, 1);
+        return result;
+    }
+
+    f32 LAMBDACOMMON_API intersect(const ray3f& ray, const point3f& a, const point3f& b, const point3f& c) {
+        auto edge1 = b - a, edge2 = c - a;
+        f32 result;
+        internal::SCALAR_KERNELS.ray_triangles(internal::in(ray), {{&a.x, &a.y, &a.z}, {&edge1.x, &edge1.y, &edge1.z},
+                                                                   {&edge2.x, &edge2.y, &edge2.z}}, &result, 1);
+        return result;
+    }
+
+    f32 LAMBDACOMMON_API intersect(const ray3f& ray, const point3f& center, f32 radius) {
+        f32 result;
+        internal::SCALAR_KERNELS.ray_spheres(internal::in(ray), {{&center.x, &center.y, &center.z}, &radius}, &result, 1);
+        return result;
+    }
+
+    void LAMBDACOMMON_API intersect(const ray3f& ray, const aabb_soa& boxes, std::vector<f32>& out) {
+        out.resize(boxes.size());
+        internal::get_kernels().ray_boxes(internal::in(ray), {internal::in(boxes.min()), internal::in(boxes.max())}, out.data(), boxes.size());
+    }
+
+    void LAMBDACOMMON_API intersect(const ray_soa& rays, const spatial::aabb3f& box, std::vector<f32>& out) {
+        f32 corners[6] = {box.min.x, box.min.y, box.min.z, box.max.x, box.max.y, box.max.z};
+        out.resize(rays.size());
+        internal::get_kernels().rays_box({internal::in(rays.origin()), internal::in(rays.inverse_direction()), rays.t_max()}, corners,
+                                         out.data(), rays.size());
+    }
+
+    void LAMBDACOMMON_API intersect(const ray3f& ray, const triangle_soa& triangles, std::vector<f32>& out) {
+        out.resize(triangles.size());
+        internal::get_kernels().ray_triangles(internal::in(ray), {internal::in(triangles.vertex()), internal::in(triangles.edge1()),
+                                                                  internal::in(triangles.edge2())}, out.data(), triangles.size());
+    }
+
+    void LAMBDACOMMON_API intersect(const ray3f& ray, const sphere_soa& spheres, std::vector<f32>& out) {
+        out.resize(spheres.size());
+        internal::get_kernels().ray_spheres(internal::in(ray), {internal::in(spheres.center()), spheres.radius()}, out.data(), spheres.size());
+    }
+}
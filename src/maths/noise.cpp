@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/maths/noise.h"
+#include "soa_kernels.h"
+
+namespace lambdacommon::maths::noise
+{
+    static maths::internal::noise_input to_input(const noise_settings& settings) {
+        f32 amplitude = settings.gain, total = 1.f;
+        for (u32 octave = 1; octave < settings.octaves; octave++) {
+            total += amplitude;
+            amplitude *= settings.gain;
+        }
+        return {settings.type, settings.fractal, settings.octaves, settings.seed, settings.frequency, settings.lacunarity, settings.gain,
+                1.f / total};
+    }
+
+    static f32 sample_scalar(const noise_settings& settings, u32 dimensions, const f32* p) {
+        const f32* coordinates[4] = {p, p + 1, p + 2, p + 3};
+        f32 result;
+        maths::internal::SCALAR_KERNELS.noise(to_input(settings), dimensions, coordinates, &result, 1);
+        return result;
+    }
+
+    f32 LAMBDACOMMON_API sample(const noise_settings& settings, f32 x, f32 y) {
+        f32 p[4] = {x, y};
+        return sample_scalar(settings, 2, p);
+    }
+
+    f32 LAMBDACOMMON_API sample(const noise_settings& settings, f32 x, f32 y, f32 z) {
+        f32 p[4] = {x, y, z};
+        return sample_scalar(settings, 3, p);
+    }
+
+    f32 LAMBDACOMMON_API sample(const noise_settings& settings, f32 x, f32 y, f32 z, f32 w) {
+        f32 p[4] = {x, y, z, w};
+        return sample_scalar(settings, 4, p);
+    }
+
+    void LAMBDACOMMON_API sample(const noise_settings& settings, const f32* x, const f32* y, f32* out, size_t count) {
+        const f32* coordinates[4] = {x, y};
+        maths::internal::get_kernels().noise(to_input(settings), 2, coordinates, out, count);
+    }
+
+    void LAMBDACOMMON_API sample(const noise_settings& settings, const f32* x, const f32* y, const f32* z, f32* out, size_t count) {
+        const f32* coordinates[4] = {x, y, z};
+        maths::internal::get_kernels().noise(to_input(settings), 3, coordinates, out, count);
+    }
+
+    void LAMBDACOMMON_API sample(const noise_settings& settings, const f32* x, const f32* y, const f32* z, const f32* w, f32* out,
+                                 size_t count) {
+        const f32* coordinates[4] = {x, y, z, w};
+        maths::internal::get_kernels().noise(to_input(settings), 4, coordinates, out, count);
+    }
+
+    /*
+     * The grids are split in ranges of samples across the threads, each range is sampled by chunks with the coordinates on
+     * the stack. The chunks start at multiples of CHUNK_SIZE in the whole grid, whatever the ranges: the samples left to the
+     * scalar tail of the kernels, which may round differently, only depend on the size of the grid and not on the count
+     * of threads.
+     */
+
+    constexpr size_t CHUNK_SIZE = 256;
+    static_assert(parallel::internal::BLOCK_SIZE % CHUNK_SIZE == 0, "The ranges must be made of whole chunks.");
+
+    static void fill_grid(const noise_settings& settings, u32 dimensions, f32* out, u32 width, u32 height, u32 depth, const f32* origin,
+                          system::thread_pool& pool) {
+        auto input = to_input(settings);
+        const auto& kernels = maths::internal::get_kernels();
+        size_t count = static_cast<size_t>(width) * height * depth;
+        parallel::internal::for_each_range(pool, count, [&](size_t, size_t begin, size_t end) {
+            f32 coordinates[4][CHUNK_SIZE];
+            const f32* pointers[4] = {coordinates[0], coordinates[1], coordinates[2], coordinates[3]};
+            size_t column = begin % width, row = begin / width % height, slice = begin / width / height;
+            while (begin < end) {
+                size_t chunk = std::min(CHUNK_SIZE - begin % CHUNK_SIZE, end - begin);
+                // A chunk may span several rows and slices.
+                for (size_t i = 0; i < chunk; i++) {
+                    coordinates[0][i] = origin[0] + static_cast<f32>(column);
+                    coordinates[1][i] = origin[1] + static_cast<f32>(row);
+                    coordinates[2][i] = origin[2] + static_cast<f32>(slice);
+                    coordinates[3][i] = origin[3];
+                    if (++column == width) {
+                        column = 0;
+                        if (++row == height) {
+                            row = 0;
+                            slice++;
+                        }
+                    }
+                }
+                kernels.noise(input, dimensions, pointers, out + begin, chunk);
+                begin += chunk;
+            }
+        });
+    }
+
+    void LAMBDACOMMON_API fill(const noise_settings& settings, f32* out, u32 width, u32 height, f32 x, f32 y, system::thread_pool& pool) {
+        f32 origin[4] = {x, y};
+        fill_grid(settings, 2, out, width, height, 1, origin, pool);
+    }
+
+    void LAMBDACOMMON_API fill(const noise_settings& settings, f32* out, u32 width, u32 height, u32 depth, f32 x, f32 y, f32 z,
+                               system::thread_pool& pool) {
+        f32 origin[4] = {x, y, z};
+        fill_grid(settings, 3, out, width, height, depth, origin, pool);
+    }
+
+    void LAMBDACOMMON_API fill(const noise_settings& settings, f32* out, u32 width, u32 height, u32 depth, f32 x, f32 y, f32 z, f32 w,
+                               system::thread_pool& pool) {
+        f32 origin[4] = {x, y, z, w};
+        fill_grid(settings, 4, out, width, height, depth, origin, pool);
+    }
+}
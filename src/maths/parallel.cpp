@@ -0,0 +1,19 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/maths/parallel.h"
+#include "../../include/lambdacommon/system/system.h"
+
+namespace lambdacommon::maths::parallel
+{
+    system::thread_pool& LAMBDACOMMON_API get_thread_pool() {
+        static system::thread_pool pool{std::max(1u, system::get_cpu_cores())};
+        return pool;
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/maths/random.h"
+#include "soa_kernels.h"
+#include <algorithm>
+
+namespace lambdacommon::maths::random
+{
+    static_assert(xoshiro256pp_x8::LANES == maths::internal::XOSHIRO_LANES, "The lanes must match the batch kernel.");
+
+    xoshiro256pp_x8::xoshiro256pp_x8(u64 seed) : xoshiro256pp_x8(xoshiro256pp(seed)) {}
+
+    xoshiro256pp_x8::xoshiro256pp_x8(xoshiro256pp generator) : _state(), _buffer() {
+        for (size_t lane = 0; lane < LANES; lane++) {
+            for (size_t word = 0; word < 4; word++)
+                _state[word * LANES + lane] = generator.get_state()[word];
+            generator.jump();
+        }
+    }
+
+    void xoshiro256pp_x8::refill() {
+        maths::internal::get_kernels().xoshiro256pp(_state, _buffer, BUFFER_SIZE / LANES);
+        _position = 0;
+    }
+
+    void xoshiro256pp_x8::fill(u64* out, size_t count) {
+        // Drains the buffer first and keeps the remainder in it, so the output does not depend on how it is drawn.
+        size_t buffered = std::min(count, BUFFER_SIZE - _position);
+        std::copy_n(_buffer + _position, buffered, out);
+        _position += buffered;
+        out += buffered;
+        count -= buffered;
+
+        size_t blocks = count / LANES;
+        if (blocks) {
+            maths::internal::get_kernels().xoshiro256pp(_state, out, blocks);
+            out += blocks * LANES;
+            count -= blocks * LANES;
+        }
+
+        if (count) {
+            refill();
+            std::copy_n(_buffer, count, out);
+            _position = count;
+        }
+    }
+
+    /*
+     * The conversions go through a chunk of integers on the stack, small enough to stay in the L1 cache.
+     */
+
+    constexpr size_t CHUNK_SIZE = 256;
+
+    void xoshiro256pp_x8::fill_uniform(f32* out, size_t count) {
+        u64 bits[CHUNK_SIZE];
+        for (size_t i = 0; i < count; i += CHUNK_SIZE) {
+            size_t chunk = std::min(CHUNK_SIZE, count - i);
+            fill(bits, chunk);
+            for (size_t j = 0; j < chunk; j++)
+                out[i + j] = static_cast<f32>(static_cast<i32>(bits[j] >> 40u)) * 0x1p-24f;
+        }
+    }
+
+    void xoshiro256pp_x8::fill_uniform(f64* out, size_t count) {
+        u64 bits[CHUNK_SIZE];
+        for (size_t i = 0; i < count; i += CHUNK_SIZE) {
+            size_t chunk = std::min(CHUNK_SIZE, count - i);
+            fill(bits, chunk);
+            for (size_t j = 0; j < chunk; j++)
+                out[i + j] = static_cast<f64>(static_cast<i64>(bits[j] >> 11u)) * 0x1p-53;
+        }
+    }
+
+    void xoshiro256pp_x8::fill_normal(f32* out, size_t count, f32 mean, f32 standard_deviation) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = normal(*this, mean, standard_deviation);
+    }
+
+    void xoshiro256pp_x8::fill_exponential(f32* out, size_t count, f32 lambda) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = exponential(*this, lambda);
+    }
+}
@@ -0,0 +1,405 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/maths/rect_packer.h"
+#include "../../include/lambdacommon/maths/parallel.h"
+#include <algorithm>
+#include <numeric>
+
+namespace lambdacommon::maths
+{
+    /*
+     * The padding is packed with each rectangle, on its right and bottom sides: the page grows by the padding so the
+     * rectangles touching its right or bottom edge do not lose it.
+     */
+
+    rect_packer::rect_packer(const Size2D<u32>& page_size, const pack_options& options) : _page_size(page_size),
+                                                                                           _options(options) {}
+
+    rect_packer::page rect_packer::new_page() const {
+        page result;
+        u32 width = _page_size.get_width() + _options.padding, height = _page_size.get_height() + _options.padding;
+        if (_options.algorithm == PACK_SKYLINE)
+            result.skyline.push_back({0, 0, width});
+        else
+            result.free.push_back({0, 0, width, height});
+        return result;
+    }
+
+    template<typename Candidate>
+    static inline bool is_better(u64 primary, u64 secondary, const std::optional<Candidate>& best) {
+        return !best || primary < best->primary || (primary == best->primary && secondary < best->secondary);
+    }
+
+    /*!
+     * Gets the length of the overlap of the segments [a_start, a_end) and [b_start, b_end).
+     */
+    static inline u32 overlap(u32 a_start, u32 a_end, u32 b_start, u32 b_end) {
+        return a_end > b_start && b_end > a_start ? std::min(a_end, b_end) - std::max(a_start, b_start) : 0;
+    }
+
+    void rect_packer::find_max_rects(const page& target, u32 width, u32 height, bool rotated,
+                                     std::optional<candidate>& best) const {
+        u32 page_width = _page_size.get_width() + _options.padding, page_height = _page_size.get_height() + _options.padding;
+        for (const rect& free : target.free) {
+            if (width > free.width || height > free.height)
+                continue;
+
+            u64 leftover_width = free.width - width, leftover_height = free.height - height;
+            u64 primary, secondary;
+            switch (_options.heuristic) {
+                case PACK_BEST_LONG_SIDE_FIT:
+                    primary = std::max(leftover_width, leftover_height);
+                    secondary = std::min(leftover_width, leftover_height);
+                    break;
+                case PACK_BEST_AREA_FIT:
+                    primary = static_cast<u64>(free.width) * free.height - static_cast<u64>(width) * height;
+                    secondary = std::min(leftover_width, leftover_height);
+                    break;
+                case PACK_BOTTOM_LEFT:
+                    primary = static_cast<u64>(free.y) + height;
+                    secondary = free.x;
+                    break;
+                case PACK_CONTACT_POINT: {
+                    u64 contact = 0;
+                    if (free.x == 0 || free.x + width == page_width)
+                        contact += height;
+                    if (free.y == 0 || free.y + height == page_height)
+                        contact += width;
+                    for (const rect& used : target.used) {
+                        if (used.x == free.x + width || used.x + used.width == free.x)
+                            contact += overlap(used.y, used.y + used.height, free.y, free.y + height);
+                        if (used.y == free.y + height || used.y + used.height == free.y)
+                            contact += overlap(used.x, used.x + used.width, free.x, free.x + width);
+                    }
+                    // The more contact the better, the scores are minimized.
+                    primary = ~contact;
+                    secondary = static_cast<u64>(free.y) + height;
+                    break;
+                }
+                default:
+                    primary = std::min(leftover_width, leftover_height);
+                    secondary = std::max(leftover_width, leftover_height);
+                    break;
+            }
+
+            if (is_better(primary, secondary, best))
+                best = candidate{{free.x, free.y, width, height}, rotated, 0, primary, secondary};
+        }
+    }
+
+    void rect_packer::find_skyline(const page& target, u32 width, u32 height, bool rotated,
+                                   std::optional<candidate>& best) const {
+        u32 page_width = _page_size.get_width() + _options.padding, page_height = _page_size.get_height() + _options.padding;
+        const auto& skyline = target.skyline;
+        for (size_t i = 0; i < skyline.size(); i++) {
+            u32 x = skyline[i].x;
+            if (width > page_width - x)
+                break;
+            u32 end = x + width;
+
+            // The rectangle rests on the highest node under it.
+            u32 y = 0;
+            for (size_t j = i; j < skyline.size() && skyline[j].x < end; j++)
+                y = std::max(y, skyline[j].y);
+            if (height > page_height || y > page_height - height)
+                continue;
+
+            u64 primary, secondary;
+            if (_options.heuristic == PACK_BEST_AREA_FIT) {
+                u64 waste = 0;
+                for (size_t j = i; j < skyline.size() && skyline[j].x < end; j++)
+                    waste += static_cast<u64>(y - skyline[j].y) * (std::min(end, skyline[j].x + skyline[j].width) - skyline[j].x);
+                primary = waste;
+                secondary = static_cast<u64>(y) + height;
+            } else {
+                primary = static_cast<u64>(y) + height;
+                secondary = skyline[i].width;
+            }
+
+            if (is_better(primary, secondary, best))
+                best = candidate{{x, y, width, height}, rotated, i, primary, secondary};
+        }
+    }
+
+    std::optional<rect_packer::candidate> rect_packer::find(const page& target, u32 width, u32 height) const {
+        std::optional<candidate> best;
+        bool rotate = _options.allow_rotation && width != height;
+        if (_options.algorithm == PACK_SKYLINE) {
+            find_skyline(target, width, height, false, best);
+            if (rotate)
+                find_skyline(target, height, width, true, best);
+        } else {
+            find_max_rects(target, width, height, false, best);
+            if (rotate)
+                find_max_rects(target, height, width, true, best);
+        }
+        return best;
+    }
+
+    template<typename Rect>
+    static inline bool intersects(const Rect& a, const Rect& b) {
+        return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    template<typename Rect>
+    static inline bool contains(const Rect& outer, const Rect& inner) {
+        return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width &&
+               inner.y + inner.height <= outer.y + outer.height;
+    }
+
+    void rect_packer::place_max_rects(page& target, const rect& place) {
+        // Splits the free rectangles overlapping the placed one into their maximal parts around it.
+        std::vector<rect> created;
+        size_t kept = 0;
+        for (size_t i = 0; i < target.free.size(); i++) {
+            rect free = target.free[i];
+            if (!intersects(free, place)) {
+                target.free[kept++] = free;
+                continue;
+            }
+            if (place.x > free.x)
+                created.push_back({free.x, free.y, place.x - free.x, free.height});
+            if (place.x + place.width < free.x + free.width)
+                created.push_back({place.x + place.width, free.y, free.x + free.width - place.x - place.width, free.height});
+            if (place.y > free.y)
+                created.push_back({free.x, free.y, free.width, place.y - free.y});
+            if (place.y + place.height < free.y + free.height)
+                created.push_back({free.x, place.y + place.height, free.width, free.y + free.height - place.y - place.height});
+        }
+        target.free.resize(kept);
+
+        // Only the new rectangles may be contained in another one: the kept ones were maximal and are not contained in
+        // the split ones, so they are not contained in their parts either.
+        std::vector<bool> removed(created.size(), false);
+        for (size_t i = 0; i < created.size(); i++) {
+            for (size_t j = 0; j < created.size() && !removed[i]; j++)
+                if (i != j && !removed[j] && contains(created[j], created[i]))
+                    removed[i] = true;
+            for (size_t j = 0; j < kept && !removed[i]; j++)
+                if (contains(target.free[j], created[i]))
+                    removed[i] = true;
+        }
+        for (size_t i = 0; i < created.size(); i++)
+            if (!removed[i])
+                target.free.push_back(created[i]);
+
+        target.used.push_back(place);
+    }
+
+    void rect_packer::place_skyline(page& target, size_t node, const rect& place) {
+        auto& skyline = target.skyline;
+        skyline.insert(skyline.begin() + node, {place.x, place.y + place.height, place.width});
+
+        // Cuts the nodes now under the placed rectangle.
+        u32 end = place.x + place.width;
+        size_t i = node + 1;
+        while (i < skyline.size() && skyline[i].x < end) {
+            u32 node_end = skyline[i].x + skyline[i].width;
+            if (node_end <= end)
+                skyline.erase(skyline.begin() + i);
+            else {
+                skyline[i].width = node_end - end;
+                skyline[i].x = end;
+                break;
+            }
+        }
+
+        for (i = 0; i + 1 < skyline.size();) {
+            if (skyline[i].y == skyline[i + 1].y) {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+            } else
+                i++;
+        }
+    }
+
+    std::optional<packed_rect> rect_packer::insert(const Size2D<u32>& size) {
+        if (size.get_width() == 0 || size.get_height() == 0)
+            return packed_rect{0, 0, 0, size.get_width(), size.get_height(), false};
+
+        u32 width = size.get_width() + _options.padding, height = size.get_height() + _options.padding;
+        u32 index = 0;
+        std::optional<candidate> found;
+        for (; index < _pages.size() && !found; index++)
+            found = find(_pages[index], width, height);
+        if (found)
+            index--;
+        else {
+            if (_options.max_pages && _pages.size() >= _options.max_pages)
+                return std::nullopt;
+            page target = new_page();
+            found = find(target, width, height);
+            if (!found)
+                return std::nullopt;
+            _pages.push_back(std::move(target));
+        }
+
+        page& target = _pages[index];
+        if (_options.algorithm == PACK_SKYLINE)
+            place_skyline(target, found->node, found->place);
+        else
+            place_max_rects(target, found->place);
+        target.used_area += static_cast<u64>(size.get_width()) * size.get_height();
+
+        u32 placed_width = found->rotated ? size.get_height() : size.get_width();
+        u32 placed_height = found->rotated ? size.get_width() : size.get_height();
+        return packed_rect{index, found->place.x, found->place.y, placed_width, placed_height, found->rotated};
+    }
+
+    void rect_packer::clear() {
+        _pages.clear();
+    }
+
+    const Size2D<u32>& rect_packer::get_page_size() const {
+        return _page_size;
+    }
+
+    const pack_options& rect_packer::get_options() const {
+        return _options;
+    }
+
+    u32 rect_packer::get_page_count() const {
+        return static_cast<u32>(_pages.size());
+    }
+
+    f64 rect_packer::get_occupancy() const {
+        if (_pages.empty())
+            return 0.0;
+        u64 used = 0;
+        for (const page& target : _pages)
+            used += target.used_area;
+        return static_cast<f64>(used) /
+               (static_cast<f64>(_page_size.get_width()) * _page_size.get_height() * static_cast<f64>(_pages.size()));
+    }
+
+    f64 rect_packer::get_occupancy(u32 page) const {
+        if (page >= _pages.size())
+            return 0.0;
+        return static_cast<f64>(_pages[page].used_area) / (static_cast<f64>(_page_size.get_width()) * _page_size.get_height());
+    }
+
+    /*
+     * Offline packing.
+     */
+
+    namespace
+    {
+        struct pack_trial
+        {
+            pack_algorithm algorithm;
+            pack_heuristic heuristic;
+            u8 order;
+        };
+
+        struct pack_outcome
+        {
+            pack_result result;
+            size_t unplaced;
+            u64 last_page_area;
+        };
+    }
+
+    static constexpr pack_trial PACK_METHODS[] = {
+            {PACK_MAX_RECTS, PACK_BEST_SHORT_SIDE_FIT, 0},
+            {PACK_MAX_RECTS, PACK_BEST_LONG_SIDE_FIT,  0},
+            {PACK_MAX_RECTS, PACK_BEST_AREA_FIT,       0},
+            {PACK_MAX_RECTS, PACK_BOTTOM_LEFT,         0},
+            {PACK_MAX_RECTS, PACK_CONTACT_POINT,       0},
+            {PACK_SKYLINE,   PACK_BOTTOM_LEFT,         0},
+            {PACK_SKYLINE,   PACK_BEST_AREA_FIT,       0}
+    };
+
+    /*!
+     * The sort orders of the rectangles, all decreasing: area, longer side, perimeter and height.
+     */
+    static constexpr u8 PACK_ORDERS = 4;
+
+    static inline u64 sort_key(const Size2D<u32>& size, u8 order) {
+        u64 width = size.get_width(), height = size.get_height();
+        switch (order) {
+            case 0:
+                return width * height;
+            case 1:
+                return std::max(width, height);
+            case 2:
+                return width + height;
+            default:
+                return height;
+        }
+    }
+
+    static pack_outcome run_trial(const std::vector<Size2D<u32>>& sizes, const Size2D<u32>& page_size, pack_options options,
+                                  u8 order) {
+        std::vector<size_t> indices(sizes.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        // Stable, so the equal keys keep the input order and the trial is deterministic.
+        std::stable_sort(indices.begin(), indices.end(), [&sizes, order](size_t a, size_t b) {
+            return sort_key(sizes[a], order) > sort_key(sizes[b], order);
+        });
+
+        rect_packer packer{page_size, options};
+        pack_outcome outcome{{std::vector<std::optional<packed_rect>>(sizes.size()), 0, 0.0, options}, 0, 0};
+        for (size_t index : indices) {
+            outcome.result.rects[index] = packer.insert(sizes[index]);
+            if (!outcome.result.rects[index])
+                outcome.unplaced++;
+        }
+        outcome.result.pages = packer.get_page_count();
+        outcome.result.occupancy = packer.get_occupancy();
+
+        u64 right = 0, bottom = 0;
+        for (const auto& placed : outcome.result.rects) {
+            if (placed && outcome.result.pages && placed->page == outcome.result.pages - 1) {
+                right = std::max<u64>(right, placed->x + placed->width);
+                bottom = std::max<u64>(bottom, placed->y + placed->height);
+            }
+        }
+        outcome.last_page_area = right * bottom;
+        return outcome;
+    }
+
+    pack_result rect_packer::pack(const std::vector<Size2D<u32>>& sizes, const Size2D<u32>& page_size,
+                            const pack_options& options, system::thread_pool& pool) {
+        constexpr size_t methods = sizeof(PACK_METHODS) / sizeof(pack_trial);
+        std::vector<std::future<pack_outcome>> futures;
+        futures.reserve(methods * PACK_ORDERS);
+        for (const pack_trial& method : PACK_METHODS) {
+            for (u8 order = 0; order < PACK_ORDERS; order++) {
+                pack_options trial = options;
+                trial.algorithm = method.algorithm;
+                trial.heuristic = method.heuristic;
+                futures.push_back(pool.submit([&sizes, &page_size, trial, order]() {
+                    return run_trial(sizes, page_size, trial, order);
+                }));
+            }
+        }
+
+        // The trials reference the arguments, they must all end before an exception of one of them propagates.
+        for (auto& future : futures)
+            future.wait();
+
+        // The ties keep the first trial, so the kept result does not depend on which trial finished first.
+        std::optional<pack_outcome> best;
+        for (auto& future : futures) {
+            pack_outcome outcome = future.get();
+            if (!best || outcome.unplaced < best->unplaced ||
+                (outcome.unplaced == best->unplaced && (outcome.result.pages < best->result.pages ||
+                                                        (outcome.result.pages == best->result.pages &&
+                                                         outcome.last_page_area < best->last_page_area))))
+                best = std::move(outcome);
+        }
+        return std::move(best->result);
+    }
+
+    pack_result rect_packer::pack(const std::vector<Size2D<u32>>& sizes, const Size2D<u32>& page_size,
+                            const pack_options& options) {
+        return pack(sizes, page_size, options, parallel::get_thread_pool());
+    }
+}
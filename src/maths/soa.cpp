@@ -0,0 +1,800 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/maths/soa.h"
+#include "soa_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LAMBDA_SOA_SSE2
+#  include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#  define LAMBDA_SOA_NEON
+#  include <arm_neon.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define LAMBDA_SOA_X86
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  endif
+#endif
+
+namespace lambdacommon::maths
+{
+    namespace internal
+    {
+        /*
+         * Scalar kernels
+         */
+
+        static void scalar_add(vec3_input a, vec3_input b, vec3_output out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                out.x[i] = a.x[i] + b.x[i];
+                out.y[i] = a.y[i] + b.y[i];
+                out.z[i] = a.z[i] + b.z[i];
+            }
+        }
+
+        static void scalar_sub(vec3_input a, vec3_input b, vec3_output out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                out.x[i] = a.x[i] - b.x[i];
+                out.y[i] = a.y[i] - b.y[i];
+                out.z[i] = a.z[i] - b.z[i];
+            }
+        }
+
+        static void scalar_scale(vec3_input a, f32 factor, vec3_output out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                out.x[i] = a.x[i] * factor;
+                out.y[i] = a.y[i] * factor;
+                out.z[i] = a.z[i] * factor;
+            }
+        }
+
+        static void scalar_cross(vec3_input a, vec3_input b, vec3_output out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                f32 x = a.y[i] * b.z[i] - a.z[i] * b.y[i];
+                f32 y = a.z[i] * b.x[i] - a.x[i] * b.z[i];
+                f32 z = a.x[i] * b.y[i] - a.y[i] * b.x[i];
+                out.x[i] = x;
+                out.y[i] = y;
+                out.z[i] = z;
+            }
+        }
+
+        static void scalar_normalize(vec3_input a, vec3_output out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                f32 length = std::sqrt(a.x[i] * a.x[i] + a.y[i] * a.y[i] + a.z[i] * a.z[i]);
+                out.x[i] = a.x[i] / length;
+                out.y[i] = a.y[i] / length;
+                out.z[i] = a.z[i] / length;
+            }
+        }
+
+        static void scalar_dot(vec3_input a, vec3_input b, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = a.x[i] * b.x[i] + a.y[i] * b.y[i] + a.z[i] * b.z[i];
+        }
+
+        static void scalar_length(vec3_input a, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = std::sqrt(a.x[i] * a.x[i] + a.y[i] * a.y[i] + a.z[i] * a.z[i]);
+        }
+
+        static void scalar_distance(vec3_input a, vec3_input b, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                f32 x = a.x[i] - b.x[i], y = a.y[i] - b.y[i], z = a.z[i] - b.z[i];
+                out[i] = std::sqrt(x * x + y * y + z * z);
+            }
+        }
+
+        template<bool Translate>
+        static void scalar_transform(const f32* m, vec3_input a, vec3_output out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                f32 x = m[0] * a.x[i] + m[4] * a.y[i] + m[8] * a.z[i];
+                f32 y = m[1] * a.x[i] + m[5] * a.y[i] + m[9] * a.z[i];
+                f32 z = m[2] * a.x[i] + m[6] * a.y[i] + m[10] * a.z[i];
+                if constexpr (Translate) {
+                    x += m[12];
+                    y += m[13];
+                    z += m[14];
+                }
+                out.x[i] = x;
+                out.y[i] = y;
+                out.z[i] = z;
+            }
+        }
+
+        static void scalar_multiply_mat4(const f32* a, size_t a_stride, const f32* b, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++, a += a_stride, b += 16, out += 16) {
+                f32 result[16];
+                for (size_t column = 0; column < 4; column++)
+                    for (size_t row = 0; row < 4; row++)
+                        result[column * 4 + row] = a[row] * b[column * 4] + a[4 + row] * b[column * 4 + 1] + a[8 + row] * b[column * 4 + 2] +
+                                                   a[12 + row] * b[column * 4 + 3];
+                std::copy(result, result + 16, out);
+            }
+        }
+
+        template<f32 (* Function)(f32)>
+        static void scalar_unary(const f32* in, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = Function(in[i]);
+        }
+
+        static void scalar_sincos(const f32* in, f32* sine, f32* cosine, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                f32 s, c;
+                fast::sincos(in[i], s, c);
+                sine[i] = s;
+                cosine[i] = c;
+            }
+        }
+
+        static void scalar_atan2(const f32* y, const f32* x, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = fast::atan2(y[i], x[i]);
+        }
+
+        typedef intersection_algorithms<fast::internal::scalar_ops> scalar_intersections;
+
+        static void scalar_ray_boxes(const ray_input& ray, box_input boxes, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                f32 minimum[3] = {boxes.min.x[i], boxes.min.y[i], boxes.min.z[i]};
+                f32 maximum[3] = {boxes.max.x[i], boxes.max.y[i], boxes.max.z[i]};
+                out[i] = scalar_intersections::ray_box(ray.origin, ray.inverse_direction, ray.t_max, minimum, maximum);
+            }
+        }
+
+        static void scalar_rays_box(ray_packet_input rays, const f32* box, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                f32 origin[3] = {rays.origin.x[i], rays.origin.y[i], rays.origin.z[i]};
+                f32 inverse[3] = {rays.inverse_direction.x[i], rays.inverse_direction.y[i], rays.inverse_direction.z[i]};
+                out[i] = scalar_intersections::ray_box(origin, inverse, rays.t_max[i], box, box + 3);
+            }
+        }
+
+        static void scalar_ray_triangles(const ray_input& ray, triangle_input triangles, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                f32 vertex[3] = {triangles.vertex.x[i], triangles.vertex.y[i], triangles.vertex.z[i]};
+                f32 edge1[3] = {triangles.edge1.x[i], triangles.edge1.y[i], triangles.edge1.z[i]};
+                f32 edge2[3] = {triangles.edge2.x[i], triangles.edge2.y[i], triangles.edge2.z[i]};
+                out[i] = scalar_intersections::ray_triangle(ray.origin, ray.direction, ray.t_max, vertex, edge1, edge2);
+            }
+        }
+
+        static void scalar_ray_spheres(const ray_input& ray, sphere_input spheres, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                f32 center[3] = {spheres.center.x[i], spheres.center.y[i], spheres.center.z[i]};
+                out[i] = scalar_intersections::ray_sphere(ray.origin, ray.direction, ray.t_max, center, spheres.radius[i]);
+            }
+        }
+
+        static void scalar_xoshiro256pp(u64* state, u64* out, size_t blocks) {
+            auto rotl = [](u64 x, int k) { return (x << k) | (x >> (64 - k)); };
+            for (size_t lane = 0; lane < XOSHIRO_LANES; lane++) {
+                u64 s0 = state[lane], s1 = state[XOSHIRO_LANES + lane], s2 = state[2 * XOSHIRO_LANES + lane], s3 = state[3 * XOSHIRO_LANES + lane];
+                for (size_t i = 0; i < blocks; i++) {
+                    out[i * XOSHIRO_LANES + lane] = rotl(s0 + s3, 23) + s0;
+                    u64 t = s1 << 17u;
+                    s2 ^= s0;
+                    s3 ^= s1;
+                    s1 ^= s2;
+                    s0 ^= s3;
+                    s2 ^= t;
+                    s3 = rotl(s3, 45);
+                }
+                state[lane] = s0;
+                state[XOSHIRO_LANES + lane] = s1;
+                state[2 * XOSHIRO_LANES + lane] = s2;
+                state[3 * XOSHIRO_LANES + lane] = s3;
+            }
+        }
+
+        static inline i32 wrap_or_saturate(i64 value, bool saturate) {
+            if (saturate)
+                return static_cast<i32>(maths::clamp<i64>(value, std::numeric_limits<i32>::min(), std::numeric_limits<i32>::max()));
+            return static_cast<i32>(static_cast<u32>(value));
+        }
+
+        static void scalar_fixed_add(const i32* a, const i32* b, i32* out, size_t count, bool saturate) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = wrap_or_saturate(static_cast<i64>(a[i]) + b[i], saturate);
+        }
+
+        static void scalar_fixed_sub(const i32* a, const i32* b, i32* out, size_t count, bool saturate) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = wrap_or_saturate(static_cast<i64>(a[i]) - b[i], saturate);
+        }
+
+        static void scalar_fixed_multiply(const i32* a, const i32* b, i32* out, size_t count, u32 frac_bits, bool saturate) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = wrap_or_saturate((static_cast<i64>(a[i]) * b[i] + (i64{1} << (frac_bits - 1))) >> frac_bits, saturate);
+        }
+
+        static void scalar_points_in_polygon(const f32* x, const f32* y, const f32* edges, size_t edge_count, u8* out, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                u32 crossings = 0;
+                for (size_t j = 0; j < edge_count; j++) {
+                    const f32* edge = edges + j * POLYGON_EDGE_STRIDE;
+                    if (!(y[i] < edge[3]) && y[i] < edge[4] && x[i] < edge[0] + edge[2] * (y[i] - edge[1]))
+                        crossings++;
+                }
+                out[i] = static_cast<u8>(crossings & 1u);
+            }
+        }
+
+        static void scalar_noise(const noise_input& settings, u32 dimensions, const f32* const* coordinates, f32* out, size_t count) {
+            dispatch_noise(dimensions, settings.type, [&](auto dimension, auto type) {
+                constexpr size_t D = decltype(dimension)::value;
+                for (size_t i = 0; i < count; i++) {
+                    f32 p[D];
+                    for (size_t d = 0; d < D; d++)
+                        p[d] = coordinates[d][i];
+                    out[i] = noise_algorithms<fast::internal::scalar_ops>::sample<D, decltype(type)::value>(settings, p);
+                }
+            });
+        }
+
+        static inline f32 saturate(f32 value) {
+            return 0.f < value ? std::min(value, 1.f) : 0.f;
+        }
+
+        /*!
+         * Applies an alpha conversion on a color of four floats, like simd_batch::convert_alpha.
+         */
+        static inline void convert_alpha(f32* rgba, u8 alpha) {
+            for (size_t c = 0; c < 3 && alpha != 0; c++) {
+                if (alpha == 1)
+                    rgba[c] *= rgba[3];
+                else
+                    rgba[c] = rgba[3] == 0.f ? 0.f : saturate(rgba[c] / rgba[3]);
+            }
+        }
+
+        static void scalar_colors_to_rgba8(const f32* in, u8* out, size_t count, u8 alpha) {
+            for (size_t i = 0; i < count * 4; i += 4) {
+                f32 rgba[4];
+                for (size_t c = 0; c < 4; c++)
+                    rgba[c] = saturate(in[i + c]);
+                convert_alpha(rgba, alpha);
+                for (size_t c = 0; c < 4; c++)
+                    out[i + c] = static_cast<u8>(std::nearbyint(rgba[c] * 255.f));
+            }
+        }
+
+        static void scalar_colors_to_f32x4(const u8* in, f32* out, size_t count, u8 alpha) {
+            for (size_t i = 0; i < count * 4; i += 4) {
+                f32 rgba[4];
+                for (size_t c = 0; c < 4; c++)
+                    rgba[c] = static_cast<f32>(in[i + c]) / 255.f;
+                convert_alpha(rgba, alpha);
+                std::copy_n(rgba, 4, out + i);
+            }
+        }
+
+        const batch_kernels SCALAR_KERNELS = {scalar_add, scalar_sub, scalar_scale, scalar_cross, scalar_normalize, scalar_dot,
+                                              scalar_length, scalar_distance, scalar_transform<true>, scalar_transform<false>,
+                                              scalar_multiply_mat4,
+                                              scalar_unary<fast::rsqrt>, scalar_unary<fast::sqrt>, scalar_unary<fast::sin>, scalar_unary<fast::cos>,
+                                              scalar_sincos, scalar_atan2, scalar_unary<fast::exp>, scalar_unary<fast::log>,
+                                              scalar_ray_boxes, scalar_rays_box, scalar_ray_triangles, scalar_ray_spheres,
+                                              scalar_xoshiro256pp, scalar_fixed_add, scalar_fixed_sub, scalar_fixed_multiply,
+                                              scalar_points_in_polygon, scalar_noise, scalar_colors_to_rgba8, scalar_colors_to_f32x4};
+
+        namespace
+        {
+#ifdef LAMBDA_SOA_SSE2
+            struct sse2_ops
+            {
+                typedef __m128 reg;
+                typedef __m128i ireg;
+                typedef __m128 mask;
+                static constexpr size_t WIDTH = 4;
+
+                static inline reg load(const f32* p) { return _mm_loadu_ps(p); }
+
+                static inline void store(f32* p, reg v) { _mm_storeu_ps(p, v); }
+
+                static inline reg splat(f32 v) { return _mm_set1_ps(v); }
+
+                static inline reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+
+                static inline reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+
+                static inline reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+
+                static inline reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+
+                static inline reg sqrt(reg a) { return _mm_sqrt_ps(a); }
+
+                static inline reg fmadd(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+                static inline reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+
+                static inline reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+
+                static inline reg rsqrt_estimate(reg a) { return _mm_rsqrt_ps(a); }
+
+                static inline ireg isplat(u32 v) { return _mm_set1_epi32(static_cast<i32>(v)); }
+
+                static inline ireg as_int(reg a) { return _mm_castps_si128(a); }
+
+                static inline reg as_float(ireg a) { return _mm_castsi128_ps(a); }
+
+                static inline ireg round_to_int(reg a) { return _mm_cvtps_epi32(a); }
+
+                static inline ireg truncate_to_int(reg a) { return _mm_cvttps_epi32(a); }
+
+                static inline reg to_float(ireg a) { return _mm_cvtepi32_ps(a); }
+
+                static inline ireg iadd(ireg a, ireg b) { return _mm_add_epi32(a, b); }
+
+                static inline ireg isub(ireg a, ireg b) { return _mm_sub_epi32(a, b); }
+
+                static inline ireg iand(ireg a, ireg b) { return _mm_and_si128(a, b); }
+
+                static inline ireg ior(ireg a, ireg b) { return _mm_or_si128(a, b); }
+
+                static inline ireg ixor(ireg a, ireg b) { return _mm_xor_si128(a, b); }
+
+                template<int N>
+                static inline ireg shl(ireg a) { return _mm_slli_epi32(a, N); }
+
+                template<int N>
+                static inline ireg shr(ireg a) { return _mm_srli_epi32(a, N); }
+
+                static inline mask less(reg a, reg b) { return _mm_cmplt_ps(a, b); }
+
+                static inline mask equal(reg a, reg b) { return _mm_cmpeq_ps(a, b); }
+
+                static inline mask is_zero(ireg a) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_setzero_si128())); }
+
+                static inline reg select(mask m, reg a, reg b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+                /*
+                 * 64-bit integer lanes, for the random generators.
+                 */
+
+                typedef __m128i qreg;
+                static constexpr size_t QWIDTH = 2;
+
+                static inline qreg qload(const u64* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+
+                static inline void qstore(u64* p, qreg v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+                static inline qreg qadd(qreg a, qreg b) { return _mm_add_epi64(a, b); }
+
+                static inline qreg qxor(qreg a, qreg b) { return _mm_xor_si128(a, b); }
+
+                template<int N>
+                static inline qreg qshl(qreg a) { return _mm_slli_epi64(a, N); }
+
+                template<int N>
+                static inline qreg qrotl(qreg a) { return _mm_or_si128(_mm_slli_epi64(a, N), _mm_srli_epi64(a, 64 - N)); }
+
+                /*
+                 * Fixed point numbers of 32 bits.
+                 */
+
+                static inline ireg iload(const i32* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+
+                static inline void istore(i32* p, ireg v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+                template<int N>
+                static inline ireg sra(ireg a) { return _mm_srai_epi32(a, N); }
+
+                /*!
+                 * Multiplies keeping the low 32 bits, SSE2 only multiplies the even lanes.
+                 */
+                static inline ireg imul(ireg a, ireg b) {
+                    __m128i even = _mm_mul_epu32(a, b), odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+                    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+                }
+
+                static inline ireg multiply_fixed(ireg a, ireg b, u32 shift, bool saturate) {
+                    // SSE2 only multiplies unsigned integers: the signed products subtract b << 32 if a is negative and a << 32 if b is.
+                    __m128i high_mask = _mm_set1_epi64x(static_cast<i64>(0xFFFFFFFF00000000ull));
+                    __m128i correction = _mm_add_epi32(_mm_and_si128(_mm_srai_epi32(a, 31), b), _mm_and_si128(_mm_srai_epi32(b, 31), a));
+                    __m128i round = _mm_set1_epi64x(i64{1} << (shift - 1));
+                    __m128i even = _mm_add_epi64(_mm_sub_epi64(_mm_mul_epu32(a, b), _mm_slli_epi64(correction, 32)), round);
+                    __m128i odd = _mm_add_epi64(_mm_sub_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)),
+                                                              _mm_and_si128(correction, high_mask)), round);
+                    // The logical shifts give the same low 32 bits as the arithmetic ones.
+                    __m128i count = _mm_cvtsi32_si128(static_cast<int>(shift));
+                    __m128i result = _mm_or_si128(_mm_andnot_si128(high_mask, _mm_srl_epi64(even, count)),
+                                                  _mm_slli_epi64(_mm_srl_epi64(odd, count), 32));
+                    if (!saturate)
+                        return result;
+                    // The products fit if their bits above shift + 31 copy the sign: their high halves shifted by shift - 1 are 0 or -1.
+                    __m128i high = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_and_si128(odd, high_mask));
+                    __m128i sign = _mm_srai_epi32(high, 31);
+                    __m128i fits = _mm_cmpeq_epi32(_mm_sra_epi32(high, _mm_cvtsi32_si128(static_cast<int>(shift - 1))), sign);
+                    return _mm_or_si128(_mm_and_si128(fits, result), _mm_andnot_si128(fits, _mm_xor_si128(sign, _mm_set1_epi32(0x7FFFFFFF))));
+                }
+
+                /*
+                 * Bytes, for the colors.
+                 */
+
+                static inline ireg bload(const u8* p) {
+                    i32 bytes;
+                    std::memcpy(&bytes, p, sizeof(bytes));
+                    __m128i zero = _mm_setzero_si128();
+                    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+                }
+
+                static inline void bstore(u8* p, ireg v) {
+                    __m128i words = _mm_packs_epi32(v, v);
+                    i32 bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+                    std::memcpy(p, &bytes, sizeof(bytes));
+                }
+
+                static inline reg broadcast_w(reg a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+                static inline void multiply_mat4(const f32* a, const f32* b, f32* out) {
+                    lambdacommon::internal::mat4_multiply(a, b, out);
+                }
+            };
+#endif
+
+#ifdef LAMBDA_SOA_NEON
+            struct neon_ops
+            {
+                typedef float32x4_t reg;
+                typedef uint32x4_t ireg;
+                typedef uint32x4_t mask;
+                static constexpr size_t WIDTH = 4;
+
+                static inline reg load(const f32* p) { return vld1q_f32(p); }
+
+                static inline void store(f32* p, reg v) { vst1q_f32(p, v); }
+
+                static inline reg splat(f32 v) { return vdupq_n_f32(v); }
+
+                static inline reg add(reg a, reg b) { return vaddq_f32(a, b); }
+
+                static inline reg sub(reg a, reg b) { return vsubq_f32(a, b); }
+
+                static inline reg mul(reg a, reg b) { return vmulq_f32(a, b); }
+
+                static inline reg div(reg a, reg b) { return vdivq_f32(a, b); }
+
+                static inline reg sqrt(reg a) { return vsqrtq_f32(a); }
+
+                static inline reg fmadd(reg a, reg b, reg c) { return vfmaq_f32(c, a, b); }
+
+                static inline reg min(reg a, reg b) { return vminq_f32(a, b); }
+
+                static inline reg max(reg a, reg b) { return vmaxq_f32(a, b); }
+
+                static inline reg rsqrt_estimate(reg a) { return vrsqrteq_f32(a); }
+
+                static inline ireg isplat(u32 v) { return vdupq_n_u32(v); }
+
+                static inline ireg as_int(reg a) { return vreinterpretq_u32_f32(a); }
+
+                static inline reg as_float(ireg a) { return vreinterpretq_f32_u32(a); }
+
+                static inline ireg round_to_int(reg a) { return vreinterpretq_u32_s32(vcvtnq_s32_f32(a)); }
+
+                static inline ireg truncate_to_int(reg a) { return vreinterpretq_u32_s32(vcvtq_s32_f32(a)); }
+
+                static inline reg to_float(ireg a) { return vcvtq_f32_s32(vreinterpretq_s32_u32(a)); }
+
+                static inline ireg iadd(ireg a, ireg b) { return vaddq_u32(a, b); }
+
+                static inline ireg isub(ireg a, ireg b) { return vsubq_u32(a, b); }
+
+                static inline ireg iand(ireg a, ireg b) { return vandq_u32(a, b); }
+
+                static inline ireg ior(ireg a, ireg b) { return vorrq_u32(a, b); }
+
+                static inline ireg ixor(ireg a, ireg b) { return veorq_u32(a, b); }
+
+                template<int N>
+                static inline ireg shl(ireg a) { return vshlq_n_u32(a, N); }
+
+                template<int N>
+                static inline ireg shr(ireg a) { return vshrq_n_u32(a, N); }
+
+                static inline mask less(reg a, reg b) { return vcltq_f32(a, b); }
+
+                static inline mask equal(reg a, reg b) { return vceqq_f32(a, b); }
+
+                static inline mask is_zero(ireg a) { return vceqq_u32(a, vdupq_n_u32(0)); }
+
+                static inline reg select(mask m, reg a, reg b) { return vbslq_f32(m, a, b); }
+
+                /*
+                 * 64-bit integer lanes, for the random generators.
+                 */
+
+                typedef uint64x2_t qreg;
+                static constexpr size_t QWIDTH = 2;
+
+                static inline qreg qload(const u64* p) { return vld1q_u64(p); }
+
+                static inline void qstore(u64* p, qreg v) { vst1q_u64(p, v); }
+
+                static inline qreg qadd(qreg a, qreg b) { return vaddq_u64(a, b); }
+
+                static inline qreg qxor(qreg a, qreg b) { return veorq_u64(a, b); }
+
+                template<int N>
+                static inline qreg qshl(qreg a) { return vshlq_n_u64(a, N); }
+
+                template<int N>
+                static inline qreg qrotl(qreg a) { return vsriq_n_u64(vshlq_n_u64(a, N), a, 64 - N); }
+
+                /*
+                 * Fixed point numbers of 32 bits.
+                 */
+
+                static inline ireg iload(const i32* p) { return vreinterpretq_u32_s32(vld1q_s32(p)); }
+
+                static inline void istore(i32* p, ireg v) { vst1q_s32(p, vreinterpretq_s32_u32(v)); }
+
+                template<int N>
+                static inline ireg sra(ireg a) { return vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(a), N)); }
+
+                static inline ireg imul(ireg a, ireg b) { return vmulq_u32(a, b); }
+
+                static inline ireg multiply_fixed(ireg a, ireg b, u32 shift, bool saturate) {
+                    int32x4_t x = vreinterpretq_s32_u32(a), y = vreinterpretq_s32_u32(b);
+                    int64x2_t round = vdupq_n_s64(i64{1} << (shift - 1)), right = vdupq_n_s64(-static_cast<i64>(shift));
+                    int64x2_t low = vshlq_s64(vaddq_s64(vmull_s32(vget_low_s32(x), vget_low_s32(y)), round), right);
+                    int64x2_t high = vshlq_s64(vaddq_s64(vmull_high_s32(x, y), round), right);
+                    if (saturate)
+                        return vreinterpretq_u32_s32(vcombine_s32(vqmovn_s64(low), vqmovn_s64(high)));
+                    return vreinterpretq_u32_s32(vcombine_s32(vmovn_s64(low), vmovn_s64(high)));
+                }
+
+                /*
+                 * Bytes, for the colors.
+                 */
+
+                static inline ireg bload(const u8* p) {
+                    u32 bytes;
+                    std::memcpy(&bytes, p, sizeof(bytes));
+                    return vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bytes)))));
+                }
+
+                static inline void bstore(u8* p, ireg v) {
+                    uint16x4_t words = vmovn_u32(v);
+                    u32 bytes = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(words, words))), 0);
+                    std::memcpy(p, &bytes, sizeof(bytes));
+                }
+
+                static inline reg broadcast_w(reg a) { return vdupq_laneq_f32(a, 3); }
+
+                static inline void multiply_mat4(const f32* a, const f32* b, f32* out) {
+                    lambdacommon::internal::mat4_multiply(a, b, out);
+                }
+            };
+#endif
+        }
+
+        const batch_kernels* get_sse2_kernels() {
+#ifdef LAMBDA_SOA_SSE2
+            return &simd_batch<sse2_ops>::KERNELS;
+#else
+            return nullptr;
+#endif
+        }
+
+        const batch_kernels* get_neon_kernels() {
+#ifdef LAMBDA_SOA_NEON
+            return &simd_batch<neon_ops>::KERNELS;
+#else
+            return nullptr;
+#endif
+        }
+
+#ifdef LAMBDA_SOA_X86
+        /*!
+         * Checks whether the processor and the operating system support an extension.
+         * @param avx512 True to check AVX-512F, else AVX2 with FMA.
+         */
+        static bool has_x86_extension(bool avx512) {
+#  ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 1);
+            // OSXSAVE, AVX and FMA.
+            if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (info[2] & (1 << 12)) == 0)
+                return false;
+            auto xcr0 = _xgetbv(0);
+            if ((xcr0 & 0x6) != 0x6)
+                return false;
+            __cpuidex(info, 7, 0);
+            if (!avx512)
+                return (info[1] & (1 << 5)) != 0;
+            return (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE0) == 0xE0;
+#  else
+            __builtin_cpu_init();
+            if (avx512)
+                return __builtin_cpu_supports("avx512f");
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#  endif
+        }
+#endif
+
+        struct dispatch
+        {
+            simd_level supported = SIMD_SCALAR;
+            std::atomic<simd_level> level{SIMD_SCALAR};
+
+            dispatch() {
+                if (get_sse2_kernels())
+                    supported = SIMD_SSE2;
+                if (get_neon_kernels())
+                    supported = SIMD_NEON;
+#ifdef LAMBDA_SOA_X86
+                if (get_avx2_kernels() && has_x86_extension(false))
+                    supported = SIMD_AVX2;
+                if (get_avx512_kernels() && has_x86_extension(true))
+                    supported = SIMD_AVX512;
+#endif
+                level = supported;
+            }
+        };
+
+        static dispatch& get_dispatch() {
+            static dispatch instance;
+            return instance;
+        }
+
+        static bool is_available(simd_level level) {
+            switch (level) {
+                case SIMD_SSE2:
+                    return get_sse2_kernels() != nullptr;
+                case SIMD_NEON:
+                    return get_neon_kernels() != nullptr;
+                case SIMD_AVX2:
+                    return get_avx2_kernels() != nullptr && get_dispatch().supported >= level;
+                case SIMD_AVX512:
+                    return get_avx512_kernels() != nullptr && get_dispatch().supported >= level;
+                default:
+                    return true;
+            }
+        }
+
+        const batch_kernels& get_kernels() {
+            switch (get_dispatch().level.load(std::memory_order_relaxed)) {
+                case SIMD_SSE2:
+                    return *get_sse2_kernels();
+                case SIMD_NEON:
+                    return *get_neon_kernels();
+                case SIMD_AVX2:
+                    return *get_avx2_kernels();
+                case SIMD_AVX512:
+                    return *get_avx512_kernels();
+                default:
+                    return SCALAR_KERNELS;
+            }
+        }
+
+        static inline vec3_input in(const vec3_soa<f32>& v) {
+            return {v.x(), v.y(), v.z()};
+        }
+
+        static inline vec3_output out(vec3_soa<f32>& v, size_t size) {
+            v.resize(size);
+            return {v.x(), v.y(), v.z()};
+        }
+    }
+
+    simd_level LAMBDACOMMON_API get_supported_simd_level() {
+        return internal::get_dispatch().supported;
+    }
+
+    simd_level LAMBDACOMMON_API get_simd_level() {
+        return internal::get_dispatch().level;
+    }
+
+    simd_level LAMBDACOMMON_API set_simd_level(simd_level level) {
+        auto& dispatch = internal::get_dispatch();
+        // NEON sits between SSE2 and AVX2, lowering an x86 level never stops on it and the other way around.
+        while (level != SIMD_SCALAR && !internal::is_available(level))
+            level = static_cast<simd_level>(level - 1);
+        dispatch.level = level;
+        return level;
+    }
+
+    const char* LAMBDACOMMON_API get_simd_level_name(simd_level level) {
+        switch (level) {
+            case SIMD_SSE2:
+                return "SSE2";
+            case SIMD_NEON:
+                return "NEON";
+            case SIMD_AVX2:
+                return "AVX2";
+            case SIMD_AVX512:
+                return "AVX-512";
+            default:
+                return "scalar";
+        }
+    }
+
+    static inline void check_sizes(const vec3_soa<f32>& a, const vec3_soa<f32>& b) {
+        if (a.size() != b.size())
+            throw std::invalid_argument("The arrays must have the same size, got " + std::to_string(a.size()) + " and " +
+                                        std::to_string(b.size()) + ".");
+    }
+
+    void LAMBDACOMMON_API add(const vec3_soa<f32>& a, const vec3_soa<f32>& b, vec3_soa<f32>& out) {
+        check_sizes(a, b);
+        internal::get_kernels().add(internal::in(a), internal::in(b), internal::out(out, a.size()), a.size());
+    }
+
+    void LAMBDACOMMON_API sub(const vec3_soa<f32>& a, const vec3_soa<f32>& b, vec3_soa<f32>& out) {
+        check_sizes(a, b);
+        internal::get_kernels().sub(internal::in(a), internal::in(b), internal::out(out, a.size()), a.size());
+    }
+
+    void LAMBDACOMMON_API scale(const vec3_soa<f32>& a, f32 factor, vec3_soa<f32>& out) {
+        internal::get_kernels().scale(internal::in(a), factor, internal::out(out, a.size()), a.size());
+    }
+
+    void LAMBDACOMMON_API cross(const vec3_soa<f32>& a, const vec3_soa<f32>& b, vec3_soa<f32>& out) {
+        check_sizes(a, b);
+        internal::get_kernels().cross(internal::in(a), internal::in(b), internal::out(out, a.size()), a.size());
+    }
+
+    void LAMBDACOMMON_API normalize(const vec3_soa<f32>& a, vec3_soa<f32>& out) {
+        internal::get_kernels().normalize(internal::in(a), internal::out(out, a.size()), a.size());
+    }
+
+    void LAMBDACOMMON_API dot(const vec3_soa<f32>& a, const vec3_soa<f32>& b, std::vector<f32>& out) {
+        check_sizes(a, b);
+        out.resize(a.size());
+        internal::get_kernels().dot(internal::in(a), internal::in(b), out.data(), a.size());
+    }
+
+    void LAMBDACOMMON_API length(const vec3_soa<f32>& a, std::vector<f32>& out) {
+        out.resize(a.size());
+        internal::get_kernels().length(internal::in(a), out.data(), a.size());
+    }
+
+    void LAMBDACOMMON_API distance(const vec3_soa<f32>& a, const vec3_soa<f32>& b, std::vector<f32>& out) {
+        check_sizes(a, b);
+        out.resize(a.size());
+        internal::get_kernels().distance(internal::in(a), internal::in(b), out.data(), a.size());
+    }
+
+    void LAMBDACOMMON_API transform_points(const mat4f& matrix, const vec3_soa<f32>& points, vec3_soa<f32>& out) {
+        internal::get_kernels().transform_points(matrix.data(), internal::in(points), internal::out(out, points.size()), points.size());
+    }
+
+    void LAMBDACOMMON_API transform_vectors(const mat4f& matrix, const vec3_soa<f32>& vectors, vec3_soa<f32>& out) {
+        internal::get_kernels().transform_vectors(matrix.data(), internal::in(vectors), internal::out(out, vectors.size()), vectors.size());
+    }
+
+    void LAMBDACOMMON_API transform_points(const mat4f& matrix, const point3f* points, point3f* out, size_t count) {
+        // A 3D point does not fill a register, every point is transformed with the 4-wide baseline operations.
+        for (size_t i = 0; i < count; i++)
+            out[i] = transform_point(matrix, points[i]);
+    }
+
+    void LAMBDACOMMON_API multiply(const mat4f& a, const mat4f* b, mat4f* out, size_t count) {
+        internal::get_kernels().multiply_mat4(a.data(), 0, reinterpret_cast<const f32*>(b), reinterpret_cast<f32*>(out), count);
+    }
+
+    void LAMBDACOMMON_API multiply(const mat4f* a, const mat4f* b, mat4f* out, size_t count) {
+        internal::get_kernels().multiply_mat4(reinterpret_cast<const f32*>(a), 16, reinterpret_cast<const f32*>(b), reinterpret_cast<f32*>(out), count);
+    }
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+/*
+ * AVX2 batch kernels, this translation unit is compiled with AVX2 and FMA enabled (see CMakeLists.txt).
+ * Its code only runs once the processor support is checked.
+ */
+
+#include "soa_kernels.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#  define LAMBDA_SOA_AVX2
+#  include <immintrin.h>
+#endif
+
+namespace lambdacommon::maths::internal
+{
+#ifdef LAMBDA_SOA_AVX2
+    namespace
+    {
+        struct avx2_ops
+        {
+            typedef __m256 reg;
+            typedef __m256i ireg;
+            typedef __m256 mask;
+            static constexpr size_t WIDTH = 8;
+
+            static inline reg load(const f32* p) { return _mm256_loadu_ps(p); }
+
+            static inline void store(f32* p, reg v) { _mm256_storeu_ps(p, v); }
+
+            static inline reg splat(f32 v) { return _mm256_set1_ps(v); }
+
+            static inline reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+
+            static inline reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+
+            static inline reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+
+            static inline reg div(reg a, reg b) { return _mm256_div_ps(a, b); }
+
+            static inline reg sqrt(reg a) { return _mm256_sqrt_ps(a); }
+
+            static inline reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+
+            static inline reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+
+            static inline reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+
+            static inline reg rsqrt_estimate(reg a) { return _mm256_rsqrt_ps(a); }
+
+            static inline ireg isplat(u32 v) { return _mm256_set1_epi32(static_cast<i32>(v)); }
+
+            static inline ireg as_int(reg a) { return _mm256_castps_si256(a); }
+
+            static inline reg as_float(ireg a) { return _mm256_castsi256_ps(a); }
+
+            static inline ireg round_to_int(reg a) { return _mm256_cvtps_epi32(a); }
+
+            static inline ireg truncate_to_int(reg a) { return _mm256_cvttps_epi32(a); }
+
+            static inline reg to_float(ireg a) { return _mm256_cvtepi32_ps(a); }
+
+            static inline ireg iadd(ireg a, ireg b) { return _mm256_add_epi32(a, b); }
+
+            static inline ireg isub(ireg a, ireg b) { return _mm256_sub_epi32(a, b); }
+
+            static inline ireg iand(ireg a, ireg b) { return _mm256_and_si256(a, b); }
+
+            static inline ireg ior(ireg a, ireg b) { return _mm256_or_si256(a, b); }
+
+            static inline ireg ixor(ireg a, ireg b) { return _mm256_xor_si256(a, b); }
+
+            template<int N>
+            static inline ireg shl(ireg a) { return _mm256_slli_epi32(a, N); }
+
+            template<int N>
+            static inline ireg shr(ireg a) { return _mm256_srli_epi32(a, N); }
+
+            static inline mask less(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+
+            static inline mask equal(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+
+            static inline mask is_zero(ireg a) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, _mm256_setzero_si256())); }
+
+            static inline reg select(mask m, reg a, reg b) { return _mm256_blendv_ps(b, a, m); }
+
+            /*
+             * 64-bit integer lanes, for the random generators.
+             */
+
+            typedef __m256i qreg;
+            static constexpr size_t QWIDTH = 4;
+
+            static inline qreg qload(const u64* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+
+            static inline void qstore(u64* p, qreg v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+
+            static inline qreg qadd(qreg a, qreg b) { return _mm256_add_epi64(a, b); }
+
+            static inline qreg qxor(qreg a, qreg b) { return _mm256_xor_si256(a, b); }
+
+            template<int N>
+            static inline qreg qshl(qreg a) { return _mm256_slli_epi64(a, N); }
+
+            template<int N>
+            static inline qreg qrotl(qreg a) { return _mm256_or_si256(_mm256_slli_epi64(a, N), _mm256_srli_epi64(a, 64 - N)); }
+
+            /*
+             * Fixed point numbers of 32 bits.
+             */
+
+            static inline ireg iload(const i32* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+
+            static inline void istore(i32* p, ireg v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+
+            template<int N>
+            static inline ireg sra(ireg a) { return _mm256_srai_epi32(a, N); }
+
+            static inline ireg imul(ireg a, ireg b) { return _mm256_mullo_epi32(a, b); }
+
+            static inline ireg multiply_fixed(ireg a, ireg b, u32 shift, bool saturate) {
+                __m256i round = _mm256_set1_epi64x(i64{1} << (shift - 1));
+                __m256i even = _mm256_add_epi64(_mm256_mul_epi32(a, b), round);
+                __m256i odd = _mm256_add_epi64(_mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)), round);
+                // The logical shifts give the same low 32 bits as the arithmetic ones.
+                __m128i count = _mm_cvtsi32_si128(static_cast<int>(shift));
+                __m256i result = _mm256_blend_epi32(_mm256_srl_epi64(even, count), _mm256_slli_epi64(_mm256_srl_epi64(odd, count), 32), 0xAA);
+                if (!saturate)
+                    return result;
+                // The products fit if their bits above shift + 31 copy the sign: their high halves shifted by shift - 1 are 0 or -1.
+                __m256i high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+                __m256i sign = _mm256_srai_epi32(high, 31);
+                __m256i fits = _mm256_cmpeq_epi32(_mm256_sra_epi32(high, _mm_cvtsi32_si128(static_cast<int>(shift - 1))), sign);
+                return _mm256_blendv_epi8(_mm256_xor_si256(sign, _mm256_set1_epi32(0x7FFFFFFF)), result, fits);
+            }
+
+            /*
+             * Bytes, for the colors.
+             */
+
+            static inline ireg bload(const u8* p) { return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))); }
+
+            static inline void bstore(u8* p, ireg v) {
+                // The packs work within each half, the four bytes of each one are then joined.
+                __m256i words = _mm256_packs_epi32(v, v);
+                __m256i bytes = _mm256_packus_epi16(words, words);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(p),
+                                 _mm_unpacklo_epi32(_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1)));
+            }
+
+            static inline reg broadcast_w(reg a) { return _mm256_permute_ps(a, 0xFF); }
+
+            /*!
+             * Computes two columns per register: each lane holds the columns of a, each half a column of b.
+             */
+            static inline void multiply_mat4(const f32* a, const f32* b, f32* out) {
+                reg a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+                reg a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+                reg a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+                reg a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+                for (size_t column = 0; column < 16; column += 8) {
+                    reg c = _mm256_loadu_ps(b + column);
+                    reg result = _mm256_mul_ps(a0, _mm256_permute_ps(c, 0x00));
+                    result = _mm256_fmadd_ps(a1, _mm256_permute_ps(c, 0x55), result);
+                    result = _mm256_fmadd_ps(a2, _mm256_permute_ps(c, 0xAA), result);
+                    result = _mm256_fmadd_ps(a3, _mm256_permute_ps(c, 0xFF), result);
+                    _mm256_storeu_ps(out + column, result);
+                }
+            }
+        };
+    }
+#endif
+
+    const batch_kernels* get_avx2_kernels() {
+#ifdef LAMBDA_SOA_AVX2
+        return &simd_batch<avx2_ops>::KERNELS;
+#else
+        return nullptr;
+#endif
+    }
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+/*
+ * AVX-512 batch kernels, this translation unit is compiled with AVX-512F enabled (see CMakeLists.txt).
+ * Its code only runs once the processor support is checked.
+ */
+
+#include "soa_kernels.h"
+
+#ifdef __AVX512F__
+#  define LAMBDA_SOA_AVX512
+#  include <immintrin.h>
+#  if defined(__GNUC__) && !defined(__clang__)
+// The AVX-512 intrinsics of GCC 12 start from an undefined register and trigger false positives (GCC bug 105593).
+#    pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#  endif
+#endif
+
+namespace lambdacommon::maths::internal
+{
+#ifdef LAMBDA_SOA_AVX512
+    namespace
+    {
+        struct avx512_ops
+        {
+            typedef __m512 reg;
+            typedef __m512i ireg;
+            typedef __mmask16 mask;
+            static constexpr size_t WIDTH = 16;
+            // The unmasked forms of some intrinsics start from an undefined register, which GCC 12 reports as uninitialized
+            // once inlined in the noise kernels (GCC bug 105593). The zero-masked forms with every lane set compile to the
+            // same instructions.
+            static constexpr __mmask16 ALL = 0xFFFF;
+
+            static inline reg load(const f32* p) { return _mm512_loadu_ps(p); }
+
+            static inline void store(f32* p, reg v) { _mm512_storeu_ps(p, v); }
+
+            static inline reg splat(f32 v) { return _mm512_set1_ps(v); }
+
+            static inline reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+
+            static inline reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+
+            static inline reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+
+            static inline reg div(reg a, reg b) { return _mm512_div_ps(a, b); }
+
+            static inline reg sqrt(reg a) { return _mm512_sqrt_ps(a); }
+
+            static inline reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+
+            static inline reg min(reg a, reg b) { return _mm512_maskz_min_ps(ALL, a, b); }
+
+            static inline reg max(reg a, reg b) { return _mm512_maskz_max_ps(ALL, a, b); }
+
+            static inline reg rsqrt_estimate(reg a) { return _mm512_rsqrt14_ps(a); }
+
+            static inline ireg isplat(u32 v) { return _mm512_set1_epi32(static_cast<i32>(v)); }
+
+            static inline ireg as_int(reg a) { return _mm512_castps_si512(a); }
+
+            static inline reg as_float(ireg a) { return _mm512_castsi512_ps(a); }
+
+            static inline ireg round_to_int(reg a) { return _mm512_maskz_cvtps_epi32(ALL, a); }
+
+            static inline ireg truncate_to_int(reg a) { return _mm512_maskz_cvttps_epi32(ALL, a); }
+
+            static inline reg to_float(ireg a) { return _mm512_maskz_cvtepi32_ps(ALL, a); }
+
+            static inline ireg iadd(ireg a, ireg b) { return _mm512_add_epi32(a, b); }
+
+            static inline ireg isub(ireg a, ireg b) { return _mm512_sub_epi32(a, b); }
+
+            static inline ireg iand(ireg a, ireg b) { return _mm512_and_si512(a, b); }
+
+            static inline ireg ior(ireg a, ireg b) { return _mm512_or_si512(a, b); }
+
+            static inline ireg ixor(ireg a, ireg b) { return _mm512_xor_si512(a, b); }
+
+            template<int N>
+            static inline ireg shl(ireg a) { return _mm512_maskz_slli_epi32(ALL, a, N); }
+
+            template<int N>
+            static inline ireg shr(ireg a) { return _mm512_maskz_srli_epi32(ALL, a, N); }
+
+            static inline mask less(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+
+            static inline mask equal(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+
+            static inline mask is_zero(ireg a) { return _mm512_cmpeq_epi32_mask(a, _mm512_setzero_si512()); }
+
+            static inline reg select(mask m, reg a, reg b) { return _mm512_mask_blend_ps(m, b, a); }
+
+            /*
+             * 64-bit integer lanes, for the random generators.
+             */
+
+            typedef __m512i qreg;
+            static constexpr size_t QWIDTH = 8;
+
+            static inline qreg qload(const u64* p) { return _mm512_loadu_si512(p); }
+
+            static inline void qstore(u64* p, qreg v) { _mm512_storeu_si512(p, v); }
+
+            static inline qreg qadd(qreg a, qreg b) { return _mm512_add_epi64(a, b); }
+
+            static inline qreg qxor(qreg a, qreg b) { return _mm512_xor_si512(a, b); }
+
+            template<int N>
+            static inline qreg qshl(qreg a) { return _mm512_slli_epi64(a, N); }
+
+            template<int N>
+            static inline qreg qrotl(qreg a) { return _mm512_rol_epi64(a, N); }
+
+            /*
+             * Fixed point numbers of 32 bits.
+             */
+
+            static inline ireg iload(const i32* p) { return _mm512_loadu_si512(p); }
+
+            static inline void istore(i32* p, ireg v) { _mm512_storeu_si512(p, v); }
+
+            template<int N>
+            static inline ireg sra(ireg a) { return _mm512_srai_epi32(a, N); }
+
+            static inline ireg imul(ireg a, ireg b) { return _mm512_mullo_epi32(a, b); }
+
+            static inline ireg multiply_fixed(ireg a, ireg b, u32 shift, bool saturate) {
+                __m512i round = _mm512_set1_epi64(i64{1} << (shift - 1));
+                __m512i even = _mm512_add_epi64(_mm512_mul_epi32(a, b), round);
+                __m512i odd = _mm512_add_epi64(_mm512_mul_epi32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32)), round);
+                // The logical shifts give the same low 32 bits as the arithmetic ones.
+                __m128i count = _mm_cvtsi32_si128(static_cast<int>(shift));
+                __m512i result = _mm512_mask_blend_epi32(0xAAAA, _mm512_srl_epi64(even, count), _mm512_slli_epi64(_mm512_srl_epi64(odd, count), 32));
+                if (!saturate)
+                    return result;
+                // The products fit if their bits above shift + 31 copy the sign: their high halves shifted by shift - 1 are 0 or -1.
+                __m512i high = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+                __m512i sign = _mm512_srai_epi32(high, 31);
+                __mmask16 fits = _mm512_cmpeq_epi32_mask(_mm512_sra_epi32(high, _mm_cvtsi32_si128(static_cast<int>(shift - 1))), sign);
+                return _mm512_mask_blend_epi32(fits, _mm512_xor_si512(sign, _mm512_set1_epi32(0x7FFFFFFF)), result);
+            }
+
+            /*
+             * Bytes, for the colors.
+             */
+
+            static inline ireg bload(const u8* p) { return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+
+            static inline void bstore(u8* p, ireg v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtepi32_epi8(v)); }
+
+            static inline reg broadcast_w(reg a) { return _mm512_permute_ps(a, 0xFF); }
+
+            /*!
+             * Computes the whole matrix in a register: each lane holds the columns of a, each quarter a column of b.
+             */
+            static inline void multiply_mat4(const f32* a, const f32* b, f32* out) {
+                reg c = _mm512_loadu_ps(b);
+                reg result = _mm512_mul_ps(_mm512_broadcast_f32x4(_mm_loadu_ps(a)), _mm512_permute_ps(c, 0x00));
+                result = _mm512_fmadd_ps(_mm512_broadcast_f32x4(_mm_loadu_ps(a + 4)), _mm512_permute_ps(c, 0x55), result);
+                result = _mm512_fmadd_ps(_mm512_broadcast_f32x4(_mm_loadu_ps(a + 8)), _mm512_permute_ps(c, 0xAA), result);
+                result = _mm512_fmadd_ps(_mm512_broadcast_f32x4(_mm_loadu_ps(a + 12)), _mm512_permute_ps(c, 0xFF), result);
+                _mm512_storeu_ps(out, result);
+            }
+        };
+    }
+#endif
+
+    const batch_kernels* get_avx512_kernels() {
+#ifdef LAMBDA_SOA_AVX512
+        return &simd_batch<avx512_ops>::KERNELS;
+#else
+        return nullptr;
+#endif
+    }
+}
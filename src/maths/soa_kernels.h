@@ -0,0 +1,999 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#ifndef LAMBDACOMMON_SOA_KERNELS_H
+#define LAMBDACOMMON_SOA_KERNELS_H
+
+/*
+ * Internal header shared by the translation units of the batch kernels, each one compiled for its own instruction set.
+ *
+ * The kernels are written once over an "Ops" structure wrapping the intrinsics of an instruction set. Every Ops structure
+ * must be declared in an anonymous namespace: the instantiations then have internal linkage, so the linker can never
+ * merge an AVX-512 instantiation into the code running on a processor without AVX-512.
+ * For the same reason, the AVX translation units must not call the inline functions of the public headers.
+ */
+
+#include "../../include/lambdacommon/maths/fast.h"
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace lambdacommon::maths::internal
+{
+    struct vec3_input
+    {
+        const f32* x;
+        const f32* y;
+        const f32* z;
+    };
+
+    struct vec3_output
+    {
+        f32* x;
+        f32* y;
+        f32* z;
+    };
+
+    /*!
+     * Boxes as their minimum and maximum corners.
+     */
+    struct box_input
+    {
+        vec3_input min;
+        vec3_input max;
+    };
+
+    /*!
+     * Rays as their origins, the inverses of their directions and their maximum distances.
+     */
+    struct ray_packet_input
+    {
+        vec3_input origin;
+        vec3_input inverse_direction;
+        const f32* t_max;
+    };
+
+    /*!
+     * Triangles as a vertex and the two edges starting from it.
+     */
+    struct triangle_input
+    {
+        vec3_input vertex;
+        vec3_input edge1;
+        vec3_input edge2;
+    };
+
+    struct sphere_input
+    {
+        vec3_input center;
+        const f32* radius;
+    };
+
+    /*!
+     * A single ray tested against a packet of shapes.
+     */
+    struct ray_input
+    {
+        f32 origin[3];
+        f32 direction[3];
+        f32 inverse_direction[3];
+        f32 t_max;
+    };
+
+    /*
+     * Every function of this header has internal linkage, an inline function with external linkage compiled in the AVX-512
+     * translation unit could be picked by the linker for every other one.
+     */
+
+    static inline vec3_input offset(vec3_input v, size_t count) {
+        return {v.x + count, v.y + count, v.z + count};
+    }
+
+    static inline vec3_output offset(vec3_output v, size_t count) {
+        return {v.x + count, v.y + count, v.z + count};
+    }
+
+    static inline box_input offset(box_input v, size_t count) {
+        return {offset(v.min, count), offset(v.max, count)};
+    }
+
+    static inline ray_packet_input offset(ray_packet_input v, size_t count) {
+        return {offset(v.origin, count), offset(v.inverse_direction, count), v.t_max + count};
+    }
+
+    static inline triangle_input offset(triangle_input v, size_t count) {
+        return {offset(v.vertex, count), offset(v.edge1, count), offset(v.edge2, count)};
+    }
+
+    static inline sphere_input offset(sphere_input v, size_t count) {
+        return {offset(v.center, count), v.radius + count};
+    }
+
+    /*!
+     * The settings of a noise, the type and the fractal take the values of the enumerations of noise.h.
+     */
+    struct noise_input
+    {
+        u8 type;
+        u8 fractal;
+        u32 octaves;
+        i32 seed;
+        f32 frequency;
+        f32 lacunarity;
+        f32 gain;
+        /*! The amplitude of the first octave: the inverse of the sum of the amplitudes, so the sum stays in [-1, 1]. */
+        f32 bounding;
+    };
+
+    typedef void (* unary_kernel)(const f32* in, f32* out, size_t count);
+
+    /*!
+     * The count of lanes of the multi-lane random generators, the same for every instruction set so they give the same
+     * output everywhere.
+     */
+    constexpr size_t XOSHIRO_LANES = 8;
+
+    /*!
+     * The count of floats of an edge of the point in polygon test: the x and y of its start, its inverse slope dx / dy,
+     * then the lowest and the highest y of the edge. The horizontal edges have a slope of 0 and are never crossed.
+     */
+    constexpr size_t POLYGON_EDGE_STRIDE = 5;
+
+    /*!
+     * Represents the batch kernels of an instruction set.
+     * Matrices are 16 floats stored column by column.
+     */
+    struct batch_kernels
+    {
+        void (* add)(vec3_input a, vec3_input b, vec3_output out, size_t count);
+
+        void (* sub)(vec3_input a, vec3_input b, vec3_output out, size_t count);
+
+        void (* scale)(vec3_input a, f32 factor, vec3_output out, size_t count);
+
+        void (* cross)(vec3_input a, vec3_input b, vec3_output out, size_t count);
+
+        void (* normalize)(vec3_input a, vec3_output out, size_t count);
+
+        void (* dot)(vec3_input a, vec3_input b, f32* out, size_t count);
+
+        void (* length)(vec3_input a, f32* out, size_t count);
+
+        void (* distance)(vec3_input a, vec3_input b, f32* out, size_t count);
+
+        void (* transform_points)(const f32* matrix, vec3_input a, vec3_output out, size_t count);
+
+        void (* transform_vectors)(const f32* matrix, vec3_input a, vec3_output out, size_t count);
+
+        /*!
+         * Multiplies count matrices, a moves by a_stride floats per matrix: 0 to multiply every b by the same matrix.
+         */
+        void (* multiply_mat4)(const f32* a, size_t a_stride, const f32* b, f32* out, size_t count);
+
+        /*
+         * The approximations of fast.h.
+         */
+
+        unary_kernel rsqrt;
+
+        unary_kernel sqrt;
+
+        unary_kernel sin;
+
+        unary_kernel cos;
+
+        void (* sincos)(const f32* in, f32* sine, f32* cosine, size_t count);
+
+        void (* atan2)(const f32* y, const f32* x, f32* out, size_t count);
+
+        unary_kernel exp;
+
+        unary_kernel log;
+
+        /*
+         * The intersection tests of intersection.h, each one writes the distance along the ray at which it enters the
+         * shape, 0 if its origin is inside, or infinity if it misses the shape within its maximum distance.
+         */
+
+        void (* ray_boxes)(const ray_input& ray, box_input boxes, f32* out, size_t count);
+
+        /*!
+         * Tests count rays against a single box, stored as its minimum then its maximum corner.
+         */
+        void (* rays_box)(ray_packet_input rays, const f32* box, f32* out, size_t count);
+
+        void (* ray_triangles)(const ray_input& ray, triangle_input triangles, f32* out, size_t count);
+
+        void (* ray_spheres)(const ray_input& ray, sphere_input spheres, f32* out, size_t count);
+
+        /*!
+         * Advances XOSHIRO_LANES interleaved xoshiro256++ generators by blocks outputs each.
+         * The state holds the first word of every lane, then the second one, etc., and output i of lane j is written at
+         * out[i * XOSHIRO_LANES + j].
+         */
+        void (* xoshiro256pp)(u64* state, u64* out, size_t blocks);
+
+        /*
+         * The fixed point operations of fixed.h on 32-bit representations: the results wrap around or saturate, the
+         * products are rounded to nearest, ties up, and 0 < frac_bits < 32.
+         */
+
+        void (* fixed_add)(const i32* a, const i32* b, i32* out, size_t count, bool saturate);
+
+        void (* fixed_sub)(const i32* a, const i32* b, i32* out, size_t count, bool saturate);
+
+        void (* fixed_multiply)(const i32* a, const i32* b, i32* out, size_t count, u32 frac_bits, bool saturate);
+
+        /*!
+         * Tests count points against the edges of a polygon with the even-odd rule, writes 1 for the points inside.
+         * A point crosses an edge if lowest y <= y < highest y and x < x start + slope * (y - y start).
+         */
+        void (* points_in_polygon)(const f32* x, const f32* y, const f32* edges, size_t edge_count, u8* out, size_t count);
+
+        /*!
+         * Samples a noise at count points of 2 to 4 dimensions, given as an array of coordinates per dimension.
+         */
+        void (* noise)(const noise_input& settings, u32 dimensions, const f32* const* coordinates, f32* out, size_t count);
+
+        /*
+         * The color conversions of color.h between count colors of four interleaved components, alpha being the value of
+         * an alpha_conversion applied on the floats. The floats are clamped in [0, 1], NaN giving 0, and the bytes are
+         * rounded to nearest.
+         */
+
+        void (* colors_to_rgba8)(const f32* in, u8* out, size_t count, u8 alpha);
+
+        void (* colors_to_f32x4)(const u8* in, f32* out, size_t count, u8 alpha);
+    };
+
+    /*!
+     * The scalar kernels, also used for the tails the vector kernels cannot fill a register with.
+     */
+    extern const batch_kernels SCALAR_KERNELS;
+
+    /*
+     * Each getter returns nullptr if its translation unit was not compiled for the instruction set.
+     */
+
+    const batch_kernels* get_sse2_kernels();
+
+    const batch_kernels* get_neon_kernels();
+
+    const batch_kernels* get_avx2_kernels();
+
+    const batch_kernels* get_avx512_kernels();
+
+    /*!
+     * Gets the kernels of the instruction set in use.
+     */
+    const batch_kernels& get_kernels();
+
+    /*!
+     * Implements the intersection tests of a lane over the operations of an instruction set, including fast::internal::scalar_ops.
+     * Misses are selected with comparisons that are false for NaN, which is what the IEEE 754 rules give when a ray
+     * starts on the plane of a slab it is parallel to.
+     */
+    template<typename Ops>
+    struct intersection_algorithms
+    {
+        typedef typename Ops::reg reg;
+
+        /*!
+         * Narrows [near, far] to the slab between two planes of an axis.
+         */
+        static inline void slab(reg minimum, reg maximum, reg origin, reg inverse, reg& near, reg& far) {
+            reg t1 = Ops::mul(Ops::sub(minimum, origin), inverse);
+            reg t2 = Ops::mul(Ops::sub(maximum, origin), inverse);
+            auto swap = Ops::less(t2, t1);
+            reg entry = Ops::select(swap, t2, t1);
+            reg exit = Ops::select(swap, t1, t2);
+            near = Ops::select(Ops::less(near, entry), entry, near);
+            far = Ops::select(Ops::less(exit, far), exit, far);
+        }
+
+        static inline reg ray_box(const reg origin[3], const reg inverse[3], reg t_max, const reg minimum[3], const reg maximum[3]) {
+            reg near = Ops::splat(0.f), far = t_max;
+            for (size_t i = 0; i < 3; i++)
+                slab(minimum[i], maximum[i], origin[i], inverse[i], near, far);
+            return Ops::select(Ops::less(far, near), Ops::splat(std::numeric_limits<f32>::infinity()), near);
+        }
+
+        /*!
+         * Möller–Trumbore test, both faces of the triangle are hit.
+         */
+        static inline reg ray_triangle(const reg origin[3], const reg direction[3], reg t_max, const reg vertex[3], const reg edge1[3],
+                                       const reg edge2[3]) {
+            reg zero = Ops::splat(0.f), infinity = Ops::splat(std::numeric_limits<f32>::infinity());
+            reg p[3] = {Ops::sub(Ops::mul(direction[1], edge2[2]), Ops::mul(direction[2], edge2[1])),
+                        Ops::sub(Ops::mul(direction[2], edge2[0]), Ops::mul(direction[0], edge2[2])),
+                        Ops::sub(Ops::mul(direction[0], edge2[1]), Ops::mul(direction[1], edge2[0]))};
+            reg determinant = Ops::fmadd(edge1[2], p[2], Ops::fmadd(edge1[1], p[1], Ops::mul(edge1[0], p[0])));
+            reg inverse = Ops::div(Ops::splat(1.f), determinant);
+            reg t[3] = {Ops::sub(origin[0], vertex[0]), Ops::sub(origin[1], vertex[1]), Ops::sub(origin[2], vertex[2])};
+            reg u = Ops::mul(Ops::fmadd(t[2], p[2], Ops::fmadd(t[1], p[1], Ops::mul(t[0], p[0]))), inverse);
+            reg q[3] = {Ops::sub(Ops::mul(t[1], edge1[2]), Ops::mul(t[2], edge1[1])),
+                        Ops::sub(Ops::mul(t[2], edge1[0]), Ops::mul(t[0], edge1[2])),
+                        Ops::sub(Ops::mul(t[0], edge1[1]), Ops::mul(t[1], edge1[0]))};
+            reg v = Ops::mul(Ops::fmadd(direction[2], q[2], Ops::fmadd(direction[1], q[1], Ops::mul(direction[0], q[0]))), inverse);
+            reg distance = Ops::mul(Ops::fmadd(edge2[2], q[2], Ops::fmadd(edge2[1], q[1], Ops::mul(edge2[0], q[0]))), inverse);
+            reg result = Ops::select(Ops::equal(determinant, zero), infinity, distance);
+            result = Ops::select(Ops::less(u, zero), infinity, result);
+            result = Ops::select(Ops::less(v, zero), infinity, result);
+            result = Ops::select(Ops::less(Ops::splat(1.f), Ops::add(u, v)), infinity, result);
+            result = Ops::select(Ops::less(distance, zero), infinity, result);
+            return Ops::select(Ops::less(t_max, distance), infinity, result);
+        }
+
+        static inline reg ray_sphere(const reg origin[3], const reg direction[3], reg t_max, const reg center[3], reg radius) {
+            reg zero = Ops::splat(0.f), infinity = Ops::splat(std::numeric_limits<f32>::infinity());
+            reg o[3] = {Ops::sub(origin[0], center[0]), Ops::sub(origin[1], center[1]), Ops::sub(origin[2], center[2])};
+            reg a = Ops::fmadd(direction[2], direction[2], Ops::fmadd(direction[1], direction[1], Ops::mul(direction[0], direction[0])));
+            reg b = Ops::fmadd(o[2], direction[2], Ops::fmadd(o[1], direction[1], Ops::mul(o[0], direction[0])));
+            reg c = Ops::sub(Ops::fmadd(o[2], o[2], Ops::fmadd(o[1], o[1], Ops::mul(o[0], o[0]))), Ops::mul(radius, radius));
+            reg discriminant = Ops::sub(Ops::mul(b, b), Ops::mul(a, c));
+            reg root = Ops::sqrt(Ops::select(Ops::less(discriminant, zero), zero, discriminant));
+            reg entry = Ops::div(Ops::sub(Ops::sub(zero, b), root), a);
+            reg exit = Ops::div(Ops::add(Ops::sub(zero, b), root), a);
+            reg result = Ops::select(Ops::less(entry, zero), zero, entry);
+            result = Ops::select(Ops::less(discriminant, zero), infinity, result);
+            result = Ops::select(Ops::less(exit, zero), infinity, result);
+            return Ops::select(Ops::less(t_max, result), infinity, result);
+        }
+    };
+
+    /*!
+     * Calls a function with the dimensions and the type of a noise as compile-time constants.
+     */
+    template<typename F>
+    static inline void dispatch_noise(u32 dimensions, u8 type, F&& func) {
+        auto with_type = [type, &func](auto dimension) {
+            if (type == 0)
+                func(dimension, std::integral_constant<u8, 0>{});
+            else if (type == 1)
+                func(dimension, std::integral_constant<u8, 1>{});
+            else
+                func(dimension, std::integral_constant<u8, 2>{});
+        };
+        if (dimensions == 2)
+            with_type(std::integral_constant<size_t, 2>{});
+        else if (dimensions == 3)
+            with_type(std::integral_constant<size_t, 3>{});
+        else
+            with_type(std::integral_constant<size_t, 4>{});
+    }
+
+    /*!
+     * Calls a function with an alpha conversion as a compile-time constant.
+     */
+    template<typename F>
+    static inline void dispatch_alpha(u8 alpha, F&& func) {
+        if (alpha == 0)
+            func(std::integral_constant<u8, 0>{});
+        else if (alpha == 1)
+            func(std::integral_constant<u8, 1>{});
+        else
+            func(std::integral_constant<u8, 2>{});
+    }
+
+    /*!
+     * Implements the noises of a lane over the operations of an instruction set, including fast::internal::scalar_ops.
+     * The lattice points are hashed from their coordinates multiplied by large primes, there is no permutation table to
+     * gather from: the output only depends on the seed and on the coordinates.
+     */
+    template<typename Ops>
+    struct noise_algorithms
+    {
+        typedef typename Ops::reg reg;
+        typedef typename Ops::ireg ireg;
+
+        static constexpr u32 PRIMES[4] = {501125321u, 1136930381u, 1720413743u, 1066037191u};
+
+        static inline reg floor(reg a) {
+            reg truncated = Ops::to_float(Ops::truncate_to_int(a));
+            return Ops::select(Ops::less(a, truncated), Ops::sub(truncated, Ops::splat(1.f)), truncated);
+        }
+
+        static inline reg abs(reg a) {
+            return Ops::max(a, Ops::sub(Ops::splat(0.f), a));
+        }
+
+        /*!
+         * Mixes the seed xored with the primed coordinates of a lattice point.
+         */
+        static inline ireg hash(ireg value) {
+            ireg h = Ops::imul(value, Ops::isplat(0x27D4EB2Du));
+            return Ops::ixor(h, Ops::template shr<15>(h));
+        }
+
+        static inline reg negate_if(ireg h, u32 bit, reg value) {
+            return Ops::select(Ops::is_zero(Ops::iand(h, Ops::isplat(bit))), value, Ops::sub(Ops::splat(0.f), value));
+        }
+
+        static inline auto is_set(ireg h, u32 bits) {
+            return Ops::is_zero(Ops::ixor(Ops::iand(h, Ops::isplat(bits)), Ops::isplat(bits)));
+        }
+
+        /*!
+         * Gets the dot product of the offset to a lattice point and the gradient chosen by its hash, without any table.
+         */
+        template<size_t D>
+        static inline reg gradient(ireg h, const reg* offset) {
+            if constexpr (D == 2) {
+                // The 8 directions (±1, ±2) and (±2, ±1).
+                auto first = Ops::is_zero(Ops::iand(h, Ops::isplat(4)));
+                reg u = Ops::select(first, offset[0], offset[1]), v = Ops::select(first, offset[1], offset[0]);
+                return Ops::add(negate_if(h, 1, u), negate_if(h, 2, Ops::add(v, v)));
+            } else if constexpr (D == 3) {
+                // The 12 directions to the middles of the edges of a cube, 4 of them twice (Perlin).
+                reg u = Ops::select(Ops::is_zero(Ops::iand(h, Ops::isplat(8))), offset[0], offset[1]);
+                reg v = Ops::select(Ops::is_zero(Ops::iand(h, Ops::isplat(12))), offset[1],
+                                    Ops::select(Ops::is_zero(Ops::ixor(Ops::iand(h, Ops::isplat(13)), Ops::isplat(12))), offset[0], offset[2]));
+                return Ops::add(negate_if(h, 1, u), negate_if(h, 2, v));
+            } else {
+                // The 32 directions to the middles of the edges of a tesseract (Gustavson).
+                reg u = Ops::select(is_set(h, 24), offset[1], offset[0]);
+                reg v = Ops::select(Ops::is_zero(Ops::iand(h, Ops::isplat(16))), offset[1], offset[2]);
+                reg w = Ops::select(Ops::is_zero(Ops::iand(h, Ops::isplat(24))), offset[2], offset[3]);
+                return Ops::add(Ops::add(negate_if(h, 1, u), negate_if(h, 2, v)), negate_if(h, 4, w));
+            }
+        }
+
+        /*!
+         * Interpolates the values or the gradients of the corners of the lattice cell with a quintic fade.
+         */
+        template<size_t D, bool Value>
+        static inline reg lattice(ireg seed, const reg* p) {
+            constexpr size_t CORNERS = size_t{1} << D;
+            reg one = Ops::splat(1.f), fraction[D], fade[D];
+            ireg primed[D];
+            for (size_t d = 0; d < D; d++) {
+                reg cell = floor(p[d]);
+                fraction[d] = Ops::sub(p[d], cell);
+                fade[d] = Ops::mul(Ops::mul(fraction[d], Ops::mul(fraction[d], fraction[d])),
+                                   Ops::fmadd(fraction[d], Ops::fmadd(fraction[d], Ops::splat(6.f), Ops::splat(-15.f)), Ops::splat(10.f)));
+                primed[d] = Ops::imul(Ops::truncate_to_int(cell), Ops::isplat(PRIMES[d]));
+            }
+
+            reg values[CORNERS];
+            for (size_t corner = 0; corner < CORNERS; corner++) {
+                ireg h = seed;
+                reg offset[D];
+                for (size_t d = 0; d < D; d++) {
+                    bool up = (corner >> d) & 1u;
+                    h = Ops::ixor(h, up ? Ops::iadd(primed[d], Ops::isplat(PRIMES[d])) : primed[d]);
+                    offset[d] = up ? Ops::sub(fraction[d], one) : fraction[d];
+                }
+                h = hash(h);
+                if constexpr (Value)
+                    values[corner] = Ops::mul(Ops::to_float(h), Ops::splat(1.f / 2147483648.f));
+                else
+                    values[corner] = gradient<D>(h, offset);
+            }
+
+            // The corners are ordered by their x bit first, each pass interpolates along an axis.
+            for (size_t d = 0, count = CORNERS / 2; d < D; d++, count /= 2)
+                for (size_t i = 0; i < count; i++)
+                    values[i] = Ops::fmadd(fade[d], Ops::sub(values[2 * i + 1], values[2 * i]), values[2 * i]);
+            return values[0];
+        }
+
+        /*!
+         * Sums the contributions of the corners of the simplex containing the point, each one fading to 0 at a distance.
+         */
+        template<size_t D>
+        static inline reg simplex(ireg seed, const reg* p) {
+            // The skew and unskew factors (sqrt(D + 1) - 1) / D and (1 - 1 / sqrt(D + 1)) / D.
+            constexpr f32 SKEW = D == 2 ? 0.36602540378f : D == 3 ? 1.f / 3.f : 0.30901699437f;
+            constexpr f32 UNSKEW = D == 2 ? 0.21132486540f : D == 3 ? 1.f / 6.f : 0.13819660113f;
+            constexpr f32 RADIUS_SQUARED = D == 2 ? 0.5f : 0.6f;
+            constexpr f32 SCALE = D == 2 ? 45.f : D == 3 ? 32.f : 27.f;
+            reg zero = Ops::splat(0.f), one = Ops::splat(1.f);
+
+            reg sum = p[0];
+            for (size_t d = 1; d < D; d++)
+                sum = Ops::add(sum, p[d]);
+            reg skew = Ops::mul(sum, Ops::splat(SKEW));
+            reg cell[D], unskew = zero;
+            for (size_t d = 0; d < D; d++) {
+                cell[d] = floor(Ops::add(p[d], skew));
+                unskew = Ops::add(unskew, cell[d]);
+            }
+            unskew = Ops::mul(unskew, Ops::splat(UNSKEW));
+
+            reg origin[D], rank[D];
+            ireg primed[D];
+            for (size_t d = 0; d < D; d++) {
+                origin[d] = Ops::add(Ops::sub(p[d], cell[d]), unskew);
+                primed[d] = Ops::imul(Ops::truncate_to_int(cell[d]), Ops::isplat(PRIMES[d]));
+                rank[d] = zero;
+            }
+            // The simplex is found by ranking the coordinates in the cell, the k-th corner adds 1 to the k largest ones.
+            for (size_t a = 0; a < D; a++) {
+                for (size_t b = a + 1; b < D; b++) {
+                    auto smaller = Ops::less(origin[a], origin[b]);
+                    rank[a] = Ops::add(rank[a], Ops::select(smaller, zero, one));
+                    rank[b] = Ops::add(rank[b], Ops::select(smaller, one, zero));
+                }
+            }
+
+            reg result = zero;
+            for (size_t corner = 0; corner <= D; corner++) {
+                ireg h = seed;
+                reg offset[D], falloff = Ops::splat(RADIUS_SQUARED);
+                for (size_t d = 0; d < D; d++) {
+                    reg step = corner == 0 ? zero : corner == D ? one :
+                                                    Ops::select(Ops::less(rank[d], Ops::splat(static_cast<f32>(D - corner) - 0.5f)), zero, one);
+                    offset[d] = Ops::add(Ops::sub(origin[d], step), Ops::splat(static_cast<f32>(corner) * UNSKEW));
+                    ireg prime = Ops::iand(Ops::isub(Ops::isplat(0), Ops::truncate_to_int(step)), Ops::isplat(PRIMES[d]));
+                    h = Ops::ixor(h, Ops::iadd(primed[d], prime));
+                    falloff = Ops::sub(falloff, Ops::mul(offset[d], offset[d]));
+                }
+                falloff = Ops::max(falloff, zero);
+                falloff = Ops::mul(falloff, falloff);
+                result = Ops::fmadd(Ops::mul(falloff, falloff), gradient<D>(hash(h), offset), result);
+            }
+            return Ops::mul(result, Ops::splat(SCALE));
+        }
+
+        template<size_t D, u8 Type>
+        static inline reg single(ireg seed, const reg* p) {
+            // Scales the gradient noise to about [-1, 1].
+            constexpr f32 PERLIN_SCALE = D == 2 ? 0.62f : D == 3 ? 0.96f : 0.9f;
+            if constexpr (Type == 0)
+                return lattice<D, true>(seed, p);
+            else if constexpr (Type == 1)
+                return Ops::mul(lattice<D, false>(seed, p), Ops::splat(PERLIN_SCALE));
+            else
+                return simplex<D>(seed, p);
+        }
+
+        /*!
+         * Samples a noise, layered in octaves of growing frequencies and shrinking amplitudes if it is fractal.
+         */
+        template<size_t D, u8 Type>
+        static inline reg sample(const noise_input& settings, const reg* coordinates) {
+            reg p[D];
+            for (size_t d = 0; d < D; d++)
+                p[d] = Ops::mul(coordinates[d], Ops::splat(settings.frequency));
+            if (settings.fractal == 0)
+                return single<D, Type>(Ops::isplat(static_cast<u32>(settings.seed)), p);
+
+            reg sum = Ops::splat(0.f);
+            f32 amplitude = settings.bounding;
+            for (u32 octave = 0; octave < settings.octaves; octave++) {
+                reg value = single<D, Type>(Ops::isplat(static_cast<u32>(settings.seed) + octave), p);
+                // The ridges are where the noise crosses 0.
+                if (settings.fractal == 2)
+                    value = Ops::fmadd(abs(value), Ops::splat(-2.f), Ops::splat(1.f));
+                sum = Ops::fmadd(value, Ops::splat(amplitude), sum);
+                for (size_t d = 0; d < D; d++)
+                    p[d] = Ops::mul(p[d], Ops::splat(settings.lacunarity));
+                amplitude *= settings.gain;
+            }
+            return sum;
+        }
+    };
+
+    /*!
+     * Implements the batch kernels over the operations of an instruction set.
+     * @tparam Ops The operations: a register type "reg", its WIDTH in floats, load, store, multiply_mat4 which multiplies a
+     * single pair of matrices (the output may be b), the operations of fast::internal::scalar_ops, and a register type
+     * "qreg" of QWIDTH 64-bit integers with qload, qstore, qadd, qxor, qshl and qrotl. The fixed point kernels need iload,
+     * istore, the arithmetic shift sra and multiply_fixed, the noise kernel needs imul. The color kernels need bload and
+     * bstore, which widen WIDTH bytes to an integer register and narrow it back, and broadcast_w, which copies the last
+     * float of every group of four over the group.
+     */
+    template<typename Ops>
+    struct simd_batch
+    {
+        typedef typename Ops::reg reg;
+        typedef fast::internal::algorithms<Ops> fast_algorithms;
+        static constexpr size_t WIDTH = Ops::WIDTH;
+
+        static inline reg dot3(reg ax, reg ay, reg az, reg bx, reg by, reg bz) {
+            return Ops::fmadd(az, bz, Ops::fmadd(ay, by, Ops::mul(ax, bx)));
+        }
+
+        static void add(vec3_input a, vec3_input b, vec3_output out, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                Ops::store(out.x + i, Ops::add(Ops::load(a.x + i), Ops::load(b.x + i)));
+                Ops::store(out.y + i, Ops::add(Ops::load(a.y + i), Ops::load(b.y + i)));
+                Ops::store(out.z + i, Ops::add(Ops::load(a.z + i), Ops::load(b.z + i)));
+            }
+            SCALAR_KERNELS.add(offset(a, i), offset(b, i), offset(out, i), count - i);
+        }
+
+        static void sub(vec3_input a, vec3_input b, vec3_output out, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                Ops::store(out.x + i, Ops::sub(Ops::load(a.x + i), Ops::load(b.x + i)));
+                Ops::store(out.y + i, Ops::sub(Ops::load(a.y + i), Ops::load(b.y + i)));
+                Ops::store(out.z + i, Ops::sub(Ops::load(a.z + i), Ops::load(b.z + i)));
+            }
+            SCALAR_KERNELS.sub(offset(a, i), offset(b, i), offset(out, i), count - i);
+        }
+
+        static void scale(vec3_input a, f32 factor, vec3_output out, size_t count) {
+            reg f = Ops::splat(factor);
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                Ops::store(out.x + i, Ops::mul(Ops::load(a.x + i), f));
+                Ops::store(out.y + i, Ops::mul(Ops::load(a.y + i), f));
+                Ops::store(out.z + i, Ops::mul(Ops::load(a.z + i), f));
+            }
+            SCALAR_KERNELS.scale(offset(a, i), factor, offset(out, i), count - i);
+        }
+
+        static void cross(vec3_input a, vec3_input b, vec3_output out, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                reg ax = Ops::load(a.x + i), ay = Ops::load(a.y + i), az = Ops::load(a.z + i);
+                reg bx = Ops::load(b.x + i), by = Ops::load(b.y + i), bz = Ops::load(b.z + i);
+                // Every component is computed before storing, the output may be an input.
+                reg x = Ops::sub(Ops::mul(ay, bz), Ops::mul(az, by));
+                reg y = Ops::sub(Ops::mul(az, bx), Ops::mul(ax, bz));
+                reg z = Ops::sub(Ops::mul(ax, by), Ops::mul(ay, bx));
+                Ops::store(out.x + i, x);
+                Ops::store(out.y + i, y);
+                Ops::store(out.z + i, z);
+            }
+            SCALAR_KERNELS.cross(offset(a, i), offset(b, i), offset(out, i), count - i);
+        }
+
+        static void normalize(vec3_input a, vec3_output out, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                reg x = Ops::load(a.x + i), y = Ops::load(a.y + i), z = Ops::load(a.z + i);
+                reg length = Ops::sqrt(dot3(x, y, z, x, y, z));
+                Ops::store(out.x + i, Ops::div(x, length));
+                Ops::store(out.y + i, Ops::div(y, length));
+                Ops::store(out.z + i, Ops::div(z, length));
+            }
+            SCALAR_KERNELS.normalize(offset(a, i), offset(out, i), count - i);
+        }
+
+        static void dot(vec3_input a, vec3_input b, f32* out, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH)
+                Ops::store(out + i, dot3(Ops::load(a.x + i), Ops::load(a.y + i), Ops::load(a.z + i),
+                                         Ops::load(b.x + i), Ops::load(b.y + i), Ops::load(b.z + i)));
+            SCALAR_KERNELS.dot(offset(a, i), offset(b, i), out + i, count - i);
+        }
+
+        static void length(vec3_input a, f32* out, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                reg x = Ops::load(a.x + i), y = Ops::load(a.y + i), z = Ops::load(a.z + i);
+                Ops::store(out + i, Ops::sqrt(dot3(x, y, z, x, y, z)));
+            }
+            SCALAR_KERNELS.length(offset(a, i), out + i, count - i);
+        }
+
+        static void distance(vec3_input a, vec3_input b, f32* out, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                reg x = Ops::sub(Ops::load(a.x + i), Ops::load(b.x + i));
+                reg y = Ops::sub(Ops::load(a.y + i), Ops::load(b.y + i));
+                reg z = Ops::sub(Ops::load(a.z + i), Ops::load(b.z + i));
+                Ops::store(out + i, Ops::sqrt(dot3(x, y, z, x, y, z)));
+            }
+            SCALAR_KERNELS.distance(offset(a, i), offset(b, i), out + i, count - i);
+        }
+
+        /*!
+         * Transforms vectors by the upper 3x4 part of a matrix, the translation is applied with w = 1.
+         */
+        template<bool Translate>
+        static void transform(const f32* matrix, vec3_input a, vec3_output out, size_t count) {
+            reg m[12];
+            for (size_t i = 0; i < 12; i++)
+                m[i] = Ops::splat(matrix[i / 3 * 4 + i % 3]);
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                reg x = Ops::load(a.x + i), y = Ops::load(a.y + i), z = Ops::load(a.z + i);
+                reg rx = Ops::fmadd(m[6], z, Ops::fmadd(m[3], y, Ops::mul(m[0], x)));
+                reg ry = Ops::fmadd(m[7], z, Ops::fmadd(m[4], y, Ops::mul(m[1], x)));
+                reg rz = Ops::fmadd(m[8], z, Ops::fmadd(m[5], y, Ops::mul(m[2], x)));
+                if constexpr (Translate) {
+                    rx = Ops::add(rx, m[9]);
+                    ry = Ops::add(ry, m[10]);
+                    rz = Ops::add(rz, m[11]);
+                }
+                Ops::store(out.x + i, rx);
+                Ops::store(out.y + i, ry);
+                Ops::store(out.z + i, rz);
+            }
+            if constexpr (Translate)
+                SCALAR_KERNELS.transform_points(matrix, offset(a, i), offset(out, i), count - i);
+            else
+                SCALAR_KERNELS.transform_vectors(matrix, offset(a, i), offset(out, i), count - i);
+        }
+
+        static void multiply_mat4(const f32* a, size_t a_stride, const f32* b, f32* out, size_t count) {
+            for (size_t i = 0; i < count; i++)
+                Ops::multiply_mat4(a + i * a_stride, b + i * 16, out + i * 16);
+        }
+
+        template<reg (* Function)(reg), unary_kernel batch_kernels::* Tail>
+        static void unary(const f32* in, f32* out, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH)
+                Ops::store(out + i, Function(Ops::load(in + i)));
+            (SCALAR_KERNELS.*Tail)(in + i, out + i, count - i);
+        }
+
+        static void sincos(const f32* in, f32* sine, f32* cosine, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                reg s, c;
+                fast_algorithms::sincos(Ops::load(in + i), s, c);
+                Ops::store(sine + i, s);
+                Ops::store(cosine + i, c);
+            }
+            SCALAR_KERNELS.sincos(in + i, sine + i, cosine + i, count - i);
+        }
+
+        static void atan2(const f32* y, const f32* x, f32* out, size_t count) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH)
+                Ops::store(out + i, fast_algorithms::atan2(Ops::load(y + i), Ops::load(x + i)));
+            SCALAR_KERNELS.atan2(y + i, x + i, out + i, count - i);
+        }
+
+        typedef intersection_algorithms<Ops> intersections;
+
+        static inline void splat3(const f32* values, reg* out) {
+            for (size_t i = 0; i < 3; i++)
+                out[i] = Ops::splat(values[i]);
+        }
+
+        static inline void load3(vec3_input v, size_t i, reg* out) {
+            out[0] = Ops::load(v.x + i);
+            out[1] = Ops::load(v.y + i);
+            out[2] = Ops::load(v.z + i);
+        }
+
+        static void ray_boxes(const ray_input& ray, box_input boxes, f32* out, size_t count) {
+            reg origin[3], inverse[3], minimum[3], maximum[3];
+            splat3(ray.origin, origin);
+            splat3(ray.inverse_direction, inverse);
+            reg t_max = Ops::splat(ray.t_max);
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                load3(boxes.min, i, minimum);
+                load3(boxes.max, i, maximum);
+                Ops::store(out + i, intersections::ray_box(origin, inverse, t_max, minimum, maximum));
+            }
+            SCALAR_KERNELS.ray_boxes(ray, offset(boxes, i), out + i, count - i);
+        }
+
+        static void rays_box(ray_packet_input rays, const f32* box, f32* out, size_t count) {
+            reg origin[3], inverse[3], minimum[3], maximum[3];
+            splat3(box, minimum);
+            splat3(box + 3, maximum);
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                load3(rays.origin, i, origin);
+                load3(rays.inverse_direction, i, inverse);
+                Ops::store(out + i, intersections::ray_box(origin, inverse, Ops::load(rays.t_max + i), minimum, maximum));
+            }
+            SCALAR_KERNELS.rays_box(offset(rays, i), box, out + i, count - i);
+        }
+
+        static void ray_triangles(const ray_input& ray, triangle_input triangles, f32* out, size_t count) {
+            reg origin[3], direction[3], vertex[3], edge1[3], edge2[3];
+            splat3(ray.origin, origin);
+            splat3(ray.direction, direction);
+            reg t_max = Ops::splat(ray.t_max);
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                load3(triangles.vertex, i, vertex);
+                load3(triangles.edge1, i, edge1);
+                load3(triangles.edge2, i, edge2);
+                Ops::store(out + i, intersections::ray_triangle(origin, direction, t_max, vertex, edge1, edge2));
+            }
+            SCALAR_KERNELS.ray_triangles(ray, offset(triangles, i), out + i, count - i);
+        }
+
+        static void ray_spheres(const ray_input& ray, sphere_input spheres, f32* out, size_t count) {
+            reg origin[3], direction[3], center[3];
+            splat3(ray.origin, origin);
+            splat3(ray.direction, direction);
+            reg t_max = Ops::splat(ray.t_max);
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                load3(spheres.center, i, center);
+                Ops::store(out + i, intersections::ray_sphere(origin, direction, t_max, center, Ops::load(spheres.radius + i)));
+            }
+            SCALAR_KERNELS.ray_spheres(ray, offset(spheres, i), out + i, count - i);
+        }
+
+        static void xoshiro256pp(u64* state, u64* out, size_t blocks) {
+            typedef typename Ops::qreg qreg;
+            static_assert(XOSHIRO_LANES % Ops::QWIDTH == 0, "The lanes must fill whole registers.");
+            for (size_t lane = 0; lane < XOSHIRO_LANES; lane += Ops::QWIDTH) {
+                qreg s0 = Ops::qload(state + lane), s1 = Ops::qload(state + XOSHIRO_LANES + lane);
+                qreg s2 = Ops::qload(state + 2 * XOSHIRO_LANES + lane), s3 = Ops::qload(state + 3 * XOSHIRO_LANES + lane);
+                for (size_t i = 0; i < blocks; i++) {
+                    Ops::qstore(out + i * XOSHIRO_LANES + lane, Ops::qadd(Ops::template qrotl<23>(Ops::qadd(s0, s3)), s0));
+                    qreg t = Ops::template qshl<17>(s1);
+                    s2 = Ops::qxor(s2, s0);
+                    s3 = Ops::qxor(s3, s1);
+                    s1 = Ops::qxor(s1, s2);
+                    s0 = Ops::qxor(s0, s3);
+                    s2 = Ops::qxor(s2, t);
+                    s3 = Ops::template qrotl<45>(s3);
+                }
+                Ops::qstore(state + lane, s0);
+                Ops::qstore(state + XOSHIRO_LANES + lane, s1);
+                Ops::qstore(state + 2 * XOSHIRO_LANES + lane, s2);
+                Ops::qstore(state + 3 * XOSHIRO_LANES + lane, s3);
+            }
+        }
+
+        /*
+         * Fixed point arithmetic, the overflows of the sums are found with the sign rules of two's complement.
+         */
+
+        typedef typename Ops::ireg ireg;
+
+        /*!
+         * Gets the largest number for the positive values, the lowest one for the negative values.
+         */
+        static inline ireg saturated(ireg sign_source) {
+            return Ops::ixor(Ops::template sra<31>(sign_source), Ops::isplat(0x7FFFFFFFu));
+        }
+
+        static inline ireg iselect(ireg mask, ireg a, ireg b) {
+            return Ops::ixor(b, Ops::iand(mask, Ops::ixor(a, b)));
+        }
+
+        static void fixed_add(const i32* a, const i32* b, i32* out, size_t count, bool saturate) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                ireg x = Ops::iload(a + i), y = Ops::iload(b + i), sum = Ops::iadd(x, y);
+                if (saturate) {
+                    // The sum overflows if it has not the sign of the operands while they have the same one.
+                    ireg overflow = Ops::template sra<31>(Ops::iand(Ops::ixor(x, sum), Ops::ixor(y, sum)));
+                    sum = iselect(overflow, saturated(x), sum);
+                }
+                Ops::istore(out + i, sum);
+            }
+            SCALAR_KERNELS.fixed_add(a + i, b + i, out + i, count - i, saturate);
+        }
+
+        static void fixed_sub(const i32* a, const i32* b, i32* out, size_t count, bool saturate) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                ireg x = Ops::iload(a + i), y = Ops::iload(b + i), difference = Ops::isub(x, y);
+                if (saturate) {
+                    // The difference overflows if the operands have different signs and it has not the sign of the first one.
+                    ireg overflow = Ops::template sra<31>(Ops::iand(Ops::ixor(x, y), Ops::ixor(x, difference)));
+                    difference = iselect(overflow, saturated(x), difference);
+                }
+                Ops::istore(out + i, difference);
+            }
+            SCALAR_KERNELS.fixed_sub(a + i, b + i, out + i, count - i, saturate);
+        }
+
+        static void fixed_multiply(const i32* a, const i32* b, i32* out, size_t count, u32 frac_bits, bool saturate) {
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH)
+                Ops::istore(out + i, Ops::multiply_fixed(Ops::iload(a + i), Ops::iload(b + i), frac_bits, saturate));
+            SCALAR_KERNELS.fixed_multiply(a + i, b + i, out + i, count - i, frac_bits, saturate);
+        }
+
+        static void points_in_polygon(const f32* x, const f32* y, const f32* edges, size_t edge_count, u8* out, size_t count) {
+            reg zero = Ops::splat(0.f), one = Ops::splat(1.f);
+            size_t i = 0;
+            for (; i + WIDTH <= count; i += WIDTH) {
+                reg px = Ops::load(x + i), py = Ops::load(y + i), crossings = zero;
+                for (size_t j = 0; j < edge_count; j++) {
+                    const f32* edge = edges + j * POLYGON_EDGE_STRIDE;
+                    reg crossing_x = Ops::add(Ops::splat(edge[0]), Ops::mul(Ops::splat(edge[2]), Ops::sub(py, Ops::splat(edge[1]))));
+                    reg crossing = Ops::select(Ops::less(px, crossing_x), one, zero);
+                    crossing = Ops::select(Ops::less(py, Ops::splat(edge[4])), crossing, zero);
+                    crossings = Ops::add(crossings, Ops::select(Ops::less(py, Ops::splat(edge[3])), zero, crossing));
+                }
+                f32 counts[WIDTH];
+                Ops::store(counts, crossings);
+                for (size_t lane = 0; lane < WIDTH; lane++)
+                    out[i + lane] = static_cast<u8>(static_cast<u32>(counts[lane]) & 1u);
+            }
+            SCALAR_KERNELS.points_in_polygon(x + i, y + i, edges, edge_count, out + i, count - i);
+        }
+
+        static void noise(const noise_input& settings, u32 dimensions, const f32* const* coordinates, f32* out, size_t count) {
+            size_t blocks = count / WIDTH * WIDTH;
+            dispatch_noise(dimensions, settings.type, [&](auto dimension, auto type) {
+                constexpr size_t D = decltype(dimension)::value;
+                for (size_t i = 0; i < blocks; i += WIDTH) {
+                    reg p[D];
+                    for (size_t d = 0; d < D; d++)
+                        p[d] = Ops::load(coordinates[d] + i);
+                    Ops::store(out + i, noise_algorithms<Ops>::template sample<D, decltype(type)::value>(settings, p));
+                }
+            });
+            const f32* tail[4] = {};
+            for (size_t d = 0; d < dimensions; d++)
+                tail[d] = coordinates[d] + blocks;
+            SCALAR_KERNELS.noise(settings, dimensions, tail, out + blocks, count - blocks);
+        }
+
+        /*
+         * Colors, a register holds WIDTH / 4 colors: the alpha of each one is broadcast over its components, and the
+         * conversions only apply to the color lanes.
+         */
+
+        static inline auto color_lanes() {
+            f32 pattern[WIDTH];
+            for (size_t i = 0; i < WIDTH; i++)
+                pattern[i] = i % 4 == 3 ? 1.f : 0.f;
+            return Ops::less(Ops::load(pattern), Ops::splat(0.5f));
+        }
+
+        /*!
+         * Clamps in [0, 1], the comparison is false for NaN.
+         */
+        static inline reg saturate(reg a) {
+            reg zero = Ops::splat(0.f);
+            return Ops::min(Ops::select(Ops::less(zero, a), a, zero), Ops::splat(1.f));
+        }
+
+        template<u8 Alpha, typename Mask>
+        static inline reg convert_alpha(reg rgba, Mask color) {
+            if constexpr (Alpha == 0)
+                return rgba;
+            reg alpha = Ops::broadcast_w(rgba);
+            if constexpr (Alpha == 1)
+                return Ops::select(color, Ops::mul(rgba, alpha), rgba);
+            // The transparent colors have lost their components, they become black.
+            reg zero = Ops::splat(0.f);
+            reg straight = Ops::select(Ops::equal(alpha, zero), zero, Ops::div(rgba, alpha));
+            return Ops::select(color, saturate(straight), rgba);
+        }
+
+        static void colors_to_rgba8(const f32* in, u8* out, size_t count, u8 alpha) {
+            size_t blocks = count * 4 / WIDTH * WIDTH;
+            dispatch_alpha(alpha, [&](auto conversion) {
+                auto color = color_lanes();
+                reg scale = Ops::splat(255.f);
+                for (size_t i = 0; i < blocks; i += WIDTH) {
+                    reg rgba = convert_alpha<decltype(conversion)::value>(saturate(Ops::load(in + i)), color);
+                    Ops::bstore(out + i, Ops::round_to_int(Ops::mul(rgba, scale)));
+                }
+            });
+            SCALAR_KERNELS.colors_to_rgba8(in + blocks, out + blocks, count - blocks / 4, alpha);
+        }
+
+        static void colors_to_f32x4(const u8* in, f32* out, size_t count, u8 alpha) {
+            size_t blocks = count * 4 / WIDTH * WIDTH;
+            dispatch_alpha(alpha, [&](auto conversion) {
+                auto color = color_lanes();
+                reg scale = Ops::splat(255.f);
+                for (size_t i = 0; i < blocks; i += WIDTH)
+                    Ops::store(out + i, convert_alpha<decltype(conversion)::value>(Ops::div(Ops::to_float(Ops::bload(in + i)), scale), color));
+            });
+            SCALAR_KERNELS.colors_to_f32x4(in + blocks, out + blocks, count - blocks / 4, alpha);
+        }
+
+        static constexpr batch_kernels KERNELS = {add, sub, scale, cross, normalize, dot, length, distance, transform<true>, transform<false>,
+                                                  multiply_mat4,
+                                                  unary<fast_algorithms::rsqrt, &batch_kernels::rsqrt>, unary<Ops::sqrt, &batch_kernels::sqrt>,
+                                                  unary<fast_algorithms::sin, &batch_kernels::sin>, unary<fast_algorithms::cos, &batch_kernels::cos>,
+                                                  sincos, atan2,
+                                                  unary<fast_algorithms::exp, &batch_kernels::exp>, unary<fast_algorithms::log, &batch_kernels::log>,
+                                                  ray_boxes, rays_box, ray_triangles, ray_spheres, xoshiro256pp,
+                                                  fixed_add, fixed_sub, fixed_multiply, points_in_polygon,
+                                                  noise, colors_to_rgba8, colors_to_f32x4};
+    };
+}
+
+#endif //LAMBDACOMMON_SOA_KERNELS_H
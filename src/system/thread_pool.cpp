@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2019 LambdAurora <aurora42lambda@gmail.com>
+ *
+ * This file is part of λcommon.
+ *
+ * Licensed under the MIT license. For more information,
+ * see the LICENSE file.
+ */
+
+#include "../../include/lambdacommon/system/thread_pool.h"
+#include "../../include/lambdacommon/system/system.h"
+
+namespace lambdacommon::system
+{
+    thread_pool::thread_pool(u32 threads) {
+        if (threads == 0)
+            threads = std::max(1u, get_cpu_cores());
+        _workers.reserve(threads);
+        for (u32 i = 0; i < threads; i++)
+            _workers.emplace_back([this]() { work(); });
+    }
+
+    thread_pool::~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _available.notify_all();
+        for (auto& worker : _workers)
+            worker.join();
+    }
+
+    void thread_pool::work() {
+        for (;;) {
+            task callback;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _available.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+                if (_tasks.empty())
+                    return;
+                callback = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+            callback();
+        }
+    }
+
+    size_t thread_pool::size() const {
+        return _workers.size();
+    }
+
+    void thread_pool::post(task callback) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push_back(std::move(callback));
+        }
+        _available.notify_one();
+    }
+}
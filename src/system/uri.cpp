@@ -361,5 +361,174 @@ namespace lambdacommon
 
             return result_uri;
         }
+
+        /*
+         * uri_view
+         */
+
+        static bool is_scheme_char(char c, bool first) {
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+                return true;
+            return !first && ((c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.');
+        }
+
+        static std::optional<port_t> parse_port(std::string_view port) {
+            if (port.empty() || port.size() > 5)
+                return std::nullopt;
+            u32 value = 0;
+            for (char c : port) {
+                if (c < '0' || c > '9')
+                    return std::nullopt;
+                value = value * 10 + static_cast<u32>(c - '0');
+            }
+            if (value > 65535)
+                return std::nullopt;
+            return static_cast<port_t>(value);
+        }
+
+        port_t uri_view::get_effective_port() const {
+            return _port != 0 ? _port : get_scheme_default_port(get_scheme_type());
+        }
+
+        std::optional<std::string_view> uri_view::get_query_parameter(std::string_view name) const {
+            auto query = _query;
+            while (!query.empty()) {
+                auto end = query.find('&');
+                auto parameter = query.substr(0, end);
+                auto equals = parameter.find('=');
+                if (parameter.substr(0, equals) == name)
+                    return equals == std::string_view::npos ? std::string_view() : parameter.substr(equals + 1);
+                if (end == std::string_view::npos)
+                    break;
+                query.remove_prefix(end + 1);
+            }
+            return std::nullopt;
+        }
+
+        URI uri_view::to_uri() const {
+            std::map<std::string, std::string> queries;
+            auto query = _query;
+            while (!query.empty()) {
+                auto end = query.find('&');
+                auto parameter = query.substr(0, end);
+                auto equals = parameter.find('=');
+                if (!parameter.empty())
+                    queries[std::string(parameter.substr(0, equals))] = equals == std::string_view::npos ? "" : std::string(parameter.substr(equals + 1));
+                if (end == std::string_view::npos)
+                    break;
+                query.remove_prefix(end + 1);
+            }
+            auto path = _path;
+            if (!path.empty() && path.front() == '/')
+                path.remove_prefix(1);
+            Address address = _host.empty() ? Address::EMPTY : Address{std::string(_host), _port};
+            return {std::string(_scheme), std::string(_username), std::string(_password), std::move(address), std::string(path), queries, std::string(_fragment)};
+        }
+
+        /*!
+         * Parses the authority component: [userinfo@]host[:port].
+         */
+        static bool parse_authority(std::string_view authority, std::string_view& username, std::string_view& password, std::string_view& host,
+                                    port_t& port) {
+            auto at = authority.rfind('@');
+            if (at != std::string_view::npos) {
+                auto userinfo = authority.substr(0, at);
+                auto colon = userinfo.find(':');
+                username = userinfo.substr(0, colon);
+                if (colon != std::string_view::npos)
+                    password = userinfo.substr(colon + 1);
+                authority.remove_prefix(at + 1);
+            }
+
+            std::string_view port_string;
+            if (!authority.empty() && authority.front() == '[') {
+                auto end = authority.find(']');
+                if (end == std::string_view::npos)
+                    return false;
+                host = authority.substr(1, end - 1);
+                auto rest = authority.substr(end + 1);
+                if (!rest.empty()) {
+                    if (rest.front() != ':')
+                        return false;
+                    port_string = rest.substr(1);
+                }
+            } else {
+                auto colon = authority.rfind(':');
+                host = authority.substr(0, colon);
+                if (colon != std::string_view::npos)
+                    port_string = authority.substr(colon + 1);
+            }
+            if (!port_string.empty()) {
+                auto parsed = parse_port(port_string);
+                if (!parsed)
+                    return false;
+                port = *parsed;
+            }
+            return true;
+        }
+
+        std::optional<uri_view> uri_view::parse(std::string_view uri) {
+            if (uri.empty())
+                return std::nullopt;
+            for (char c : uri)
+                if (static_cast<unsigned char>(c) <= 0x20 || c == 0x7F)
+                    return std::nullopt;
+
+            uri_view view;
+            view._raw = uri;
+            if (uri == "*") {
+                view._path = uri;
+                return view;
+            }
+
+            auto rest = uri;
+            if (uri.front() != '/') {
+                size_t scheme_end = 0;
+                while (scheme_end < uri.size() && is_scheme_char(uri[scheme_end], scheme_end == 0))
+                    scheme_end++;
+                if (scheme_end == 0 || scheme_end == uri.size() || uri[scheme_end] != ':')
+                    return std::nullopt;
+
+                view._scheme = uri.substr(0, scheme_end);
+                rest = uri.substr(scheme_end + 1);
+                if (rest.substr(0, 2) == "//") {
+                    rest.remove_prefix(2);
+                    auto authority_end = rest.find_first_of("/?#");
+                    if (!parse_authority(rest.substr(0, authority_end), view._username, view._password, view._host, view._port))
+                        return std::nullopt;
+                    rest = authority_end == std::string_view::npos ? std::string_view() : rest.substr(authority_end);
+                }
+            }
+
+            auto fragment = rest.find('#');
+            if (fragment != std::string_view::npos) {
+                view._fragment = rest.substr(fragment + 1);
+                rest = rest.substr(0, fragment);
+            }
+            auto query = rest.find('?');
+            if (query != std::string_view::npos) {
+                view._query = rest.substr(query + 1);
+                rest = rest.substr(0, query);
+            }
+            view._path = rest;
+            return view;
+        }
+
+        std::optional<uri_view> uri_view::parse_authority_form(std::string_view authority) {
+            for (char c : authority)
+                if (static_cast<unsigned char>(c) <= 0x20 || c == 0x7F)
+                    return std::nullopt;
+            // A host and a port only.
+            auto port_separator = authority.rfind(':');
+            if (authority.find_first_of("/?#@") != std::string_view::npos || port_separator == std::string_view::npos
+                || !parse_port(authority.substr(port_separator + 1)))
+                return std::nullopt;
+
+            uri_view view;
+            view._raw = authority;
+            if (!parse_authority(authority, view._username, view._password, view._host, view._port))
+                return std::nullopt;
+            return view;
+        }
     }
 }
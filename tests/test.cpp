@@ -3,11 +3,32 @@
 #include <lambdacommon/system/system.h>
 #include <lambdacommon/resources.h>
 #include <lambdacommon/system/uri.h>
+#include <lambdacommon/system/uri_router.h>
 #include <lambdacommon/exceptions/exceptions.h>
 #include <lambdacommon/maths.h>
+#include <lambdacommon/maths/fast.h>
+#include <lambdacommon/maths/fixed.h>
+#include <lambdacommon/maths/geometry2d.h>
+#include <lambdacommon/maths/intersection.h>
+#include <lambdacommon/maths/noise.h>
+#include <lambdacommon/maths/parallel.h>
+#include <lambdacommon/maths/random.h>
+#include <lambdacommon/maths/rect_packer.h>
+#include <lambdacommon/maths/soa.h>
+#include <lambdacommon/maths/soa_expression.h>
+#include <lambdacommon/maths/spatial.h>
+#include <lambdacommon/maths/tables.h>
 #include <lambdacommon/maths/geometry/geometry.h>
+#include <lambdacommon/connection/connection_pool.h>
+#include <lambdacommon/connection/event_loop.h>
+#include <lambdacommon/connection/http.h>
+#include <lambdacommon/connection/resolver.h>
+#include <lambdacommon/connection/udp_batch.h>
+#include <cstring>
 #include <functional>
+#include <numeric>
 #include <fstream>
+#include <random>
 
 using namespace lambdacommon;
 using namespace uri;
@@ -56,9 +77,16 @@ LC_TEST_SECTION(String)
         REQUIRE(!lstring::equals("lambdacommon", "LambdAcommOn"));
     }
 
-    LC_TEST(lstring_equals_ignore_case, "lstring::equals_ignore_case(const std::string &a, const std::string &b)") {
+    LC_TEST(lstring_equals_ignore_case, "lstring::equals_ignore_case(std::string_view a, std::string_view b)") {
         REQUIRE(lstring::equals_ignore_case("owo", "owo"));
         REQUIRE(lstring::equals_ignore_case("lambdacommon", "LambdaCommon"));
+        REQUIRE(lstring::equals_ignore_case("Content-Type: text/html; charset=UTF-8", "content-type: TEXT/HTML; CHARSET=utf-8"));
+        REQUIRE(!lstring::equals_ignore_case("Content-Type: text/html; charset=UTF-8", "content-type: TEXT/HTML; CHARSET=utf-9"));
+        REQUIRE(!lstring::equals_ignore_case("Transfer-Encoding", "Transfer-Encodin_"));
+        // Only ASCII letters are folded, '@' and '[' surround the upper case letters.
+        REQUIRE(!lstring::equals_ignore_case("@@@@@@@@@@@@@@@@[", "`````````````````{"));
+        REQUIRE(lstring::starts_with_ignore_case("Keep-Alive, Upgrade", "keep-alive"));
+        REQUIRE(lstring::ends_with_ignore_case("gzip, Chunked", "chunked"));
     }
 
     LC_TEST(lstring_to_lower, "lstring::to_lower_case(const std::string &input)") {
@@ -109,8 +137,774 @@ LC_TEST_SECTION(URI)
         auto uri_string = u8"https://www.youtube.com/channel/UC2i7nj6wnh1Z2GQwvFeeKoA";
         REQUIRE(uri::from_string(uri_string).to_string() == uri_string);
     }
+
+    LC_TEST(uri_view_parse, "uri::uri_view::parse(std::string_view uri)") {
+        auto view = uri::uri_view::parse("https://user:pwd@[::1]:8443/a/b?x=1&y=&z#top");
+        REQUIRE(view.has_value());
+        REQUIRE(view->get_scheme() == "https");
+        REQUIRE(view->get_username() == "user");
+        REQUIRE(view->get_password() == "pwd");
+        REQUIRE(view->get_host() == "::1");
+        REQUIRE(view->get_port() == 8443);
+        REQUIRE(view->get_path() == "/a/b");
+        REQUIRE(view->get_query_parameter("x") == std::string_view("1"));
+        REQUIRE(view->get_query_parameter("y") == std::string_view());
+        REQUIRE(view->get_query_parameter("z").has_value());
+        REQUIRE(!view->get_query_parameter("w"));
+        REQUIRE(view->get_fragment() == "top");
+
+        auto origin = uri::uri_view::parse("/index.html?lang=en");
+        REQUIRE(origin && !origin->is_absolute());
+        REQUIRE(origin->get_path() == "/index.html");
+        REQUIRE(origin->get_query() == "lang=en");
+
+        auto authority = uri::uri_view::parse_authority_form("example.com:443");
+        REQUIRE(authority && authority->get_host() == "example.com" && authority->get_port() == 443);
+        REQUIRE(!uri::uri_view::parse_authority_form("/index.html"));
+        auto urn = uri::uri_view::parse("urn:123");
+        REQUIRE(urn && urn->get_scheme() == "urn" && urn->get_path() == "123");
+        REQUIRE(uri::uri_view::parse("*").has_value());
+        REQUIRE(uri::uri_view::parse("http://example.com")->get_effective_port() == 80);
+        REQUIRE(!uri::uri_view::parse("/a b"));
+        REQUIRE(!uri::uri_view::parse("http://example.com:99999/"));
+    }
+
+    LC_TEST(uri_router_match, "uri::router<T>::match(std::string_view method, std::string_view path)") {
+        uri::router<int> router;
+        router.add("GET", "/", 1);
+        router.add("GET", "/users", 2);
+        router.add("GET", "/users/:id", 3);
+        router.add("GET", "/users/me", 4);
+        router.add("GET", "/users/:id/files/*path", 5);
+        router.add("POST", "/users", 6);
+        router.add("*", "/static/*", 7);
+        router.add("GET", "/user", 8);
+        REQUIRE(router.size() == 8);
+
+        REQUIRE(*router.match("GET", "/") == 1);
+        REQUIRE(*router.match("GET", "/users") == 2);
+        REQUIRE(*router.match("GET", "/user") == 8);
+        REQUIRE(*router.match("POST", "/users") == 6);
+        REQUIRE(*router.match("GET", "/users/me") == 4);
+        auto user = router.match("GET", "/users/42");
+        REQUIRE(user && *user == 3);
+        REQUIRE(user.get_parameter("id") == std::string_view("42"));
+        auto file = router.match("GET", "/users/mel/files/a/b.txt");
+        REQUIRE(file && *file == 5);
+        REQUIRE(file.get_parameter("id") == std::string_view("mel"));
+        REQUIRE(file.get_parameter("path") == std::string_view("a/b.txt"));
+        auto any = router.match("DELETE", "/static/app.js");
+        REQUIRE(any && *any == 7);
+        REQUIRE(any.get_parameter("*") == std::string_view("app.js"));
+
+        REQUIRE(!router.match("GET", "/users/"));
+        REQUIRE(!router.match("GET", "/users/42/extra"));
+        REQUIRE(!router.match("DELETE", "/users"));
+        REQUIRE(router.get_allowed_methods("/users") == std::vector<std::string_view>({"GET", "POST"}));
+
+        bool conflict = false;
+        try {
+            router.add("GET", "/users/:name/posts", 9);
+        } catch (const std::invalid_argument&) {
+            conflict = true;
+        }
+        REQUIRE(conflict);
+    }
+}
+
+LC_TEST_SECTION(Address)
+{
+    LC_TEST(address_domain_valid, "Address::is_domain_valid()") {
+        REQUIRE(Address("aperlambda.github.io").is_domain_valid());
+        REQUIRE(Address("WWW.Example.COM").is_domain_valid());
+        REQUIRE(Address("xn--80ak6aa92e.xn--p1ai").is_domain_valid());
+        REQUIRE(Address("a-very-long-sub-domain-name-to-cross-a-vector-chunk.example.org").is_domain_valid());
+        REQUIRE(!Address("localhost").is_domain_valid());
+        REQUIRE(!Address("example.notatld").is_domain_valid());
+        REQUIRE(!Address("abc..com").is_domain_valid());
+        REQUIRE(!Address(".abc.com").is_domain_valid());
+        REQUIRE(!Address("abc.com.").is_domain_valid());
+        REQUIRE(!Address("-abc.com").is_domain_valid());
+        REQUIRE(!Address("abc-.com").is_domain_valid());
+        REQUIRE(!Address("ab_c.com").is_domain_valid());
+        REQUIRE(!Address(std::string(64, 'a') + ".com").is_domain_valid());
+        REQUIRE(Address(std::string(63, 'a') + ".com").is_domain_valid());
+    }
+
+    LC_TEST(address_type, "Address::get_type()") {
+        REQUIRE(Address("127.0.0.1").get_type() == IPv4);
+        REQUIRE(Address("::1").get_type() == IPv6);
+        REQUIRE(Address("github.com", 443).get_type() == DOMAIN_NAME);
+        REQUIRE(Address("").get_type() == AddressType::EMPTY);
+        REQUIRE(Address("not a host").get_type() == INVALID);
+    }
+
+    LC_TEST(ip_address_parse, "ip_address::parse(std::string_view str)") {
+        REQUIRE(ip_address::parse("192.168.1.42")->to_string() == "192.168.1.42");
+        REQUIRE(ip_address::parse("192.168.1.42")->to_v4() == 0xC0A8012Au);
+        REQUIRE(ip_address::parse("2001:DB8:0:0:1:0:0:1")->to_string() == "2001:db8::1:0:0:1");
+        REQUIRE(ip_address::parse("::1")->is_loopback());
+        REQUIRE(ip_address::parse("::")->to_string() == "::");
+        REQUIRE(ip_address::parse("fe80::")->to_string() == "fe80::");
+        REQUIRE(*ip_address::parse("::ffff:10.0.0.1") == *ip_address::parse("10.0.0.1"));
+        REQUIRE(!ip_address::parse("256.0.0.1"));
+        REQUIRE(!ip_address::parse("01.2.3.4"));
+        REQUIRE(!ip_address::parse("1.2.3"));
+        REQUIRE(!ip_address::parse("1::2::3"));
+        REQUIRE(!ip_address::parse("1:2:3:4:5:6:7:8:9"));
+        REQUIRE(!ip_address::parse("12345::"));
+        REQUIRE(*Address("10.1.2.3", 80).get_ip_address() == ip_address::from_v4(0x0A010203));
+        REQUIRE(!Address("github.com").get_ip_address());
+    }
+
+    LC_TEST(cidr_contains, "cidr::contains(const ip_address& address)") {
+        auto private_range = *cidr::parse("10.0.0.0/8");
+        REQUIRE(private_range.to_string() == "10.0.0.0/8");
+        REQUIRE(private_range.contains(*ip_address::parse("10.255.0.1")));
+        REQUIRE(!private_range.contains(*ip_address::parse("11.0.0.1")));
+        REQUIRE(cidr::parse("fe80::1/10")->to_string() == "fe80::/10");
+        REQUIRE(cidr::parse("fe80::/10")->contains(*ip_address::parse("febf::1")));
+        REQUIRE(!cidr::parse("10.0.0.0/33"));
+    }
+
+    LC_TEST(ip_prefix_table_match, "ip_prefix_table<T>::match(const ip_address& address)") {
+        ip_prefix_table<std::string> table;
+        table.insert(*cidr::parse("0.0.0.0/0"), "default");
+        table.insert(*cidr::parse("10.0.0.0/8"), "private");
+        table.insert(*cidr::parse("10.1.0.0/16"), "office");
+        table.insert(*cidr::parse("10.1.2.0/24"), "lab");
+        table.insert(*cidr::parse("10.1.2.3/32"), "server");
+        table.insert(*cidr::parse("2001:db8::/32"), "documentation");
+        table.insert(*cidr::parse("10.0.0.0/8"), "private network");
+        REQUIRE(table.size() == 6);
+        REQUIRE(*table.match(*ip_address::parse("8.8.8.8")) == "default");
+        REQUIRE(*table.match(*ip_address::parse("10.200.0.1")) == "private network");
+        REQUIRE(*table.match(*ip_address::parse("10.1.9.9")) == "office");
+        REQUIRE(*table.match(*ip_address::parse("10.1.2.4")) == "lab");
+        REQUIRE(*table.match(*ip_address::parse("10.1.2.3")) == "server");
+        REQUIRE(*table.match(*ip_address::parse("2001:db8::42")) == "documentation");
+        REQUIRE(table.match(*ip_address::parse("2001:db9::42")) == nullptr);
+        REQUIRE(*table.find(*cidr::parse("10.1.0.0/16")) == "office");
+        REQUIRE(table.find(*cidr::parse("10.1.0.0/17")) == nullptr);
+    }
+}
+
+LC_TEST_SECTION(Resolver)
+{
+    LC_TEST(thread_pool_submit, "system::thread_pool submit") {
+        system::thread_pool pool{2};
+        REQUIRE(pool.size() == 2);
+        std::vector<std::future<int>> results;
+        for (int i = 0; i < 16; i++)
+            results.push_back(pool.submit([i]() { return i * i; }));
+        int sum = 0;
+        for (auto& result : results)
+            sum += result.get();
+        REQUIRE(sum == 1240);
+    }
+
+    LC_TEST(resolver_localhost, "resolver localhost and literals") {
+        connection::resolver resolver;
+        auto addresses = resolver.resolve("LocalHost").get();
+        REQUIRE(std::find(addresses.begin(), addresses.end(), ip_address::from_v4(0x7F000001)) != addresses.end());
+        REQUIRE(resolver.get_cached("localhost").has_value());
+        REQUIRE(resolver.resolve("localhost").get() == addresses);
+        REQUIRE(resolver.resolve("::1").get() == std::vector<ip_address>{*ip_address::parse("::1")});
+        auto resolved = resolver.resolve(Address{"localhost", 8080});
+        REQUIRE(!resolved.empty());
+        REQUIRE(resolved[0].get_port() == 8080);
+        REQUIRE(resolved[0].get_ip_address().has_value());
+        auto stats = resolver.get_stats();
+        REQUIRE(stats.lookups == 1);
+        REQUIRE(stats.cache_hits == 2);
+        REQUIRE(std::string(connection::resolver_category().name()) == "resolver");
+    }
+
+    LC_TEST(resolver_cache, "resolver deduplication and TTL") {
+        connection::resolver_options options;
+        options.ttl = std::chrono::milliseconds(200);
+        options.negative_ttl = std::chrono::milliseconds(10);
+        std::atomic<int> lookups{0};
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        options.lookup = [&](const std::string& host) {
+            lookups++;
+            released.wait();
+            if (host == "missing.example")
+                return std::vector<ip_address>();
+            return std::vector<ip_address>{*ip_address::parse("192.0.2.1")};
+        };
+        connection::resolver resolver{options};
+
+        // Concurrent requests share the lookup in progress.
+        auto first = resolver.resolve("service.example");
+        auto second = resolver.resolve("SERVICE.example");
+        auto missing = resolver.resolve("missing.example");
+        release.set_value();
+        REQUIRE(first.get() == second.get());
+        REQUIRE(missing.get().empty());
+        REQUIRE(lookups == 2);
+        REQUIRE(resolver.get_stats().joined == 1);
+
+        // Negative results expire sooner than positive ones.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        resolver.resolve("missing.example").get();
+        resolver.resolve("service.example").get();
+        REQUIRE(lookups == 3);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        resolver.resolve("service.example").get();
+        REQUIRE(lookups == 4);
+    }
 }
 
+LC_TEST_SECTION(HTTP)
+{
+    using namespace connection;
+
+    const std::string REQUEST = "GET /search?q=lambda HTTP/1.1\r\n"
+                                "Host: example.com\r\n"
+                                "User-Agent: lambdacommon\r\n"
+                                "Connection: Keep-Alive, Upgrade\r\n"
+                                "Content-Length:  5 \r\n"
+                                "\r\n"
+                                "hello";
+
+    LC_TEST(http_request_parse, "http::request_parser::parse(std::string_view data)") {
+        http::request_parser parser;
+        REQUIRE(parser.parse(REQUEST) == http::COMPLETE);
+        REQUIRE(parser.get_method() == "GET");
+        REQUIRE(parser.get_target().get_path() == "/search");
+        REQUIRE(parser.get_target().get_query_parameter("q") == std::string_view("lambda"));
+        REQUIRE(parser.get_minor_version() == 1);
+        REQUIRE(parser.get_header_count() == 4);
+        REQUIRE(parser.find_header("host") == std::string_view("example.com"));
+        REQUIRE(parser.get_content_length() == 5u);
+        REQUIRE(parser.has_header_token("connection", "upgrade"));
+        REQUIRE(parser.is_keep_alive());
+        REQUIRE(!parser.is_chunked());
+        REQUIRE(REQUEST.substr(parser.get_head_size()) == "hello");
+    }
+
+    LC_TEST(http_request_incremental, "http::request_parser incremental parsing") {
+        // Feeding the bytes one at a time must give the same result as a single call.
+        http::request_parser parser;
+        size_t head_size = REQUEST.size() - 5;
+        for (size_t size = 0; size < head_size; size++)
+            REQUIRE(parser.parse(std::string_view(REQUEST).substr(0, size)) == http::INCOMPLETE);
+        REQUIRE(parser.parse(std::string_view(REQUEST).substr(0, head_size)) == http::COMPLETE);
+        REQUIRE(parser.get_head_size() == head_size);
+        REQUIRE(parser.find_header("User-Agent") == std::string_view("lambdacommon"));
+
+        parser.reset();
+        REQUIRE(parser.parse("\r\nPOST / HTTP/1.0\nHost: a\n\n") == http::COMPLETE);
+        REQUIRE(parser.get_method() == "POST");
+        REQUIRE(parser.get_minor_version() == 0);
+        REQUIRE(!parser.is_keep_alive());
+        parser.reset();
+        REQUIRE(parser.parse("CONNECT example.com:443 HTTP/1.1\r\n\r\n") == http::COMPLETE);
+        REQUIRE(parser.get_target().get_host() == "example.com");
+        REQUIRE(parser.get_target().get_port() == 443);
+    }
+
+    LC_TEST(http_request_invalid, "http::request_parser invalid requests") {
+        const char* invalid[] = {
+                "GET / HTTP/2.0\r\n\r\n",
+                "GET  / HTTP/1.1\r\n\r\n",
+                "G(T / HTTP/1.1\r\n\r\n",
+                "GET / HTTP/1.1\r\nHost : a\r\n\r\n",
+                "GET / HTTP/1.1\r\nHost: a\r\n folded\r\n\r\n",
+                "GET / HTTP/1.1\r\nHost: a\rb\r\n\r\n",
+                "GET / HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 6\r\n\r\n",
+                "GET / HTTP/1.1\r\nContent-Length: -1\r\n\r\n",
+                "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 5\r\n\r\n",
+                "CONNECT /index.html HTTP/1.1\r\n\r\n"
+        };
+        for (auto request : invalid) {
+            http::request_parser parser;
+            REQUIRE(parser.parse(request) == http::INVALID);
+        }
+        std::string nul = "GET / HTTP/1.1\r\nHost: a";
+        nul.push_back('\0');
+        nul += "\r\n\r\n";
+        http::request_parser parser;
+        REQUIRE(parser.parse(nul) == http::INVALID);
+
+        http::request_parser limited{32};
+        REQUIRE(limited.parse("GET / HTTP/1.1\r\nX-Long-Header: 0123456789") == http::INVALID);
+    }
+
+    LC_TEST(http_response_parse, "http::response_parser::parse(std::string_view data)") {
+        http::response_parser parser;
+        REQUIRE(parser.parse("HTTP/1.1 404 Not Found\r\nTransfer-Encoding: gzip, chunked\r\nConnection: close\r\n\r\n") == http::COMPLETE);
+        REQUIRE(parser.get_status() == 404);
+        REQUIRE(parser.get_reason() == "Not Found");
+        REQUIRE(parser.is_chunked());
+        REQUIRE(!parser.is_keep_alive());
+        parser.reset();
+        REQUIRE(parser.parse("HTTP/1.1 204\r\n\r\n") == http::COMPLETE);
+        REQUIRE(parser.get_status() == 204);
+        REQUIRE(parser.get_reason().empty());
+        parser.reset();
+        REQUIRE(parser.parse("HTTP/1.1 20x OK\r\n\r\n") == http::INVALID);
+    }
+
+    LC_TEST(http_chunked_decode, "http::chunked_decoder::decode(char* data, size_t& size)") {
+        const std::string body = "5\r\nhello\r\n7;ext=1\r\n, world\r\n0\r\nTrailer: x\r\n\r\nNEXT";
+        std::string data = body;
+        size_t size = data.size();
+        http::chunked_decoder decoder;
+        REQUIRE(decoder.decode(data.data(), size) == http::COMPLETE);
+        REQUIRE(data.substr(0, size) == "hello, world");
+        REQUIRE(body.substr(decoder.get_consumed()) == "NEXT");
+
+        // Byte by byte, each call decodes in place and the caller appends the decoded bytes.
+        decoder.reset();
+        std::string decoded;
+        http::parse_status status = http::INCOMPLETE;
+        for (size_t i = 0; i < body.size() && status == http::INCOMPLETE; i++) {
+            char c = body[i];
+            size_t count = 1;
+            status = decoder.decode(&c, count);
+            decoded.append(&c, count);
+        }
+        REQUIRE(status == http::COMPLETE);
+        REQUIRE(decoded == "hello, world");
+
+        for (std::string invalid : {"5\r\nhelloXX", "5\r\nhello\n0\r\n\r\n", "5zz\r\nhello\r\n0\r\n\r\n"}) {
+            decoder.reset();
+            size = invalid.size();
+            REQUIRE(decoder.decode(invalid.data(), size) == http::INVALID);
+        }
+    }
+}
+
+LC_TEST_SECTION(BufferChain)
+{
+    LC_TEST(buffer_chain_append_consume, "buffer_chain append/consume") {
+        connection::buffer_chain chain;
+        chain.append("Hello"sv);
+        chain.append(", world!"sv);
+        REQUIRE(chain.size() == 13);
+        REQUIRE(chain.get_slice_count() == 1);
+        REQUIRE(chain.to_string() == "Hello, world!");
+        chain.consume(7);
+        REQUIRE(chain.to_string() == "world!");
+        chain.consume(100);
+        REQUIRE(chain.empty());
+
+        std::string big(connection::slab::DEFAULT_CAPACITY * 2 + 10, 'x');
+        chain.append(big);
+        REQUIRE(chain.size() == big.size());
+        REQUIRE(chain.get_slice_count() == 3);
+        REQUIRE(chain.to_string() == big);
+    }
+
+    LC_TEST(buffer_chain_slice, "buffer_chain slicing without copies") {
+        connection::buffer_chain chain;
+        chain.append("GET /index.html HTTP/1.1"sv);
+        auto path = chain.slice(4, 11);
+        REQUIRE(path.to_string() == "/index.html");
+        REQUIRE(path.front().data() == chain.front().data() + 4);
+
+        // The slab is shared, appending must not overwrite the bytes seen by the slice.
+        path.append("?q"sv);
+        chain.append("\r\n"sv);
+        REQUIRE(path.to_string() == "/index.html?q");
+        REQUIRE(chain.to_string() == "GET /index.html HTTP/1.1\r\n");
+
+        connection::buffer_chain joined;
+        joined.append(chain);
+        joined.append(path);
+        REQUIRE(joined.get_slice_count() == 4);
+        REQUIRE(joined.size() == chain.size() + path.size());
+    }
+
+    LC_TEST(buffer_chain_contiguous, "buffer_chain contiguous/iovecs") {
+        connection::buffer_chain first, chain;
+        first.append("Content-"sv);
+        chain.append(first);
+        chain.append("Length: 42"sv);
+        REQUIRE(chain.get_slice_count() == 2);
+        REQUIRE(chain.contiguous(4) == "Cont");
+        REQUIRE(chain.get_slice_count() == 2);
+        REQUIRE(chain.contiguous(14) == "Content-Length");
+        REQUIRE(chain.to_string() == "Content-Length: 42");
+
+#if !defined(LAMBDA_WINDOWS) && !defined(LAMBDA_WASM)
+        iovec iovecs[8];
+        REQUIRE(chain.get_iovecs(iovecs, 8) == chain.get_slice_count());
+        REQUIRE(iovecs[0].iov_len == 14);
+#endif
+        std::string_view segments[1];
+        REQUIRE(chain.get_segments(segments, 1) == 1);
+        REQUIRE(segments[0] == "Content-Length");
+    }
+
+    LC_TEST(buffer_chain_prepare_commit, "buffer_chain prepare/commit") {
+        connection::buffer_chain chain;
+        auto[area, size] = chain.prepare(16);
+        REQUIRE(size >= 16);
+        std::memcpy(area, "abc", 3);
+        chain.commit(3);
+        chain.prepare();
+        chain.commit(0);
+        REQUIRE(chain.get_slice_count() == 1);
+        REQUIRE(chain.to_string() == "abc");
+    }
+
+    LC_TEST(slab_thread_cache, "slab caches flushed on thread exit") {
+        // The cache of an exiting thread goes to the shared list, where the next thread with an empty cache finds it.
+        connection::slab* released = nullptr;
+        std::thread([&]() {
+            released = connection::slab::acquire();
+            connection::slab::release(released);
+        }).join();
+        connection::slab* reused = nullptr;
+        std::thread([&]() {
+            reused = connection::slab::acquire();
+            connection::slab::release(reused);
+        }).join();
+        REQUIRE(reused == released);
+    }
+}
+
+#ifdef LAMBDA_HAS_EVENT_LOOP
+LC_TEST_SECTION(EventLoop)
+{
+    /*!
+     * Accepts the connections of a listener and echoes what they send through buffer chains, until they hang up.
+     */
+    void serve_echo(connection::event_loop& loop, connection::tcp_listener& listener,
+                    std::unordered_map<int, connection::tcp_stream>& server_streams) {
+        loop.add(listener.get_fd(), connection::READABLE, [&](u32) {
+            while (auto stream = listener.accept()) {
+                int fd = stream->get_fd();
+                loop.add(fd, connection::READABLE, [&, fd](u32) {
+                    auto& server_stream = server_streams[fd];
+                    connection::buffer_chain buffer;
+                    while (auto read = server_stream.read(buffer)) {
+                        if (*read == 0) {
+                            loop.remove(fd);
+                            server_streams.erase(fd);
+                            return;
+                        }
+                        server_stream.write(buffer);
+                    }
+                });
+                server_streams[fd] = std::move(*stream);
+            }
+        });
+    }
+
+    LC_TEST(event_loop_timers, "event_loop timers") {
+        connection::event_loop loop;
+        std::string order;
+        loop.set_timeout(std::chrono::milliseconds(20), [&]() { order += 'b'; });
+        loop.set_timeout(std::chrono::milliseconds(5), [&]() { order += 'a'; });
+        auto cancelled = loop.set_timeout(std::chrono::milliseconds(10), [&]() { order += 'x'; });
+        int ticks = 0;
+        loop.set_interval(std::chrono::milliseconds(2), [&]() { ticks++; });
+        REQUIRE(loop.cancel_timer(cancelled));
+        loop.set_timeout(std::chrono::milliseconds(30), [&]() { loop.stop(); });
+        loop.run();
+        REQUIRE(order == "ab");
+        REQUIRE(ticks >= 5);
+    }
+
+    LC_TEST(event_loop_tcp_echo, "tcp_listener/tcp_stream loopback echo") {
+        connection::event_loop loop;
+        connection::tcp_listener listener{Address{"127.0.0.1", 0}};
+        std::unordered_map<int, connection::tcp_stream> server_streams;
+        loop.add(listener.get_fd(), connection::READABLE, [&](u32) {
+            while (auto stream = listener.accept()) {
+                int fd = stream->get_fd();
+                loop.add(fd, connection::READABLE, [&, fd](u32) {
+                    auto& server_stream = server_streams[fd];
+                    char buffer[256];
+                    while (auto read = server_stream.read(buffer, sizeof(buffer))) {
+                        if (*read == 0) {
+                            loop.remove(fd);
+                            server_streams.erase(fd);
+                            return;
+                        }
+                        server_stream.write(buffer, *read);
+                    }
+                });
+                server_streams[fd] = std::move(*stream);
+            }
+        });
+
+        auto client = connection::tcp_stream::connect(listener.get_local_address());
+        bool sent = false;
+        std::string received;
+        loop.add(client.get_fd(), connection::READABLE | connection::WRITABLE, [&](u32 events) {
+            if ((events & connection::WRITABLE) && !sent && client.get_error() == 0) {
+                sent = client.write("λcommon", std::string("λcommon").size()).has_value();
+                client.shutdown_write();
+            }
+            char buffer[256];
+            while (auto read = client.read(buffer, sizeof(buffer))) {
+                if (*read == 0) {
+                    loop.stop();
+                    return;
+                }
+                received.append(buffer, *read);
+            }
+        });
+        loop.set_timeout(std::chrono::seconds(2), [&]() { loop.stop(); });
+        loop.run();
+        REQUIRE(sent);
+        REQUIRE(received == "λcommon");
+        REQUIRE(server_streams.empty());
+    }
+
+    LC_TEST(event_loop_buffer_chain_echo, "tcp_stream loopback echo through buffer chains") {
+        connection::event_loop loop;
+        connection::tcp_listener listener{Address{"127.0.0.1", 0}};
+        std::unordered_map<int, connection::tcp_stream> server_streams;
+        serve_echo(loop, listener, server_streams);
+
+        auto client = connection::tcp_stream::connect(listener.get_local_address());
+        connection::buffer_chain out, in;
+        out.append("λcommon"sv);
+        loop.add(client.get_fd(), connection::READABLE | connection::WRITABLE, [&](u32 events) {
+            if ((events & connection::WRITABLE) && !out.empty() && client.get_error() == 0) {
+                client.write(out);
+                if (out.empty())
+                    client.shutdown_write();
+            }
+            while (auto read = client.read(in)) {
+                if (*read == 0) {
+                    loop.stop();
+                    return;
+                }
+            }
+        });
+        loop.set_timeout(std::chrono::seconds(2), [&]() { loop.stop(); });
+        loop.run();
+        REQUIRE(out.empty());
+        REQUIRE(in.to_string() == "λcommon");
+        REQUIRE(server_streams.empty());
+
+        // A failed read leaves the chain as it was.
+        connection::tcp_listener not_connected{Address{"127.0.0.1", 0}};
+        connection::tcp_stream stream{not_connected.release()};
+        connection::buffer_chain chain;
+        bool thrown = false;
+        try {
+            stream.read(chain);
+        } catch (const std::system_error&) {
+            thrown = true;
+        }
+        REQUIRE(thrown);
+        REQUIRE(chain.get_slice_count() == 0);
+    }
+
+    LC_TEST(event_loop_udp, "udp_socket loopback") {
+        connection::event_loop loop;
+        connection::udp_socket receiver{Address{"127.0.0.1", 0}};
+        connection::udp_socket sender{Address{"127.0.0.1", 0}};
+        std::vector<std::string> datagrams;
+        Address from = Address::EMPTY;
+        loop.add(receiver.get_fd(), connection::READABLE, [&](u32) {
+            char buffer[64];
+            while (auto size = receiver.receive_from(buffer, sizeof(buffer), &from))
+                datagrams.emplace_back(buffer, *size);
+            if (datagrams.size() == 3)
+                loop.stop();
+        });
+        for (auto message : {"one", "two", "three"})
+            sender.send_to(message, std::strlen(message), receiver.get_local_address());
+        loop.set_timeout(std::chrono::seconds(2), [&]() { loop.stop(); });
+        loop.run();
+        REQUIRE(datagrams == std::vector<std::string>({"one", "two", "three"}));
+        REQUIRE(from == sender.get_local_address());
+    }
+
+    LC_TEST(event_loop_reused_fd, "event_loop with a file descriptor closed and reused within a batch") {
+        connection::event_loop loop;
+        connection::udp_socket sender{Address{"127.0.0.1", 0}};
+        std::optional<connection::udp_socket> sockets[2];
+        sockets[0].emplace(Address{"127.0.0.1", 0});
+        sockets[1].emplace(Address{"127.0.0.1", 0});
+        std::optional<connection::udp_socket> replacement;
+        int calls = 0, replacement_calls = 0;
+        for (int i = 0; i < 2; i++) {
+            loop.add(sockets[i]->get_fd(), connection::READABLE, [&, i](u32) {
+                calls++;
+                // The first callback closes the other socket, whose event is already in the batch, and reuses its number.
+                auto& other = sockets[1 - i];
+                int fd = other->get_fd();
+                loop.remove(fd);
+                other.reset();
+                replacement.emplace(Address{"127.0.0.1", 0});
+                REQUIRE(replacement->get_fd() == fd);
+                loop.add(fd, connection::READABLE, [&](u32) { replacement_calls++; });
+            });
+        }
+        for (auto& socket : sockets)
+            sender.send_to("x", 1, socket->get_local_address());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        loop.run_once(100);
+        REQUIRE(calls == 1);
+        REQUIRE(replacement_calls == 0);
+    }
+
+    LC_TEST(event_loop_connection_pool, "connection_pool with a loopback echo server") {
+        connection::event_loop loop;
+        connection::tcp_listener listener{Address{"127.0.0.1", 0}};
+        std::unordered_map<int, connection::tcp_stream> server_streams;
+        serve_echo(loop, listener, server_streams);
+        std::thread server([&]() { loop.run(); });
+        auto address = listener.get_local_address();
+
+        auto echo = [](connection::pooled_connection& connection, const std::string& message) {
+            connection->write(message.data(), message.size());
+            std::string received;
+            char buffer[64];
+            for (int i = 0; i < 2000 && received.size() < message.size(); i++) {
+                if (auto read = connection->read(buffer, sizeof(buffer)))
+                    received.append(buffer, *read);
+                else
+                    std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+            return received;
+        };
+
+        connection::connection_pool_options options;
+        options.max_per_host = 2;
+        options.idle_timeout = std::chrono::milliseconds(20);
+        connection::connection_pool pool{options};
+        {
+            auto connection = pool.acquire(address);
+            REQUIRE(!connection.is_reused());
+            REQUIRE(echo(connection, "ping") == "ping");
+        }
+        REQUIRE(pool.get_idle_count(address) == 1);
+        {
+            auto first = pool.acquire(address);
+            REQUIRE(first.is_reused());
+            REQUIRE(echo(first, "pong") == "pong");
+            auto second = pool.acquire(address);
+            REQUIRE(!second.is_reused());
+            REQUIRE(pool.get_open_count(address) == 2);
+
+            // The limit is reached, the third checkout waits for the first connection.
+            bool third_reused = false;
+            std::thread waiter([&]() { third_reused = pool.acquire(address).is_reused(); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            first.release();
+            waiter.join();
+            REQUIRE(third_reused);
+        }
+        REQUIRE(pool.get_open_count(address) == 2);
+        REQUIRE(pool.get_idle_count(address) == 2);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        REQUIRE(pool.tick() == 2);
+        REQUIRE(pool.get_open_count(address) == 0);
+
+        auto stats = pool.get_stats();
+        REQUIRE(stats.checkouts == 4);
+        REQUIRE(stats.reused == 2);
+        REQUIRE(stats.created == 2);
+        REQUIRE(stats.evicted == 2);
+        REQUIRE(stats.waits == 1);
+        REQUIRE(stats.get_reuse_ratio() == 0.5);
+        REQUIRE(stats.get_average_wait_ms() > 0.0);
+
+        loop.post([&]() { loop.stop(); });
+        server.join();
+    }
+
+    LC_TEST(event_loop_group_reuse_port, "event_loop_group with SO_REUSEPORT listeners") {
+        connection::event_loop_group group{2};
+        std::atomic<port_t> port{0};
+        std::atomic<int> accepted{0};
+        std::mutex mutex;
+        std::vector<std::unique_ptr<connection::tcp_listener>> listeners;
+        {
+            // Reserve an ephemeral port that the loops can share.
+            connection::tcp_listener reserved{Address{"127.0.0.1", 0}, true};
+            port = reserved.get_local_address().get_port();
+            std::atomic<int> ready{0};
+            group.start([&](connection::event_loop& loop, size_t) {
+                auto listener = std::make_unique<connection::tcp_listener>(Address{"127.0.0.1", port}, true);
+                auto raw = listener.get();
+                loop.add(raw->get_fd(), connection::READABLE, [raw, &accepted](u32) {
+                    while (raw->accept())
+                        accepted++;
+                });
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    listeners.push_back(std::move(listener));
+                }
+                ready++;
+            });
+            while (ready < 2)
+                std::this_thread::yield();
+        }
+        std::vector<connection::tcp_stream> clients;
+        for (int i = 0; i < 8; i++)
+            clients.push_back(connection::tcp_stream::connect(Address{"127.0.0.1", port}));
+        for (int i = 0; i < 200 && accepted < 8; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        group.stop();
+        REQUIRE(accepted == 8);
+
+        // An exception thrown on a loop thread is kept for stop() instead of terminating.
+        group.start([](connection::event_loop& loop, size_t index) {
+            if (index == 1)
+                loop.post([]() { throw std::runtime_error("failed"); });
+        });
+        bool rethrown = false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        try {
+            group.stop();
+        } catch (const std::runtime_error&) {
+            rethrown = true;
+        }
+        REQUIRE(rethrown);
+    }
+}
+#endif
+
+#ifdef LAMBDA_HAS_SOCKETS
+LC_TEST_SECTION(UDPBatch)
+{
+    LC_TEST(udp_batch_loopback, "udp_send_batch/udp_receive_batch loopback") {
+        connection::udp_socket receiver{Address{"127.0.0.1", 0}};
+        connection::udp_socket sender{Address{"127.0.0.1", 0}};
+        bool gro = receiver.set_gro(true);
+        auto to = receiver.get_local_address();
+
+        // The first four datagrams can be segmented as a single message, the others are on their own.
+        connection::udp_send_batch send_batch{8};
+        std::vector<std::string> sent{"aaaa", "bbbb", "cccc", "dd", "eeeeeee", "f"};
+        for (const auto& datagram : sent)
+            REQUIRE(send_batch.add(datagram.data(), datagram.size(), to));
+        std::vector<char> too_long(connection::slab::DEFAULT_CAPACITY, 'x');
+        REQUIRE(!send_batch.add(too_long.data(), too_long.size(), to));
+        REQUIRE(send_batch.send(sender) == sent.size());
+        REQUIRE(send_batch.size() == 0);
+
+        connection::udp_receive_batch receive_batch{8, gro ? 65535u : 2048u};
+        std::vector<std::string> received;
+        for (int i = 0; i < 200 && received.size() < sent.size(); i++) {
+            if (auto count = receive_batch.receive(receiver)) {
+                for (size_t j = 0; j < *count; j++) {
+                    received.emplace_back(receive_batch.get_data(j));
+                    REQUIRE(receive_batch.get_source(j) == sender.get_local_address());
+                }
+            } else
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE(received == sent);
+        REQUIRE(!receive_batch.receive(receiver));
+    }
+}
+#endif
+
 LC_TEST_SECTION(Maths)
 {
     LC_TEST(maths_abs, "maths::abs(N a)") {
@@ -135,6 +929,1453 @@ LC_TEST_SECTION(Maths)
         REQUIRE(maths::clamp(128, 0, 255) == 128);
         REQUIRE(maths::clamp(32.f, 0.f, 1.f) == 1.f);
     }
+
+    LC_TEST(maths_constexpr, "maths constexpr functions") {
+        static_assert(maths::min(4, 2, 8, -1, 3) == -1);
+        static_assert(maths::max(4.f, 2.f, 8.f) == 8.f);
+        static_assert(maths::min({3, 1, 2}) == 1);
+        static_assert(maths::clamp(5, 0, 3) == 3);
+        static_assert(maths::abs(-3) == 3);
+        REQUIRE(maths::max(1, 9, 3, 7) == 9);
+    }
+
+    LC_TEST(maths_integer, "maths integer functions") {
+        static_assert(maths::ipow(3, 5) == 243);
+        static_assert(maths::ipow(2.0, 10) == 1024.0);
+        static_assert(maths::ipow(7, 0) == 1);
+        static_assert(maths::isqrt(99u) == 9);
+        static_assert(maths::isqrt(100) == 10);
+        static_assert(maths::isqrt(0xFFFFFFFFu) == 65535u);
+        static_assert(maths::ilog2(1) == 0);
+        static_assert(maths::ilog2(~u64(0)) == 63);
+        static_assert(maths::is_power_of_two(64) && !maths::is_power_of_two(0) && !maths::is_power_of_two(12));
+        static_assert(maths::next_power_of_two(17) == 32 && maths::next_power_of_two(16u) == 16u);
+
+        bool exact = true;
+        for (u64 value = 0; value < 100000; value += 3) {
+            u64 root = maths::isqrt(value);
+            exact = exact && root * root <= value && (root + 1) * (root + 1) > value;
+        }
+        REQUIRE(exact);
+    }
+
+    LC_TEST(maths_tables, "maths compile-time tables") {
+        static constexpr auto SINE = maths::make_sin_table<f32, 1024>();
+        static constexpr auto GAMMA = maths::make_gamma_table(2.2);
+        static_assert(SINE[0] == 0.f && SINE[256] == 1.f);
+        static_assert(GAMMA[0] == 0 && GAMMA[255] == 255);
+
+        f64 error = 0.0;
+        for (size_t i = 0; i < SINE.size(); i++)
+            error = maths::max(error, std::abs(SINE[i] - std::sin(2.0 * 3.14159265358979323846 * i / SINE.size())));
+        REQUIRE(error < 1e-7);
+        bool exact = true;
+        for (int i = 0; i < 256; i++)
+            exact = exact && GAMMA[i] == std::lround(255.0 * std::pow(i / 255.0, 2.2));
+        REQUIRE(exact);
+        REQUIRE(std::abs(maths::compile_time::exp(1.0) - std::exp(1.0)) < 1e-15);
+        REQUIRE(std::abs(maths::compile_time::log(10.0) - std::log(10.0)) < 1e-15);
+        REQUIRE(std::abs(maths::compile_time::sqrt(2.0) - std::sqrt(2.0)) < 1e-15);
+    }
+}
+
+LC_TEST_SECTION(Vec)
+{
+    LC_TEST(vec_layout, "vec<T, N> layout") {
+        REQUIRE(std::is_trivially_copyable_v<vec3f>);
+        REQUIRE(std::is_standard_layout_v<point3f>);
+        REQUIRE(sizeof(vec3f) == 3 * sizeof(float));
+        REQUIRE(alignof(vec4f) == 16);
+        REQUIRE(alignof(extent2u) == 8);
+
+        vec3f values[2] = {{1.f, 2.f, 3.f}, {4.f, 5.f, 6.f}};
+        float raw[6];
+        std::memcpy(raw, values, sizeof(values));
+        REQUIRE(raw[3] == 4.f && raw[5] == 6.f);
+    }
+
+    LC_TEST(vec_operations, "vec<T, N> operations") {
+        constexpr vec3i a{1, 2, 3};
+        constexpr vec3i b{4, 5, 6};
+        static_assert(dot(a, b) == 32);
+        static_assert(cross(a, b) == vec3i{-3, 6, -3});
+        static_assert(a + b == vec3i{5, 7, 9});
+        static_assert(vec3i::splat(2) * a == vec3i{2, 4, 6});
+        REQUIRE(a[2] == 3);
+        REQUIRE(-a == vec3i{-1, -2, -3});
+        REQUIRE((a * 2).sum() == 12);
+        REQUIRE(min(a, vec3i{0, 5, 3}) == vec3i{0, 2, 3});
+        REQUIRE(max(a, vec3i{0, 5, 3}) == vec3i{1, 5, 3});
+        REQUIRE(length(vec2f{3.f, 4.f}) == 5.f);
+        REQUIRE(normalize(vec2f{0.f, 2.f}) == vec2f{0.f, 1.f});
+        REQUIRE(a.cast<float>() == vec3f{1.f, 2.f, 3.f});
+        REQUIRE(a.to_string() == "(1;2;3)");
+
+        point3i p{1, 1, 1};
+        point3i q = p + a;
+        REQUIRE(q == point3i{2, 3, 4});
+        REQUIRE(q - p == a);
+        constexpr extent3u box{2, 3, 4};
+        static_assert(box.product() == 24);
+        REQUIRE(box.depth == 4);
+    }
+
+    LC_TEST(vec_conversions, "vec<T, N> conversions") {
+        REQUIRE(to_vec(Vector3D<float>(1.f, 2.f, 3.f)) == vec3f{1.f, 2.f, 3.f});
+        REQUIRE(to_point(Point2D<i32>(4, 5)) == point2i{4, 5});
+        REQUIRE(to_extent(Size2D<u32>(640, 480)) == extent2u{640, 480});
+        REQUIRE(to_vector3d(vec3f{1.f, 2.f, 3.f}) == Vector3D<float>(1.f, 2.f, 3.f));
+        REQUIRE(to_size2d(extent2u{640, 480}) == Size2D<u32>(640, 480));
+        REQUIRE(to_point2d(point2i{4, 5}) == Point2D<i32>(4, 5));
+    }
+}
+
+LC_TEST_SECTION(Transform)
+{
+    auto near = [](const mat4f& a, const mat4f& b) {
+        for (size_t i = 0; i < 16; i++)
+            if (std::fabs(a.data()[i] - b.data()[i]) > 1e-5f)
+                return false;
+        return true;
+    };
+
+    LC_TEST(mat4_operations, "mat4 multiply, transpose and inverse") {
+        mat4f m{{{2.f, 1.f, 0.f, 0.5f}, {0.f, 3.f, 1.f, 0.f}, {1.f, 0.f, 4.f, 1.f}, {0.2f, 1.f, 0.f, 2.f}}};
+        REQUIRE(m * mat4f::identity() == m);
+        REQUIRE(transpose(m)(0, 1) == m(1, 0));
+        REQUIRE(transpose(transpose(m)) == m);
+        REQUIRE(near(m * inverse(m), mat4f::identity()));
+        REQUIRE(std::fabs(determinant(m) - 50.1f) < 1e-4f);
+
+        mat4d md{{{2., 1., 0., 0.5}, {0., 3., 1., 0.}, {1., 0., 4., 1.}, {0.2, 1., 0., 2.}}};
+        auto product = md * inverse(md);
+        REQUIRE(std::fabs(product(2, 2) - 1.) < 1e-12 && std::fabs(product(0, 3)) < 1e-12);
+
+        auto translation = mat4f::translation({1.f, 2.f, 3.f});
+        auto scale = mat4f::scale({2.f, 2.f, 2.f});
+        // The scale applies first.
+        REQUIRE(transform_point(translation * scale, point3f{1.f, 1.f, 1.f}) == point3f{3.f, 4.f, 5.f});
+        REQUIRE(transform_vector(translation, vec3f{1.f, 1.f, 1.f}) == vec3f{1.f, 1.f, 1.f});
+        REQUIRE(transform_point(translation, Point3D<float>(0.f, 0.f, 0.f)) == Point3D<float>(1.f, 2.f, 3.f));
+        REQUIRE(affine_inverse(translation * scale) == inverse(scale) * inverse(translation));
+    }
+
+    LC_TEST(quat_operations, "quat rotate, compose and slerp") {
+        auto quarter = quatf::from_axis_angle({0.f, 0.f, 1.f}, 1.5707964f);
+        auto x = rotate(quarter, vec3f{1.f, 0.f, 0.f});
+        REQUIRE(std::fabs(x.x) < 1e-6f && std::fabs(x.y - 1.f) < 1e-6f);
+        auto y = mat3f::rotation(quarter) * vec3f{1.f, 0.f, 0.f};
+        REQUIRE(std::fabs(y.y - 1.f) < 1e-6f);
+        REQUIRE(rotate(quarter * conjugate(quarter), vec3f{1.f, 2.f, 3.f}) == vec3f{1.f, 2.f, 3.f});
+
+        auto half = slerp(quatf::identity(), quarter, 0.5f);
+        auto eighth = quatf::from_axis_angle({0.f, 0.f, 1.f}, 0.7853982f);
+        REQUIRE(std::fabs(dot(half, eighth) - 1.f) < 1e-6f);
+
+        auto rotation = normalize(quatf{0.3f, -0.5f, 0.2f, 0.8f});
+        auto composed = mat4f::compose({1.f, 2.f, 3.f}, rotation, {2.f, 0.5f, 3.f});
+        auto product = mat4f::translation({1.f, 2.f, 3.f}) * mat4f::rotation(rotation) * mat4f::scale({2.f, 0.5f, 3.f});
+        REQUIRE(near(composed, product));
+        REQUIRE(near(composed * affine_inverse(composed), mat4f::identity()));
+        auto inverse_linear = inverse(composed.to_mat3());
+        REQUIRE(std::fabs((inverse_linear * composed.to_mat3())(1, 1) - 1.f) < 1e-5f);
+    }
+}
+
+LC_TEST_SECTION(Fast)
+{
+    // Error in units in the last place of the float result, relative to the double precision function.
+    auto ulp = [](f32 result, f64 exact) {
+        auto rounded = std::fabs(static_cast<f32>(exact));
+        return std::fabs(result - exact) / static_cast<f64>(std::nextafter(rounded, std::numeric_limits<f32>::infinity()) - rounded);
+    };
+
+    LC_TEST(fast_scalar, "maths::fast scalar functions") {
+        f64 rsqrt_error = 0, trigonometric_error = 0, atan2_error = 0, exp_error = 0, log_error = 0;
+        for (f32 x = -3.14f; x < 3.14f; x += 0.001f) {
+            f32 sine, cosine;
+            maths::fast::sincos(x, sine, cosine);
+            if (std::fabs(x) > 0.01f)
+                trigonometric_error = std::max(trigonometric_error, ulp(sine, std::sin(static_cast<f64>(x))));
+            if (std::fabs(std::fabs(x) - 1.5708f) > 0.01f)
+                trigonometric_error = std::max(trigonometric_error, ulp(cosine, std::cos(static_cast<f64>(x))));
+            exp_error = std::max(exp_error, ulp(maths::fast::exp(x * 25.f), std::exp(static_cast<f64>(x * 25.f))));
+            atan2_error = std::max(atan2_error, ulp(maths::fast::atan2(x, 0.7f), std::atan2(static_cast<f64>(x), 0.7)));
+            atan2_error = std::max(atan2_error, ulp(maths::fast::atan2(0.3f, x), std::atan2(0.3, static_cast<f64>(x))));
+        }
+        for (f32 x = 1e-30f; x < 1e30f; x *= 1.01f) {
+            rsqrt_error = std::max(rsqrt_error, ulp(maths::fast::rsqrt(x), 1. / std::sqrt(static_cast<f64>(x))));
+            log_error = std::max(log_error, ulp(maths::fast::log(x), std::log(static_cast<f64>(x))));
+        }
+        REQUIRE(rsqrt_error <= 5.);
+        REQUIRE(trigonometric_error <= 2.);
+        REQUIRE(atan2_error <= 4.);
+        REQUIRE(exp_error <= 2.);
+        REQUIRE(log_error <= 1.);
+
+        REQUIRE(std::fabs(maths::fast::sin(8000.f) - std::sin(8000.)) < 1e-7);
+        REQUIRE(maths::fast::atan2(0.f, -0.f) == maths::fast::atan2(0.f, -1.f));
+        REQUIRE(maths::fast::atan2(0.f, 0.f) == 0.f);
+        REQUIRE(std::isinf(maths::fast::exp(100.f)));
+        REQUIRE(maths::fast::exp(-200.f) == 0.f);
+        REQUIRE(maths::fast::log(1.f) == 0.f);
+        REQUIRE(std::isnan(maths::fast::log(-1.f)));
+        REQUIRE(maths::fast::log(0.f) == -std::numeric_limits<f32>::infinity());
+        REQUIRE(std::fabs(maths::fast::log(1e-40f) - std::log(1e-40)) < 1e-5);
+
+        static_assert(maths::radians(180.f) == static_cast<f32>(LCOMMON_PI));
+        static_assert(maths::degrees(maths::radians(90.0)) == 90.0);
+        REQUIRE(Vector3D<f32>(2.f, 3.f, 6.f).get_standard() == 7.f);
+        REQUIRE(Vector2D<i32>(3, 4).get_standard() == 5);
+    }
+
+    LC_TEST(fast_batch, "maths::fast batch kernels at every supported SIMD level") {
+        // 100 values leave a tail for every register width.
+        std::vector<f32> angles, positives;
+        for (int i = 0; i < 100; i++) {
+            angles.push_back(static_cast<f32>(i - 50) * 0.13f);
+            positives.push_back(static_cast<f32>(i) * 0.37f + 0.01f);
+        }
+
+        auto supported = maths::get_supported_simd_level();
+        for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+            if (level > supported || maths::set_simd_level(level) != level)
+                continue;
+            std::vector<f32> rsqrt(100), sqrt(100), sine(100), cosine(100), atan2(100), exp(100), log(100);
+            maths::fast::rsqrt(positives.data(), rsqrt.data(), 100);
+            maths::fast::sqrt(positives.data(), sqrt.data(), 100);
+            maths::fast::sincos(angles.data(), sine.data(), cosine.data(), 100);
+            maths::fast::atan2(angles.data(), positives.data(), atan2.data(), 100);
+            maths::fast::exp(angles.data(), exp.data(), 100);
+            maths::fast::log(positives.data(), log.data(), 100);
+            bool valid = true;
+            for (size_t i = 0; i < 100; i++) {
+                f64 angle = angles[i], positive = positives[i];
+                valid &= ulp(rsqrt[i], 1. / std::sqrt(positive)) <= 5.;
+                valid &= sqrt[i] == std::sqrt(positives[i]);
+                valid &= std::fabs(sine[i] - std::sin(angle)) <= 1e-7 && std::fabs(cosine[i] - std::cos(angle)) <= 1e-7;
+                valid &= ulp(atan2[i], std::atan2(angle, positive)) <= 4.;
+                valid &= ulp(exp[i], std::exp(angle)) <= 2.;
+                valid &= ulp(log[i], std::log(positive)) <= 1.;
+            }
+            REQUIRE(valid);
+
+            // In place.
+            auto values = angles;
+            maths::fast::sin(values.data(), values.data(), 100);
+            REQUIRE(values[99] == sine[99]);
+        }
+        maths::set_simd_level(supported);
+    }
+}
+
+LC_TEST_SECTION(SoA)
+{
+    LC_TEST(soa_kernels, "vec3_soa batch kernels at every supported SIMD level") {
+        // 37 vectors leave a tail for every register width.
+        maths::vec3_soa<f32> a, b;
+        for (int i = 0; i < 37; i++) {
+            a.push_back({static_cast<f32>(i) + 1.f, static_cast<f32>(i % 5) - 2.f, 0.5f * static_cast<f32>(i)});
+            b.push_back({2.f - static_cast<f32>(i % 7), static_cast<f32>(i) * 0.25f, 3.f});
+        }
+        auto close = [](f32 x, f32 y) { return std::fabs(x - y) <= 1e-4f * std::max(1.f, std::fabs(y)); };
+
+        auto supported = maths::get_supported_simd_level();
+        for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+            if (level > supported || maths::set_simd_level(level) != level)
+                continue;
+            maths::vec3_soa<f32> sum, difference, scaled, product, normalized;
+            std::vector<f32> dots, lengths, distances;
+            maths::add(a, b, sum);
+            maths::sub(a, b, difference);
+            maths::scale(a, 2.f, scaled);
+            maths::cross(a, b, product);
+            maths::normalize(a, normalized);
+            maths::dot(a, b, dots);
+            maths::length(a, lengths);
+            maths::distance(a, b, distances);
+            REQUIRE(sum.size() == a.size() && dots.size() == a.size());
+            bool valid = true;
+            for (size_t i = 0; i < a.size(); i++) {
+                auto u = a.get(i), v = b.get(i);
+                valid &= sum.get(i) == u + v && difference.get(i) == u - v && scaled.get(i) == u * 2.f && product.get(i) == cross(u, v);
+                valid &= close(dots[i], dot(u, v)) && close(lengths[i], length(u)) && close(distances[i], length(u - v));
+                auto n = normalize(u);
+                valid &= close(normalized.get(i).x, n.x) && close(normalized.get(i).y, n.y) && close(normalized.get(i).z, n.z);
+            }
+            REQUIRE(valid);
+
+            // The output may be an input.
+            maths::vec3_soa<f32> in_place = a;
+            maths::cross(in_place, b, in_place);
+            REQUIRE(in_place.get(36) == cross(a.get(36), b.get(36)));
+            REQUIRE(in_place.get(3) == cross(a.get(3), b.get(3)));
+        }
+        maths::set_simd_level(supported);
+        REQUIRE(maths::get_simd_level() == supported);
+
+        bool mismatch = false;
+        b.resize(36);
+        maths::vec3_soa<f32> sum;
+        try {
+            maths::add(a, b, sum);
+        } catch (const std::invalid_argument&) {
+            mismatch = true;
+        }
+        REQUIRE(mismatch && sum.empty());
+    }
+
+    LC_TEST(soa_transforms, "batch transforms at every supported SIMD level") {
+        auto matrix = mat4f::compose({1.f, -2.f, 3.f}, normalize(quatf{0.3f, -0.5f, 0.2f, 0.8f}), {2.f, 0.5f, 3.f});
+        maths::vec3_soa<f32> points;
+        std::vector<point3f> aos;
+        std::vector<mat4f> matrices;
+        for (int i = 0; i < 37; i++) {
+            points.push_back({static_cast<f32>(i), static_cast<f32>(i % 4), -static_cast<f32>(i % 9)});
+            aos.push_back({static_cast<f32>(i), static_cast<f32>(i % 4), -static_cast<f32>(i % 9)});
+            matrices.push_back(mat4f::translation({static_cast<f32>(i), 1.f, 0.f}) * mat4f::scale({1.f, static_cast<f32>(i), 2.f}));
+        }
+        auto close = [](const vec3f& a, const vec3f& b) { return length(a - b) <= 1e-4f * std::max(1.f, length(b)); };
+
+        auto supported = maths::get_supported_simd_level();
+        for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+            if (level > supported || maths::set_simd_level(level) != level)
+                continue;
+            maths::vec3_soa<f32> transformed, directions;
+            maths::transform_points(matrix, points, transformed);
+            maths::transform_vectors(matrix, points, directions);
+            std::vector<mat4f> products(matrices.size()), pairwise(matrices.size());
+            maths::multiply(matrix, matrices.data(), products.data(), matrices.size());
+            maths::multiply(matrices.data(), matrices.data(), pairwise.data(), matrices.size());
+            bool valid = true;
+            for (size_t i = 0; i < points.size(); i++) {
+                auto p = points.get(i);
+                auto expected = transform_point(matrix, point3f{p.x, p.y, p.z});
+                valid &= close(transformed.get(i), {expected.x, expected.y, expected.z});
+                valid &= close(directions.get(i), transform_vector(matrix, p));
+                for (size_t column = 0; column < 4; column++) {
+                    valid &= length(products[i][column] - (matrix * matrices[i])[column]) < 1e-4f * length(products[i][column]) + 1e-5f;
+                    valid &= pairwise[i][column] == (matrices[i] * matrices[i])[column];
+                }
+            }
+            REQUIRE(valid);
+        }
+        maths::set_simd_level(supported);
+
+        std::vector<point3f> transformed(aos.size());
+        maths::transform_points(matrix, aos.data(), transformed.data(), aos.size());
+        REQUIRE(transformed[5] == transform_point(matrix, aos[5]));
+    }
+}
+
+LC_TEST_SECTION(Spatial)
+{
+    std::vector<point3f> random_points(size_t count, u32 seed) {
+        std::mt19937 random{seed};
+        std::uniform_real_distribution<f32> coordinate{-100.f, 100.f};
+        std::vector<point3f> points(count);
+        for (auto& p : points)
+            p = {coordinate(random), coordinate(random), coordinate(random)};
+        return points;
+    }
+
+    // The reference answers, sorted by distance then index.
+    std::vector<size_t> brute_k_nearest(const std::vector<point3f>& points, const point3f& q, size_t k) {
+        std::vector<std::pair<f32, size_t>> all;
+        for (size_t i = 0; i < points.size(); i++)
+            all.emplace_back(length_squared(points[i] - q), i);
+        std::sort(all.begin(), all.end());
+        std::vector<size_t> result;
+        for (size_t i = 0; i < k && i < all.size(); i++)
+            result.push_back(all[i].second);
+        return result;
+    }
+
+    std::vector<size_t> brute_radius(const std::vector<point3f>& points, const point3f& q, f32 radius) {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < points.size(); i++)
+            if (length_squared(points[i] - q) <= radius * radius)
+                result.push_back(i);
+        return result;
+    }
+
+    std::vector<size_t> sorted(std::vector<size_t> values) {
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    LC_TEST(spatial_aabb, "aabb operations") {
+        constexpr maths::spatial::aabb3f box{{0.f, 0.f, 0.f}, {2.f, 1.f, 3.f}};
+        static_assert(box.contains(point3f{1.f, 1.f, 1.f}) && !box.contains(point3f{-1.f, 0.f, 0.f}));
+        static_assert(box.surface_area() == 22.f);
+        static_assert(box.distance_squared({4.f, 0.f, 4.f}) == 5.f);
+        static_assert(box.intersects({{2.f, 1.f, 3.f}, {5.f, 5.f, 5.f}}));
+        static_assert(maths::spatial::aabb3f::empty().is_empty());
+        auto grown = maths::spatial::aabb3f::empty();
+        grown.expand(point3f{1.f, 2.f, 3.f});
+        grown.expand(point3f{-1.f, 0.f, 5.f});
+        REQUIRE(grown == (maths::spatial::aabb3f{{-1.f, 0.f, 3.f}, {1.f, 2.f, 5.f}}));
+        REQUIRE(grown.center() == point3f{0.f, 1.f, 4.f});
+    }
+
+    LC_TEST(spatial_kd_tree, "kd_tree queries") {
+        auto points = random_points(2000, 42);
+        auto queries = random_points(300, 7);
+        maths::spatial::kd_tree3f tree{points};
+        REQUIRE(tree.size() == points.size());
+        REQUIRE(maths::spatial::kd_tree3f{}.nearest(queries[0]) == maths::spatial::npos);
+        bool exact = true;
+        std::vector<size_t> found;
+        for (auto& q : queries) {
+            exact = exact && tree.nearest(q) == brute_k_nearest(points, q, 1)[0];
+            tree.k_nearest(q, 10, found);
+            exact = exact && found == brute_k_nearest(points, q, 10);
+            tree.radius(q, 20.f, found);
+            exact = exact && sorted(found) == brute_radius(points, q, 20.f);
+        }
+        REQUIRE(exact);
+
+        maths::spatial::aabb3f box{{-10.f, -50.f, 0.f}, {30.f, 0.f, 40.f}};
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < points.size(); i++)
+            if (box.contains(points[i]))
+                expected.push_back(i);
+        tree.box(box, found);
+        REQUIRE(sorted(found) == expected);
+        tree.k_nearest(queries[0], points.size() + 5, found);
+        REQUIRE(found.size() == points.size());
+
+        system::thread_pool pool{4};
+        std::vector<size_t> nearest(queries.size()), k_nearest(queries.size() * 4);
+        tree.nearest(pool, queries.data(), queries.size(), nearest.data());
+        tree.k_nearest(pool, queries.data(), queries.size(), 4, k_nearest.data());
+        std::vector<std::vector<size_t>> radii;
+        tree.radius(pool, queries.data(), queries.size(), 15.f, radii);
+        for (size_t i = 0; i < queries.size(); i++) {
+            exact = exact && nearest[i] == tree.nearest(queries[i]);
+            exact = exact && std::vector<size_t>(k_nearest.begin() + i * 4, k_nearest.begin() + i * 4 + 4) == brute_k_nearest(points, queries[i], 4);
+            exact = exact && sorted(radii[i]) == brute_radius(points, queries[i], 15.f);
+        }
+        REQUIRE(exact);
+    }
+
+    LC_TEST(spatial_hash, "spatial_hash queries and updates") {
+        auto points = random_points(2000, 42);
+        auto queries = random_points(300, 7);
+        maths::spatial::spatial_hash3f grid{10.f};
+        for (size_t i = 0; i < points.size(); i++)
+            grid.insert(i, points[i]);
+        REQUIRE(grid.size() == points.size());
+        bool exact = true;
+        std::vector<size_t> found;
+        for (auto& q : queries) {
+            grid.radius(q, 12.f, found);
+            exact = exact && sorted(found) == brute_radius(points, q, 12.f);
+            grid.k_nearest(q, 5, found);
+            exact = exact && found == brute_k_nearest(points, q, 5);
+        }
+        REQUIRE(exact);
+
+        // Moves every point, some within their cell and some across cells.
+        for (size_t i = 0; i < points.size(); i++) {
+            points[i] = points[i] + vec3f{static_cast<f32>(i % 3), -static_cast<f32>(i % 7) * 2.f, 0.5f};
+            grid.update(i, points[i]);
+        }
+        REQUIRE(grid.size() == points.size());
+        for (auto& q : queries) {
+            grid.radius(q, 12.f, found);
+            exact = exact && sorted(found) == brute_radius(points, q, 12.f);
+        }
+        REQUIRE(exact);
+
+        REQUIRE(grid.remove(7));
+        REQUIRE(!grid.remove(7));
+        grid.radius(points[7], 0.f, found);
+        REQUIRE(std::find(found.begin(), found.end(), 7) == found.end());
+        grid.clear();
+        grid.k_nearest(queries[0], 3, found);
+        REQUIRE(grid.empty() && found.empty());
+    }
+
+    LC_TEST(spatial_bvh, "bvh queries and refit") {
+        auto points = random_points(2000, 42);
+        auto queries = random_points(300, 7);
+        std::vector<maths::spatial::aabb3f> boxes;
+        for (size_t i = 0; i < points.size(); i++)
+            boxes.push_back(maths::spatial::aabb3f::around(points[i], static_cast<f32>(i % 5) + 0.5f));
+        maths::spatial::bvh3f hierarchy{boxes};
+        REQUIRE(hierarchy.size() == boxes.size());
+
+        auto check = [&]() {
+            bool exact = true;
+            std::vector<size_t> found, expected;
+            for (auto& q : queries) {
+                auto area = maths::spatial::aabb3f::around(q, 8.f);
+                expected.clear();
+                for (size_t i = 0; i < boxes.size(); i++)
+                    if (boxes[i].intersects(area))
+                        expected.push_back(i);
+                hierarchy.query(area, found);
+                exact = exact && sorted(found) == expected;
+
+                expected.clear();
+                for (size_t i = 0; i < boxes.size(); i++)
+                    if (boxes[i].contains(q))
+                        expected.push_back(i);
+                hierarchy.query(q, found);
+                exact = exact && sorted(found) == expected;
+
+                std::vector<std::pair<f32, size_t>> distances;
+                for (size_t i = 0; i < boxes.size(); i++)
+                    distances.emplace_back(boxes[i].distance_squared(q), i);
+                std::sort(distances.begin(), distances.end());
+                hierarchy.k_nearest(q, 6, found);
+                for (size_t i = 0; i < 6; i++)
+                    exact = exact && boxes[found[i]].distance_squared(q) == distances[i].first;
+            }
+            return exact;
+        };
+        REQUIRE(check());
+
+        for (auto& box : boxes) {
+            box.min = box.min + vec3f{5.f, 0.f, -3.f};
+            box.max = box.max + vec3f{6.f, 1.f, -3.f};
+        }
+        hierarchy.refit(boxes.data());
+        REQUIRE(check());
+
+        system::thread_pool pool{4};
+        std::vector<maths::spatial::aabb3f> areas;
+        for (auto& q : queries)
+            areas.push_back(maths::spatial::aabb3f::around(q, 8.f));
+        std::vector<std::vector<size_t>> results;
+        hierarchy.query(pool, areas.data(), areas.size(), results);
+        bool exact = results.size() == areas.size();
+        std::vector<size_t> found;
+        for (size_t i = 0; i < areas.size(); i++) {
+            hierarchy.query(areas[i], found);
+            exact = exact && results[i] == found;
+        }
+        REQUIRE(exact);
+    }
+}
+
+LC_TEST_SECTION(Intersection)
+{
+    LC_TEST(intersection_single, "ray intersection tests") {
+        constexpr f32 INFINITY_F = std::numeric_limits<f32>::infinity();
+        maths::ray3f ray{{0.f, 0.f, -5.f}, {0.f, 0.f, 2.f}};
+        REQUIRE(ray.at(1.f) == point3f{0.f, 0.f, -3.f});
+        REQUIRE(maths::intersect(ray, maths::spatial::aabb3f{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}}) == 2.f);
+        REQUIRE(maths::intersect(ray, maths::spatial::aabb3f{{2.f, -1.f, -1.f}, {3.f, 1.f, 1.f}}) == INFINITY_F);
+        REQUIRE(maths::intersect({{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}}, maths::spatial::aabb3f{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}}) == 0.f);
+        // A ray starting on the plane of a face it is parallel to.
+        REQUIRE(maths::intersect({{1.f, 0.f, -5.f}, {0.f, 0.f, 1.f}}, maths::spatial::aabb3f{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}}) == 4.f);
+        REQUIRE(maths::intersect({{0.f, 0.f, -5.f}, {0.f, 0.f, 1.f}, 3.f}, maths::spatial::aabb3f{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}}) == INFINITY_F);
+
+        REQUIRE(maths::intersect(ray, {-1.f, -1.f, 1.f}, {1.f, -1.f, 1.f}, {0.f, 1.f, 1.f}) == 3.f);
+        REQUIRE(maths::intersect(ray, {1.f, -1.f, 1.f}, {-1.f, -1.f, 1.f}, {0.f, 1.f, 1.f}) == 3.f);
+        REQUIRE(maths::intersect(ray, {1.f, 1.f, 1.f}, {3.f, 1.f, 1.f}, {2.f, 3.f, 1.f}) == INFINITY_F);
+        REQUIRE(maths::intersect(ray, {-1.f, -1.f, -6.f}, {1.f, -1.f, -6.f}, {0.f, 1.f, -6.f}) == INFINITY_F);
+
+        REQUIRE(maths::intersect(ray, {0.f, 0.f, 0.f}, 1.f) == 2.f);
+        REQUIRE(maths::intersect(ray, {0.f, 0.f, -5.f}, 1.f) == 0.f);
+        REQUIRE(maths::intersect(ray, {0.f, 0.f, -10.f}, 1.f) == INFINITY_F);
+        REQUIRE(maths::intersect(ray, {0.f, 3.f, 0.f}, 1.f) == INFINITY_F);
+
+        auto from_objects = maths::to_ray(Point3D<f32>{1.f, 2.f, 3.f}, Vector3D<f32>{0.f, 1.f, 0.f});
+        REQUIRE(from_objects.origin == point3f{1.f, 2.f, 3.f} && from_objects.direction == vec3f{0.f, 1.f, 0.f});
+    }
+
+    LC_TEST(intersection_batch, "ray intersection batch kernels at every supported SIMD level") {
+        std::mt19937 random{3};
+        std::uniform_real_distribution<f32> coordinate{-10.f, 10.f};
+        auto random_point = [&]() { return point3f{coordinate(random), coordinate(random), coordinate(random)}; };
+
+        // 37 shapes leave a tail for every register width.
+        maths::aabb_soa boxes;
+        maths::triangle_soa triangles;
+        maths::sphere_soa spheres;
+        maths::ray_soa rays;
+        std::vector<maths::spatial::aabb3f> box_list;
+        std::vector<std::array<point3f, 3>> triangle_list;
+        std::vector<std::pair<point3f, f32>> sphere_list;
+        for (int i = 0; i < 37; i++) {
+            auto corner = random_point();
+            box_list.push_back({corner, corner + vec3f{3.f, 2.f, 4.f}});
+            boxes.push_back(box_list.back());
+            triangle_list.push_back({random_point(), random_point(), random_point()});
+            triangles.push_back(triangle_list.back()[0], triangle_list.back()[1], triangle_list.back()[2]);
+            sphere_list.emplace_back(random_point(), 1.f + static_cast<f32>(i % 4));
+            spheres.push_back(sphere_list.back().first, sphere_list.back().second);
+            rays.push_back({random_point(), vec3f{coordinate(random), coordinate(random), i % 5 ? coordinate(random) : 0.f}, i % 3 ? 30.f : 1.f});
+        }
+        maths::spatial::aabb3f box{{-4.f, -4.f, -4.f}, {4.f, 5.f, 6.f}};
+        auto close = [](f32 x, f32 y) { return x == y || std::fabs(x - y) <= 1e-4f * std::max(1.f, std::fabs(y)); };
+
+        bool valid = true;
+        size_t hits = 0;
+        auto supported = maths::get_supported_simd_level();
+        for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+            if (level > supported || maths::set_simd_level(level) != level)
+                continue;
+            std::vector<f32> out;
+            for (size_t r = 0; r < rays.size(); r++) {
+                auto ray = rays.get(r);
+                maths::intersect(ray, boxes, out);
+                for (size_t i = 0; i < box_list.size(); i++)
+                    valid = valid && close(out[i], maths::intersect(ray, box_list[i]));
+                maths::intersect(ray, triangles, out);
+                for (size_t i = 0; i < triangle_list.size(); i++) {
+                    valid = valid && close(out[i], maths::intersect(ray, triangle_list[i][0], triangle_list[i][1], triangle_list[i][2]));
+                    hits += out[i] != std::numeric_limits<f32>::infinity();
+                }
+                maths::intersect(ray, spheres, out);
+                for (size_t i = 0; i < sphere_list.size(); i++)
+                    valid = valid && close(out[i], maths::intersect(ray, sphere_list[i].first, sphere_list[i].second));
+            }
+            maths::intersect(rays, box, out);
+            for (size_t r = 0; r < rays.size(); r++)
+                valid = valid && close(out[r], maths::intersect(rays.get(r), box));
+        }
+        maths::set_simd_level(supported);
+        REQUIRE(valid);
+        REQUIRE(hits > 0);
+    }
+}
+
+LC_TEST_SECTION(Random)
+{
+    template<typename Sample>
+    std::pair<f64, f64> mean_variance(Sample sample, size_t count) {
+        f64 sum = 0, squares = 0;
+        for (size_t i = 0; i < count; i++) {
+            f64 value = sample();
+            sum += value;
+            squares += value * value;
+        }
+        f64 mean = sum / count;
+        return {mean, squares / count - mean * mean};
+    }
+
+    LC_TEST(random_generators, "Random generators") {
+        maths::random::xoshiro256pp xoshiro{1, 2, 3, 4};
+        REQUIRE(xoshiro() == 41943041);
+        REQUIRE(xoshiro() == 58720359);
+
+        maths::random::pcg64 pcg{42, 54};
+        REQUIRE(pcg() == 0x86B1DA1D72062B68ull);
+        REQUIRE(pcg() == 0x1304AA46C9853D39ull);
+
+        maths::random::pcg64 skipped{42, 54};
+        skipped.advance(2);
+        REQUIRE(skipped == pcg);
+        for (int i = 0; i < 1000; i++)
+            pcg();
+        skipped.advance(1000);
+        REQUIRE(skipped == pcg);
+        REQUIRE(skipped() == pcg());
+        REQUIRE(maths::random::pcg64(42, 55)() != maths::random::pcg64(42, 54)());
+
+        maths::random::xoshiro256pp a{7}, b{7};
+        a.jump();
+        REQUIRE(a != b);
+        b.jump();
+        REQUIRE(a == b);
+        b.long_jump();
+        REQUIRE(a != b);
+
+        constexpr auto first = [] {
+            maths::random::xoshiro256pp generator{1, 2, 3, 4};
+            return generator();
+        }();
+        REQUIRE(first == 41943041);
+    }
+
+    LC_TEST(random_x8, "xoshiro256pp_x8 lanes") {
+        // The interleaved output must be the 8 lanes jumped from the seed generator, at every instruction set and however it is drawn.
+        std::vector<maths::random::xoshiro256pp> lanes;
+        maths::random::xoshiro256pp base{2019};
+        for (int i = 0; i < 8; i++) {
+            lanes.push_back(base);
+            base.jump();
+        }
+        std::vector<u64> expected(8 * 300);
+        for (size_t i = 0; i < expected.size(); i++)
+            expected[i] = lanes[i % 8]();
+
+        bool valid = true;
+        auto supported = maths::get_supported_simd_level();
+        for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+            if (level > supported || maths::set_simd_level(level) != level)
+                continue;
+            maths::random::xoshiro256pp_x8 generator{2019};
+            std::vector<u64> out(expected.size());
+            out[0] = generator();
+            out[1] = generator();
+            generator.fill(out.data() + 2, 27);
+            generator.fill(out.data() + 29, 1000);
+            for (size_t i = 1029; i < out.size(); i++)
+                out[i] = generator();
+            valid = valid && out == expected;
+
+            maths::random::xoshiro256pp_x8 bulk{2019};
+            bulk.fill(out.data(), out.size());
+            valid = valid && out == expected;
+        }
+        maths::set_simd_level(supported);
+        REQUIRE(valid);
+    }
+
+    LC_TEST(random_distributions, "Random distributions") {
+        maths::random::xoshiro256pp generator{42};
+        for (int i = 0; i < 10000; i++) {
+            auto value = maths::random::uniform_int(generator, -3, 5);
+            REQUIRE(value >= -3 && value <= 5);
+            auto byte = maths::random::uniform_int<u8>(generator, 250, 255);
+            REQUIRE(byte >= 250);
+            auto real = maths::random::uniform_f32(generator);
+            REQUIRE(real >= 0.f && real < 1.f);
+        }
+        REQUIRE(maths::random::uniform_int<u64>(generator, 0, std::numeric_limits<u64>::max()) != maths::random::uniform_int<u64>(generator, 0, std::numeric_limits<u64>::max()));
+
+        auto uniform = mean_variance([&] { return maths::random::uniform_f64(generator); }, 200000);
+        REQUIRE(std::abs(uniform.first - 0.5) < 0.005 && std::abs(uniform.second - 1.0 / 12) < 0.002);
+        auto dice = mean_variance([&] { return maths::random::uniform_int(generator, 1, 6); }, 200000);
+        REQUIRE(std::abs(dice.first - 3.5) < 0.02 && std::abs(dice.second - 35.0 / 12) < 0.03);
+        auto normal = mean_variance([&] { return maths::random::normal(generator, 2.0, 3.0); }, 200000);
+        REQUIRE(std::abs(normal.first - 2.0) < 0.03 && std::abs(normal.second - 9.0) < 0.1);
+        auto exponential = mean_variance([&] { return maths::random::exponential(generator, 2.0); }, 200000);
+        REQUIRE(std::abs(exponential.first - 0.5) < 0.005 && std::abs(exponential.second - 0.25) < 0.005);
+
+        size_t tail = 0;
+        for (int i = 0; i < 200000; i++)
+            tail += std::abs(maths::random::normal(generator)) > 3.0;
+        // 2 * (1 - Φ(3)) = 0.27%
+        REQUIRE(tail > 400 && tail < 700);
+
+        maths::random::xoshiro256pp_x8 x8{42};
+        std::vector<f32> values(100000);
+        x8.fill_normal(values.data(), values.size(), 1.f, 0.5f);
+        size_t index = 0;
+        auto bulk = mean_variance([&] { return values[index++]; }, values.size());
+        REQUIRE(std::abs(bulk.first - 1.0) < 0.01 && std::abs(bulk.second - 0.25) < 0.01);
+        x8.fill_uniform(values.data(), values.size());
+        REQUIRE(std::all_of(values.begin(), values.end(), [](f32 value) { return value >= 0.f && value < 1.f; }));
+    }
+
+    LC_TEST(random_sampling, "Random sampling") {
+        maths::random::pcg64 generator{7};
+        bool valid = true;
+        for (int i = 0; i < 1000; i++) {
+            auto p = maths::random::uniform_point(generator, point3f{-1.f, 2.f, 3.f}, point3f{1.f, 4.f, 3.5f});
+            valid = valid && p.x >= -1.f && p.x < 1.f && p.y >= 2.f && p.y < 4.f && p.z >= 3.f && p.z < 3.5f;
+            auto object = maths::random::uniform_point(generator, Point2D<f32>{0.f, 0.f}, Point2D<f32>{2.f, 1.f});
+            valid = valid && object.get_x() >= 0.f && object.get_x() < 2.f && object.get_y() >= 0.f && object.get_y() < 1.f;
+            valid = valid && std::abs(length(maths::random::unit_vector2(generator)) - 1.f) < 1e-5f;
+            valid = valid && std::abs(length(maths::random::unit_vector3(generator)) - 1.f) < 1e-5f;
+            auto disk = maths::random::in_unit_disk(generator);
+            valid = valid && disk.x * disk.x + disk.y * disk.y <= 1.f + 1e-5f;
+            auto ball = maths::random::in_unit_ball<f64>(generator);
+            valid = valid && ball.x * ball.x + ball.y * ball.y + ball.z * ball.z <= 1.0 + 1e-12;
+        }
+        REQUIRE(valid);
+
+        std::normal_distribution<f64> standard;
+        REQUIRE(std::isfinite(standard(generator)));
+    }
+}
+
+LC_TEST_SECTION(Parallel)
+{
+    LC_TEST(parallel_span, "span") {
+        std::vector<f32> values{1.f, 2.f, 3.f, 4.f};
+        maths::span view{values};
+        maths::span<const f32> read_only = view;
+        REQUIRE(read_only.size() == 4 && read_only[2] == 3.f);
+        REQUIRE(view.subspan(1, 2).size() == 2 && view.subspan(1, 2)[0] == 2.f);
+        REQUIRE(view.subspan(3).size() == 1);
+        i32 array[3] = {4, 5, 6};
+        REQUIRE(std::accumulate(maths::span(array).begin(), maths::span(array).end(), 0) == 15);
+    }
+
+    LC_TEST(parallel_reductions, "Parallel reductions") {
+        std::mt19937 random{69};
+        std::uniform_real_distribution<f32> distribution{-1000.f, 1000.f};
+        std::vector<f32> values(100003);
+        for (auto& value : values)
+            value = distribution(random);
+        values[77777] = std::numeric_limits<f32>::quiet_NaN();
+        maths::span<const f32> view{values.data(), values.size()};
+        auto finite = view.subspan(0, 77777);
+
+        f64 exact = 0, magnitude = 0;
+        for (f32 value : finite) {
+            exact += value;
+            magnitude += std::abs(value);
+        }
+        auto total = maths::parallel::sum(finite);
+        REQUIRE(std::abs(total - exact) < 1e-6 * magnitude);
+
+        f32 smallest = std::numeric_limits<f32>::infinity(), largest = -smallest;
+        for (f32 value : values)
+            if (!std::isnan(value)) {
+                smallest = std::min(smallest, value);
+                largest = std::max(largest, value);
+            }
+
+        // The results do not depend on the count of threads.
+        bool valid = true;
+        for (u32 threads : {1u, 2u, 3u, 5u}) {
+            system::thread_pool pool{threads};
+            valid = valid && maths::parallel::sum(pool, finite) == total;
+            valid = valid && maths::parallel::mean(pool, finite) == maths::parallel::mean(finite);
+            valid = valid && maths::parallel::min(pool, view) == smallest;
+            valid = valid && maths::parallel::max(pool, view) == largest;
+        }
+        REQUIRE(valid);
+
+        auto range = maths::parallel::min_max(view);
+        REQUIRE(range.first == maths::parallel::min(view) && range.second == maths::parallel::max(view));
+        REQUIRE(std::abs(maths::parallel::dot(finite, finite) - maths::parallel::transform_sum(finite, [](f32 x) { return x * x; })) < 1.f);
+
+        std::vector<i64> integers(50000);
+        std::iota(integers.begin(), integers.end(), 1);
+        REQUIRE(maths::parallel::sum(maths::span(integers)) == 50000ll * 50001 / 2);
+        REQUIRE(maths::parallel::mean(maths::span(integers)) == 25000.5);
+        REQUIRE(maths::parallel::min(maths::span(integers)) == 1);
+
+        // An exception of the calling thread is only propagated once the other tasks ended.
+        std::atomic<size_t> calls{0};
+        system::thread_pool throwing_pool{3};
+        size_t calls_at_throw = 0;
+        try {
+            maths::parallel::transform_sum(throwing_pool, maths::span(integers), [&](i64 value) {
+                if (value == 1)
+                    throw std::runtime_error("first element");
+                calls++;
+                return value;
+            });
+        } catch (const std::runtime_error&) {
+            calls_at_throw = calls.load();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        REQUIRE(calls_at_throw > 0 && calls.load() == calls_at_throw);
+
+        maths::span<const f32> empty;
+        REQUIRE(maths::parallel::sum(empty) == 0.f);
+        REQUIRE(std::isnan(maths::parallel::mean(empty)));
+        REQUIRE(maths::parallel::min(empty) == std::numeric_limits<f32>::infinity());
+    }
+
+    LC_TEST(parallel_histogram, "Parallel histogram") {
+        std::vector<f64> values;
+        for (int i = 0; i < 30000; i++)
+            values.push_back(i % 10 + 0.5);
+        values.push_back(10.0);
+        values.push_back(-1.0);
+        values.push_back(std::numeric_limits<f64>::quiet_NaN());
+        auto bins = maths::parallel::histogram(maths::span(values), 0.0, 10.0, 5);
+        REQUIRE(bins.size() == 5);
+        REQUIRE(bins[0] == 6000 && bins[3] == 6000 && bins[4] == 6001);
+        system::thread_pool pool{3};
+        REQUIRE(maths::parallel::histogram(pool, maths::span(values), 0.0, 10.0, 5) == bins);
+    }
+
+    LC_TEST(parallel_transforms, "Parallel transforms") {
+        std::vector<f32> a(20000), b(20000), out(20000);
+        std::iota(a.begin(), a.end(), 0.f);
+        std::iota(b.begin(), b.end(), 1.f);
+        maths::parallel::transform(maths::span(a), maths::span(out), [](f32 x) { return x * 2.f; });
+        REQUIRE(out[12345] == 24690.f);
+        maths::parallel::transform(maths::span(a), maths::span(b), maths::span(out), [](f32 x, f32 y) { return y - x; });
+        REQUIRE(std::all_of(out.begin(), out.end(), [](f32 value) { return value == 1.f; }));
+        maths::parallel::transform(maths::span(a), maths::span(a), [](f32 x) { return -x; });
+        REQUIRE(a[19999] == -19999.f);
+
+        // Mismatched sizes and short outputs are rejected instead of truncated or overflowed.
+        int rejected = 0;
+        std::vector<f32> shorter(100);
+        auto expect_invalid = [&rejected](auto func) {
+            try {
+                func();
+            } catch (const std::invalid_argument&) {
+                rejected++;
+            }
+        };
+        expect_invalid([&]() { maths::parallel::transform(maths::span(a), maths::span(shorter), [](f32 x) { return x; }); });
+        expect_invalid([&]() { maths::parallel::transform(maths::span(a), maths::span(shorter), maths::span(out), [](f32 x, f32) { return x; }); });
+        expect_invalid([&]() { maths::parallel::transform(maths::span(a), maths::span(b), maths::span(shorter), [](f32 x, f32) { return x; }); });
+        expect_invalid([&]() { maths::parallel::dot(maths::span(a), maths::span(shorter)); });
+        REQUIRE(rejected == 4);
+    }
+}
+
+LC_TEST_SECTION(Fixed)
+{
+    template<typename Fixed>
+    std::vector<Fixed> random_fixed(size_t count, u32 seed) {
+        std::mt19937 random{seed};
+        std::vector<Fixed> values;
+        for (size_t i = 0; i < count; i++) {
+            // Mostly small numbers whose products fit, some large ones which overflow.
+            auto raw = static_cast<i32>(random());
+            values.push_back(Fixed::from_raw(i % 3 == 0 ? raw : raw >> 12));
+        }
+        values[0] = std::numeric_limits<Fixed>::max();
+        values[1] = std::numeric_limits<Fixed>::lowest();
+        return values;
+    }
+
+    template<typename Fixed>
+    bool batch_matches_scalar() {
+        auto a = random_fixed<Fixed>(1037, 1), b = random_fixed<Fixed>(1037, 2);
+        std::reverse(b.begin(), b.end());
+        std::vector<Fixed> sum(a.size()), difference(a.size()), product(a.size());
+        maths::add(a.data(), b.data(), sum.data(), a.size());
+        maths::sub(a.data(), b.data(), difference.data(), a.size());
+        maths::multiply(a.data(), b.data(), product.data(), a.size());
+        bool valid = true;
+        for (size_t i = 0; i < a.size(); i++)
+            valid = valid && sum[i] == a[i] + b[i] && difference[i] == a[i] - b[i] && product[i] == a[i] * b[i];
+        return valid;
+    }
+
+    LC_TEST(fixed_arithmetic, "Fixed point arithmetic") {
+        constexpr maths::fixed32 three = 3, half{0.5};
+        static_assert(three * half == maths::fixed32{1.5}, "fixed must be constexpr.");
+        REQUIRE(half.raw() == 32768);
+        REQUIRE(static_cast<f64>(three / 2) == 1.5);
+        REQUIRE(static_cast<i32>(-three / 2) == -1);
+        REQUIRE(three - half * 4 == 1);
+        REQUIRE(-three < half && half <= half && three > 0);
+        REQUIRE(maths::fixed32{-1.25}.raw() == -81920);
+        REQUIRE(maths::fixed32{1.0 / 65536 * 0.5}.raw() == 1);
+        REQUIRE(maths::floor(maths::fixed32{-1.25}) == -2);
+        REQUIRE(maths::abs(maths::fixed32{-2.5}) == maths::fixed32{2.5});
+        REQUIRE(three / 0 == std::numeric_limits<maths::fixed32>::max());
+
+        // 32767 + 1 wraps around, or saturates.
+        REQUIRE(maths::fixed32{32767} + 1 == -32768);
+        REQUIRE(maths::fixed32_saturate{32767} + 1 == std::numeric_limits<maths::fixed32_saturate>::max());
+        REQUIRE(maths::fixed32_saturate{-40000} == std::numeric_limits<maths::fixed32_saturate>::lowest());
+        REQUIRE(maths::fixed32_saturate{300} * 300 == std::numeric_limits<maths::fixed32_saturate>::max());
+        REQUIRE(maths::fixed32{300} * 300 == maths::fixed32{(300 * 300) % 65536 - 65536});
+        REQUIRE(maths::fixed16{100} + 100 == maths::fixed16{-56});
+        REQUIRE(sizeof(maths::fixed16) == 2);
+        REQUIRE(std::numeric_limits<maths::fixed16>::epsilon().raw() == 1);
+    }
+
+    LC_TEST(fixed_functions, "Fixed point functions") {
+        bool valid = true;
+        std::mt19937 random{70};
+        for (int i = 0; i < 10000; i++) {
+            auto x = maths::fixed32::from_raw(static_cast<i32>(random() >> 1u));
+            i64 root = maths::sqrt(x).raw(), scaled = static_cast<i64>(x.raw()) << 16;
+            valid = valid && root * root <= scaled && (root + 1) * (root + 1) > scaled;
+        }
+        REQUIRE(valid);
+        REQUIRE(maths::sqrt(maths::fixed32{2.25}) == maths::fixed32{1.5});
+        REQUIRE(maths::sqrt(maths::fixed32{-4}) == 0);
+        static_assert(maths::sqrt(maths::fixed32{16}) == 4, "The fixed point square root must be constexpr.");
+
+        f64 error = 0;
+        for (int i = -10000; i <= 10000; i++) {
+            f64 angle = i * 0.001;
+            error = std::max(error, std::abs(static_cast<f64>(maths::sin(maths::fixed32{angle})) - std::sin(angle)));
+            error = std::max(error, std::abs(static_cast<f64>(maths::cos(maths::fixed32{angle})) - std::cos(angle)));
+        }
+        REQUIRE(error < 3e-5);
+        REQUIRE(maths::sin(maths::fixed32{0}) == 0);
+        REQUIRE(maths::cos(maths::fixed32{0}) == 1);
+        REQUIRE(std::abs(static_cast<f64>(maths::sin(maths::fixed<4, 28>{1.0})) - std::sin(1.0)) < 1e-5);
+    }
+
+    LC_TEST(fixed_geometry, "Fixed point geometry") {
+        Vector2D<maths::fixed32> vector{3, 4};
+        REQUIRE(vector.get_standard() == 5);
+        REQUIRE(vector.to_string() == "(3.000000;4.000000)");
+        vector += Vector2D<maths::fixed32>{maths::fixed32{0.5}, -1};
+        REQUIRE(vector.get_x() == maths::fixed32{3.5} && vector.get_y() == 3);
+        REQUIRE(!vector.is_null());
+        Point2D<maths::fixed32> a{1, 2}, b{maths::fixed32{2.5}, 0};
+        REQUIRE(Vector::from_points(a, b) == Vector2D<maths::fixed32>(maths::fixed32{1.5}, -2));
+        REQUIRE(b.to_string() == "{\"x\":2.500000,\"y\":0.000000}");
+    }
+
+    LC_TEST(fixed_batch, "Fixed point batch operations") {
+        bool valid = true;
+        auto supported = maths::get_supported_simd_level();
+        for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+            if (level > supported || maths::set_simd_level(level) != level)
+                continue;
+            valid = valid && batch_matches_scalar<maths::fixed32>() && batch_matches_scalar<maths::fixed32_saturate>();
+            valid = valid && batch_matches_scalar<maths::fixed<8, 24>>() && batch_matches_scalar<maths::fixed<24, 8, maths::overflow::saturate>>();
+            valid = valid && batch_matches_scalar<maths::fixed<1, 31, maths::overflow::saturate>>() && batch_matches_scalar<maths::fixed<31, 1>>();
+            valid = valid && batch_matches_scalar<maths::fixed16>();
+        }
+        maths::set_simd_level(supported);
+        REQUIRE(valid);
+    }
+}
+
+LC_TEST_SECTION(RectPacker)
+{
+    std::vector<Size2D<u32>> random_sizes(size_t count, u32 seed) {
+        std::mt19937 engine{seed};
+        std::uniform_int_distribution<u32> distribution{4, 64};
+        std::vector<Size2D<u32>> sizes;
+        for (size_t i = 0; i < count; i++)
+            sizes.emplace_back(distribution(engine), distribution(engine));
+        return sizes;
+    }
+
+    /*!
+     * Checks the rectangles are inside their page, do not overlap and keep the padding between them.
+     */
+    bool is_valid_packing(const std::vector<std::optional<maths::packed_rect>>& rects, u32 width, u32 height, u32 padding) {
+        for (size_t i = 0; i < rects.size(); i++) {
+            if (!rects[i])
+                continue;
+            const auto& a = *rects[i];
+            if (a.x + a.width > width || a.y + a.height > height)
+                return false;
+            for (size_t j = i + 1; j < rects.size(); j++) {
+                if (!rects[j] || rects[j]->page != a.page)
+                    continue;
+                const auto& b = *rects[j];
+                if (a.x < b.x + b.width + padding && b.x < a.x + a.width + padding && a.y < b.y + b.height + padding &&
+                    b.y < a.y + a.height + padding)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    LC_TEST(rect_packer_incremental, "rect_packer incremental insertion") {
+        auto sizes = random_sizes(300, 7);
+        for (auto algorithm : {maths::PACK_MAX_RECTS, maths::PACK_SKYLINE}) {
+            for (auto heuristic : {maths::PACK_BEST_SHORT_SIDE_FIT, maths::PACK_BEST_LONG_SIDE_FIT, maths::PACK_BEST_AREA_FIT,
+                                   maths::PACK_BOTTOM_LEFT, maths::PACK_CONTACT_POINT}) {
+                maths::rect_packer packer{{256, 256}, {algorithm, heuristic, true, 1, 0}};
+                std::vector<std::optional<maths::packed_rect>> rects;
+                for (const auto& size : sizes) {
+                    rects.push_back(packer.insert(size));
+                    REQUIRE(rects.back().has_value());
+                    REQUIRE((rects.back()->rotated ? rects.back()->height : rects.back()->width) == size.get_width());
+                }
+                REQUIRE(is_valid_packing(rects, 256, 256, 1));
+                REQUIRE(packer.get_page_count() > 1);
+                REQUIRE(packer.get_occupancy() > 0.5 && packer.get_occupancy() <= 1.0);
+                REQUIRE(packer.get_occupancy(0) > 0.75);
+            }
+        }
+    }
+
+    LC_TEST(rect_packer_limits, "rect_packer rotation and limits") {
+        maths::rect_packer packer{{100, 10}, {maths::PACK_MAX_RECTS, maths::PACK_BEST_SHORT_SIDE_FIT, true, 0, 1}};
+        auto rotated = packer.insert({10, 100});
+        REQUIRE(rotated && rotated->rotated && rotated->width == 100 && rotated->height == 10);
+        REQUIRE(!packer.insert({1, 1}));
+        REQUIRE(!packer.insert({101, 1}));
+        REQUIRE(packer.get_page_count() == 1 && packer.get_occupancy() == 1.0);
+
+        maths::rect_packer fixed{{100, 10}, {maths::PACK_SKYLINE, maths::PACK_BOTTOM_LEFT, false, 0, 0}};
+        REQUIRE(!fixed.insert({10, 100}));
+        for (u32 i = 0; i < 10; i++)
+            REQUIRE(fixed.insert({50, 5}) == maths::packed_rect{i / 4, (i % 2) * 50, (i / 2 % 2) * 5, 50, 5, false});
+        REQUIRE(fixed.get_page_count() == 3);
+        fixed.clear();
+        REQUIRE(fixed.get_page_count() == 0 && fixed.get_occupancy() == 0.0);
+    }
+
+    LC_TEST(rect_packer_offline, "rect_packer offline packing") {
+        auto sizes = random_sizes(400, 11);
+        sizes.emplace_back(600, 1);
+        maths::pack_options options;
+        options.padding = 2;
+
+        system::thread_pool single{1};
+        auto result = maths::rect_packer::pack(sizes, {512, 512}, options, single);
+        REQUIRE(result.rects.size() == sizes.size() && !result.rects.back());
+        REQUIRE(is_valid_packing(result.rects, 512, 512, 2));
+        REQUIRE(result.pages == 3 && result.occupancy > 0.55);
+
+        // The densest incremental packing cannot use fewer pages than the offline one.
+        for (auto heuristic : {maths::PACK_BEST_SHORT_SIDE_FIT, maths::PACK_BOTTOM_LEFT}) {
+            options.heuristic = heuristic;
+            maths::rect_packer packer{{512, 512}, options};
+            for (const auto& size : sizes)
+                packer.insert(size);
+            REQUIRE(packer.get_page_count() >= result.pages);
+        }
+
+        system::thread_pool pool{4};
+        auto other = maths::rect_packer::pack(sizes, {512, 512}, options, pool);
+        REQUIRE(other.rects == result.rects && other.pages == result.pages);
+        REQUIRE(other.chosen.algorithm == result.chosen.algorithm && other.chosen.heuristic == result.chosen.heuristic);
+    }
+}
+
+LC_TEST_SECTION(Geometry2D)
+{
+    std::vector<point2f> star_polygon(size_t tips, f32 inner, f32 outer) {
+        std::vector<point2f> polygon;
+        for (size_t i = 0; i < tips * 2; i++) {
+            f32 angle = static_cast<f32>(i) * static_cast<f32>(M_PI) / static_cast<f32>(tips);
+            f32 radius = i % 2 ? inner : outer;
+            polygon.push_back({radius * std::cos(angle), radius * std::sin(angle)});
+        }
+        return polygon;
+    }
+
+    LC_TEST(geometry2d_area, "geometry2d area and convex hull") {
+        std::vector<point2f> square{{0.f, 0.f}, {4.f, 0.f}, {4.f, 4.f}, {0.f, 4.f}};
+        REQUIRE(maths::geometry2d::signed_area(square) == 16.0);
+        std::vector<point2f> reversed(square.rbegin(), square.rend());
+        REQUIRE(maths::geometry2d::signed_area(reversed) == -16.0 && maths::geometry2d::area(reversed) == 16.0);
+
+        // A grid has its corners as hull, the points along the sides are collinear.
+        std::vector<point2f> points;
+        for (int i = 0; i < 25; i++)
+            points.push_back({static_cast<f32>(i % 5), static_cast<f32>(4 - i / 5)});
+        maths::geometry2d::scratch_buffer scratch;
+        std::vector<u32> hull;
+        maths::geometry2d::convex_hull(points, hull, scratch);
+        REQUIRE(hull == std::vector<u32>({20, 24, 4, 0}));
+
+        std::mt19937 engine{5};
+        std::uniform_real_distribution<f32> distribution{-10.f, 10.f};
+        points.clear();
+        for (int i = 0; i < 500; i++)
+            points.push_back({distribution(engine), distribution(engine)});
+        maths::geometry2d::convex_hull(points, hull, scratch);
+        bool valid = hull.size() >= 3;
+        for (size_t i = 0; i < hull.size(); i++)
+            for (const auto& point : points)
+                valid = valid && maths::geometry2d::orientation(points[hull[i]], points[hull[(i + 1) % hull.size()]], point) >= 0.0;
+        REQUIRE(valid);
+
+        points.assign(3, {1.f, 2.f});
+        maths::geometry2d::convex_hull(points, hull, scratch);
+        REQUIRE(hull.size() == 1);
+        points.resize(1);
+        maths::geometry2d::convex_hull(points, hull, scratch);
+        REQUIRE(hull == std::vector<u32>{0});
+        maths::geometry2d::convex_hull(maths::span<const point2f>{}, hull, scratch);
+        REQUIRE(hull.empty());
+    }
+
+    LC_TEST(geometry2d_simplify, "geometry2d Ramer-Douglas-Peucker simplification") {
+        std::vector<point2f> polyline;
+        for (int i = 0; i <= 100; i++)
+            polyline.push_back({static_cast<f32>(i), i % 2 ? 0.01f : -0.01f});
+        polyline.push_back({100.f, 50.f});
+        maths::geometry2d::scratch_buffer scratch;
+        std::vector<u32> kept;
+        maths::geometry2d::simplify(polyline, 0.1f, kept, scratch);
+        REQUIRE(kept == std::vector<u32>({0, 100, 101}));
+        maths::geometry2d::simplify(polyline, 0.001f, kept, scratch);
+        REQUIRE(kept.size() == polyline.size());
+    }
+
+    LC_TEST(geometry2d_contains, "geometry2d point in polygon") {
+        auto polygon = star_polygon(7, 3.f, 10.f);
+        REQUIRE(maths::geometry2d::contains(polygon, point2f{0.f, 0.f}));
+        REQUIRE(maths::geometry2d::contains(polygon, point2f{9.f, 0.1f}));
+        REQUIRE(!maths::geometry2d::contains(polygon, point2f{5.f, 4.f}));
+        REQUIRE(!maths::geometry2d::contains(polygon, point2f{11.f, 0.f}));
+
+        std::mt19937 engine{9};
+        std::uniform_real_distribution<f32> distribution{-12.f, 12.f};
+        std::vector<point2f> points;
+        for (int i = 0; i < 1003; i++)
+            points.push_back({distribution(engine), distribution(engine)});
+        maths::geometry2d::scratch_buffer scratch;
+        std::vector<u8> inside;
+        bool valid = true;
+        auto supported = maths::get_supported_simd_level();
+        for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+            if (level > supported || maths::set_simd_level(level) != level)
+                continue;
+            maths::geometry2d::contains(polygon, points, inside, scratch);
+            valid = valid && inside.size() == points.size();
+            for (size_t i = 0; i < points.size(); i++)
+                valid = valid && (inside[i] != 0) == maths::geometry2d::contains(polygon, points[i]);
+        }
+        maths::set_simd_level(supported);
+        REQUIRE(valid);
+        REQUIRE(std::count(inside.begin(), inside.end(), 1) > 100);
+    }
+
+    LC_TEST(geometry2d_intersections, "geometry2d segment intersection sweep") {
+        std::mt19937 engine{13};
+        std::uniform_real_distribution<f32> distribution{0.f, 100.f}, offset{-8.f, 8.f};
+        std::vector<maths::geometry2d::segment2f> segments;
+        for (int i = 0; i < 300; i++) {
+            point2f a{distribution(engine), distribution(engine)};
+            segments.push_back({a, {a.x + offset(engine), a.y + offset(engine)}});
+        }
+        segments.push_back({{0.f, 0.f}, {10.f, 0.f}});
+        segments.push_back({{10.f, 0.f}, {10.f, 10.f}});
+
+        std::vector<std::pair<u32, u32>> expected;
+        for (u32 i = 0; i < segments.size(); i++)
+            for (u32 j = i + 1; j < segments.size(); j++)
+                if (maths::geometry2d::intersects(segments[i], segments[j]))
+                    expected.emplace_back(i, j);
+        maths::geometry2d::scratch_buffer scratch;
+        std::vector<std::pair<u32, u32>> pairs;
+        maths::geometry2d::find_intersections(segments, pairs, scratch);
+        REQUIRE(pairs == expected && !pairs.empty());
+        REQUIRE(pairs.back() == std::make_pair(300u, 301u));
+        REQUIRE(!maths::geometry2d::intersects({{0.f, 0.f}, {1.f, 1.f}}, {{2.f, 2.f}, {3.f, 3.f}}));
+        REQUIRE(maths::geometry2d::intersects({{0.f, 0.f}, {2.f, 2.f}}, {{1.f, 1.f}, {3.f, 3.f}}));
+    }
+
+    LC_TEST(geometry2d_triangulate, "geometry2d ear clipping") {
+        maths::geometry2d::scratch_buffer scratch;
+        std::vector<u32> triangles;
+        auto polygon = star_polygon(9, 2.f, 7.f);
+        std::vector<point2f> l_shape{{0.f, 0.f}, {2.f, 0.f}, {2.f, 0.f}, {2.f, 1.f}, {1.f, 1.f}, {1.f, 3.f}, {0.f, 3.f}, {0.f, 1.5f}};
+        for (const auto& shape : {polygon, l_shape, std::vector<point2f>(polygon.rbegin(), polygon.rend())}) {
+            maths::geometry2d::triangulate(shape, triangles, scratch);
+            REQUIRE(triangles.size() == (shape.size() - 2) * 3);
+            f64 area = 0.0, turn = maths::geometry2d::signed_area(shape);
+            bool valid = true;
+            for (size_t i = 0; i < triangles.size(); i += 3) {
+                f64 triangle = maths::geometry2d::orientation(shape[triangles[i]], shape[triangles[i + 1]], shape[triangles[i + 2]]) / 2.0;
+                valid = valid && triangle * turn >= 0.0;
+                area += triangle;
+            }
+            REQUIRE(valid);
+            REQUIRE(std::abs(area - turn) < 1e-4);
+        }
+    }
+}
+
+LC_TEST_SECTION(Noise)
+{
+    using namespace maths::noise;
+
+    f32 sample_at(const noise_settings& settings, u32 dimensions, f32 x, f32 y, f32 z, f32 w) {
+        if (dimensions == 2)
+            return sample(settings, x, y);
+        else if (dimensions == 3)
+            return sample(settings, x, y, z);
+        return sample(settings, x, y, z, w);
+    }
+
+    LC_TEST(noise_range, "noise range and continuity") {
+        bool valid = true;
+        for (auto type : {NOISE_VALUE, NOISE_PERLIN, NOISE_SIMPLEX}) {
+            for (auto fractal : {FRACTAL_NONE, FRACTAL_FBM, FRACTAL_RIDGED}) {
+                noise_settings settings;
+                settings.type = type;
+                settings.fractal = fractal;
+                settings.frequency = 0.37f;
+                for (u32 dimensions = 2; dimensions <= 4; dimensions++) {
+                    f32 minimum = 1.f, maximum = -1.f;
+                    for (int i = 0; i < 2000; i++) {
+                        f32 x = static_cast<f32>(i % 50) * 0.93f - 20.f, y = static_cast<f32>(i / 50) * 1.17f, z = static_cast<f32>(i % 7), w = -3.5f;
+                        f32 value = sample_at(settings, dimensions, x, y, z, w);
+                        minimum = std::min(minimum, value);
+                        maximum = std::max(maximum, value);
+                        valid = valid && std::abs(value) <= 1.f;
+                        valid = valid && std::abs(sample_at(settings, dimensions, x + 0.001f, y, z, w) - value) < 0.05f;
+                    }
+                    // Every noise spreads over most of its range.
+                    valid = valid && maximum - minimum > 0.6f;
+                }
+            }
+        }
+        REQUIRE(valid);
+    }
+
+    LC_TEST(noise_seed, "noise seed stability") {
+        noise_settings settings;
+        settings.frequency = 0.1f;
+        f32 first = sample(settings, 12.5f, -7.25f, 3.f);
+        REQUIRE(sample(settings, 12.5f, -7.25f, 3.f) == first);
+        settings.seed++;
+        REQUIRE(sample(settings, 12.5f, -7.25f, 3.f) != first);
+        settings.seed--;
+        settings.type = NOISE_PERLIN;
+        REQUIRE(sample(settings, 12.5f, -7.25f, 3.f) != first);
+        // The gradient noises are 0 on the lattice points.
+        settings.frequency = 1.f;
+        REQUIRE(sample(settings, 3.f, -2.f) == 0.f && sample(settings, 3.f, -2.f, 5.f, 1.f) == 0.f);
+    }
+
+    LC_TEST(noise_batch, "noise batch and grid fill") {
+        const u32 width = 67, height = 5, depth = 3;
+        std::vector<f32> expected(width * height * depth), grid(expected.size()), x(expected.size()), y(expected.size()), z(expected.size()),
+                w(expected.size(), 2.5f);
+        bool valid = true;
+        auto supported = maths::get_supported_simd_level();
+        for (auto type : {NOISE_VALUE, NOISE_PERLIN, NOISE_SIMPLEX}) {
+            noise_settings settings;
+            settings.type = type;
+            settings.fractal = FRACTAL_FBM;
+            settings.octaves = 4;
+            settings.frequency = 0.21f;
+            for (u32 k = 0; k < depth; k++) {
+                for (u32 j = 0; j < height; j++) {
+                    for (u32 i = 0; i < width; i++) {
+                        size_t index = (k * height + j) * width + i;
+                        x[index] = -10.f + static_cast<f32>(i);
+                        y[index] = 4.f + static_cast<f32>(j);
+                        z[index] = 0.5f + static_cast<f32>(k);
+                        expected[index] = sample(settings, x[index], y[index], z[index], w[index]);
+                    }
+                }
+            }
+
+            for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+                if (level > supported || maths::set_simd_level(level) != level)
+                    continue;
+                sample(settings, x.data(), y.data(), z.data(), w.data(), grid.data(), grid.size());
+                for (size_t i = 0; i < grid.size(); i++)
+                    valid = valid && std::abs(grid[i] - expected[i]) < 1e-4f;
+
+                system::thread_pool single{1};
+                fill(settings, grid.data(), width, height, depth, -10.f, 4.f, 0.5f, 2.5f, single);
+                for (size_t i = 0; i < grid.size(); i++)
+                    valid = valid && std::abs(grid[i] - expected[i]) < 1e-4f;
+
+                // The output does not depend on how the grid is split.
+                std::vector<f32> split(grid.size());
+                system::thread_pool pool{3};
+                fill(settings, split.data(), width, height, depth, -10.f, 4.f, 0.5f, 2.5f, pool);
+                valid = valid && split == grid;
+
+                fill(settings, grid.data(), width, height, -10.f, 4.f, pool);
+                valid = valid && std::abs(grid[width + 3] - sample(settings, -7.f, 5.f)) < 1e-4f;
+            }
+        }
+        maths::set_simd_level(supported);
+        REQUIRE(valid);
+    }
+
+    LC_TEST(noise_fill_threads, "noise grid fill with any count of threads") {
+        // Large enough to be split, with rows which do not divide the ranges of the threads.
+        const u32 width = 203, height = 77;
+        std::vector<f32> expected(width * height), grid(expected.size());
+        bool valid = true;
+        for (auto type : {NOISE_VALUE, NOISE_PERLIN, NOISE_SIMPLEX}) {
+            noise_settings settings;
+            settings.type = type;
+            settings.fractal = FRACTAL_RIDGED;
+            settings.octaves = 3;
+            settings.frequency = 0.037f;
+            system::thread_pool single{1};
+            fill(settings, expected.data(), width, height, -31.5f, 7.25f, single);
+            for (u32 threads : {3u, 7u}) {
+                system::thread_pool pool{threads};
+                fill(settings, grid.data(), width, height, -31.5f, 7.25f, pool);
+                valid = valid && std::memcmp(grid.data(), expected.data(), grid.size() * sizeof(f32)) == 0;
+            }
+        }
+        REQUIRE(valid);
+    }
+}
+
+LC_TEST_SECTION(Expression)
+{
+    template<typename A, typename B, typename = void>
+    struct can_add : std::false_type
+    {};
+
+    template<typename A, typename B>
+    struct can_add<A, B, std::void_t<decltype(std::declval<A>() + std::declval<B>())>> : std::true_type
+    {};
+
+    template<typename T, typename = void>
+    struct can_lazy : std::false_type
+    {};
+
+    template<typename T>
+    struct can_lazy<T, std::void_t<decltype(maths::lazy(std::declval<T>()))>> : std::true_type
+    {};
+
+    LC_TEST(expression_vectors, "lazy expressions over vec3_soa") {
+        // 37 vectors leave a tail after the blocks.
+        maths::vec3_soa<f32> a, b, c;
+        std::vector<f32> weights;
+        for (int i = 0; i < 37; i++) {
+            a.push_back({static_cast<f32>(i) + 1.f, static_cast<f32>(i % 5) - 2.f, 0.5f * static_cast<f32>(i)});
+            b.push_back({2.f - static_cast<f32>(i % 7), static_cast<f32>(i) * 0.25f, 3.f});
+            c.push_back({1.f, -static_cast<f32>(i % 3), static_cast<f32>(i % 4)});
+            weights.push_back(static_cast<f32>(i % 6) * 0.5f);
+        }
+
+        maths::vec3_soa<f32> result;
+        maths::evaluate(a + b - c * 2.f, result);
+        REQUIRE(result.size() == a.size());
+        bool valid = true;
+        for (size_t i = 0; i < a.size(); i++)
+            valid &= result.get(i) == a.get(i) + b.get(i) - c.get(i) * 2.f;
+        REQUIRE(valid);
+
+        maths::evaluate(-maths::cross(a, b) / vec3f{2.f, 4.f, 8.f} + maths::lazy(weights) * a, result);
+        for (size_t i = 0; i < a.size(); i++)
+            valid &= result.get(i) == -cross(a.get(i), b.get(i)) / vec3f{2.f, 4.f, 8.f} + a.get(i) * weights[i];
+        REQUIRE(valid);
+
+        // The output may be an operand.
+        maths::vec3_soa<f32> in_place = a;
+        maths::evaluate(in_place * 0.5f + b, in_place);
+        REQUIRE(in_place.get(36) == a.get(36) * 0.5f + b.get(36));
+        REQUIRE(in_place.get(3) == a.get(3) * 0.5f + b.get(3));
+
+        maths::evaluate(maths::normalize(a - b), result);
+        for (size_t i = 0; i < a.size(); i++)
+            valid &= length(result.get(i) - normalize(a.get(i) - b.get(i))) < 1e-6f;
+        REQUIRE(valid);
+    }
+
+    LC_TEST(expression_scalars, "lazy expressions of numbers and user functions") {
+        maths::vec3_soa<f32> a, b;
+        std::vector<f32> offsets;
+        for (int i = 0; i < 21; i++) {
+            a.push_back({static_cast<f32>(i), 1.f, -static_cast<f32>(i % 4)});
+            b.push_back({0.5f, static_cast<f32>(i % 3), 2.f});
+            offsets.push_back(static_cast<f32>(i) * 0.25f);
+        }
+
+        std::vector<f32> result;
+        maths::evaluate(maths::dot(a, b) + maths::lazy(offsets), result);
+        REQUIRE(result.size() == a.size());
+        bool valid = true;
+        for (size_t i = 0; i < a.size(); i++)
+            valid &= result[i] == dot(a.get(i), b.get(i)) + offsets[i];
+        REQUIRE(valid);
+
+        // A user function gets the elements of its operands, here the vectors of a and the numbers of the previous result.
+        auto clamped = maths::map([](const vec3f& v, f32 limit) { return std::min(length(v), limit); }, a, maths::lazy(result));
+        std::vector<f32> lengths;
+        maths::evaluate(clamped, lengths);
+        for (size_t i = 0; i < a.size(); i++)
+            valid &= lengths[i] == std::min(length(a.get(i)), result[i]);
+        REQUIRE(valid);
+
+        maths::vec3_soa<f32> reflected;
+        maths::evaluate(maths::map([](const vec3f& v, const vec3f& n) { return v - n * (2.f * dot(v, n)); }, a, vec3f{0.f, 1.f, 0.f}), reflected);
+        REQUIRE(reflected.get(7) == (vec3f{7.f, -1.f, -3.f}));
+
+        // The size is the smallest one of the operands, the constants do not have any.
+        std::vector<f32> shorter(offsets.begin(), offsets.begin() + 5);
+        REQUIRE((maths::lazy(shorter) + maths::length(a)).size() == 5);
+        REQUIRE((a * 2.f).size() == a.size());
+
+        // An expression would outlive a temporary array.
+        REQUIRE((can_add<const maths::vec3_soa<f32>&, maths::vec3_soa<f32>&>::value));
+        REQUIRE(!(can_add<maths::vec3_soa<f32>, const maths::vec3_soa<f32>&>::value));
+        REQUIRE(!(can_add<const maths::vec3_soa<f32>&, maths::vec3_soa<f32>&&>::value));
+        REQUIRE(can_lazy<std::vector<f32>&>::value && can_lazy<const maths::vec3_soa<f32>&>::value);
+        REQUIRE(!can_lazy<std::vector<f32>>::value && !can_lazy<const std::vector<f32>&&>::value);
+        REQUIRE(!can_lazy<maths::vec3_soa<f32>>::value);
+    }
 }
 
 LC_TEST_SECTION(Size)
@@ -180,6 +2421,62 @@ LC_TEST_SECTION(Color)
     LC_TEST(color_from_hex, "color::from_hex(uint64_t color, bool has_alpha)") {
         REQUIRE(color::from_hex(0xCE0031AA).to_string(false) == "rgba(206, 0, 49, 170)");
     }
+
+    LC_TEST(color_packed, "color_rgba8 and color_f32x4 conversions") {
+        // Rounded to nearest where Color::red_as_int() truncates.
+        REQUIRE(color::to_rgba8(Color{0.999f, 0.5f, 0.f, 1.f}) == (color_rgba8{255, 128, 0, 255}));
+        REQUIRE(color::to_rgba8(color_f32x4{-1.f, 2.f, std::numeric_limits<f32>::quiet_NaN(), 0.502f}) == (color_rgba8{0, 255, 0, 128}));
+        REQUIRE(color::to_rgba8(color_f32x4{1.f, 0.5f, 0.25f, 0.5f}, ALPHA_PREMULTIPLY) == (color_rgba8{128, 64, 32, 128}));
+        REQUIRE(color::to_rgba8(color_f32x4{0.5f, 0.25f, 0.f, 0.5f}, ALPHA_UNPREMULTIPLY) == (color_rgba8{255, 128, 0, 128}));
+        REQUIRE(color::to_f32x4(color_rgba8{255, 51, 0, 0}, ALPHA_UNPREMULTIPLY) == (color_f32x4{0.f, 0.f, 0.f, 0.f}));
+        REQUIRE(color::to_f32x4(color_rgba8{255, 51, 0, 51}) == (color_f32x4{1.f, 0.2f, 0.f, 0.2f}));
+
+        // Every byte, with every alpha, in colors whose count leaves a tail for every register width.
+        std::vector<color_rgba8> bytes;
+        for (u32 a = 0; a < 256; a++)
+            for (u32 c = 0; c < 256; c += 3)
+                bytes.push_back({static_cast<u8>(c), static_cast<u8>(c + 1), static_cast<u8>(c + 2), static_cast<u8>(a)});
+        std::vector<color_f32x4> floats;
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<f32> distribution(-0.1f, 1.1f);
+        for (int i = 0; i < 1001; i++)
+            floats.push_back({distribution(generator), distribution(generator), distribution(generator), distribution(generator)});
+
+        auto supported = maths::get_supported_simd_level();
+        bool valid = true;
+        for (auto level : {maths::SIMD_SCALAR, maths::SIMD_SSE2, maths::SIMD_NEON, maths::SIMD_AVX2, maths::SIMD_AVX512}) {
+            if (level > supported || maths::set_simd_level(level) != level)
+                continue;
+            std::vector<color_f32x4> unpacked(bytes.size());
+            std::vector<color_rgba8> packed(bytes.size());
+            color::to_f32x4(bytes.data(), unpacked.data(), bytes.size());
+            color::to_rgba8(unpacked.data(), packed.data(), bytes.size());
+            valid = valid && packed == bytes;
+
+            auto premultiplied = bytes;
+            color::premultiply(premultiplied.data(), premultiplied.size());
+            for (size_t i = 0; i < bytes.size(); i++) {
+                auto [red, green, blue, alpha] = bytes[i];
+                valid = valid && premultiplied[i] == (color_rgba8{static_cast<u8>((red * alpha + 127) / 255), static_cast<u8>((green * alpha + 127) / 255),
+                                                                   static_cast<u8>((blue * alpha + 127) / 255), alpha});
+            }
+            auto restored = premultiplied;
+            color::unpremultiply(restored.data(), restored.size());
+            valid = valid && restored.back() == bytes.back() && restored[bytes.size() / 2].alpha == bytes[bytes.size() / 2].alpha;
+
+            for (auto conversion : {ALPHA_KEEP, ALPHA_PREMULTIPLY, ALPHA_UNPREMULTIPLY}) {
+                packed.resize(floats.size());
+                color::to_rgba8(floats.data(), packed.data(), floats.size(), conversion);
+                color::to_f32x4(bytes.data(), unpacked.data(), bytes.size(), conversion);
+                for (size_t i = 0; i < floats.size(); i++)
+                    valid = valid && packed[i] == color::to_rgba8(floats[i], conversion);
+                for (size_t i = 0; i < bytes.size(); i++)
+                    valid = valid && unpacked[i] == color::to_f32x4(bytes[i], conversion);
+            }
+        }
+        maths::set_simd_level(supported);
+        REQUIRE(valid);
+    }
 }
 
 auto main() -> int {